@@ -0,0 +1,3 @@
+set(BENCHMARK-SOURCES
+    benchmark/main.cpp
+    )
@@ -0,0 +1,109 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <rbxdoc.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "test_rbxm.h"
+
+using namespace rbxdoc;
+
+// Load time benchmark of binary files
+// The synthetic file has one type with numeric fixed-layout columns only (uncompressed), so the time is spent in the column decoders and
+// in property storage rather than in decompression. Files passed on the command line are measured as they are.
+
+static bool saveColumnsFile(const std::string& fileName, size_t numRows)
+{
+    std::vector<int32_t> ids(numRows);
+    std::vector<int32_t> parents(numRows, -1);
+    std::vector<int32_t> ints(numRows);
+    std::vector<int64_t> longs(numRows);
+    std::vector<float> floats(numRows);
+    std::vector<float> x(numRows);
+    std::vector<float> y(numRows);
+    std::vector<float> z(numRows);
+    std::vector<uint64_t> enums(numRows);
+    std::string bools(numRows, '\0');
+    for (size_t i = 0; i < numRows; i++)
+    {
+        ids[i] = int32_t(i);
+        ints[i] = int32_t(i * 7) - 1000;
+        longs[i] = int64_t(i) * 1000003 - 5;
+        floats[i] = float(i) * 0.25f;
+        x[i] = float(i);
+        y[i] = -float(i);
+        z[i] = float(i % 100);
+        enums[i] = i % 5;
+        bools[i] = char(i & 1);
+    }
+
+    using Builder = rbxdoc_test::RbxmBuilder;
+    Builder file;
+    file.addInstances(0, "Part", ids);
+    file.addProperty(0, "IntValue", PropertyType::Int32, Builder::int32s(ints));
+    file.addProperty(0, "LongValue", PropertyType::Int64, Builder::int64s(longs));
+    file.addProperty(0, "Transparency", PropertyType::Float, Builder::floats(floats));
+    file.addProperty(0, "size", PropertyType::Vector3, Builder::floats(x) + Builder::floats(y) + Builder::floats(z));
+    file.addProperty(0, "Material", PropertyType::Enum, Builder::interleave(enums, 4));
+    file.addProperty(0, "Anchored", PropertyType::Bool, bools);
+    file.addParents(ids, parents);
+    return file.save(fileName);
+}
+
+// best of several loads, returns a negative value if the file can not be loaded
+static double measureLoad(const char* fileName, int numIterations)
+{
+    double best = -1.0;
+    for (int i = 0; i < numIterations; i++)
+    {
+        Document doc;
+        auto start = std::chrono::steady_clock::now();
+        LoadResult res = doc.loadFile(fileName);
+        auto finish = std::chrono::steady_clock::now();
+        if (res != LoadResult::OK)
+        {
+            const LoadError& err = doc.getLoadError();
+            printf("Can't load file %s: %s (chunk %d '%s', offset %zu)\n", fileName, err.reason, err.chunkIndex, err.chunkName, err.offset);
+            return -1.0;
+        }
+
+        double ms = std::chrono::duration<double, std::milli>(finish - start).count();
+        best = (best < 0.0) ? ms : std::min(best, ms);
+    }
+    return best;
+}
+
+// usage: rbxdoc-benchmark [number of rows] [file.rbxm ...]
+int main(int argc, char** argv)
+{
+    const int kNumIterations = 10;
+    size_t numRows = (argc > 1) ? size_t(strtoull(argv[1], nullptr, 10)) : 200000;
+
+    std::string fileName = "rbxdoc_benchmark_columns.rbxm";
+    if (!saveColumnsFile(fileName, numRows))
+    {
+        printf("Can't write %s\n", fileName.c_str());
+        return -1;
+    }
+
+    double ms = measureLoad(fileName.c_str(), kNumIterations);
+    remove(fileName.c_str());
+    if (ms < 0.0)
+    {
+        return -1;
+    }
+    printf("columns: %zu rows x 6 columns, %.2f ms, %.1f ns/value\n", numRows, ms, ms * 1e6 / double(numRows * 6));
+
+    for (int i = 2; i < argc; i++)
+    {
+        ms = measureLoad(argv[i], kNumIterations);
+        if (ms < 0.0)
+        {
+            return -1;
+        }
+        printf("%s: %.2f ms\n", argv[i], ms);
+    }
+    return 0;
+}
@@ -1,9 +1,39 @@
 set(LIB-SOURCES
     rbx-doc/rbxdoc.cpp
+    rbx-doc/rbxdoc_assets.cpp
+    rbx-doc/rbxdoc_async.cpp
     rbx-doc/rbxdoc_binary.cpp
+    rbx-doc/rbxdoc_copy.cpp
+    rbx-doc/rbxdoc_diff.cpp
+    rbx-doc/rbxdoc_export.cpp
+    rbx-doc/rbxdoc_file.cpp
+    rbx-doc/rbxdoc_hash.cpp
+    rbx-doc/rbxdoc_intern.cpp
+    rbx-doc/rbxdoc_mesh.cpp
+    rbx-doc/rbxdoc_names.cpp
+    rbx-doc/rbxdoc_query.cpp
+    rbx-doc/rbxdoc_snapshot.cpp
+    rbx-doc/rbxdoc_spatial.cpp
+    rbx-doc/rbxdoc_transform.cpp
+    rbx-doc/rbxdoc_xml.cpp
     )
 
 set(LIB-HEADERS
     rbx-doc/rbxdoc.h
+    rbx-doc/rbxdoc_assets.h
+    rbx-doc/rbxdoc_async.h
     rbx-doc/rbxdoc_binary.h
+    rbx-doc/rbxdoc_diff.h
+    rbx-doc/rbxdoc_export.h
+    rbx-doc/rbxdoc_file.h
+    rbx-doc/rbxdoc_hash.h
+    rbx-doc/rbxdoc_intern.h
+    rbx-doc/rbxdoc_mesh.h
+    rbx-doc/rbxdoc_names.h
+    rbx-doc/rbxdoc_parallel.h
+    rbx-doc/rbxdoc_query.h
+    rbx-doc/rbxdoc_snapshot.h
+    rbx-doc/rbxdoc_spatial.h
+    rbx-doc/rbxdoc_transform.h
+    rbx-doc/rbxdoc_xml.h
     )
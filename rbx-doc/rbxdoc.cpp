@@ -1,7 +1,19 @@
 #include "rbxdoc.h"
 #include "rbxdoc_binary.h"
+#include "rbxdoc_hash.h"
+#include "rbxdoc_intern.h"
+#include "rbxdoc_parallel.h"
+#include "rbxdoc_xml.h"
+#include <algorithm>
+#include <iterator>
 #include <string.h>
 
+#ifdef _MSC_VER
+    #define strcasecmp _stricmp
+#else
+    #include <strings.h>
+#endif
+
 namespace rbxdoc
 {
 
@@ -12,23 +24,103 @@ Type::Type(std::string&& _name)
 
 const char* Type::getName() const { return name.c_str(); }
 
+ArrayView<int32_t> Type::getInstances() const { return ArrayView<int32_t>(instanceIds.begin(), instanceIds.end()); }
+
+ArrayView<PropertyInfo> Type::getProperties() const { return ArrayView<PropertyInfo>(properties.begin(), properties.end()); }
+
+int32_t Type::findProperty(const char* propertyName, bool ignoreCase) const
+{
+    for (size_t i = 0; i < properties.size(); i++)
+    {
+        const char* name = properties[i].name;
+        if (ignoreCase ? (strcasecmp(name, propertyName) == 0) : (strcmp(name, propertyName) == 0))
+        {
+            return int32_t(i);
+        }
+    }
+    return -1;
+}
+
 Property::Property(const char* _name, PropertyType _type)
-    : name(_name)
+    : name(_name ? _name : "")
     , type(_type)
 {
 }
 
 PropertyType Property::getType() const { return type; }
-const char* Property::getName() const { return name.c_str(); }
+const char* Property::getName() const { return name; }
+
+const char* Property::findString(size_t& size) const
+{
+    const ValuePool* pool = data.pooled.pool;
+    uint32_t index = data.pooled.index;
+    switch (type)
+    {
+    case PropertyType::String:
+    case PropertyType::SharedString:
+    case PropertyType::Bytecode:
+        break;
+    case PropertyType::Content:
+    {
+        const ValuePool::ContentRef& content = pool->contents[index];
+        if (content.sourceType != ContentSourceType::Uri)
+        {
+            return nullptr;
+        }
+        index = content.uri;
+        break;
+    }
+    default:
+        return nullptr;
+    }
+
+    const ValuePool::StringRef& str = pool->strings[index];
+    size = str.size;
+    return str.data;
+}
 
 const char* Property::asString(const char* defaultVal) const
 {
-    if (type != PropertyType::String)
+    size_t size;
+    const char* str = findString(size);
+    return str ? str : defaultVal;
+}
+
+ArrayView<char> Property::asBytes() const
+{
+    size_t size;
+    const char* str = findString(size);
+    return str ? ArrayView<char>(str, size) : ArrayView<char>();
+}
+
+bool Property::asBool(bool defaultVal) const
+{
+    if (type != PropertyType::Bool)
+    {
+        return defaultVal;
+    }
+
+    return data.b;
+}
+
+int32_t Property::asInt32(int32_t defaultVal) const
+{
+    if (type != PropertyType::Int32)
+    {
+        return defaultVal;
+    }
+
+    return data.i32;
+}
+
+int64_t Property::asInt64(int64_t defaultVal) const
+{
+    if (type != PropertyType::Int64)
     {
         return defaultVal;
     }
 
-    return std::get<std::string>(data).c_str();
+    return data.i64;
 }
 
 float Property::asFloat(float defaultVal) const
@@ -38,7 +130,57 @@ float Property::asFloat(float defaultVal) const
         return defaultVal;
     }
 
-    return std::get<float>(data);
+    return data.f;
+}
+
+double Property::asDouble(double defaultVal) const
+{
+    if (type != PropertyType::Double)
+    {
+        return defaultVal;
+    }
+
+    return data.d;
+}
+
+uint32_t Property::asEnum(uint32_t defaultVal) const
+{
+    if (type != PropertyType::Enum)
+    {
+        return defaultVal;
+    }
+
+    return data.u32;
+}
+
+BrickColor Property::asBrickColor(BrickColor defaultVal) const
+{
+    if (type != PropertyType::BrickColor)
+    {
+        return defaultVal;
+    }
+
+    return data.brickColor;
+}
+
+const Color3& Property::asColor3(const Color3& defaultVal) const
+{
+    if (type != PropertyType::Color3 && type != PropertyType::UColor3)
+    {
+        return defaultVal;
+    }
+
+    return data.color3;
+}
+
+const Vec2& Property::asVec2(const Vec2& defaultVal) const
+{
+    if (type != PropertyType::Vector2)
+    {
+        return defaultVal;
+    }
+
+    return data.v2;
 }
 
 const Vec3& Property::asVec3(const Vec3& defaultVal) const
@@ -48,7 +190,127 @@ const Vec3& Property::asVec3(const Vec3& defaultVal) const
         return defaultVal;
     }
 
-    return std::get<Vec3>(data);
+    return data.v3;
+}
+
+const Vec2int16& Property::asVec2int16(const Vec2int16& defaultVal) const
+{
+    if (type != PropertyType::Vector2int16)
+    {
+        return defaultVal;
+    }
+
+    return data.v2i16;
+}
+
+const Vec3int16& Property::asVec3int16(const Vec3int16& defaultVal) const
+{
+    if (type != PropertyType::Vector3int16)
+    {
+        return defaultVal;
+    }
+
+    return data.v3i16;
+}
+
+const UDim& Property::asUDim(const UDim& defaultVal) const
+{
+    if (type != PropertyType::UDim)
+    {
+        return defaultVal;
+    }
+
+    return data.udim;
+}
+
+const UDim2& Property::asUDim2(const UDim2& defaultVal) const
+{
+    if (type != PropertyType::UDim2)
+    {
+        return defaultVal;
+    }
+
+    return data.udim2;
+}
+
+const Ray& Property::asRay(const Ray& defaultVal) const
+{
+    if (type != PropertyType::Ray)
+    {
+        return defaultVal;
+    }
+
+    return data.pooled.pool->rays[data.pooled.index];
+}
+
+uint8_t Property::asFaces(uint8_t defaultVal) const
+{
+    if (type != PropertyType::Faces)
+    {
+        return defaultVal;
+    }
+
+    return data.u8;
+}
+
+uint8_t Property::asAxes(uint8_t defaultVal) const
+{
+    if (type != PropertyType::Axes)
+    {
+        return defaultVal;
+    }
+
+    return data.u8;
+}
+
+uint64_t Property::asSecurityCapabilities(uint64_t defaultVal) const
+{
+    if (type != PropertyType::SecurityCapabilities)
+    {
+        return defaultVal;
+    }
+
+    return data.u64;
+}
+
+ContentSourceType Property::asContentSourceType(ContentSourceType defaultVal) const
+{
+    if (type != PropertyType::Content)
+    {
+        return defaultVal;
+    }
+
+    return data.pooled.pool->contents[data.pooled.index].sourceType;
+}
+
+const Rect2D& Property::asRect2D(const Rect2D& defaultVal) const
+{
+    if (type != PropertyType::Rect2D)
+    {
+        return defaultVal;
+    }
+
+    return data.rect2D;
+}
+
+const NumberRange& Property::asNumberRange(const NumberRange& defaultVal) const
+{
+    if (type != PropertyType::NumberRange)
+    {
+        return defaultVal;
+    }
+
+    return data.numberRange;
+}
+
+const UniqueId& Property::asUniqueId(const UniqueId& defaultVal) const
+{
+    if (type != PropertyType::UniqueId)
+    {
+        return defaultVal;
+    }
+
+    return data.uniqueId;
 }
 
 const CFrame& Property::asCFrame(const CFrame& defaultVal) const
@@ -60,81 +322,992 @@ const CFrame& Property::asCFrame(const CFrame& defaultVal) const
 
     if (type == PropertyType::OptionalCFrame)
     {
-        const OptionalCFrame& ocf = std::get<OptionalCFrame>(data);
+        const OptionalCFrame& ocf = data.pooled.pool->optionalCFrames[data.pooled.index];
         if (ocf.hasData)
         {
             return ocf.val;
         }
+        return defaultVal;
     }
-    return std::get<CFrame>(data);
+    return data.pooled.pool->cframes[data.pooled.index];
 }
 
+const OptionalCFrame& Property::asOptionalCFrame(const OptionalCFrame& defaultVal) const
+{
+    if (type != PropertyType::OptionalCFrame)
+    {
+        return defaultVal;
+    }
 
-Instance::Instance(int32_t _parentId, int32_t _id, uint32_t _typeIndex, bool _isService, bool _isServiceRooted)
-    : parentId(_parentId)
-    , id(_id)
-    , typeIndex(_typeIndex)
-    , isService(_isService)
-    , isServiceRooted(_isServiceRooted)
+    return data.pooled.pool->optionalCFrames[data.pooled.index];
+}
+
+const PhysicalProperties& Property::asPhysicalProperties(const PhysicalProperties& defaultVal) const
 {
+    if (type != PropertyType::PhysicalProperties)
+    {
+        return defaultVal;
+    }
+
+    return data.pooled.pool->physicalProperties[data.pooled.index];
 }
 
-ArrayView<Property> Instance::getProperties() const { return ArrayView<Property>(properties.begin(), properties.end()); }
+const FontInfo& Property::asFont(const FontInfo& defaultVal) const
+{
+    if (type != PropertyType::Font)
+    {
+        return defaultVal;
+    }
+
+    return data.pooled.pool->fonts[data.pooled.index];
+}
 
-LoadResult Document::loadFile(const char* fileName)
+ArrayView<NumberSeq::KeyValue> Property::asNumberSequence() const
 {
-    if (!fileName)
+    if (type != PropertyType::NumberSequence)
     {
-        return LoadResult::Error;
+        return ArrayView<NumberSeq::KeyValue>();
     }
 
-    size_t len = strlen(fileName);
-    if (len == 0)
+    const ValuePool::SequenceRef<NumberSeq::KeyValue>& seq = data.pooled.pool->numberSequences[data.pooled.index];
+    return ArrayView<NumberSeq::KeyValue>(seq.data, seq.size);
+}
+
+ArrayView<ColorSeq::KeyValue> Property::asColorSequence() const
+{
+    if (type != PropertyType::ColorSequenceV1)
     {
-        return LoadResult::Error;
+        return ArrayView<ColorSeq::KeyValue>();
     }
 
-    char lastChar = fileName[len - 1];
-    if (lastChar == 'x' || lastChar == 'X')
+    const ValuePool::SequenceRef<ColorSeq::KeyValue>& seq = data.pooled.pool->colorSequences[data.pooled.index];
+    return ArrayView<ColorSeq::KeyValue>(seq.data, seq.size);
+}
+
+int32_t Property::asRef(int32_t defaultVal) const
+{
+    if (type == PropertyType::Content)
     {
-        // rbxlx, or rbxmx = XML based format (not supported for now)
-        return LoadResult::Error;
+        const ValuePool::ContentRef& content = data.pooled.pool->contents[data.pooled.index];
+        return (content.sourceType == ContentSourceType::Object) ? content.objectId : defaultVal;
     }
 
-    try
+    if (type != PropertyType::Ref)
     {
-        LoadResult res = BinaryReader::loadBinary(fileName, *this);
-        return res;
+        return defaultVal;
     }
 
-    catch (...)
+    return data.i32;
+}
+
+ValuePool::~ValuePool()
+{
+    if (store)
     {
-        return LoadResult::Error;
+        store->release(internedValues);
     }
 }
 
-ArrayView<Instance> Document::getInstances() const { return ArrayView<Instance>(instances.begin(), instances.end()); }
+char* ValuePool::allocate(size_t size, size_t alignment)
+{
+    if (size > kBlockSize / 4)
+    {
+        // large allocations get a dedicated block, the current block keeps being filled
+        auto it = blocks.insert(blocks.empty() ? blocks.end() : blocks.end() - 1, std::unique_ptr<char[]>(new char[size]));
+        return it->get();
+    }
 
-const char* Document::getTypeName(const Instance& inst) const
+    size_t offset = (blockOffset + alignment - 1) & ~(alignment - 1);
+    if (blocks.empty() || offset + size > blockCapacity)
+    {
+        blocks.emplace_back(new char[kBlockSize]);
+        blockCapacity = kBlockSize;
+        offset = 0;
+    }
+
+    char* res = blocks.back().get() + offset;
+    blockOffset = offset + size;
+    return res;
+}
+
+void ValuePool::freeLast(char* data, size_t size)
 {
-    if (inst.id < 0 || size_t(inst.id) >= instances.size())
+    if (size > kBlockSize / 4)
     {
-        return "";
+        // dedicated blocks are placed right before the current block
+        for (size_t i = blocks.size(); i-- > 0 && i + 2 >= blocks.size();)
+        {
+            if (blocks[i].get() == data)
+            {
+                blocks.erase(blocks.begin() + i);
+                return;
+            }
+        }
+        return;
     }
 
-    const Instance& instRef = instances[inst.id];
-    if (&instRef != &inst)
+    if (!blocks.empty() && data + size == blocks.back().get() + blockOffset)
     {
-        return "";
+        blockOffset = size_t(data - blocks.back().get());
     }
+}
 
-    if (inst.typeIndex >= types.size())
+const char* ValuePool::intern(char* data, size_t size)
+{
+    if (!store || size < store->getMinValueSize())
     {
-        return "";
+        return data;
     }
 
-    const Type& type = types[inst.typeIndex];
-    return type.getName();
+    const char* res = store->acquire(data, size);
+    internedValues.push_back(res);
+    freeLast(data, size);
+    return res;
+}
+
+void ValuePool::internString(uint32_t index)
+{
+    StringRef& str = strings[index];
+    // the terminator is a part of the shared value
+    str.data = intern(const_cast<char*>(str.data), str.size + 1);
+}
+
+void ValuePool::internNumberSequence(uint32_t index)
+{
+    SequenceRef<NumberSeq::KeyValue>& seq = numberSequences[index];
+    char* data = reinterpret_cast<char*>(const_cast<NumberSeq::KeyValue*>(seq.data));
+    seq.data = reinterpret_cast<const NumberSeq::KeyValue*>(intern(data, seq.size * sizeof(NumberSeq::KeyValue)));
+}
+
+void ValuePool::internColorSequence(uint32_t index)
+{
+    SequenceRef<ColorSeq::KeyValue>& seq = colorSequences[index];
+    char* data = reinterpret_cast<char*>(const_cast<ColorSeq::KeyValue*>(seq.data));
+    seq.data = reinterpret_cast<const ColorSeq::KeyValue*>(intern(data, seq.size * sizeof(ColorSeq::KeyValue)));
+}
+
+const char* ValuePool::internName(const char* name, size_t size)
+{
+    char* res = allocate(size + 1, 1);
+    memcpy(res, name, size);
+    res[size] = '\0';
+    return res;
+}
+
+char* ValuePool::allocateString(size_t size, uint32_t& index)
+{
+    char* res = allocate(size + 1, 1);
+    res[size] = '\0';
+    index = uint32_t(strings.size());
+    strings.push_back(StringRef{res, size});
+    return res;
+}
+
+NumberSeq::KeyValue* ValuePool::allocateNumberSequence(size_t count, uint32_t& index)
+{
+    NumberSeq::KeyValue* res = reinterpret_cast<NumberSeq::KeyValue*>(allocate(sizeof(NumberSeq::KeyValue) * count, alignof(NumberSeq::KeyValue)));
+    index = uint32_t(numberSequences.size());
+    numberSequences.push_back(SequenceRef<NumberSeq::KeyValue>{res, count});
+    return res;
+}
+
+ColorSeq::KeyValue* ValuePool::allocateColorSequence(size_t count, uint32_t& index)
+{
+    ColorSeq::KeyValue* res = reinterpret_cast<ColorSeq::KeyValue*>(allocate(sizeof(ColorSeq::KeyValue) * count, alignof(ColorSeq::KeyValue)));
+    index = uint32_t(colorSequences.size());
+    colorSequences.push_back(SequenceRef<ColorSeq::KeyValue>{res, count});
+    return res;
+}
+
+Instance::Instance(int32_t _parentId, int32_t _id, uint32_t _typeIndex, bool _isService, bool _isServiceRooted)
+    : parentId(_parentId)
+    , id(_id)
+    , typeIndex(_typeIndex)
+    , isService(_isService)
+    , isServiceRooted(_isServiceRooted)
+{
 }
 
+ArrayView<Property> Instance::getProperties() const { return ArrayView<Property>(properties.begin(), properties.end()); }
+
+int32_t Instance::getId() const { return id; }
+int32_t Instance::getParentId() const { return parentId; }
+uint32_t Instance::getTypeIndex() const { return typeIndex; }
+
+AncestorRange::Iterator::Iterator(const Document* _doc, int32_t _id)
+    : doc(_doc)
+    , id(_id)
+{
+}
+
+AncestorRange::Iterator& AncestorRange::Iterator::operator++()
+{
+    id = doc->getParent(id);
+    return *this;
+}
+
+AncestorRange::AncestorRange(const Document* _doc, int32_t _id)
+    : doc(_doc)
+    , id(_id)
+{
+}
+
+AncestorRange::Iterator AncestorRange::begin() const { return Iterator(doc, doc->getParent(id)); }
+AncestorRange::Iterator AncestorRange::end() const { return Iterator(doc, -1); }
+
+SubtreeRange::Iterator::Iterator(const Document* _doc, int32_t _root)
+    : doc(_doc)
+    , id(_root)
+{
+    if (id < 0)
+    {
+        descend(doc->getChildren(-1));
+    }
+}
+
+void SubtreeRange::Iterator::descend(ArrayView<int32_t> children)
+{
+    if (children.size() == 0)
+    {
+        id = -1;
+        return;
+    }
+
+    if (children.size() > 1)
+    {
+        stack.emplace_back(children.begin() + 1, children.end());
+    }
+    id = children[0];
+}
+
+SubtreeRange::Iterator& SubtreeRange::Iterator::operator++()
+{
+    ArrayView<int32_t> children = doc->getChildren(id);
+    if (children.size() > 0)
+    {
+        descend(children);
+        return *this;
+    }
+
+    if (stack.empty())
+    {
+        id = -1;
+        return *this;
+    }
+
+    std::pair<const int32_t*, const int32_t*>& siblings = stack.back();
+    id = *siblings.first;
+    siblings.first++;
+    if (siblings.first == siblings.second)
+    {
+        stack.pop_back();
+    }
+    return *this;
+}
+
+SubtreeRange::SubtreeRange(const Document* _doc, int32_t _root)
+    : doc(_doc)
+    , root(_root)
+{
+}
+
+SubtreeRange::Iterator SubtreeRange::begin() const { return Iterator(doc, root); }
+SubtreeRange::Iterator SubtreeRange::end() const { return Iterator(); }
+
+// rbxlx, or rbxmx = XML based format
+static bool isXmlFileName(const char* fileName)
+{
+    char lastChar = fileName[strlen(fileName) - 1];
+    return lastChar == 'x' || lastChar == 'X';
+}
+
+Document::Document()
+    : pool(std::make_unique<ValuePool>())
+{
+}
+
+LoadResult Document::loadFile(const char* fileName) { return loadFile(fileName, LoadOptions()); }
+
+LoadResult Document::loadFile(const char* fileName, const LoadOptions& options)
+{
+    loadError = LoadError();
+    if (!fileName || fileName[0] == '\0')
+    {
+        loadError.code = LoadErrorCode::InvalidArgument;
+        loadError.reason = "Empty file name";
+        return LoadResult::Error;
+    }
+
+    if (isXmlFileName(fileName))
+    {
+        return XmlReader::loadXml(fileName, *this, options);
+    }
+
+    // the binary reader never throws, decoding errors are reported through loadError
+    return BinaryReader::loadBinary(fileName, *this, options);
+}
+
+LoadResult Document::reload(const char* fileName)
+{
+    if (!fileName || fileName[0] == '\0' || isXmlFileName(fileName))
+    {
+        return loadFile(fileName);
+    }
+    return BinaryReader::reloadBinary(fileName, *this);
+}
+
+const LoadError& Document::getLoadError() const { return loadError; }
+
+void Document::setInternStore(std::shared_ptr<InternStore> store) { internStore = std::move(store); }
+
+void Document::clear()
+{
+    instances.clear();
+    types.clear();
+    pool = std::make_unique<ValuePool>();
+    pool->store = internStore;
+
+    childOffsets.clear();
+    childIds.clear();
+    rootIds.clear();
+    referrerOffsets.clear();
+    referrers.clear();
+    originalIds.clear();
+    currentIds.clear();
+    subtreeSizes.clear();
+    chunkHashes.clear();
+    reloadedSize = 0;
+}
+
+ArrayView<Instance> Document::getInstances() const { return ArrayView<Instance>(instances.begin(), instances.end()); }
+ArrayView<Type> Document::getTypes() const { return ArrayView<Type>(types.begin(), types.end()); }
+
+ArrayView<ChunkHash> Document::getChunkHashes() const { return ArrayView<ChunkHash>(chunkHashes.begin(), chunkHashes.end()); }
+
+const char* Document::getTypeName(const Instance& inst) const
+{
+    if (inst.id < 0 || size_t(inst.id) >= instances.size())
+    {
+        return "";
+    }
+
+    const Instance& instRef = instances[inst.id];
+    if (&instRef != &inst)
+    {
+        return "";
+    }
+
+    if (inst.typeIndex >= types.size())
+    {
+        return "";
+    }
+
+    const Type& type = types[inst.typeIndex];
+    return type.getName();
+}
+
+ArrayView<int32_t> Document::getChildren(int32_t id) const
+{
+    if (id < 0)
+    {
+        return ArrayView<int32_t>(rootIds.data(), rootIds.size());
+    }
+
+    if (size_t(id) >= instances.size() || childOffsets.size() != instances.size() + 1)
+    {
+        return ArrayView<int32_t>();
+    }
+
+    uint32_t first = childOffsets[id];
+    uint32_t last = childOffsets[id + 1];
+    return ArrayView<int32_t>(childIds.data() + first, last - first);
+}
+
+int32_t Document::getParent(int32_t id) const
+{
+    if (id < 0 || size_t(id) >= instances.size())
+    {
+        return -1;
+    }
+    return instances[id].parentId;
+}
+
+AncestorRange Document::getAncestors(int32_t id) const { return AncestorRange(this, id); }
+
+SubtreeRange Document::getSubtree(int32_t id) const { return SubtreeRange(this, id); }
+
+bool Document::renumberDepthFirst()
+{
+    size_t numInstances = instances.size();
+
+    std::vector<int32_t> newToOld;
+    newToOld.reserve(numInstances);
+    for (int32_t id : getSubtree(-1))
+    {
+        newToOld.push_back(id);
+    }
+
+    // the loaders reject parent cycles, this only guards against a hierarchy that does not cover every instance
+    if (newToOld.size() != numInstances)
+    {
+        return false;
+    }
+
+    std::vector<int32_t> oldToNew(numInstances, -1);
+    for (size_t i = 0; i < newToOld.size(); i++)
+    {
+        oldToNew[newToOld[i]] = int32_t(i);
+    }
+
+    std::vector<Instance> ordered;
+    ordered.reserve(numInstances);
+    for (int32_t oldId : newToOld)
+    {
+        ordered.emplace_back(std::move(instances[oldId]));
+        Instance& inst = ordered.back();
+        inst.id = int32_t(ordered.size() - 1);
+        inst.parentId = (inst.parentId >= 0) ? oldToNew[inst.parentId] : -1;
+
+        for (Property& prop : inst.properties)
+        {
+            if (prop.type != PropertyType::Ref)
+            {
+                continue;
+            }
+            int32_t ref = prop.data.i32;
+            prop.data.i32 = (ref >= 0 && size_t(ref) < numInstances) ? oldToNew[ref] : -1;
+        }
+    }
+    instances = std::move(ordered);
+
+    // object-sourced Content values live in the pool, one entry per property
+    for (ValuePool::ContentRef& content : pool->contents)
+    {
+        if (content.objectId >= 0)
+        {
+            content.objectId = oldToNew[content.objectId];
+        }
+    }
+
+    for (Type& type : types)
+    {
+        for (int32_t& id : type.instanceIds)
+        {
+            id = oldToNew[id];
+        }
+    }
+
+    // compose with the previous renumbering (if any)
+    std::vector<int32_t> prevOriginalIds = std::move(originalIds);
+    originalIds.resize(numInstances);
+    currentIds.assign(numInstances, -1);
+    for (size_t i = 0; i < numInstances; i++)
+    {
+        int32_t originalId = prevOriginalIds.empty() ? newToOld[i] : prevOriginalIds[newToOld[i]];
+        originalIds[i] = originalId;
+        currentIds[originalId] = int32_t(i);
+    }
+
+    // children sorted by the new ids keep their original order
+    buildHierarchy(std::vector<int32_t>());
+
+    if (hasReferenceIndex())
+    {
+        buildReferenceIndex();
+    }
+
+    // instances are in preorder, so a reverse pass sees all descendants before their ancestor
+    subtreeSizes.assign(numInstances, 1);
+    for (size_t i = numInstances; i-- > 0;)
+    {
+        int32_t parentId = instances[i].parentId;
+        if (parentId >= 0)
+        {
+            subtreeSizes[parentId] += subtreeSizes[i];
+        }
+    }
+    return true;
+}
+
+bool Document::isDepthFirstOrdered() const { return !subtreeSizes.empty() && subtreeSizes.size() == instances.size(); }
+
+ArrayView<Instance> Document::getSubtreeInstances(int32_t id) const
+{
+    if (!isDepthFirstOrdered() || id < 0 || size_t(id) >= instances.size())
+    {
+        return ArrayView<Instance>();
+    }
+    return ArrayView<Instance>(instances.data() + id, subtreeSizes[id]);
+}
+
+// instances per batch of the parallel subtree hashing
+static constexpr size_t kMinHashBatchSize = 1024;
+// distinguishes a document from a subtree with the same children
+static constexpr uint64_t kDocumentHashSeed = 0x646f63756d656e74ULL;
+
+// Canonical encoding of instance contents for Document::getSubtreeHash()
+class SubtreeHasher
+{
+  public:
+    SubtreeHasher(const Document& _doc, int32_t rootId)
+        : doc(_doc)
+    {
+        for (int32_t id : doc.getSubtree(rootId))
+        {
+            order.push_back(id);
+        }
+
+        positions.reserve(order.size());
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            positions.emplace_back(order[i], int32_t(i));
+        }
+        std::sort(positions.begin(), positions.end());
+
+        // properties are hashed in name order, the layout order depends on the source file
+        // class name, property names and types are the same for all instances of a type and seed the hash of their values
+        std::string layout;
+        for (const Type& type : doc.getTypes())
+        {
+            ArrayView<PropertyInfo> properties = type.getProperties();
+            std::vector<uint32_t> indices(properties.size());
+            for (size_t i = 0; i < indices.size(); i++)
+            {
+                indices[i] = uint32_t(i);
+            }
+            std::sort(indices.begin(), indices.end(), [&](uint32_t a, uint32_t b) { return strcmp(properties[a].name, properties[b].name) < 0; });
+
+            layout.assign(type.getName(), strlen(type.getName()) + 1);
+            for (uint32_t index : indices)
+            {
+                // both CFrame encodings decode to the same value
+                PropertyType propertyType = properties[index].type;
+                append(layout, (propertyType == PropertyType::CFrameQuat) ? PropertyType::CFrameMatrix : propertyType);
+                layout.append(properties[index].name, strlen(properties[index].name) + 1);
+            }
+            layoutHashes.push_back(hash64(layout.data(), layout.size()));
+            propertyOrders.push_back(std::move(indices));
+        }
+    }
+
+    const std::vector<int32_t>& getOrder() const { return order; }
+
+    uint64_t hashInstance(int32_t id, std::string& buffer) const
+    {
+        const Instance& inst = doc.getInstances()[id];
+        ArrayView<Property> properties = inst.getProperties();
+
+        buffer.clear();
+        uint32_t typeIndex = inst.getTypeIndex();
+        if (typeIndex >= propertyOrders.size())
+        {
+            // instance without a type (loaders reject them), hashes as an empty layout
+            return hash64(buffer.data(), buffer.size());
+        }
+
+        for (uint32_t index : propertyOrders[typeIndex])
+        {
+            appendValue(properties[index], buffer);
+        }
+        return hash64(buffer.data(), buffer.size(), layoutHashes[typeIndex]);
+    }
+
+  private:
+    template <typename T> static void append(std::string& buffer, const T& val) { buffer.append(reinterpret_cast<const char*>(&val), sizeof(T)); }
+
+    static void appendBytes(std::string& buffer, ArrayView<char> bytes)
+    {
+        append(buffer, uint32_t(bytes.size()));
+        buffer.append(bytes.data(), bytes.size());
+    }
+
+    // preorder position of a ref target, -1 for null and -2 for targets outside of the subtree
+    int32_t findPosition(int32_t id) const
+    {
+        if (id < 0)
+        {
+            return -1;
+        }
+        auto it = std::lower_bound(positions.begin(), positions.end(), std::make_pair(id, int32_t(-1)));
+        return (it != positions.end() && it->first == id) ? it->second : -2;
+    }
+
+    void appendValue(const Property& prop, std::string& buffer) const
+    {
+        switch (prop.type)
+        {
+        case PropertyType::Ref:
+            append(buffer, findPosition(prop.data.i32));
+            break;
+        case PropertyType::String:
+        case PropertyType::SharedString:
+        case PropertyType::Bytecode:
+            appendBytes(buffer, prop.asBytes());
+            break;
+        case PropertyType::CFrameMatrix:
+        case PropertyType::CFrameQuat:
+            append(buffer, prop.asCFrame());
+            break;
+        case PropertyType::OptionalCFrame:
+        {
+            const OptionalCFrame& ocf = prop.asOptionalCFrame();
+            append(buffer, ocf.hasData);
+            if (ocf.hasData)
+            {
+                append(buffer, ocf.val);
+            }
+            break;
+        }
+        case PropertyType::PhysicalProperties:
+            append(buffer, prop.asPhysicalProperties());
+            break;
+        case PropertyType::Font:
+        {
+            const FontInfo& font = prop.asFont();
+            appendBytes(buffer, ArrayView<char>(font.family.data(), font.family.size()));
+            append(buffer, font.weight);
+            append(buffer, font.style);
+            appendBytes(buffer, ArrayView<char>(font.cachedFaceId.data(), font.cachedFaceId.size()));
+            break;
+        }
+        case PropertyType::NumberSequence:
+        {
+            ArrayView<NumberSeq::KeyValue> keys = prop.asNumberSequence();
+            append(buffer, uint32_t(keys.size()));
+            buffer.append(reinterpret_cast<const char*>(keys.data()), keys.size() * sizeof(NumberSeq::KeyValue));
+            break;
+        }
+        case PropertyType::ColorSequenceV1:
+        {
+            ArrayView<ColorSeq::KeyValue> keys = prop.asColorSequence();
+            append(buffer, uint32_t(keys.size()));
+            buffer.append(reinterpret_cast<const char*>(keys.data()), keys.size() * sizeof(ColorSeq::KeyValue));
+            break;
+        }
+        case PropertyType::Ray:
+            append(buffer, prop.asRay());
+            break;
+        case PropertyType::Content:
+        {
+            ContentSourceType sourceType = prop.asContentSourceType();
+            append(buffer, sourceType);
+            if (sourceType == ContentSourceType::Object)
+            {
+                append(buffer, findPosition(prop.asRef()));
+            }
+            else
+            {
+                appendBytes(buffer, prop.asBytes());
+            }
+            break;
+        }
+        default:
+            // inline payload, unused bytes are zero
+            append(buffer, prop.data.raw);
+            break;
+        }
+    }
+
+    const Document& doc;
+    // instances of the subtree in preorder
+    std::vector<int32_t> order;
+    // (instance id, preorder position) sorted by id
+    std::vector<std::pair<int32_t, int32_t>> positions;
+    // per type
+    std::vector<uint64_t> layoutHashes;
+    std::vector<std::vector<uint32_t>> propertyOrders;
+};
+
+uint64_t Document::getSubtreeHash(int32_t id, uint32_t numThreads) const
+{
+    if (id < -1 || id >= int32_t(instances.size()))
+    {
+        return 0;
+    }
+
+    SubtreeHasher hasher(*this, id);
+    const std::vector<int32_t>& order = hasher.getOrder();
+    std::vector<uint64_t> hashes(order.size());
+    parallelFor(order.size(), kMinHashBatchSize, numThreads, [&](size_t begin, size_t end) {
+        std::string buffer;
+        for (size_t i = begin; i < end; i++)
+        {
+            hashes[i] = hasher.hashInstance(order[i], buffer);
+        }
+    });
+
+    // fold subtrees bottom up: the children of order[i] follow it in preorder, each one followed by its own subtree
+    std::vector<uint32_t> sizes(order.size());
+    std::vector<uint64_t> parts;
+    for (size_t i = order.size(); i-- > 0;)
+    {
+        parts.clear();
+        parts.push_back(hashes[i]);
+        size_t pos = i + 1;
+        for (size_t c = 0; c < getChildren(order[i]).size(); c++)
+        {
+            parts.push_back(hashes[pos]);
+            pos += sizes[pos];
+        }
+        sizes[i] = uint32_t(pos - i);
+        hashes[i] = hash64(parts.data(), parts.size() * sizeof(uint64_t));
+    }
+
+    if (id >= 0)
+    {
+        return hashes[0];
+    }
+
+    // the virtual root only has children
+    parts.clear();
+    for (size_t pos = 0; pos < order.size(); pos += sizes[pos])
+    {
+        parts.push_back(hashes[pos]);
+    }
+    return hash64(parts.data(), parts.size() * sizeof(uint64_t), kDocumentHashSeed);
+}
+
+void Document::buildReferenceIndex()
+{
+    size_t numInstances = instances.size();
+    referrerOffsets.assign(numInstances + 1, 0);
+    referrers.clear();
+
+    // Ref and Content columns are found through the type layouts, only instances of types with such properties are visited
+    auto forEachRef = [&](auto&& func) {
+        for (const Type& type : types)
+        {
+            for (size_t propertyIndex = 0; propertyIndex < type.properties.size(); propertyIndex++)
+            {
+                PropertyType propertyType = type.properties[propertyIndex].type;
+                if (propertyType != PropertyType::Ref && propertyType != PropertyType::Content)
+                {
+                    continue;
+                }
+
+                for (int32_t id : type.instanceIds)
+                {
+                    const Property& prop = instances[id].properties[propertyIndex];
+                    int32_t target = prop.asRef();
+                    if (target >= 0)
+                    {
+                        func(target, Referrer{id, uint32_t(propertyIndex)});
+                    }
+                }
+            }
+        }
+    };
+
+    forEachRef([&](int32_t target, const Referrer&) { referrerOffsets[target + 1]++; });
+    for (size_t i = 0; i < numInstances; i++)
+    {
+        referrerOffsets[i + 1] += referrerOffsets[i];
+    }
+
+    referrers.resize(referrerOffsets[numInstances]);
+    std::vector<uint32_t> cursor(referrerOffsets.begin(), referrerOffsets.end() - 1);
+    forEachRef([&](int32_t target, const Referrer& referrer) { referrers[cursor[target]++] = referrer; });
+}
+
+bool Document::hasReferenceIndex() const { return referrerOffsets.size() == instances.size() + 1; }
+
+ArrayView<Referrer> Document::getReferrers(int32_t id) const
+{
+    if (!hasReferenceIndex() || id < 0 || size_t(id) >= instances.size())
+    {
+        return ArrayView<Referrer>();
+    }
+
+    uint32_t first = referrerOffsets[id];
+    uint32_t last = referrerOffsets[id + 1];
+    return ArrayView<Referrer>(referrers.data() + first, last - first);
+}
+
+int32_t Document::getOriginalId(int32_t id) const
+{
+    if (id < 0 || size_t(id) >= instances.size())
+    {
+        return -1;
+    }
+    return originalIds.empty() ? id : originalIds[id];
+}
+
+int32_t Document::getIdFromOriginal(int32_t originalId) const
+{
+    if (originalId < 0 || size_t(originalId) >= instances.size())
+    {
+        return -1;
+    }
+    return currentIds.empty() ? originalId : currentIds[originalId];
+}
+
+void Document::buildHierarchy(const std::vector<int32_t>& order)
+{
+    size_t numInstances = instances.size();
+
+    childOffsets.assign(numInstances + 1, 0);
+    for (const Instance& inst : instances)
+    {
+        if (inst.parentId >= 0)
+        {
+            childOffsets[inst.parentId + 1]++;
+        }
+    }
+
+    for (size_t i = 0; i < numInstances; i++)
+    {
+        childOffsets[i + 1] += childOffsets[i];
+    }
+
+    childIds.resize(childOffsets[numInstances]);
+    rootIds.clear();
+
+    std::vector<uint32_t> cursor(childOffsets.begin(), childOffsets.end() - 1);
+    std::vector<bool> placed(numInstances, false);
+    auto place = [&](int32_t id) {
+        if (id < 0 || size_t(id) >= numInstances || placed[id])
+        {
+            return;
+        }
+        placed[id] = true;
+
+        int32_t parentId = instances[id].parentId;
+        if (parentId < 0)
+        {
+            rootIds.push_back(id);
+        }
+        else
+        {
+            childIds[cursor[parentId]++] = id;
+        }
+    };
+
+    for (int32_t id : order)
+    {
+        place(id);
+    }
+
+    for (size_t i = 0; i < numInstances; i++)
+    {
+        place(int32_t(i));
+    }
+}
+
+bool Document::hasParentCycle() const
+{
+    // 0 = not visited, 1 = on the current path, 2 = leads to a root
+    std::vector<uint8_t> states(instances.size(), 0);
+    std::vector<int32_t> path;
+    for (size_t i = 0; i < instances.size(); i++)
+    {
+        int32_t id = int32_t(i);
+        while (id >= 0 && states[id] == 0)
+        {
+            states[id] = 1;
+            path.push_back(id);
+            id = instances[id].parentId;
+        }
+
+        if (id >= 0 && states[id] == 1)
+        {
+            return true;
+        }
+
+        for (int32_t pathId : path)
+        {
+            states[pathId] = 2;
+        }
+        path.clear();
+    }
+    return false;
+}
+
+// Maps a column element type to the property types it can be copied from
+template <typename T> struct ColumnTraits;
+
+#define RBXDOC_COLUMN_TRAITS(T, accessor, ...)                                                                                                                 \
+    template <> struct ColumnTraits<T>                                                                                                                         \
+    {                                                                                                                                                          \
+        static bool accepts(PropertyType type)                                                                                                                 \
+        {                                                                                                                                                      \
+            const PropertyType types[] = {__VA_ARGS__};                                                                                                        \
+            return std::find(std::begin(types), std::end(types), type) != std::end(types);                                                                     \
+        }                                                                                                                                                      \
+        static T get(const Property& prop) { return prop.accessor(); }                                                                                         \
+    };
+
+RBXDOC_COLUMN_TRAITS(bool, asBool, PropertyType::Bool)
+RBXDOC_COLUMN_TRAITS(uint32_t, asEnum, PropertyType::Enum)
+RBXDOC_COLUMN_TRAITS(int64_t, asInt64, PropertyType::Int64)
+RBXDOC_COLUMN_TRAITS(float, asFloat, PropertyType::Float)
+RBXDOC_COLUMN_TRAITS(double, asDouble, PropertyType::Double)
+RBXDOC_COLUMN_TRAITS(BrickColor, asBrickColor, PropertyType::BrickColor)
+RBXDOC_COLUMN_TRAITS(Color3, asColor3, PropertyType::Color3, PropertyType::UColor3)
+RBXDOC_COLUMN_TRAITS(Vec2, asVec2, PropertyType::Vector2)
+RBXDOC_COLUMN_TRAITS(Vec3, asVec3, PropertyType::Vector3)
+RBXDOC_COLUMN_TRAITS(UDim2, asUDim2, PropertyType::UDim2)
+RBXDOC_COLUMN_TRAITS(Rect2D, asRect2D, PropertyType::Rect2D)
+RBXDOC_COLUMN_TRAITS(NumberRange, asNumberRange, PropertyType::NumberRange)
+RBXDOC_COLUMN_TRAITS(UniqueId, asUniqueId, PropertyType::UniqueId)
+RBXDOC_COLUMN_TRAITS(UDim, asUDim, PropertyType::UDim)
+RBXDOC_COLUMN_TRAITS(Vec2int16, asVec2int16, PropertyType::Vector2int16)
+RBXDOC_COLUMN_TRAITS(Vec3int16, asVec3int16, PropertyType::Vector3int16)
+RBXDOC_COLUMN_TRAITS(Ray, asRay, PropertyType::Ray)
+RBXDOC_COLUMN_TRAITS(uint64_t, asSecurityCapabilities, PropertyType::SecurityCapabilities)
+RBXDOC_COLUMN_TRAITS(CFrame, asCFrame, PropertyType::CFrameMatrix, PropertyType::CFrameQuat, PropertyType::OptionalCFrame)
+RBXDOC_COLUMN_TRAITS(const char*, asString, PropertyType::String, PropertyType::SharedString, PropertyType::Bytecode, PropertyType::Content)
+
+#undef RBXDOC_COLUMN_TRAITS
+
+// Int32 and Ref columns share the element type
+template <> struct ColumnTraits<int32_t>
+{
+    static bool accepts(PropertyType type) { return type == PropertyType::Int32 || type == PropertyType::Ref; }
+    static int32_t get(const Property& prop) { return (prop.getType() == PropertyType::Ref) ? prop.asRef() : prop.asInt32(); }
+};
+
+template <typename T> size_t Document::copyColumn(uint32_t typeIndex, uint32_t propertyIndex, T* dst, size_t dstSize) const
+{
+    if (typeIndex >= types.size())
+    {
+        return 0;
+    }
+
+    const Type& type = types[typeIndex];
+    if (propertyIndex >= type.properties.size() || !ColumnTraits<T>::accepts(type.properties[propertyIndex].type))
+    {
+        return 0;
+    }
+
+    size_t count = std::min(type.instanceIds.size(), dstSize);
+    const int32_t* rows = type.instanceIds.data();
+    for (size_t i = 0; i < count; i++)
+    {
+        dst[i] = ColumnTraits<T>::get(instances[rows[i]].properties[propertyIndex]);
+    }
+    return count;
+}
+
+template size_t Document::copyColumn<bool>(uint32_t, uint32_t, bool*, size_t) const;
+template size_t Document::copyColumn<int32_t>(uint32_t, uint32_t, int32_t*, size_t) const;
+template size_t Document::copyColumn<uint32_t>(uint32_t, uint32_t, uint32_t*, size_t) const;
+template size_t Document::copyColumn<int64_t>(uint32_t, uint32_t, int64_t*, size_t) const;
+template size_t Document::copyColumn<float>(uint32_t, uint32_t, float*, size_t) const;
+template size_t Document::copyColumn<double>(uint32_t, uint32_t, double*, size_t) const;
+template size_t Document::copyColumn<BrickColor>(uint32_t, uint32_t, BrickColor*, size_t) const;
+template size_t Document::copyColumn<Color3>(uint32_t, uint32_t, Color3*, size_t) const;
+template size_t Document::copyColumn<Vec2>(uint32_t, uint32_t, Vec2*, size_t) const;
+template size_t Document::copyColumn<Vec3>(uint32_t, uint32_t, Vec3*, size_t) const;
+template size_t Document::copyColumn<UDim2>(uint32_t, uint32_t, UDim2*, size_t) const;
+template size_t Document::copyColumn<Rect2D>(uint32_t, uint32_t, Rect2D*, size_t) const;
+template size_t Document::copyColumn<NumberRange>(uint32_t, uint32_t, NumberRange*, size_t) const;
+template size_t Document::copyColumn<UniqueId>(uint32_t, uint32_t, UniqueId*, size_t) const;
+template size_t Document::copyColumn<UDim>(uint32_t, uint32_t, UDim*, size_t) const;
+template size_t Document::copyColumn<Vec2int16>(uint32_t, uint32_t, Vec2int16*, size_t) const;
+template size_t Document::copyColumn<Vec3int16>(uint32_t, uint32_t, Vec3int16*, size_t) const;
+template size_t Document::copyColumn<Ray>(uint32_t, uint32_t, Ray*, size_t) const;
+template size_t Document::copyColumn<uint64_t>(uint32_t, uint32_t, uint64_t*, size_t) const;
+template size_t Document::copyColumn<CFrame>(uint32_t, uint32_t, CFrame*, size_t) const;
+template size_t Document::copyColumn<const char*>(uint32_t, uint32_t, const char**, size_t) const;
+
 } // namespace rbxdoc
\ No newline at end of file
@@ -1,7 +1,10 @@
 #pragma once
 
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <stdint.h>
 #include <string>
-#include <variant>
 #include <vector>
 
 namespace rbxdoc
@@ -55,7 +58,7 @@ template <typename T> class ArrayView
     size_type size_;
 };
 
-enum class PropertyType
+enum class PropertyType : uint8_t
 {
     Unknown = 0,
     String,
@@ -119,6 +122,25 @@ struct Vec3
     float z;
 };
 
+struct Vec2int16
+{
+    int16_t x;
+    int16_t y;
+};
+
+struct Vec3int16
+{
+    int16_t x;
+    int16_t y;
+    int16_t z;
+};
+
+struct Ray
+{
+    Vec3 origin;
+    Vec3 direction;
+};
+
 struct Mat3x3
 {
     float v[9];
@@ -165,6 +187,12 @@ struct NumberSeq
     std::vector<KeyValue> data;
 };
 
+struct UDim
+{
+    float scale;
+    int32_t offset;
+};
+
 struct UDim2
 {
     float scaleX;
@@ -205,31 +233,207 @@ struct PhysicalProperties
     float acousticAbsorption = 1.0f;
 };
 
+// Source of a Content value, the uri is returned by Property::asString() and the object by Property::asRef()
+enum class ContentSourceType : uint8_t
+{
+    None = 0,
+    Uri = 1,
+    Object = 2
+};
+
+class ValuePool;
+class MappedFile;
+class InternStore;
+
 class Property
 {
   public:
     Property() = default;
+    // note: the name is not copied, it must outlive the property (Document interns all property names in its ValuePool)
     Property(const char* _name, PropertyType _type);
 
     PropertyType getType() const;
     const char* getName() const;
 
+    // Typed accessors return defaultVal if the property has a different type
+    // String, SharedString, Bytecode and uri-sourced Content
     const char* asString(const char* defaultVal = "") const;
+    // the same values as asString, SharedString and Bytecode may contain zeros (empty if the property has a different type)
+    ArrayView<char> asBytes() const;
+    bool asBool(bool defaultVal = false) const;
+    int32_t asInt32(int32_t defaultVal = 0) const;
+    int64_t asInt64(int64_t defaultVal = 0) const;
     float asFloat(float defaultVal = 0.0f) const;
+    double asDouble(double defaultVal = 0.0) const;
+    uint32_t asEnum(uint32_t defaultVal = 0) const;
+    BrickColor asBrickColor(BrickColor defaultVal = BrickColor{0}) const;
+    // Color3 and UColor3 (converted to floats at load time)
+    const Color3& asColor3(const Color3& defaultVal = Color3{0.0f, 0.0f, 0.0f}) const;
+    const Vec2& asVec2(const Vec2& defaultVal = Vec2{0.0f, 0.0f}) const;
     const Vec3& asVec3(const Vec3& defaultVal = Vec3{0.0f, 0.0f, 0.0f}) const;
+    const Vec2int16& asVec2int16(const Vec2int16& defaultVal = Vec2int16{0, 0}) const;
+    const Vec3int16& asVec3int16(const Vec3int16& defaultVal = Vec3int16{0, 0, 0}) const;
+    const UDim& asUDim(const UDim& defaultVal = UDim{0.0f, 0}) const;
+    const UDim2& asUDim2(const UDim2& defaultVal = UDim2{0.0f, 0.0f, 0, 0}) const;
+    const Ray& asRay(const Ray& defaultVal = Ray{Vec3{0.0f, 0.0f, 0.0f}, Vec3{0.0f, 0.0f, 0.0f}}) const;
+    // bit mask in NormalId order: Right, Top, Back, Left, Bottom, Front
+    uint8_t asFaces(uint8_t defaultVal = 0) const;
+    // bit mask: X, Y, Z
+    uint8_t asAxes(uint8_t defaultVal = 0) const;
+    uint64_t asSecurityCapabilities(uint64_t defaultVal = 0) const;
+    ContentSourceType asContentSourceType(ContentSourceType defaultVal = ContentSourceType::None) const;
+    const Rect2D& asRect2D(const Rect2D& defaultVal = Rect2D{0.0f, 0.0f, 0.0f, 0.0f}) const;
+    const NumberRange& asNumberRange(const NumberRange& defaultVal = NumberRange{0.0f, 0.0f}) const;
+    const UniqueId& asUniqueId(const UniqueId& defaultVal = UniqueId{0, 0, 0}) const;
+    // CFrameMatrix, CFrameQuat and OptionalCFrame with data
     const CFrame& asCFrame(const CFrame& defaultVal = CFrame{Mat3x3{1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f}, Vec3{0.0f, 0.0f, 0.0f}}) const;
-    // TODO: add other types
+    const OptionalCFrame& asOptionalCFrame(const OptionalCFrame& defaultVal = OptionalCFrame{CFrame{}, false}) const;
+    const PhysicalProperties& asPhysicalProperties(const PhysicalProperties& defaultVal = PhysicalProperties()) const;
+    const FontInfo& asFont(const FontInfo& defaultVal = FontInfo()) const;
+    // sequences are empty if the property has a different type
+    ArrayView<NumberSeq::KeyValue> asNumberSequence() const;
+    ArrayView<ColorSeq::KeyValue> asColorSequence() const;
+    // referenced instance id of Ref and object-sourced Content, -1 for null (refs are validated at load time)
+    int32_t asRef(int32_t defaultVal = -1) const;
 
   private:
-    std::string name;
-    PropertyType type;
+    // String, SharedString, Bytecode and uri-sourced Content, nullptr for other values
+    const char* findString(size_t& size) const;
+
+    // Large or variable-size values live out-of-line in the document's ValuePool and are referenced by index
+    struct PooledValue
+    {
+        const ValuePool* pool;
+        uint32_t index;
+    };
+
+    // Small values are stored inline, the payload never exceeds 16 bytes
+    union Payload
+    {
+        uint64_t raw[2];
+        bool b;
+        uint8_t u8;
+        int32_t i32;
+        uint32_t u32;
+        int64_t i64;
+        uint64_t u64;
+        float f;
+        double d;
+        Vec2 v2;
+        Vec3 v3;
+        Vec2int16 v2i16;
+        Vec3int16 v3i16;
+        Color3 color3;
+        BrickColor brickColor;
+        UniqueId uniqueId;
+        UDim udim;
+        UDim2 udim2;
+        Rect2D rect2D;
+        NumberRange numberRange;
+        PooledValue pooled;
+    };
 
-    std::variant<std::string, bool, float, double, int32_t, uint32_t, int64_t, Vec2, Vec3, CFrame, OptionalCFrame, BrickColor, UniqueId, ColorSeq, NumberSeq,
-                 UDim2, Color3, Rect2D, PhysicalProperties, NumberRange, FontInfo>
-        data;
+    const char* name = "";
+    Payload data = {};
+    PropertyType type = PropertyType::Unknown;
 
     friend class BinaryReader;
+    friend class DiffEngine;
     friend class Document;
+    friend class DocumentCopier;
+    friend class QueryEvaluator;
+    friend class Snapshot;
+    friend class SubtreeHasher;
+    friend class XmlReader;
+};
+
+static_assert(sizeof(Property) <= 32, "Property is expected to fit into 32 bytes");
+
+// Out-of-line storage for property values that do not fit into the Property inline payload.
+// Values of one PROP chunk are appended contiguously, so every pool is also a packed column storage.
+class ValuePool
+{
+  public:
+    ValuePool() = default;
+    ~ValuePool();
+    ValuePool(const ValuePool&) = delete;
+    ValuePool& operator=(const ValuePool&) = delete;
+
+    // returns a stable NUL terminated copy of the name
+    const char* internName(const char* name, size_t size);
+
+    // allocate out-of-line values of a given size, the caller fills the returned buffer
+    // note: strings are always NUL terminated
+    char* allocateString(size_t size, uint32_t& index);
+    NumberSeq::KeyValue* allocateNumberSequence(size_t count, uint32_t& index);
+    ColorSeq::KeyValue* allocateColorSequence(size_t count, uint32_t& index);
+
+    // moves the value that was allocated and filled last into the shared store (if the pool is attached to one and the value is large enough)
+    void internString(uint32_t index);
+    void internNumberSequence(uint32_t index);
+    void internColorSequence(uint32_t index);
+
+  private:
+    struct StringRef
+    {
+        const char* data;
+        size_t size;
+    };
+
+    template <typename T> struct SequenceRef
+    {
+        const T* data;
+        size_t size;
+    };
+
+    struct ContentRef
+    {
+        ContentSourceType sourceType;
+        // index in strings for Uri
+        uint32_t uri;
+        // instance id for Object
+        int32_t objectId;
+    };
+
+    static constexpr size_t kBlockSize = 64 * 1024;
+
+    // bump allocator, allocated memory never moves
+    char* allocate(size_t size, size_t alignment);
+    // gives back the memory of the last allocation
+    void freeLast(char* data, size_t size);
+    // returns the shared copy of the bytes, or data if they are not shared
+    const char* intern(char* data, size_t size);
+
+    std::vector<std::unique_ptr<char[]>> blocks;
+    size_t blockOffset = 0;
+    size_t blockCapacity = 0;
+
+    std::vector<StringRef> strings;
+    std::vector<CFrame> cframes;
+    std::vector<OptionalCFrame> optionalCFrames;
+    std::vector<PhysicalProperties> physicalProperties;
+    std::vector<FontInfo> fonts;
+    std::vector<SequenceRef<NumberSeq::KeyValue>> numberSequences;
+    std::vector<SequenceRef<ColorSeq::KeyValue>> colorSequences;
+    std::vector<Ray> rays;
+    std::vector<ContentRef> contents;
+
+    // SSTR dictionary, index in strings of every shared string (values of SharedString properties share these strings)
+    std::vector<uint32_t> sharedStrings;
+
+    // snapshot the pooled strings and sequences point into (if the document was loaded from a snapshot)
+    std::shared_ptr<const MappedFile> mapping;
+
+    // store of the large strings and sequences shared with other documents, values in it are released with the pool
+    std::shared_ptr<InternStore> store;
+    std::vector<const char*> internedValues;
+
+    friend class BinaryReader;
+    friend class Property;
+    friend class Document;
+    friend class DocumentCopier;
+    friend class Snapshot;
+    friend class XmlReader;
 };
 
 class Instance
@@ -240,9 +444,12 @@ class Instance
 
     ArrayView<Property> getProperties() const;
 
+    int32_t getId() const;
+    int32_t getParentId() const;
+    uint32_t getTypeIndex() const;
+
   private:
     std::vector<Property> properties;
-    std::vector<int32_t> childIds;
     int32_t parentId = -1;
     int32_t id = -1;
     uint32_t typeIndex = uint32_t(-1);
@@ -251,6 +458,17 @@ class Instance
 
     friend class BinaryReader;
     friend class Document;
+    friend class DocumentCopier;
+    friend class QueryEvaluator;
+    friend class Snapshot;
+    friend class XmlReader;
+};
+
+// Property column description, all instances of a type share the same property layout
+struct PropertyInfo
+{
+    const char* name;
+    PropertyType type;
 };
 
 class Type
@@ -261,8 +479,97 @@ class Type
 
     const char* getName() const;
 
+    // Instances of the type, the order matches the rows of the property columns
+    ArrayView<int32_t> getInstances() const;
+
+    // Property layout, the index is the same as in Instance::getProperties() of every instance of the type
+    ArrayView<PropertyInfo> getProperties() const;
+    int32_t findProperty(const char* propertyName, bool ignoreCase = false) const;
+
   private:
     std::string name;
+    std::vector<int32_t> instanceIds;
+    std::vector<PropertyInfo> properties;
+
+    friend class BinaryReader;
+    friend class Document;
+    friend class DocumentCopier;
+    friend class Snapshot;
+    friend class XmlReader;
+};
+
+class Document;
+
+// Walks the parent links from the parent of a given instance up to the root
+class AncestorRange
+{
+  public:
+    class Iterator
+    {
+      public:
+        Iterator(const Document* _doc, int32_t _id);
+
+        int32_t operator*() const { return id; }
+        Iterator& operator++();
+        bool operator==(const Iterator& other) const { return id == other.id; }
+        bool operator!=(const Iterator& other) const { return id != other.id; }
+
+      private:
+        const Document* doc;
+        int32_t id;
+    };
+
+    AncestorRange(const Document* _doc, int32_t _id);
+
+    Iterator begin() const;
+    Iterator end() const;
+
+  private:
+    const Document* doc;
+    int32_t id;
+};
+
+// Preorder depth-first walk over a subtree (including its root)
+// Subtree of -1 visits every instance of the document starting from the root instances
+class SubtreeRange
+{
+  public:
+    class Iterator
+    {
+      public:
+        Iterator() = default;
+        Iterator(const Document* _doc, int32_t _root);
+
+        int32_t operator*() const { return id; }
+        Iterator& operator++();
+        bool operator==(const Iterator& other) const { return id == other.id; }
+        bool operator!=(const Iterator& other) const { return id != other.id; }
+
+      private:
+        void descend(ArrayView<int32_t> children);
+
+        const Document* doc = nullptr;
+        // remaining siblings on each level of the walk
+        std::vector<std::pair<const int32_t*, const int32_t*>> stack;
+        int32_t id = -1;
+    };
+
+    SubtreeRange(const Document* _doc, int32_t _root);
+
+    Iterator begin() const;
+    Iterator end() const;
+
+  private:
+    const Document* doc;
+    int32_t root;
+};
+
+// Ref property that points at an instance
+struct Referrer
+{
+    int32_t instanceId;
+    // index in Instance::getProperties()
+    uint32_t propertyIndex;
 };
 
 enum class LoadResult
@@ -271,20 +578,208 @@ enum class LoadResult
     OK = 1
 };
 
+enum class LoadErrorCode : uint8_t
+{
+    None = 0,
+    InvalidArgument,
+    FileReadFailed,
+    UnsupportedFormat,
+    CorruptedHeader,
+    ChunkOutOfBounds,
+    DecompressionFailed,
+    TruncatedData,
+    InvalidTypeIndex,
+    InvalidInstanceId,
+    UnsupportedEncoding,
+    InvalidXml,
+    Cancelled
+};
+
+// Hash of the decompressed data of a binary file chunk
+struct ChunkHash
+{
+    // NUL terminated chunk name (INST, PROP, ...)
+    char name[5];
+    // type index of INST and PROP chunks, -1 for the other chunks
+    int32_t typeIndex;
+    // property name of PROP chunks, empty for the other chunks
+    const char* propertyName;
+    uint64_t hash;
+    // hash of the chunk data as stored in the file (compressed or not)
+    uint64_t payloadHash;
+};
+
+// Diagnostics of a failed load
+struct LoadError
+{
+    LoadErrorCode code = LoadErrorCode::None;
+    // index of the chunk that failed to decode, -1 for errors outside of chunks (e.g. the file header and all XML errors)
+    int32_t chunkIndex = -1;
+    // NUL terminated chunk name (INST, PROP, ...)
+    char chunkName[5] = {};
+    // file offset of the chunk header
+    size_t chunkOffset = 0;
+    // offset of the failed read, relative to the decompressed chunk data for decode errors, relative to the file otherwise
+    size_t offset = 0;
+    const char* reason = "";
+};
+
+// Source of Document::merge()
+struct MergeSource
+{
+    const Document* doc = nullptr;
+    // the roots of the document are placed under instance parentId of source parentSource, which must be an earlier source
+    // (-1 keeps them as roots of the merged document)
+    int32_t parentSource = -1;
+    int32_t parentId = -1;
+};
+
+// Progress of a load
+struct LoadProgress
+{
+    // file bytes decoded so far and the file size
+    size_t bytesProcessed = 0;
+    size_t bytesTotal = 0;
+    // decoded chunks of a binary file (item ranges of an XML file)
+    uint32_t chunksProcessed = 0;
+};
+
+// Optional controls of a load
+struct LoadOptions
+{
+    // called after every decoded chunk by the loading threads, calls never overlap
+    std::function<void(const LoadProgress& progress)> onProgress;
+    // checked between chunks, once set the load stops with LoadErrorCode::Cancelled (copies of the options share the flag)
+    std::shared_ptr<std::atomic<bool>> cancel;
+
+    bool isCancelled() const { return cancel && cancel->load(std::memory_order_relaxed); }
+};
+
 class Document
 {
   public:
+    Document();
+
     LoadResult loadFile(const char* fileName);
+    LoadResult loadFile(const char* fileName, const LoadOptions& options);
+    // details of the last loadFile() error
+    const LoadError& getLoadError() const;
+
+    // Reloads a modified version of the binary file the document was loaded from. Chunks are compared by the hash of their stored bytes,
+    // only changed property and parent chunks are decoded again and patched into the document in place.
+    // Falls back to loadFile() when instances or shared strings changed, for XML files and for renumbered documents.
+    // note: pooled values of replaced properties are kept until the next full load, which happens once reloads decoded as much as the file
+    LoadResult reload(const char* fileName);
 
     ArrayView<Instance> getInstances() const;
+    ArrayView<Type> getTypes() const;
 
     const char* getTypeName(const Instance& inst) const;
 
+    // Hierarchy traversal, -1 stands for the (virtual) root of the document
+    ArrayView<int32_t> getChildren(int32_t id) const;
+    int32_t getParent(int32_t id) const;
+    AncestorRange getAncestors(int32_t id) const;
+    SubtreeRange getSubtree(int32_t id) const;
+
+    // Optional post-load pass: renumbers instances in preorder depth-first order and remaps parent links and Ref properties
+    // After that every subtree occupies a contiguous range of instances
+    // returns false (and keeps the ids) if some instances are not reachable from the roots
+    bool renumberDepthFirst();
+    bool isDepthFirstOrdered() const;
+
+    // Returns instances of the subtree (including its root) as a contiguous slice
+    // note: the document must be renumbered in depth-first order, otherwise the result is empty
+    ArrayView<Instance> getSubtreeInstances(int32_t id) const;
+
+    // Copies a subtree (id = -1 copies the whole document) into a new compact document
+    // Instances are renumbered in preorder (the result is depth-first ordered), refs to instances outside of the subtree become null and
+    // types without instances are dropped. The result is attached to the same intern store.
+    // note: only reads the document, several subtrees can be extracted concurrently
+    Document extractSubtree(int32_t id) const;
+
+    // Merges documents into a new one, instances of every source follow those of the previous sources (in preorder of the source)
+    // Types are unified by class name, layouts are the union of the source layouts (properties that a source type misses get the defaults
+    // XML files use, a property that changes its type keeps the first one). Refs and object-sourced Content are remapped, shared strings
+    // are deduplicated by payload. The result is attached to the intern store of the first source.
+    static Document merge(const std::vector<MergeSource>& sources);
+
+    // Optional reverse reference index: which Ref (and object-sourced Content) properties point at an instance
+    void buildReferenceIndex();
+    bool hasReferenceIndex() const;
+    // note: the reference index must be built, otherwise the result is empty
+    ArrayView<Referrer> getReferrers(int32_t id) const;
+
+    // Gathers a property column of a type into dst, values follow the row order of Type::getInstances()
+    // A convenience for column-oriented consumers: values are stored per instance, so this is a per-row gather (the column type is
+    // checked once), not a memcpy of contiguous storage.
+    // returns the number of copied values (at most dstSize), 0 if the column type does not match T
+    // supported T: bool, int32_t (Int32 and Ref), uint32_t (Enum), int64_t, float, double, BrickColor, Color3, Vec2, Vec3, UDim2, Rect2D,
+    // NumberRange, UniqueId, UDim, Vec2int16, Vec3int16, Ray, uint64_t (SecurityCapabilities), CFrame (identity for empty OptionalCFrame)
+    // and const char* (String, SharedString, Bytecode, Content)
+    template <typename T> size_t copyColumn(uint32_t typeIndex, uint32_t propertyIndex, T* dst, size_t dstSize) const;
+
+    // Hashes of the source file chunks in file order, computed while loading (binary files only, empty for XML and snapshots)
+    ArrayView<ChunkHash> getChunkHashes() const;
+
+    // Content hash of a subtree, id = -1 hashes the whole document
+    // Covers class names, property names, types and values (bitwise, pooled values by content) and children in order. It does not depend
+    // on instance ids, the property order of types or the source format. Refs hash as the preorder position of the target in the subtree,
+    // refs to instances outside of the subtree all hash the same.
+    // numThreads: 0 = use all hardware threads
+    uint64_t getSubtreeHash(int32_t id, uint32_t numThreads = 0) const;
+
+    // Attaches the document to a store shared with other documents (nullptr detaches it)
+    // Large strings, SharedString payloads and sequences of the files loaded after this call are kept once for all attached documents.
+    // note: values of snapshots are not shared, they stay in the mapped snapshot file
+    void setInternStore(std::shared_ptr<InternStore> store);
+
+    // Mapping between current instance ids and the ids stored in the source file
+    int32_t getOriginalId(int32_t id) const;
+    int32_t getIdFromOriginal(int32_t originalId) const;
+
   private:
+    // drops all instances, types, indices and pooled values
+    void clear();
+
+    // builds compressed sparse row child lists out of the instance parent links
+    // children are placed in a given order (if it is provided), otherwise in order of instance ids
+    void buildHierarchy(const std::vector<int32_t>& order);
+
+    // true if following parent links from some instance never reaches a root (parent ids must be valid)
+    bool hasParentCycle() const;
+
     std::vector<Instance> instances;
     std::vector<Type> types;
 
+    // children of instance i are childIds[childOffsets[i] .. childOffsets[i + 1]]
+    std::vector<uint32_t> childOffsets;
+    std::vector<int32_t> childIds;
+    std::vector<int32_t> rootIds;
+
+    // referrers of instance i are referrers[referrerOffsets[i] .. referrerOffsets[i + 1]]
+    std::vector<uint32_t> referrerOffsets;
+    std::vector<Referrer> referrers;
+
+    // filled by renumberDepthFirst() (empty means ids match the source file)
+    std::vector<int32_t> originalIds;
+    std::vector<int32_t> currentIds;
+    std::vector<uint32_t> subtreeSizes;
+
+    std::vector<ChunkHash> chunkHashes;
+    // decompressed size of the chunks decoded by reload() since the last full load
+    size_t reloadedSize = 0;
+
+    // owned through a pointer so that pooled property references survive moving the document
+    std::unique_ptr<ValuePool> pool;
+    std::shared_ptr<InternStore> internStore;
+
+    LoadError loadError;
+
     friend class BinaryReader;
+    friend class DocumentCopier;
+    friend class Snapshot;
+    friend class XmlReader;
 };
 
 } // namespace rbxdoc
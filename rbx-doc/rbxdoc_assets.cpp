@@ -0,0 +1,80 @@
+#include <mutex>
+#include <string.h>
+
+#include "rbxdoc_assets.h"
+#include "rbxdoc_binary.h"
+#include "rbxdoc_file.h"
+#include "rbxdoc_parallel.h"
+
+namespace rbxdoc
+{
+
+static const char* kDefaultAssetProperties[] = {
+    "AnimationId",   "BaseTextureId",  "ColorMap",     "CursorIcon",    "Graphic",        "HoverImage",   "Image",        "LinkedSource",
+    "MeshId",        "MetalnessMap",   "MoonTextureId", "NormalMap",    "OverlayTextureId", "PantsTemplate", "PressedImage", "RoughnessMap",
+    "ShirtTemplate", "SkyboxBk",       "SkyboxDn",     "SkyboxFt",      "SkyboxLf",       "SkyboxRt",     "SkyboxUp",     "SoundId",
+    "SunTextureId",  "Texture",        "TextureId",    "TextureID",     "Video",
+};
+
+AssetScanner::AssetScanner() { setPropertyNames(kDefaultAssetProperties, sizeof(kDefaultAssetProperties) / sizeof(kDefaultAssetProperties[0])); }
+
+void AssetScanner::setPropertyNames(const char* const* names, size_t count)
+{
+    propertyNames.clear();
+    propertyNames.reserve(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        propertyNames.emplace_back(names[i]);
+    }
+}
+
+bool AssetScanner::isAssetProperty(const char* name, size_t nameLength) const
+{
+    for (const std::string& propertyName : propertyNames)
+    {
+        if (propertyName.size() == nameLength && memcmp(propertyName.data(), name, nameLength) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+LoadResult AssetScanner::scanFile(const char* fileName, const AssetCallback& callback) const
+{
+    if (!fileName)
+    {
+        return LoadResult::Error;
+    }
+
+    MappedFile file;
+    if (!file.open(fileName))
+    {
+        return LoadResult::Error;
+    }
+
+    return BinaryReader::scanAssets(file.data(), file.size(), fileName, *this, callback);
+}
+
+size_t AssetScanner::scanFiles(const char* const* fileNames, size_t count, const AssetCallback& callback, uint32_t numThreads) const
+{
+    std::mutex callbackMutex;
+    AssetCallback serialized = [&](const AssetReference& ref) {
+        std::lock_guard<std::mutex> lock(callbackMutex);
+        callback(ref);
+    };
+
+    std::atomic<size_t> numScanned(0);
+    parallelFor(count, 1, numThreads, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+        {
+            if (scanFile(fileNames[i], serialized) == LoadResult::OK)
+            {
+                numScanned++;
+            }
+        }
+    });
+    return numScanned;
+}
+
+} // namespace rbxdoc
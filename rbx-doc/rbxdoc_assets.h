@@ -0,0 +1,46 @@
+#pragma once
+
+#include <functional>
+
+#include "rbxdoc.h"
+
+namespace rbxdoc
+{
+
+// note: all strings are only valid during the callback
+struct AssetReference
+{
+    const char* fileName;
+    int32_t instanceId;
+    const char* typeName;
+    const char* propertyName;
+    // points into the file (or the decompressed chunk) and is not NUL terminated
+    const char* url;
+    size_t urlLength;
+};
+
+using AssetCallback = std::function<void(const AssetReference& ref)>;
+
+// Streams asset urls out of binary files without loading documents
+// Only PROP chunks of String properties from the asset property set and Content properties are decompressed and decoded,
+// for any other PROP chunk only its header is decompressed, all other chunks (except INST) are skipped without decompression
+class AssetScanner
+{
+  public:
+    // uses a default set of asset properties (MeshId, TextureID, SoundId, ...)
+    AssetScanner();
+
+    void setPropertyNames(const char* const* names, size_t count);
+    bool isAssetProperty(const char* name, size_t nameLength) const;
+
+    LoadResult scanFile(const char* fileName, const AssetCallback& callback) const;
+
+    // scans files in parallel, the callback is never invoked concurrently
+    // returns the number of files that were scanned successfully
+    size_t scanFiles(const char* const* fileNames, size_t count, const AssetCallback& callback, uint32_t numThreads = 0) const;
+
+  private:
+    std::vector<std::string> propertyNames;
+};
+
+} // namespace rbxdoc
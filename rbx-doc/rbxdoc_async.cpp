@@ -0,0 +1,39 @@
+#include <memory>
+#include <thread>
+#include <utility>
+
+#include "rbxdoc_async.h"
+
+namespace rbxdoc
+{
+
+static void run(const Executor& executor, std::function<void()> task)
+{
+    if (executor)
+    {
+        executor(std::move(task));
+        return;
+    }
+    std::thread(std::move(task)).detach();
+}
+
+std::future<Document> loadFileAsync(std::string fileName, LoadOptions options, const Executor& executor)
+{
+    // std::function needs a copyable task, the promise is shared with it
+    auto promise = std::make_shared<std::promise<Document>>();
+    std::future<Document> res = promise->get_future();
+    LoadCallback onLoaded = [promise](Document&& doc) { promise->set_value(std::move(doc)); };
+    loadFileAsync(std::move(fileName), std::move(onLoaded), std::move(options), executor);
+    return res;
+}
+
+void loadFileAsync(std::string fileName, LoadCallback onLoaded, LoadOptions options, const Executor& executor)
+{
+    run(executor, [fileName = std::move(fileName), onLoaded = std::move(onLoaded), options = std::move(options)]() {
+        Document doc;
+        doc.loadFile(fileName.c_str(), options);
+        onLoaded(std::move(doc));
+    });
+}
+
+} // namespace rbxdoc
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <functional>
+#include <future>
+#include <string>
+
+#include "rbxdoc.h"
+
+namespace rbxdoc
+{
+
+// Runs a task on a thread of the caller's choice (a thread pool, a UI event loop, ...)
+using Executor = std::function<void(std::function<void()> task)>;
+
+using LoadCallback = std::function<void(Document&& doc)>;
+
+// Loads a file without blocking the calling thread, the future gets the document (Document::getLoadError() tells why a load failed)
+// The load runs on the executor (empty = a thread of its own), progress callbacks are called from the loading threads.
+// Setting LoadOptions::cancel stops the load between chunks, the document then fails with LoadErrorCode::Cancelled.
+std::future<Document> loadFileAsync(std::string fileName, LoadOptions options = LoadOptions(), const Executor& executor = Executor());
+
+// Same as above, onLoaded gets the document on the loading thread once the load is finished
+// note: onLoaded must not throw
+void loadFileAsync(std::string fileName, LoadCallback onLoaded, LoadOptions options = LoadOptions(), const Executor& executor = Executor());
+
+} // namespace rbxdoc
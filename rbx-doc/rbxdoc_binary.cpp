@@ -1,12 +1,17 @@
-#include <stdexcept>
+#include <algorithm>
+#include <array>
 #include <stdio.h>
+#include <string.h>
+#include <utility>
 #include <vector>
 
 #include <lz4.h>
 #include <zstd.h>
 
 #include "rbxdoc.h"
+#include "rbxdoc_assets.h"
 #include "rbxdoc_binary.h"
+#include "rbxdoc_hash.h"
 
 namespace rbxdoc
 {
@@ -56,35 +61,40 @@ enum BinaryParentLinkFormat
     bplfPlain,
 };
 
+// Input stream of the decoder, reads never throw
+// A failed read zero-fills the destination and puts the blob into a sticky error state: the read position moves to the end,
+// so all subsequent reads fail too and decoding loops terminate without checking every read. Callers check hasError() once per chunk.
 class BinaryBlob
 {
   public:
     BinaryBlob()
-        : offset(0)
+        : bytes(nullptr)
+        , length(0)
+        , offset(0)
     {
     }
 
-    void initFromFile(const char* filename)
+    bool initFromFile(const char* filename)
     {
-        offset = 0;
+        reset(nullptr, 0);
 
         FILE* file = fopen(filename, "rb");
         if (!file)
         {
-            throw std::runtime_error("Failed to open file");
+            return fail(LoadErrorCode::FileReadFailed, "Failed to open file");
         }
 
         if (fseek(file, 0, SEEK_END) != 0)
         {
             fclose(file);
-            throw std::runtime_error("Failed to seek to end of file");
+            return fail(LoadErrorCode::FileReadFailed, "Failed to seek to end of file");
         }
 
         long fileSize = ftell(file);
         if (fileSize < 0)
         {
             fclose(file);
-            throw std::runtime_error("Failed to determine file size");
+            return fail(LoadErrorCode::FileReadFailed, "Failed to determine file size");
         }
         ::rewind(file);
         buffer.resize(static_cast<size_t>(fileSize));
@@ -93,20 +103,33 @@ class BinaryBlob
         if (readBytes != buffer.size())
         {
             buffer.clear();
-            throw std::runtime_error("Failed to read entire file");
+            return fail(LoadErrorCode::FileReadFailed, "Failed to read entire file");
         }
+        bytes = buffer.data();
+        length = buffer.size();
+        return true;
     }
 
-    void initFromBlob(BinaryBlob& other, size_t size)
+    // zero-copy, the memory must outlive the blob
+    void initFromMemory(const uint8_t* data, size_t size) { reset(data, size); }
+
+    // zero-copy view of the next size bytes of the other blob
+    bool initFromBlob(BinaryBlob& other, size_t size)
     {
-        buffer.resize(size);
-        other.read(buffer.data(), size);
-        offset = 0;
+        reset(nullptr, 0);
+        if (!other.require(size))
+        {
+            return false;
+        }
+        initFromMemory(other.bytes + other.offset, size);
+        other.offset += size;
+        return true;
     }
 
-    size_t initFromCompressed(const char* compressedBytes, size_t compressedSize, size_t size)
+    bool initFromCompressed(const char* compressedBytes, size_t compressedSize, size_t size)
     {
         buffer.resize(size);
+        reset(buffer.data(), size);
         size_t decompressedSize = 0;
         if (compressedSize > 4 && memcmp(compressedBytes, kZStdFrameHeader, 4) == 0)
         {
@@ -114,42 +137,138 @@ class BinaryBlob
         }
         else
         {
-            decompressedSize = LZ4_decompress_safe(compressedBytes, reinterpret_cast<char*>(buffer.data()), int(compressedSize), int(size));
+            int res = LZ4_decompress_safe(compressedBytes, reinterpret_cast<char*>(buffer.data()), int(compressedSize), int(size));
+            decompressedSize = (res >= 0) ? size_t(res) : 0;
         }
-        offset = 0;
-        return decompressedSize;
+
+        if (decompressedSize != size)
+        {
+            return fail(LoadErrorCode::DecompressionFailed, "Malformed compressed data");
+        }
+        return true;
     }
 
-    void read(void* dest, size_t bytesToRead)
+    // decompresses only the first size bytes of the data, returns the number of bytes decompressed (0 on error)
+    size_t initFromCompressedPrefix(const char* compressedBytes, size_t compressedSize, size_t size)
     {
-        if (offset + bytesToRead > buffer.size())
+        buffer.resize(size);
+        reset(buffer.data(), 0);
+        if (compressedSize > 4 && memcmp(compressedBytes, kZStdFrameHeader, 4) == 0)
         {
-            throw std::runtime_error("Attempt to read beyond available data");
+            ZSTD_DStream* stream = ZSTD_createDStream();
+            ZSTD_inBuffer in = {compressedBytes, compressedSize, 0};
+            ZSTD_outBuffer out = {buffer.data(), size, 0};
+            while (out.pos < out.size && in.pos < in.size)
+            {
+                size_t res = ZSTD_decompressStream(stream, &out, &in);
+                if (ZSTD_isError(res) || res == 0)
+                {
+                    break;
+                }
+            }
+            ZSTD_freeDStream(stream);
+            length = out.pos;
         }
-        std::memcpy(dest, buffer.data() + offset, bytesToRead);
-        offset += bytesToRead;
+        else
+        {
+            int res = LZ4_decompress_safe_partial(compressedBytes, reinterpret_cast<char*>(buffer.data()), int(compressedSize), int(size), int(size));
+            length = (res > 0) ? size_t(res) : 0;
+        }
+        return length;
+    }
+
+    // checks that numBytes are available, the following numBytes can be consumed with unchecked reads
+    bool require(size_t numBytes)
+    {
+        if (numBytes > length - offset)
+        {
+            return fail(LoadErrorCode::TruncatedData, "Attempt to read beyond available data");
+        }
+        return true;
+    }
+
+    bool read(void* dest, size_t bytesToRead)
+    {
+        if (!require(bytesToRead))
+        {
+            memset(dest, 0, bytesToRead);
+            return false;
+        }
+        readUnchecked(dest, bytesToRead);
+        return true;
     }
 
-    template <typename T> void read(T& result)
+    template <typename T> bool read(T& result)
     {
-        if (offset + sizeof(T) > buffer.size())
+        if (!require(sizeof(T)))
         {
-            throw std::runtime_error("Not enough data to read object");
+            memset(&result, 0, sizeof(T));
+            return false;
         }
-        std::memcpy(&result, buffer.data() + offset, sizeof(T));
+        readUnchecked(result);
+        return true;
+    }
+
+    // note: the caller must validate the size with require() first
+    void readUnchecked(void* dest, size_t bytesToRead)
+    {
+        memcpy(dest, bytes + offset, bytesToRead);
+        offset += bytesToRead;
+    }
+
+    template <typename T> void readUnchecked(T& result)
+    {
+        memcpy(&result, bytes + offset, sizeof(T));
         offset += sizeof(T);
     }
 
-    size_t size() const { return buffer.size(); }
+    size_t size() const { return length; }
     size_t tell() const { return offset; }
 
-    uint8_t at(size_t offset) const { return buffer[offset]; }
+    uint8_t at(size_t offset) const { return bytes[offset]; }
+    const uint8_t* data() const { return bytes; }
 
+    // note: the caller must validate the size with require() first
     void skip(size_t numBytes) { offset += numBytes; }
 
+    // records the first error, always returns false
+    bool fail(LoadErrorCode code, const char* reason)
+    {
+        if (errorCode == LoadErrorCode::None)
+        {
+            errorCode = code;
+            errorReason = reason;
+            errorOffset = offset;
+        }
+        offset = length;
+        return false;
+    }
+
+    bool hasError() const { return errorCode != LoadErrorCode::None; }
+    LoadErrorCode getErrorCode() const { return errorCode; }
+    const char* getErrorReason() const { return errorReason; }
+    size_t getErrorOffset() const { return errorOffset; }
+
   private:
+    void reset(const uint8_t* data, size_t size)
+    {
+        bytes = data;
+        length = size;
+        offset = 0;
+        errorCode = LoadErrorCode::None;
+        errorReason = "";
+        errorOffset = 0;
+    }
+
+    // owned storage (file contents or decompressed data), empty for views
     std::vector<uint8_t> buffer;
+    const uint8_t* bytes;
+    size_t length;
     size_t offset;
+
+    LoadErrorCode errorCode = LoadErrorCode::None;
+    const char* errorReason = "";
+    size_t errorOffset = 0;
 };
 
 enum class NormalId
@@ -163,46 +282,71 @@ enum class NormalId
     Front = 5
 };
 
-static Vec3 normalIdToVector3(NormalId normalId)
+static constexpr Vec3 normalIdToVector3(NormalId normalId)
 {
-    float coords[] = {0.0f, 0.0f, 0.0f};
-    int index = (int)(normalId);
-    coords[index % 3] = ((normalId >= NormalId::Left) ? -1.0f : 1.0f);
-    return Vec3{coords[0], coords[1], coords[2]};
+    float sign = (normalId >= NormalId::Left) ? -1.0f : 1.0f;
+    int axis = int(normalId) % 3;
+    return Vec3{(axis == 0) ? sign : 0.0f, (axis == 1) ? sign : 0.0f, (axis == 2) ? sign : 0.0f};
 }
 
-static Vec3 vec3_cross(const Vec3& a, const Vec3& b) { return Vec3{a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x}; }
+static constexpr Vec3 vec3_cross(const Vec3& a, const Vec3& b) { return Vec3{a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x}; }
 
-static void idToMatrix3(int orientId, Mat3x3& matrix)
+static constexpr Mat3x3 idToMatrix3(int orientId)
 {
-    NormalId xNormal = (NormalId)(orientId / 6);
-    NormalId yNormal = (NormalId)(orientId % 6);
-    Vec3 r0 = normalIdToVector3(xNormal);
-    Vec3 r1 = normalIdToVector3(yNormal);
+    Vec3 r0 = normalIdToVector3(NormalId(orientId / 6));
+    Vec3 r1 = normalIdToVector3(NormalId(orientId % 6));
     Vec3 r2 = vec3_cross(r0, r1);
-    matrix = Mat3x3{r0.x, r0.y, r0.z, r1.x, r1.y, r1.z, r2.x, r2.y, r2.z};
+    return Mat3x3{r0.x, r0.y, r0.z, r1.x, r1.y, r1.z, r2.x, r2.y, r2.z};
+}
+
+template <size_t... Ids> static constexpr std::array<Mat3x3, sizeof...(Ids)> makeRotationTable(std::index_sequence<Ids...>)
+{
+    return std::array<Mat3x3, sizeof...(Ids)>{idToMatrix3(int(Ids))...};
 }
 
-static void readExactRotation(BinaryBlob& blob, Mat3x3& res)
+// rotation id - 1 = xNormal * 6 + yNormal, the 24 axis-aligned rotations are the ids with perpendicular axes
+// ids with parallel axes produce a degenerate matrix but are still accepted
+static constexpr std::array<Mat3x3, 36> kRotations = makeRotationTable(std::make_index_sequence<36>());
+
+static void readString(BinaryBlob& blob, std::string& res)
 {
-    char orientId;
-    blob.read(orientId);
-    if (orientId)
+    uint32_t length;
+    blob.read(length);
+    if (!blob.require(length))
     {
-        idToMatrix3(orientId - 1, res);
+        res.clear();
+        return;
     }
-    else
+    res.resize(length);
+    blob.readUnchecked(&res[0], length);
+}
+
+// returns the string bytes in place (not NUL terminated), they stay valid as long as the blob data
+static const char* readStringView(BinaryBlob& blob, uint32_t& length)
+{
+    blob.read(length);
+    if (!blob.require(length))
     {
-        blob.read(&res.v[0], sizeof(float) * 9);
+        length = 0;
+        return "";
     }
+    const char* res = reinterpret_cast<const char*>(blob.data() + blob.tell());
+    blob.skip(length);
+    return res;
 }
 
-static void readString(BinaryBlob& blob, std::string& res)
+static uint32_t readPooledString(BinaryBlob& blob, ValuePool& pool)
 {
     uint32_t length;
     blob.read(length);
-    res.resize(length);
-    blob.read(&res[0], length);
+    if (!blob.require(length))
+    {
+        length = 0;
+    }
+    uint32_t index;
+    blob.readUnchecked(pool.allocateString(length, index), length);
+    pool.internString(index);
+    return index;
 }
 
 union FloatBitcast
@@ -221,29 +365,36 @@ static float decodeFloat(unsigned int value)
 static int decodeInt(int32_t value) { return (static_cast<uint32_t>(value) >> 1) ^ (-(value & 1)); }
 static int64_t decodeInt64(int64_t value) { return (static_cast<uint64_t>(value) >> 1) ^ (-(value & 1)); }
 
-static void readIntVector(BinaryBlob& blob, std::vector<int32_t>& values, size_t count)
+// value i of a column of 4 byte big-endian values stored as 4 interleaved byte planes
+static inline uint32_t loadPlane32(const uint8_t* planes, size_t count, size_t i)
 {
-    values.clear();
-    values.reserve(count);
+    return (uint32_t(planes[i]) << 24) | (uint32_t(planes[count + i]) << 16) | (uint32_t(planes[count * 2 + i]) << 8) | uint32_t(planes[count * 3 + i]);
+}
 
-    if (blob.tell() + count * 4 > blob.size())
+static inline uint64_t loadPlane64(const uint8_t* planes, size_t count, size_t i)
+{
+    uint64_t res = 0;
+    for (size_t plane = 0; plane < 8; plane++)
     {
+        res = (res << 8) | planes[count * plane + i];
+    }
+    return res;
+}
 
-        throw std::runtime_error("readIntVector offset is out of bounds");
+static void readIntVector(BinaryBlob& blob, std::vector<int32_t>& values, size_t count)
+{
+    values.clear();
+    if (!blob.require(count * 4))
+    {
+        values.resize(count, 0);
+        return;
     }
 
-    size_t startOffset = blob.tell();
+    values.resize(count);
+    const uint8_t* planes = blob.data() + blob.tell();
     for (size_t i = 0; i < count; ++i)
     {
-        uint8_t v0;
-        uint8_t v1;
-        uint8_t v2;
-        uint8_t v3;
-        v0 = blob.at(startOffset + count * 0 + i);
-        v1 = blob.at(startOffset + count * 1 + i);
-        v2 = blob.at(startOffset + count * 2 + i);
-        v3 = blob.at(startOffset + count * 3 + i);
-        values.push_back(decodeInt((v0 << 24) | (v1 << 16) | (v2 << 8) | v3));
+        values[i] = decodeInt(int32_t(loadPlane32(planes, count, i)));
     }
 
     blob.skip(count * 4);
@@ -252,123 +403,234 @@ static void readIntVector(BinaryBlob& blob, std::vector<int32_t>& values, size_t
 static void readUIntVector(BinaryBlob& blob, std::vector<uint32_t>& values, size_t count)
 {
     values.clear();
-    values.reserve(count);
-
-    if (blob.tell() + count * 4 > blob.size())
+    if (!blob.require(count * 4))
     {
-        throw std::runtime_error("readUIntVector offset is out of bounds");
+        values.resize(count, 0);
+        return;
     }
 
-    size_t startOffset = blob.tell();
+    values.resize(count);
+    const uint8_t* planes = blob.data() + blob.tell();
     for (size_t i = 0; i < count; ++i)
     {
-        uint8_t v0 = blob.at(startOffset + count * 0 + i);
-        uint8_t v1 = blob.at(startOffset + count * 1 + i);
-        uint8_t v2 = blob.at(startOffset + count * 2 + i);
-        uint8_t v3 = blob.at(startOffset + count * 3 + i);
-        values.push_back((v0 << 24) | (v1 << 16) | (v2 << 8) | v3);
+        values[i] = loadPlane32(planes, count, i);
     }
 
     blob.skip(count * 4);
 }
 
-static void readInt64Vector(BinaryBlob& blob, std::vector<int64_t>& values, size_t count)
+// rotation of a unit quaternion (x, y, z, w)
+static Mat3x3 quaternionToMatrix3(float x, float y, float z, float w)
 {
-    values.clear();
-    values.reserve(count);
+    Mat3x3 res;
+    res.v[0] = 1.0f - 2.0f * (y * y + z * z);
+    res.v[1] = 2.0f * (x * y - w * z);
+    res.v[2] = 2.0f * (x * z + w * y);
+    res.v[3] = 2.0f * (x * y + w * z);
+    res.v[4] = 1.0f - 2.0f * (x * x + z * z);
+    res.v[5] = 2.0f * (y * z - w * x);
+    res.v[6] = 2.0f * (x * z - w * y);
+    res.v[7] = 2.0f * (y * z + w * x);
+    res.v[8] = 1.0f - 2.0f * (x * x + y * y);
+    return res;
+}
 
-    if (blob.tell() + count * 8 > blob.size())
+// rotations of all values go first (1 byte id or 1 byte + an explicit rotation), followed by three float planes of translations
+// the explicit rotation is a 3x3 matrix (CFrameMatrix) or a quaternion (CFrameQuat)
+// cframeAt(i) returns the destination of the i-th value
+template <PropertyType Format, typename CFrameAt> static bool readCFrames(BinaryBlob& blob, size_t count, const CFrameAt& cframeAt)
+{
+    for (size_t i = 0; i < count; i++)
     {
-        throw std::runtime_error("readInt64Vector offset is out of bounds");
+        uint8_t orientId;
+        if (!blob.read(orientId))
+        {
+            return false;
+        }
+
+        if (orientId == 0)
+        {
+            if constexpr (Format == PropertyType::CFrameQuat)
+            {
+                float q[4];
+                if (!blob.read(q, sizeof(q)))
+                {
+                    return false;
+                }
+                cframeAt(i).rotation = quaternionToMatrix3(q[0], q[1], q[2], q[3]);
+            }
+            else
+            {
+                if (!blob.read(&cframeAt(i).rotation.v[0], sizeof(float) * 9))
+                {
+                    return false;
+                }
+            }
+        }
+        else if (orientId <= kRotations.size())
+        {
+            cframeAt(i).rotation = kRotations[orientId - 1];
+        }
+        else
+        {
+            return blob.fail(LoadErrorCode::UnsupportedEncoding, "Invalid rotation id");
+        }
     }
 
-    size_t startOffset = blob.tell();
-    for (size_t i = 0; i < count; ++i)
+    if (!blob.require(count * 12))
     {
-        uint64_t v0 = blob.at(startOffset + count * 0 + i);
-        uint64_t v1 = blob.at(startOffset + count * 0 + i);
-        uint64_t v2 = blob.at(startOffset + count * 0 + i);
-        uint64_t v3 = blob.at(startOffset + count * 0 + i);
-        uint64_t v4 = blob.at(startOffset + count * 0 + i);
-        uint64_t v5 = blob.at(startOffset + count * 0 + i);
-        uint64_t v6 = blob.at(startOffset + count * 0 + i);
-        uint64_t v7 = blob.at(startOffset + count * 0 + i);
-        values.push_back(decodeInt64((v0 << 56) | (v1 << 48) | (v2 << 40) | (v3 << 32) | (v4 << 24) | (v5 << 16) | (v6 << 8) | v7));
+        return false;
     }
 
-    blob.skip(count * 8);
+    const uint8_t* planes = blob.data() + blob.tell();
+    for (size_t i = 0; i < count; i++)
+    {
+        cframeAt(i).translation = Vec3{decodeFloat(loadPlane32(planes, count, i)), decodeFloat(loadPlane32(planes + count * 4, count, i)),
+                                        decodeFloat(loadPlane32(planes + count * 8, count, i))};
+    }
+    blob.skip(count * 12);
+    return true;
 }
 
-static void readFloatVector(BinaryBlob& blob, std::vector<float>& values, size_t count)
+static void readIdVector(BinaryBlob& blob, std::vector<int>& values, size_t count)
 {
-    values.clear();
-    values.reserve(count);
+    readIntVector(blob, values, count);
 
-    if (blob.tell() + count * 4 > blob.size())
+    int last = 0;
+    for (size_t i = 0; i < count; ++i)
     {
-        throw std::runtime_error("readFloatVector offset is out of bounds");
+        values[i] += last;
+        last = values[i];
     }
+}
 
-    size_t startOffset = blob.tell();
-    for (size_t i = 0; i < count; ++i)
+// errors are recorded in the file blob (out of bounds payload) or in the chunk blob (decompression)
+static bool readChunkData(const ChunkHeader& chunk, BinaryBlob& blob, BinaryBlob& bytes)
+{
+    if (chunk.size == 0)
     {
-        uint8_t v0 = blob.at(startOffset + count * 0 + i);
-        uint8_t v1 = blob.at(startOffset + count * 1 + i);
-        uint8_t v2 = blob.at(startOffset + count * 2 + i);
-        uint8_t v3 = blob.at(startOffset + count * 3 + i);
-        values.push_back(decodeFloat((v0 << 24) | (v1 << 16) | (v2 << 8) | v3));
+        bytes.initFromMemory(nullptr, 0);
+        return true;
     }
 
-    blob.skip(count * 4);
+    if (chunk.compressedSize == 0)
+    {
+        if (chunk.size > blob.size() - blob.tell())
+        {
+            return blob.fail(LoadErrorCode::ChunkOutOfBounds, "Chunk data is out of bounds");
+        }
+        return bytes.initFromBlob(blob, chunk.size);
+    }
+
+    if (chunk.compressedSize > blob.size() - blob.tell())
+    {
+        return blob.fail(LoadErrorCode::ChunkOutOfBounds, "Chunk data is out of bounds");
+    }
+    const char* compressed = reinterpret_cast<const char*>(blob.data() + blob.tell());
+    blob.skip(chunk.compressedSize);
+    return bytes.initFromCompressed(compressed, chunk.compressedSize, chunk.size);
 }
 
-static void readUInt8Vector(BinaryBlob& blob, std::vector<uint8_t>& values, size_t count)
+// hash of the chunk data as stored in the file (compressed or not), the blob is positioned at the data
+static uint64_t hashChunkPayload(const ChunkHeader& chunk, const BinaryBlob& blob)
 {
-    values.clear();
+    size_t payloadSize = (chunk.compressedSize != 0) ? chunk.compressedSize : chunk.size;
+    payloadSize = std::min(payloadSize, blob.size() - blob.tell());
+    return hash64(blob.data() + blob.tell(), payloadSize);
+}
 
-    if (blob.tell() + count > blob.size())
+// INST and PROP chunks start with the type index, -1 if the chunk is too short
+static int32_t readChunkTypeIndex(const BinaryBlob& blob)
+{
+    uint32_t typeIndex = 0;
+    if (blob.size() < sizeof(typeIndex))
     {
-        throw std::runtime_error("readUInt8Vector offset is out of bounds");
+        return -1;
     }
-
-    values.resize(count);
-    blob.read(values.data(), count);
+    memcpy(&typeIndex, blob.data(), sizeof(typeIndex));
+    return int32_t(typeIndex);
 }
 
-static void readIdVector(BinaryBlob& blob, std::vector<int>& values, size_t count)
+static bool skipChunkData(const ChunkHeader& chunk, BinaryBlob& blob)
 {
-    readIntVector(blob, values, count);
-
-    int last = 0;
-    for (size_t i = 0; i < count; ++i)
+    size_t payloadSize = (chunk.compressedSize != 0) ? chunk.compressedSize : chunk.size;
+    if (payloadSize > blob.size() - blob.tell())
     {
-        values[i] += last;
-        last = values[i];
+        return blob.fail(LoadErrorCode::ChunkOutOfBounds, "Chunk data is out of bounds");
     }
+    blob.skip(payloadSize);
+    return true;
 }
 
-static void readChunkData(const ChunkHeader& chunk, BinaryBlob& blob, BinaryBlob& bytes)
+static bool readFileHeader(BinaryBlob& blob, FileHeader& header)
 {
-    if (chunk.size == 0)
+    if (!blob.read(header))
     {
-        return;
+        return false;
     }
 
-    if (chunk.compressedSize == 0)
+    if (memcmp(header.magic, kMagicHeader, sizeof(header.magic)) != 0)
     {
-        bytes.initFromBlob(blob, chunk.size);
+        return blob.fail(LoadErrorCode::UnsupportedFormat, "Unrecognized format");
     }
-    else
+
+    if (memcmp(header.signature, kHeaderSignature, sizeof(header.signature)) != 0)
+    {
+        return blob.fail(LoadErrorCode::CorruptedHeader, "The file header is corrupted, unexpected signature");
+    }
+
+    if (header.version != 0)
+    {
+        return blob.fail(LoadErrorCode::UnsupportedFormat, "Unrecognized version");
+    }
+    return true;
+}
+
+// The header counts are used to size the document before any chunk is read. Every instance is listed in an INST chunk (4 byte id) and
+// every type has its own INST chunk, so the chunk headers bound the counts a corrupted header can request.
+// returns false if the chunk list is broken, the limits then only cover the chunks before the broken one
+static bool readHeaderLimits(const BinaryBlob& fileBlob, size_t& maxObjects, size_t& maxTypes)
+{
+    BinaryBlob blob;
+    blob.initFromMemory(fileBlob.data() + fileBlob.tell(), fileBlob.size() - fileBlob.tell());
+
+    maxObjects = 0;
+    maxTypes = 0;
+    while (blob.tell() < blob.size())
     {
-        std::vector<char> compressed;
-        compressed.resize(chunk.compressedSize);
-        blob.read(compressed.data(), chunk.compressedSize);
-        size_t decompressed = bytes.initFromCompressed(compressed.data(), compressed.size(), chunk.size);
-        if (decompressed != bytes.size())
+        ChunkHeader chunk = {};
+        if (!blob.read(chunk) || !skipChunkData(chunk, blob))
+        {
+            return false;
+        }
+
+        if (memcmp(chunk.name, kChunkInstances, sizeof(chunk.name)) == 0)
+        {
+            maxObjects += chunk.size / 4;
+            maxTypes++;
+        }
+        else if (memcmp(chunk.name, kChunkEnd, sizeof(chunk.name)) == 0)
         {
-            throw std::runtime_error("Malformed data");
+            break;
         }
     }
+    return true;
+}
+
+static bool validateHeader(BinaryBlob& fileBlob, const FileHeader& header, size_t& numObjects, size_t& numTypes)
+{
+    size_t maxObjects;
+    size_t maxTypes;
+    bool isComplete = readHeaderLimits(fileBlob, maxObjects, maxTypes);
+    if (isComplete && (header.objects > maxObjects || header.types > maxTypes))
+    {
+        return fileBlob.fail(LoadErrorCode::CorruptedHeader, "The file header is corrupted, instance or type count exceeds the INST chunks");
+    }
+
+    // a broken chunk list is reported by the chunk that is broken
+    numObjects = std::min(size_t(header.objects), maxObjects);
+    numTypes = std::min(size_t(header.types), maxTypes);
+    return true;
 }
 
 void BinaryReader::readInstances(const ChunkHeader& chunk, BinaryBlob& blob, Document& doc)
@@ -382,19 +644,31 @@ void BinaryReader::readInstances(const ChunkHeader& chunk, BinaryBlob& blob, Doc
     char format;
     blob.read(format);
 
+    uint32_t idCount;
+    blob.read(idCount);
+    if (blob.hasError())
+    {
+        return;
+    }
+
     if (format != bofPlain && format != bofServiceType)
     {
-        throw std::runtime_error("Unrecognized object format");
+        blob.fail(LoadErrorCode::UnsupportedEncoding, "Unrecognized object format");
+        return;
     }
 
-    uint32_t idCount;
-    blob.read(idCount);
+    bool isServiceType = (format == bofServiceType);
+
+    // ids and the optional service flags, validated once for the whole chunk
+    if (!blob.require(size_t(idCount) * (isServiceType ? 5 : 4)))
+    {
+        return;
+    }
 
     std::vector<int32_t> ids;
     readIdVector(blob, ids, idCount);
     size_t numInstances = ids.size();
 
-    bool isServiceType = (format == bofServiceType);
     std::vector<bool> isServiceRootedArray;
     if (isServiceType)
     {
@@ -403,240 +677,479 @@ void BinaryReader::readInstances(const ChunkHeader& chunk, BinaryBlob& blob, Doc
         for (size_t i = 0; i < numInstances; ++i)
         {
             char value;
-            blob.read(value);
+            blob.readUnchecked(value);
             isServiceRootedArray[i] = value;
         }
     }
 
     if (typeIndex >= doc.types.size())
     {
-        throw std::runtime_error("Incorrect type index");
+        blob.fail(LoadErrorCode::InvalidTypeIndex, "Incorrect type index");
+        return;
     }
-    doc.types[typeIndex] = Type{std::move(typeName)};
-    // note: do not use typeName it was moved!
 
     for (size_t i = 0; i < numInstances; ++i)
     {
-        int instanceId = ids[i];
-        bool isServiceRooted = isServiceType ? isServiceRootedArray[i] : false;
-
-        if (instanceId >= doc.instances.size())
+        if (ids[i] < 0 || size_t(ids[i]) >= doc.instances.size())
         {
-            throw std::runtime_error("Incorrect instance index");
+            blob.fail(LoadErrorCode::InvalidInstanceId, "Incorrect instance index");
+            return;
         }
-        doc.instances[instanceId] = Instance{-1, instanceId, typeIndex, isServiceType, isServiceRooted};
-    }
-}
-
-void BinaryReader::readStringProperties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances)
-{
-    std::string tmp;
-    for (size_t i = 0; i < typeInstances.size(); i++)
-    {
-        Instance& inst = doc.instances[typeInstances[i]];
-        inst.properties.push_back(Property{name.c_str(), PropertyType::String});
-        Property& prop = inst.properties.back();
-        readString(blob, tmp);
-        prop.data = tmp;
     }
-}
 
-void BinaryReader::readEnumProperties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances)
-{
-    std::vector<uint32_t> values;
-    readUIntVector(blob, values, typeInstances.size());
+    Type& type = doc.types[typeIndex];
+    type = Type{std::move(typeName)};
+    // note: do not use typeName it was moved!
 
-    for (size_t i = 0; i < typeInstances.size(); i++)
+    type.instanceIds.reserve(numInstances);
+    for (size_t i = 0; i < numInstances; ++i)
     {
-        Instance& inst = doc.instances[typeInstances[i]];
-        inst.properties.push_back(Property{name.c_str(), PropertyType::Enum});
-        Property& prop = inst.properties.back();
-        prop.data = values[i];
+        int instanceId = ids[i];
+        bool isServiceRooted = isServiceType ? isServiceRootedArray[i] : false;
+        doc.instances[instanceId] = Instance{-1, instanceId, typeIndex, isServiceType, isServiceRooted};
+        type.instanceIds.push_back(instanceId);
     }
 }
 
-void BinaryReader::readBoolProperties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances)
+// Column decoders
+//
+// Values of a PROP chunk are stored column-wise. Fixed-size types are described by a ColumnLayout: a list of component planes and a
+// function that assembles the value from the decoded components. readColumn<Type> generates a single fused loop that decodes all the
+// planes of a row in place (no intermediate vectors) and stores the value into the property payload.
+// Variable-size types (strings, sequences, CFrames, ...) provide explicit readColumn specializations instead.
+
+// Component encodings, every component takes kSize * count bytes of the column
+struct Int32Plane
 {
-    for (size_t i = 0; i < typeInstances.size(); i++)
-    {
-        Instance& inst = doc.instances[typeInstances[i]];
-        inst.properties.push_back(Property{name.c_str(), PropertyType::Bool});
-        Property& prop = inst.properties.back();
-        char tmp;
-        blob.read(tmp);
-        bool val = (tmp != 0);
-        prop.data = val;
-    }
-}
-void BinaryReader::readInt32Properties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances)
+    static constexpr size_t kSize = 4;
+    static int32_t load(const uint8_t* planes, size_t count, size_t i) { return decodeInt(int32_t(loadPlane32(planes, count, i))); }
+};
+
+struct UInt32Plane
 {
-    std::vector<int32_t> values;
-    readIntVector(blob, values, typeInstances.size());
+    static constexpr size_t kSize = 4;
+    static uint32_t load(const uint8_t* planes, size_t count, size_t i) { return loadPlane32(planes, count, i); }
+};
 
-    for (size_t i = 0; i < typeInstances.size(); i++)
-    {
-        Instance& inst = doc.instances[typeInstances[i]];
-        inst.properties.push_back(Property{name.c_str(), PropertyType::Int32});
-        Property& prop = inst.properties.back();
-        prop.data = values[i];
-    }
-}
+struct Int64Plane
+{
+    static constexpr size_t kSize = 8;
+    static int64_t load(const uint8_t* planes, size_t count, size_t i) { return decodeInt64(int64_t(loadPlane64(planes, count, i))); }
+};
 
-void BinaryReader::readInt64Properties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances)
+struct FloatPlane
 {
-    std::vector<int64_t> values;
-    readInt64Vector(blob, values, typeInstances.size());
+    static constexpr size_t kSize = 4;
+    static float load(const uint8_t* planes, size_t count, size_t i) { return decodeFloat(loadPlane32(planes, count, i)); }
+};
 
-    for (size_t i = 0; i < typeInstances.size(); i++)
+// not interleaved, values are stored one after another
+template <typename T> struct RawValue
+{
+    static constexpr size_t kSize = sizeof(T);
+    static T load(const uint8_t* values, size_t /*count*/, size_t i)
     {
-        Instance& inst = doc.instances[typeInstances[i]];
-        inst.properties.push_back(Property{name.c_str(), PropertyType::Int64});
-        Property& prop = inst.properties.back();
-        prop.data = values[i];
+        T res;
+        memcpy(&res, values + i * sizeof(T), sizeof(T));
+        return res;
     }
-}
+};
 
-void BinaryReader::readFloatProperties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances)
+template <typename... Planes> struct PlaneList
 {
-    std::vector<float> values;
-    readFloatVector(blob, values, typeInstances.size());
+};
 
-    for (size_t i = 0; i < typeInstances.size(); i++)
-    {
-        Instance& inst = doc.instances[typeInstances[i]];
-        inst.properties.push_back(Property{name.c_str(), PropertyType::Float});
-        Property& prop = inst.properties.back();
-        prop.data = values[i];
-    }
-}
+// layout of an unsupported type, its values are skipped
+template <PropertyType Type> struct ColumnLayout
+{
+    static constexpr bool kSupported = false;
+    static constexpr bool kFixedSize = false;
+    static constexpr size_t kMinValueSize = 0;
+};
 
-void BinaryReader::readDoubleProperties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances)
+// variable-size layout, decoded by an explicit readColumn specialization
+template <size_t MinValueSize> struct VariableLayout
 {
-    for (size_t i = 0; i < typeInstances.size(); i++)
-    {
-        double val;
-        blob.read(val);
+    static constexpr bool kSupported = true;
+    static constexpr bool kFixedSize = false;
+    // smallest encoded value (length prefixes, flags), used to validate the column size up front
+    static constexpr size_t kMinValueSize = MinValueSize;
+};
 
-        Instance& inst = doc.instances[typeInstances[i]];
-        inst.properties.push_back(Property{name.c_str(), PropertyType::Double});
-        Property& prop = inst.properties.back();
-        prop.data = val;
-    }
-}
+template <typename... Planes> struct FixedLayout
+{
+    static constexpr bool kSupported = true;
+    static constexpr bool kFixedSize = true;
+    static constexpr size_t kMinValueSize = (Planes::kSize + ...);
+    using Components = PlaneList<Planes...>;
+};
 
-void BinaryReader::readRect2DProperties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances)
+template <> struct ColumnLayout<PropertyType::Bool> : FixedLayout<RawValue<uint8_t>>
 {
-    std::vector<float> x0;
-    std::vector<float> y0;
-    std::vector<float> x1;
-    std::vector<float> y1;
-    readFloatVector(blob, x0, typeInstances.size());
-    readFloatVector(blob, y0, typeInstances.size());
-    readFloatVector(blob, x1, typeInstances.size());
-    readFloatVector(blob, y1, typeInstances.size());
+    static bool make(uint8_t v) { return v != 0; }
+};
 
-    for (size_t i = 0; i < typeInstances.size(); i++)
-    {
-        Instance& inst = doc.instances[typeInstances[i]];
-        inst.properties.push_back(Property{name.c_str(), PropertyType::Rect2D});
-        Property& prop = inst.properties.back();
-        prop.data = Rect2D{x0[i], y0[i], x1[i], y1[i]};
-    }
-}
+template <> struct ColumnLayout<PropertyType::Int32> : FixedLayout<Int32Plane>
+{
+    static int32_t make(int32_t v) { return v; }
+};
 
-void BinaryReader::readUdim2Properties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances)
+template <> struct ColumnLayout<PropertyType::Int64> : FixedLayout<Int64Plane>
 {
-    std::vector<float> sx;
-    std::vector<float> sy;
-    readFloatVector(blob, sx, typeInstances.size());
-    readFloatVector(blob, sy, typeInstances.size());
+    static int64_t make(int64_t v) { return v; }
+};
 
-    std::vector<int32_t> ox;
-    std::vector<int32_t> oy;
-    readIntVector(blob, ox, typeInstances.size());
-    readIntVector(blob, oy, typeInstances.size());
+template <> struct ColumnLayout<PropertyType::Float> : FixedLayout<FloatPlane>
+{
+    static float make(float v) { return v; }
+};
 
-    for (size_t i = 0; i < typeInstances.size(); i++)
+template <> struct ColumnLayout<PropertyType::Double> : FixedLayout<RawValue<double>>
+{
+    static double make(double v) { return v; }
+};
+
+template <> struct ColumnLayout<PropertyType::Enum> : FixedLayout<UInt32Plane>
+{
+    static uint32_t make(uint32_t v) { return v; }
+};
+
+template <> struct ColumnLayout<PropertyType::BrickColor> : FixedLayout<UInt32Plane>
+{
+    static BrickColor make(uint32_t v) { return BrickColor{v}; }
+};
+
+template <> struct ColumnLayout<PropertyType::Vector2> : FixedLayout<FloatPlane, FloatPlane>
+{
+    static Vec2 make(float x, float y) { return Vec2{x, y}; }
+};
+
+template <> struct ColumnLayout<PropertyType::Vector3> : FixedLayout<FloatPlane, FloatPlane, FloatPlane>
+{
+    static Vec3 make(float x, float y, float z) { return Vec3{x, y, z}; }
+};
+
+template <> struct ColumnLayout<PropertyType::Color3> : FixedLayout<FloatPlane, FloatPlane, FloatPlane>
+{
+    static Color3 make(float r, float g, float b) { return Color3{r, g, b}; }
+};
+
+template <> struct ColumnLayout<PropertyType::UColor3> : FixedLayout<RawValue<uint8_t>, RawValue<uint8_t>, RawValue<uint8_t>>
+{
+    static Color3 make(uint8_t r, uint8_t g, uint8_t b) { return Color3{r / 255.0f, g / 255.0f, b / 255.0f}; }
+};
+
+template <> struct ColumnLayout<PropertyType::UDim> : FixedLayout<FloatPlane, Int32Plane>
+{
+    static UDim make(float scale, int32_t offset) { return UDim{scale, offset}; }
+};
+
+template <> struct ColumnLayout<PropertyType::UDim2> : FixedLayout<FloatPlane, FloatPlane, Int32Plane, Int32Plane>
+{
+    static UDim2 make(float sx, float sy, int32_t ox, int32_t oy) { return UDim2{sx, sy, ox, oy}; }
+};
+
+template <> struct ColumnLayout<PropertyType::Rect2D> : FixedLayout<FloatPlane, FloatPlane, FloatPlane, FloatPlane>
+{
+    static Rect2D make(float x0, float y0, float x1, float y1) { return Rect2D{x0, y0, x1, y1}; }
+};
+
+template <> struct ColumnLayout<PropertyType::NumberRange> : FixedLayout<RawValue<NumberRange>>
+{
+    static NumberRange make(const NumberRange& v) { return v; }
+};
+
+template <> struct ColumnLayout<PropertyType::UniqueId> : FixedLayout<UInt32Plane, UInt32Plane, Int64Plane>
+{
+    static UniqueId make(uint32_t index, uint32_t timestamp, int64_t rawbits) { return UniqueId{index, timestamp, rawbits}; }
+};
+
+template <> struct ColumnLayout<PropertyType::Vector2int16> : FixedLayout<RawValue<Vec2int16>>
+{
+    static Vec2int16 make(const Vec2int16& v) { return v; }
+};
+
+template <> struct ColumnLayout<PropertyType::Vector3int16> : FixedLayout<RawValue<Vec3int16>>
+{
+    static Vec3int16 make(const Vec3int16& v) { return v; }
+};
+
+// bit masks
+template <> struct ColumnLayout<PropertyType::Faces> : FixedLayout<RawValue<uint8_t>>
+{
+    static uint8_t make(uint8_t v) { return v; }
+};
+
+template <> struct ColumnLayout<PropertyType::Axes> : FixedLayout<RawValue<uint8_t>>
+{
+    static uint8_t make(uint8_t v) { return v; }
+};
+
+template <> struct ColumnLayout<PropertyType::SecurityCapabilities> : FixedLayout<Int64Plane>
+{
+    static uint64_t make(int64_t v) { return uint64_t(v); }
+};
+
+// origin + direction, stored in the pool
+template <> struct ColumnLayout<PropertyType::Ray> : VariableLayout<24>
+{
+};
+// delta-coded ids
+template <> struct ColumnLayout<PropertyType::Ref> : VariableLayout<4>
+{
+};
+template <> struct ColumnLayout<PropertyType::SharedString> : VariableLayout<4>
+{
+};
+// length prefix
+template <> struct ColumnLayout<PropertyType::String> : VariableLayout<4>
+{
+};
+template <> struct ColumnLayout<PropertyType::Bytecode> : VariableLayout<4>
+{
+};
+// source type, uris and objects follow the column
+template <> struct ColumnLayout<PropertyType::Content> : VariableLayout<4>
+{
+};
+template <> struct ColumnLayout<PropertyType::NumberSequence> : VariableLayout<4>
+{
+};
+template <> struct ColumnLayout<PropertyType::ColorSequenceV1> : VariableLayout<4>
+{
+};
+// rotation id + translation
+template <> struct ColumnLayout<PropertyType::CFrameMatrix> : VariableLayout<13>
+{
+};
+template <> struct ColumnLayout<PropertyType::CFrameQuat> : VariableLayout<13>
+{
+};
+// rotation id + translation + bool
+template <> struct ColumnLayout<PropertyType::OptionalCFrame> : VariableLayout<14>
+{
+};
+// flags
+template <> struct ColumnLayout<PropertyType::PhysicalProperties> : VariableLayout<1>
+{
+};
+// family length + weight + style + face id length
+template <> struct ColumnLayout<PropertyType::Font> : VariableLayout<11>
+{
+};
+
+// the payload type is deduced, the overload is picked by the decoded value type
+template <typename P> static inline void storeValue(P& data, bool v) { data.b = v; }
+template <typename P> static inline void storeValue(P& data, uint8_t v) { data.u8 = v; }
+template <typename P> static inline void storeValue(P& data, int32_t v) { data.i32 = v; }
+template <typename P> static inline void storeValue(P& data, uint32_t v) { data.u32 = v; }
+template <typename P> static inline void storeValue(P& data, int64_t v) { data.i64 = v; }
+template <typename P> static inline void storeValue(P& data, uint64_t v) { data.u64 = v; }
+template <typename P> static inline void storeValue(P& data, float v) { data.f = v; }
+template <typename P> static inline void storeValue(P& data, double v) { data.d = v; }
+template <typename P> static inline void storeValue(P& data, const BrickColor& v) { data.brickColor = v; }
+template <typename P> static inline void storeValue(P& data, const Vec2& v) { data.v2 = v; }
+template <typename P> static inline void storeValue(P& data, const Vec3& v) { data.v3 = v; }
+template <typename P> static inline void storeValue(P& data, const Vec2int16& v) { data.v2i16 = v; }
+template <typename P> static inline void storeValue(P& data, const Vec3int16& v) { data.v3i16 = v; }
+template <typename P> static inline void storeValue(P& data, const Color3& v) { data.color3 = v; }
+template <typename P> static inline void storeValue(P& data, const UDim& v) { data.udim = v; }
+template <typename P> static inline void storeValue(P& data, const UDim2& v) { data.udim2 = v; }
+template <typename P> static inline void storeValue(P& data, const Rect2D& v) { data.rect2D = v; }
+template <typename P> static inline void storeValue(P& data, const NumberRange& v) { data.numberRange = v; }
+template <typename P> static inline void storeValue(P& data, const UniqueId& v) { data.uniqueId = v; }
+
+template <typename Layout, typename... Planes, size_t... I>
+static inline auto decodeRow(const uint8_t* const* planes, size_t count, size_t i, PlaneList<Planes...>, std::index_sequence<I...>)
+{
+    return Layout::make(Planes::load(planes[I], count, i)...);
+}
+
+template <PropertyType Type> void BinaryReader::readColumn(const char* name, BinaryBlob& blob, Document& doc, const std::vector<int32_t>& typeInstances)
+{
+    using Layout = ColumnLayout<Type>;
+    static_assert(Layout::kFixedSize, "Variable-size types must provide a readColumn specialization");
+    decodeFixedColumn<Type>(name, blob, doc, typeInstances, typename Layout::Components());
+}
+
+template <PropertyType Type, typename... Planes>
+void BinaryReader::decodeFixedColumn(const char* name, BinaryBlob& blob, Document& doc, const std::vector<int32_t>& typeInstances, PlaneList<Planes...> components)
+{
+    using Layout = ColumnLayout<Type>;
+    size_t count = typeInstances.size();
+    if (!blob.require(Layout::kMinValueSize * count))
+    {
+        return;
+    }
+
+    // planes follow each other
+    const uint8_t* planes[sizeof...(Planes)];
+    const size_t sizes[] = {Planes::kSize...};
+    const uint8_t* plane = blob.data() + blob.tell();
+    for (size_t k = 0; k < sizeof...(Planes); k++)
+    {
+        planes[k] = plane;
+        plane += sizes[k] * count;
+    }
+
+    for (size_t i = 0; i < count; i++)
     {
         Instance& inst = doc.instances[typeInstances[i]];
-        inst.properties.push_back(Property{name.c_str(), PropertyType::UDim2});
-        Property& prop = inst.properties.back();
-        prop.data = UDim2{sx[i], sy[i], ox[i], oy[i]};
+        inst.properties.push_back(Property{name, Type});
+        storeValue(inst.properties.back().data, decodeRow<Layout>(planes, count, i, components, std::index_sequence_for<Planes...>()));
     }
+
+    blob.skip(Layout::kMinValueSize * count);
 }
 
-void BinaryReader::readVector3Properties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances)
+template <> void BinaryReader::readColumn<PropertyType::Ref>(const char* name, BinaryBlob& blob, Document& doc, const std::vector<int32_t>& typeInstances)
 {
-    std::vector<float> x;
-    std::vector<float> y;
-    std::vector<float> z;
-    readFloatVector(blob, x, typeInstances.size());
-    readFloatVector(blob, y, typeInstances.size());
-    readFloatVector(blob, z, typeInstances.size());
+    size_t count = typeInstances.size();
+    if (!blob.require(count * 4))
+    {
+        return;
+    }
 
-    for (size_t i = 0; i < typeInstances.size(); i++)
+    // referents are delta-coded, resolve them into instance indices, null and dangling refs become -1
+    const uint8_t* planes = blob.data() + blob.tell();
+    int32_t numInstances = int32_t(doc.instances.size());
+    int32_t ref = 0;
+    for (size_t i = 0; i < count; i++)
     {
+        ref += decodeInt(int32_t(loadPlane32(planes, count, i)));
+
         Instance& inst = doc.instances[typeInstances[i]];
-        inst.properties.push_back(Property{name.c_str(), PropertyType::Vector3});
+        inst.properties.push_back(Property{name, PropertyType::Ref});
         Property& prop = inst.properties.back();
-        prop.data = Vec3{x[i], y[i], z[i]};
+        prop.data.i32 = (ref >= 0 && ref < numInstances) ? ref : -1;
     }
+
+    blob.skip(count * 4);
 }
 
-void readUColor3Properties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances);
-void BinaryReader::readUColor3Properties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances)
+void BinaryReader::readStringColumn(const char* name, PropertyType type, BinaryBlob& blob, Document& doc, const std::vector<int32_t>& typeInstances)
 {
-    std::vector<uint8_t> r;
-    std::vector<uint8_t> g;
-    std::vector<uint8_t> b;
-    readUInt8Vector(blob, r, typeInstances.size());
-    readUInt8Vector(blob, g, typeInstances.size());
-    readUInt8Vector(blob, b, typeInstances.size());
-
+    ValuePool& pool = *doc.pool;
     for (size_t i = 0; i < typeInstances.size(); i++)
     {
         Instance& inst = doc.instances[typeInstances[i]];
-        inst.properties.push_back(Property{name.c_str(), PropertyType::UColor3});
+        inst.properties.push_back(Property{name, type});
         Property& prop = inst.properties.back();
-        prop.data = Color3{r[i] / 255.0f, g[i] / 255.0f, b[i] / 255.0f};
+        prop.data.pooled = Property::PooledValue{&pool, readPooledString(blob, pool)};
     }
 }
 
-void BinaryReader::readColor3Properties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances)
+template <> void BinaryReader::readColumn<PropertyType::String>(const char* name, BinaryBlob& blob, Document& doc, const std::vector<int32_t>& typeInstances)
 {
-    std::vector<float> r;
-    std::vector<float> g;
-    std::vector<float> b;
-    readFloatVector(blob, r, typeInstances.size());
-    readFloatVector(blob, g, typeInstances.size());
-    readFloatVector(blob, b, typeInstances.size());
+    readStringColumn(name, PropertyType::String, blob, doc, typeInstances);
+}
 
-    for (size_t i = 0; i < typeInstances.size(); i++)
+template <> void BinaryReader::readColumn<PropertyType::Bytecode>(const char* name, BinaryBlob& blob, Document& doc, const std::vector<int32_t>& typeInstances)
+{
+    readStringColumn(name, PropertyType::Bytecode, blob, doc, typeInstances);
+}
+
+template <> void BinaryReader::readColumn<PropertyType::Content>(const char* name, BinaryBlob& blob, Document& doc, const std::vector<int32_t>& typeInstances)
+{
+    size_t count = typeInstances.size();
+    std::vector<int32_t> sourceTypes;
+    readIntVector(blob, sourceTypes, count);
+
+    // uris and objects are listed in the order of the values that use them
+    ValuePool& pool = *doc.pool;
+    uint32_t uriCount = 0;
+    blob.read(uriCount);
+    if (!blob.require(size_t(uriCount) * 4))
+    {
+        return;
+    }
+    std::vector<uint32_t> uris(uriCount);
+    for (uint32_t k = 0; k < uriCount; k++)
+    {
+        uris[k] = readPooledString(blob, pool);
+    }
+
+    uint32_t objectCount = 0;
+    blob.read(objectCount);
+    if (!blob.require(size_t(objectCount) * 4))
+    {
+        return;
+    }
+    std::vector<int32_t> objects;
+    readIdVector(blob, objects, objectCount);
+
+    // references to objects outside of the file are not supported, they are skipped
+    uint32_t externalCount = 0;
+    blob.read(externalCount);
+    if (!blob.require(size_t(externalCount) * 4))
+    {
+        return;
+    }
+    blob.skip(size_t(externalCount) * 4);
+
+    int32_t numInstances = int32_t(doc.instances.size());
+    size_t first = pool.contents.size();
+    pool.contents.reserve(first + count);
+    size_t uriIndex = 0;
+    size_t objectIndex = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        ValuePool::ContentRef content = {ContentSourceType::None, 0, -1};
+        if (sourceTypes[i] == int32_t(ContentSourceType::Uri))
+        {
+            if (uriIndex >= uris.size())
+            {
+                break;
+            }
+            content.sourceType = ContentSourceType::Uri;
+            content.uri = uris[uriIndex++];
+        }
+        else if (sourceTypes[i] == int32_t(ContentSourceType::Object))
+        {
+            if (objectIndex >= objects.size())
+            {
+                break;
+            }
+            int32_t ref = objects[objectIndex++];
+            content.sourceType = ContentSourceType::Object;
+            content.objectId = (ref >= 0 && ref < numInstances) ? ref : -1;
+        }
+        pool.contents.push_back(content);
+    }
+
+    if (pool.contents.size() - first != count)
+    {
+        pool.contents.resize(first);
+        blob.fail(LoadErrorCode::UnsupportedEncoding, "Content values do not match the uri and object lists");
+        return;
+    }
+
+    for (size_t i = 0; i < count; i++)
     {
         Instance& inst = doc.instances[typeInstances[i]];
-        inst.properties.push_back(Property{name.c_str(), PropertyType::Color3});
-        Property& prop = inst.properties.back();
-        prop.data = Color3{r[i], g[i], b[i]};
+        inst.properties.push_back(Property{name, PropertyType::Content});
+        inst.properties.back().data.pooled = Property::PooledValue{&pool, uint32_t(first + i)};
     }
 }
 
-void BinaryReader::readVector2Properties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances)
+template <> void BinaryReader::readColumn<PropertyType::Ray>(const char* name, BinaryBlob& blob, Document& doc, const std::vector<int32_t>& typeInstances)
 {
-    std::vector<float> x;
-    std::vector<float> y;
-    readFloatVector(blob, x, typeInstances.size());
-    readFloatVector(blob, y, typeInstances.size());
-
-    for (size_t i = 0; i < typeInstances.size(); i++)
+    // not interleaved, the size is validated by the column layout
+    size_t count = typeInstances.size();
+    std::vector<Ray>& rays = doc.pool->rays;
+    size_t first = rays.size();
+    rays.resize(first + count);
+    blob.readUnchecked(rays.data() + first, count * sizeof(Ray));
+
+    for (size_t i = 0; i < count; i++)
     {
         Instance& inst = doc.instances[typeInstances[i]];
-        inst.properties.push_back(Property{name.c_str(), PropertyType::Vector2});
-        Property& prop = inst.properties.back();
-        prop.data = Vec2{x[i], y[i]};
+        inst.properties.push_back(Property{name, PropertyType::Ray});
+        inst.properties.back().data.pooled = Property::PooledValue{doc.pool.get(), uint32_t(first + i)};
     }
 }
 
-void BinaryReader::readFontProperties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances)
+template <> void BinaryReader::readColumn<PropertyType::Font>(const char* name, BinaryBlob& blob, Document& doc, const std::vector<int32_t>& typeInstances)
 {
     std::string family;
     uint16_t weight;
@@ -646,7 +1159,7 @@ void BinaryReader::readFontProperties(const std::string& name, BinaryBlob& blob,
     for (size_t i = 0; i < typeInstances.size(); i++)
     {
         Instance& inst = doc.instances[typeInstances[i]];
-        inst.properties.push_back(Property{name.c_str(), PropertyType::Font});
+        inst.properties.push_back(Property{name, PropertyType::Font});
         Property& prop = inst.properties.back();
         
 
@@ -655,69 +1168,43 @@ void BinaryReader::readFontProperties(const std::string& name, BinaryBlob& blob,
         blob.read(style);
         readString(blob, cachedFaceId);
 
-        prop.data = FontInfo{family, weight, style, cachedFaceId};
-    }
-}
-
-void BinaryReader::readRefProperties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances)
-{
-    std::vector<int32_t> values;
-    readIdVector(blob, values, typeInstances.size());
-    for (size_t i = 0; i < typeInstances.size(); i++)
-    {
-        Instance& inst = doc.instances[typeInstances[i]];
-        inst.properties.push_back(Property{name.c_str(), PropertyType::Ref});
-        Property& prop = inst.properties.back();
-        prop.data = values[i];
-    }
-}
-
-void BinaryReader::readBrickColorProperties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances)
-{
-    std::vector<uint32_t> values;
-    readUIntVector(blob, values, typeInstances.size());
-    for (size_t i = 0; i < typeInstances.size(); i++)
-    {
-        Instance& inst = doc.instances[typeInstances[i]];
-        inst.properties.push_back(Property{name.c_str(), PropertyType::BrickColor});
-        Property& prop = inst.properties.back();
-        prop.data = BrickColor{values[i]};
+        prop.data.pooled = Property::PooledValue{doc.pool.get(), uint32_t(doc.pool->fonts.size())};
+        doc.pool->fonts.emplace_back(FontInfo{family, weight, style, cachedFaceId});
     }
 }
 
-void BinaryReader::readUniqueIdProperties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances)
+template <> void BinaryReader::readColumn<PropertyType::SharedString>(const char* name, BinaryBlob& blob, Document& doc, const std::vector<int32_t>& typeInstances)
 {
     std::vector<uint32_t> indices;
-    std::vector<uint32_t> timestamps;
-    std::vector<int64_t> rawbits;
-
     readUIntVector(blob, indices, typeInstances.size());
-    readUIntVector(blob, timestamps, typeInstances.size());
-    readInt64Vector(blob, rawbits, typeInstances.size());
 
+    // values refer to the SSTR dictionary, all properties with the same index share one pooled string
+    ValuePool& pool = *doc.pool;
+    uint32_t emptyString = uint32_t(-1);
     for (size_t i = 0; i < typeInstances.size(); i++)
     {
-        Instance& inst = doc.instances[typeInstances[i]];
-        inst.properties.push_back(Property{name.c_str(), PropertyType::UniqueId});
-        Property& prop = inst.properties.back();
-        prop.data = UniqueId{indices[i], timestamps[i], rawbits[i]};
-    }
-}
+        uint32_t index;
+        if (indices[i] < pool.sharedStrings.size())
+        {
+            index = pool.sharedStrings[indices[i]];
+        }
+        else
+        {
+            // unknown index, the value is empty
+            if (emptyString == uint32_t(-1))
+            {
+                pool.allocateString(0, emptyString);
+            }
+            index = emptyString;
+        }
 
-void BinaryReader::readNumberRangeProperties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances)
-{
-    NumberRange tmp;
-    for (size_t i = 0; i < typeInstances.size(); i++)
-    {
         Instance& inst = doc.instances[typeInstances[i]];
-        inst.properties.push_back(Property{name.c_str(), PropertyType::NumberRange});
-        Property& prop = inst.properties.back();
-        blob.read(tmp);
-        prop.data = tmp;
+        inst.properties.push_back(Property{name, PropertyType::SharedString});
+        inst.properties.back().data.pooled = Property::PooledValue{&pool, index};
     }
 }
 
-void BinaryReader::readPhysicalProperties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances)
+template <> void BinaryReader::readColumn<PropertyType::PhysicalProperties>(const char* name, BinaryBlob& blob, Document& doc, const std::vector<int32_t>& typeInstances)
 {
     static constexpr uint8_t kCustomizeMask = 0x01;
 
@@ -749,140 +1236,203 @@ void BinaryReader::readPhysicalProperties(const std::string& name, BinaryBlob& b
         }
 
         Instance& inst = doc.instances[typeInstances[i]];
-        inst.properties.push_back(Property{name.c_str(), PropertyType::PhysicalProperties});
+        inst.properties.push_back(Property{name, PropertyType::PhysicalProperties});
         Property& prop = inst.properties.back();
-        prop.data = PhysicalProperties{density, friction, elasticity, frictionWeight, elasticityWeight, acousticAbsorption};
+        prop.data.pooled = Property::PooledValue{doc.pool.get(), uint32_t(doc.pool->physicalProperties.size())};
+        doc.pool->physicalProperties.emplace_back(PhysicalProperties{density, friction, elasticity, frictionWeight, elasticityWeight, acousticAbsorption});
     }
 }
 
-void BinaryReader::readSharedStringProperties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances)
+template <PropertyType Format>
+void BinaryReader::readCFrameColumn(const char* name, BinaryBlob& blob, Document& doc, const std::vector<int32_t>& typeInstances)
 {
-    std::vector<uint32_t> indices;
-    readUIntVector(blob, indices, typeInstances.size());
-    for (size_t i = 0; i < typeInstances.size(); i++)
+    // values are decoded in place into the pool, one contiguous range per column
+    size_t numInstances = typeInstances.size();
+    std::vector<CFrame>& cframes = doc.pool->cframes;
+    size_t first = cframes.size();
+    cframes.resize(first + numInstances);
+    if (!readCFrames<Format>(blob, numInstances, [&](size_t i) -> CFrame& { return cframes[first + i]; }))
+    {
+        cframes.resize(first);
+        return;
+    }
+
+    for (size_t i = 0; i < numInstances; i++)
     {
         Instance& inst = doc.instances[typeInstances[i]];
-        inst.properties.push_back(Property{name.c_str(), PropertyType::SharedString});
-        Property& prop = inst.properties.back();
-        prop.data = std::string("TODO"); // copy from shared string dictionary
+        inst.properties.push_back(Property{name, Format});
+        inst.properties.back().data.pooled = Property::PooledValue{doc.pool.get(), uint32_t(first + i)};
     }
 }
 
-void BinaryReader::readOptionalCFrameProperties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances)
+template <> void BinaryReader::readColumn<PropertyType::CFrameMatrix>(const char* name, BinaryBlob& blob, Document& doc, const std::vector<int32_t>& typeInstances)
+{
+    readCFrameColumn<PropertyType::CFrameMatrix>(name, blob, doc, typeInstances);
+}
+
+template <> void BinaryReader::readColumn<PropertyType::CFrameQuat>(const char* name, BinaryBlob& blob, Document& doc, const std::vector<int32_t>& typeInstances)
+{
+    readCFrameColumn<PropertyType::CFrameQuat>(name, blob, doc, typeInstances);
+}
+
+template <> void BinaryReader::readColumn<PropertyType::OptionalCFrame>(const char* name, BinaryBlob& blob, Document& doc, const std::vector<int32_t>& typeInstances)
 {
     size_t numInstances = typeInstances.size();
-    std::vector<Mat3x3> rot(numInstances);
-    std::vector<float> tx;
-    std::vector<float> ty;
-    std::vector<float> tz;
 
     char fmtCf;
     blob.read(fmtCf);
-    if (PropertyType(fmtCf) == PropertyType::CFrameMatrix)
+    if (PropertyType(fmtCf) != PropertyType::CFrameMatrix && PropertyType(fmtCf) != PropertyType::CFrameQuat)
     {
-        for (size_t i = 0; i < numInstances; i++)
-        {
-            readExactRotation(blob, rot[i]);
-        }
-        readFloatVector(blob, tx, numInstances);
-        readFloatVector(blob, ty, numInstances);
-        readFloatVector(blob, tz, numInstances);
+        blob.fail(LoadErrorCode::UnsupportedEncoding, "Unsupported OptionalCFrame format");
+        return;
     }
-    else
+
+    std::vector<OptionalCFrame>& optionalCFrames = doc.pool->optionalCFrames;
+    size_t first = optionalCFrames.size();
+    optionalCFrames.resize(first + numInstances);
+    auto cframeAt = [&](size_t i) -> CFrame& { return optionalCFrames[first + i].val; };
+    bool isValid = (PropertyType(fmtCf) == PropertyType::CFrameQuat) ? readCFrames<PropertyType::CFrameQuat>(blob, numInstances, cframeAt)
+                                                                     : readCFrames<PropertyType::CFrameMatrix>(blob, numInstances, cframeAt);
+    if (!isValid)
     {
-        throw std::runtime_error("Unsupported OptionalCFrame format");
+        optionalCFrames.resize(first);
+        return;
     }
 
     char fmtBl;
     blob.read(fmtBl);
     if (PropertyType(fmtBl) != PropertyType::Bool)
     {
-        throw std::runtime_error("Unsupported OptionalCFrame format");
+        blob.fail(LoadErrorCode::UnsupportedEncoding, "Unsupported OptionalCFrame format");
+    }
+
+    if (!blob.require(numInstances))
+    {
+        optionalCFrames.resize(first);
+        return;
     }
 
     for (size_t i = 0; i < numInstances; i++)
     {
         char val;
-        blob.read(val);
+        blob.readUnchecked(val);
+        optionalCFrames[first + i].hasData = (val != 0);
 
         Instance& inst = doc.instances[typeInstances[i]];
-        inst.properties.push_back(Property{name.c_str(), PropertyType::OptionalCFrame});
-        Property& prop = inst.properties.back();
-
-        bool hasData = (val != 0);
-        prop.data = OptionalCFrame{CFrame{rot[i], Vec3{tx[i], ty[i], tz[i]}}, hasData};
+        inst.properties.push_back(Property{name, PropertyType::OptionalCFrame});
+        inst.properties.back().data.pooled = Property::PooledValue{doc.pool.get(), uint32_t(first + i)};
     }
 }
 
-void BinaryReader::readCFrameProperties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances)
+template <> void BinaryReader::readColumn<PropertyType::NumberSequence>(const char* name, BinaryBlob& blob, Document& doc, const std::vector<int32_t>& typeInstances)
 {
-    size_t numInstances = typeInstances.size();
-    std::vector<Mat3x3> rot(numInstances);
-    std::vector<float> tx;
-    std::vector<float> ty;
-    std::vector<float> tz;
-
-    for (size_t i = 0; i < numInstances; i++)
+    ValuePool& pool = *doc.pool;
+    for (size_t i = 0; i < typeInstances.size(); i++)
     {
-        readExactRotation(blob, rot[i]);
-    }
-    readFloatVector(blob, tx, numInstances);
-    readFloatVector(blob, ty, numInstances);
-    readFloatVector(blob, tz, numInstances);
+        uint32_t size;
+        blob.read(size);
+        if (!blob.require(size_t(size) * sizeof(NumberSeq::KeyValue)))
+        {
+            size = 0;
+        }
+        uint32_t index;
+        blob.readUnchecked(pool.allocateNumberSequence(size, index), sizeof(NumberSeq::KeyValue) * size);
+        pool.internNumberSequence(index);
 
-    for (size_t i = 0; i < numInstances; i++)
-    {
         Instance& inst = doc.instances[typeInstances[i]];
-        inst.properties.push_back(Property{name.c_str(), PropertyType::CFrameMatrix});
+        inst.properties.push_back(Property{name, PropertyType::NumberSequence});
         Property& prop = inst.properties.back();
-        prop.data = CFrame{rot[i], Vec3{tx[i], ty[i], tz[i]}};
+        prop.data.pooled = Property::PooledValue{&pool, index};
     }
 }
 
-void BinaryReader::readNumberSequenceProperties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances)
+template <> void BinaryReader::readColumn<PropertyType::ColorSequenceV1>(const char* name, BinaryBlob& blob, Document& doc, const std::vector<int32_t>& typeInstances)
 {
-    NumberSeq sq;
+    ValuePool& pool = *doc.pool;
     for (size_t i = 0; i < typeInstances.size(); i++)
     {
         uint32_t size;
         blob.read(size);
-        sq.data.resize(size);
-        blob.read(&sq.data[0], sizeof(NumberSeq::KeyValue) * size);
+        if (!blob.require(size_t(size) * sizeof(ColorSeq::KeyValue)))
+        {
+            size = 0;
+        }
+        uint32_t index;
+        blob.readUnchecked(pool.allocateColorSequence(size, index), sizeof(ColorSeq::KeyValue) * size);
+        pool.internColorSequence(index);
 
         Instance& inst = doc.instances[typeInstances[i]];
-        inst.properties.push_back(Property{name.c_str(), PropertyType::NumberSequence});
+        inst.properties.push_back(Property{name, PropertyType::ColorSequenceV1});
         Property& prop = inst.properties.back();
-        prop.data = sq;
+        prop.data.pooled = Property::PooledValue{&pool, index};
     }
 }
 
-void BinaryReader::readColorSequenceProperties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances)
+void BinaryReader::readSharedStrings(BinaryBlob& blob, Document& doc)
 {
-    ColorSeq sq;
-    for (size_t i = 0; i < typeInstances.size(); i++)
+    uint32_t version = 0;
+    uint32_t count = 0;
+    blob.read(version);
+    blob.read(count);
+    if (version != 0)
     {
-        uint32_t size;
-        blob.read(size);
-        sq.data.resize(size);
-        blob.read(&sq.data[0], sizeof(ColorSeq::KeyValue) * size);
+        blob.fail(LoadErrorCode::UnsupportedEncoding, "Unsupported shared strings version");
+        return;
+    }
 
-        Instance& inst = doc.instances[typeInstances[i]];
-        inst.properties.push_back(Property{name.c_str(), PropertyType::ColorSequenceV1});
-        Property& prop = inst.properties.back();
-        prop.data = sq;
+    // every entry is at least a 16 byte hash and a length prefix
+    if (!blob.require(size_t(count) * 20))
+    {
+        return;
+    }
+
+    ValuePool& pool = *doc.pool;
+    pool.sharedStrings.resize(count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint8_t hash[16];
+        blob.read(hash);
+        pool.sharedStrings[i] = readPooledString(blob, pool);
     }
 }
 
-void BinaryReader::createEmptyProperties(const std::string& name, Document& doc, const std::vector<uint32_t>& typeInstances)
+void BinaryReader::createEmptyProperties(const char* name, Document& doc, const std::vector<int32_t>& typeInstances)
 {
     for (size_t i = 0; i < typeInstances.size(); i++)
     {
         Instance& inst = doc.instances[typeInstances[i]];
-        inst.properties.push_back(Property{name.c_str(), PropertyType::Unknown});
-        Property& prop = inst.properties.back();
+        inst.properties.push_back(Property{name, PropertyType::Unknown});
+    }
+}
+
+struct ColumnDecoder
+{
+    void (*read)(const char* name, BinaryBlob& blob, Document& doc, const std::vector<int32_t>& typeInstances);
+    size_t minValueSize;
+};
+
+template <PropertyType Type> static constexpr ColumnDecoder makeColumnDecoder()
+{
+    if constexpr (ColumnLayout<Type>::kSupported)
+    {
+        return ColumnDecoder{&BinaryReader::readColumn<Type>, ColumnLayout<Type>::kMinValueSize};
+    }
+    else
+    {
+        return ColumnDecoder{nullptr, 0};
     }
 }
 
+// decoders indexed by PropertyType, generated from the column layouts
+static constexpr size_t kNumPropertyTypes = size_t(PropertyType::Content) + 1;
+
+template <size_t... I> static constexpr std::array<ColumnDecoder, sizeof...(I)> makeColumnDecoders(std::index_sequence<I...>)
+{
+    return {{makeColumnDecoder<PropertyType(I)>()...}};
+}
+
+static constexpr std::array<ColumnDecoder, kNumPropertyTypes> kColumnDecoders = makeColumnDecoders(std::make_index_sequence<kNumPropertyTypes>());
+
 void BinaryReader::readProperties(const ChunkHeader& chunk, BinaryBlob& blob, Document& doc)
 {
     //
@@ -896,112 +1446,66 @@ void BinaryReader::readProperties(const ChunkHeader& chunk, BinaryBlob& blob, Do
     blob.read(propFormat);
 
     PropertyType propertyType = PropertyType(propFormat);
+    if (blob.hasError())
+    {
+        return;
+    }
+
+    if (typeIndex >= doc.types.size())
+    {
+        blob.fail(LoadErrorCode::InvalidTypeIndex, "Incorrect type index");
+        return;
+    }
 
     Type& type = doc.types[typeIndex];
 
-    std::vector<uint32_t> typeInstances;
-    for (size_t i = 0; i < doc.instances.size(); i++)
+    // property values are stored in the same order as instances in the INST chunk
+    const std::vector<int32_t>& typeInstances = type.instanceIds;
+
+    const ColumnDecoder* decoder = (uint8_t(propFormat) < kColumnDecoders.size()) ? &kColumnDecoders[uint8_t(propFormat)] : nullptr;
+
+    // validate the column size once, values of fixed-size types are decoded without per-read bounds checks
+    if (decoder && !blob.require(decoder->minValueSize * typeInstances.size()))
     {
-        Instance& inst = doc.instances[i];
-        if (inst.typeIndex != typeIndex)
-        {
-            continue;
-        }
-        typeInstances.emplace_back(uint32_t(i));
-    }
-
-    switch (propertyType)
-    {
-    case PropertyType::String:
-        readStringProperties(propertyName, blob, doc, typeInstances);
-        break;
-    case PropertyType::Bool:
-        readBoolProperties(propertyName, blob, doc, typeInstances);
-        break;
-    case PropertyType::Int32:
-        readInt32Properties(propertyName, blob, doc, typeInstances);
-        break;
-    case PropertyType::Int64:
-        readInt64Properties(propertyName, blob, doc, typeInstances);
-        break;
-    case PropertyType::Float:
-        readFloatProperties(propertyName, blob, doc, typeInstances);
-        break;
-    case PropertyType::Double:
-        readDoubleProperties(propertyName, blob, doc, typeInstances);
-        break;
-    case PropertyType::Color3:
-        readColor3Properties(propertyName, blob, doc, typeInstances);
-        break;
-    case PropertyType::UColor3:
-        readUColor3Properties(propertyName, blob, doc, typeInstances);
-        break;
-    case PropertyType::Vector3:
-        readVector3Properties(propertyName, blob, doc, typeInstances);
-        break;
-    case PropertyType::Vector2:
-        readVector2Properties(propertyName, blob, doc, typeInstances);
-        break;
-    case PropertyType::Enum:
-        readEnumProperties(propertyName, blob, doc, typeInstances);
-        break;
-    case PropertyType::Ref:
-        readRefProperties(propertyName, blob, doc, typeInstances);
-        break;
-    case PropertyType::BrickColor:
-        readBrickColorProperties(propertyName, blob, doc, typeInstances);
-        break;
-    case PropertyType::UniqueId:
-        readUniqueIdProperties(propertyName, blob, doc, typeInstances);
-        break;
-    case PropertyType::CFrameMatrix:
-        readCFrameProperties(propertyName, blob, doc, typeInstances);
-        break;
-    case PropertyType::OptionalCFrame:
-        readOptionalCFrameProperties(propertyName, blob, doc, typeInstances);
-        break;
-    case PropertyType::ColorSequenceV1:
-        readColorSequenceProperties(propertyName, blob, doc, typeInstances);
-        break;
-    case PropertyType::NumberSequence:
-        readNumberSequenceProperties(propertyName, blob, doc, typeInstances);
-        break;
-    case PropertyType::UDim2:
-        readUdim2Properties(propertyName, blob, doc, typeInstances);
-        break;
-    case PropertyType::Rect2D:
-        readRect2DProperties(propertyName, blob, doc, typeInstances);
-        break;
-    case PropertyType::SharedString:
-        readSharedStringProperties(propertyName, blob, doc, typeInstances);
-        break;
-    case PropertyType::PhysicalProperties:
-        readPhysicalProperties(propertyName, blob, doc, typeInstances);
-        break;
-    case PropertyType::NumberRange:
-        readNumberRangeProperties(propertyName, blob, doc, typeInstances);
-        break;
-    case PropertyType::Font:
-        readFontProperties(propertyName, blob, doc, typeInstances);
-        break;
-    default:
-        createEmptyProperties(propertyName, doc, typeInstances);
-        break;
+        return;
     }
+
+    const char* name = doc.pool->internName(propertyName.c_str(), propertyName.size());
+
+    if (!decoder || !decoder->read)
+    {
+        type.properties.push_back(PropertyInfo{name, PropertyType::Unknown});
+        createEmptyProperties(name, doc, typeInstances);
+        return;
+    }
+
+    type.properties.push_back(PropertyInfo{name, propertyType});
+    decoder->read(name, blob, doc, typeInstances);
 }
 
+// Walks up from every instance until a root or an instance checked before, a walk that comes back to its own path found a cycle
 void BinaryReader::readParentsChunk(const ChunkHeader& chunk, BinaryBlob& blob, Document& doc)
 {
     char format;
     blob.read(format);
 
+    uint32_t linkCount = 0;
+    blob.read(linkCount);
+    if (blob.hasError())
+    {
+        return;
+    }
+
     if (format != bplfPlain)
     {
-        throw std::runtime_error("Unrecognized parent link format");
+        blob.fail(LoadErrorCode::UnsupportedEncoding, "Unrecognized parent link format");
+        return;
     }
 
-    uint32_t linkCount = 0;
-    blob.read(linkCount);
+    if (!blob.require(size_t(linkCount) * 8))
+    {
+        return;
+    }
 
     std::vector<int32_t> childIds;
     readIdVector(blob, childIds, linkCount);
@@ -1014,75 +1518,130 @@ void BinaryReader::readParentsChunk(const ChunkHeader& chunk, BinaryBlob& blob,
         int32_t childId = childIds[i];
         int32_t parentId = parentIds[i];
 
-        if (childId >= doc.instances.size())
+        if (childId < 0 || size_t(childId) >= doc.instances.size())
         {
-            throw std::runtime_error("Invalid child index");
+            blob.fail(LoadErrorCode::InvalidInstanceId, "Invalid child index");
+            return;
         }
 
-        Instance& child = doc.instances[childId];
-        child.parentId = (parentId >= 0) ? parentId : -1;
-
-        if (parentId >= 0)
+        if (parentId >= 0 && size_t(parentId) >= doc.instances.size())
         {
-            if (parentId >= doc.instances.size())
-            {
-                throw std::runtime_error("Invalid parent index");
-            }
-            Instance& parent = doc.instances[parentId];
-            parent.childIds.emplace_back(childId);
+            blob.fail(LoadErrorCode::InvalidInstanceId, "Invalid parent index");
+            return;
         }
     }
-    return;
-}
-
-LoadResult BinaryReader::loadBinary(const char* fileName, Document& doc)
-{
-    //
-    BinaryBlob chunkBlob;
-
-    BinaryBlob fileBlob;
-    fileBlob.initFromFile(fileName);
 
-    FileHeader header = {};
-    fileBlob.read(header);
+    for (uint32_t i = 0; i < linkCount; i++)
+    {
+        Instance& child = doc.instances[childIds[i]];
+        child.parentId = (parentIds[i] >= 0) ? parentIds[i] : -1;
+    }
 
-    if (memcmp(header.magic, kMagicHeader, sizeof(header.magic)) != 0)
+    // instances on a parent cycle would be unreachable from the roots and ancestor walks would never end
+    if (doc.hasParentCycle())
     {
-        throw std::runtime_error("Unrecognized format");
+        blob.fail(LoadErrorCode::InvalidInstanceId, "Cyclic parent link");
+        return;
     }
 
-    if (memcmp(header.signature, kHeaderSignature, sizeof(header.signature)) != 0)
+    // keep children in the file order
+    doc.buildHierarchy(childIds);
+}
+
+// Fills the diagnostics from the blob that failed, chunkHeader is null for errors outside of chunks
+static void setLoadError(LoadError& error, const BinaryBlob& blob, const ChunkHeader* chunkHeader, int32_t chunkIndex, size_t chunkOffset)
+{
+    error.code = blob.getErrorCode();
+    error.reason = blob.getErrorReason();
+    error.offset = blob.getErrorOffset();
+    error.chunkIndex = chunkHeader ? chunkIndex : -1;
+    error.chunkOffset = chunkHeader ? chunkOffset : 0;
+    memset(error.chunkName, 0, sizeof(error.chunkName));
+    if (chunkHeader)
     {
-        throw std::runtime_error("The file header is corrupted, unexpected signature");
+        memcpy(error.chunkName, chunkHeader->name, sizeof(chunkHeader->name));
     }
+}
 
-    if (header.version != 0)
+LoadResult BinaryReader::loadBinary(const char* fileName, Document& doc, const LoadOptions& options)
+{
+    //
+    BinaryBlob chunkBlob;
+
+    doc.clear();
+    doc.loadError = LoadError();
+
+    BinaryBlob fileBlob;
+    FileHeader header = {};
+    size_t numObjects = 0;
+    size_t numTypes = 0;
+    if (!fileBlob.initFromFile(fileName) || !readFileHeader(fileBlob, header) || !validateHeader(fileBlob, header, numObjects, numTypes))
     {
-        throw std::runtime_error("Unrecognized version");
+        setLoadError(doc.loadError, fileBlob, nullptr, -1, 0);
+        return LoadResult::Error;
     }
 
-    doc.instances.clear();
-    doc.instances.resize(header.objects);
+    doc.instances.resize(numObjects);
+    doc.types.resize(numTypes);
 
-    doc.types.clear();
-    doc.types.resize(header.types);
+    int32_t chunkIndex = 0;
+    auto reportProgress = [&options, &fileBlob](int32_t chunksProcessed) {
+        if (options.onProgress)
+        {
+            LoadProgress progress;
+            progress.bytesProcessed = fileBlob.tell();
+            progress.bytesTotal = fileBlob.size();
+            progress.chunksProcessed = uint32_t(chunksProcessed);
+            options.onProgress(progress);
+        }
+    };
 
     while (fileBlob.tell() < fileBlob.size())
     {
+        size_t chunkOffset = fileBlob.tell();
+        if (options.isCancelled())
+        {
+            doc.loadError.code = LoadErrorCode::Cancelled;
+            doc.loadError.reason = "Load cancelled";
+            doc.loadError.offset = chunkOffset;
+            break;
+        }
+
         ChunkHeader chunk = {};
         fileBlob.read(chunk);
+        uint64_t payloadHash = hashChunkPayload(chunk, fileBlob);
         readChunkData(chunk, fileBlob, chunkBlob);
 
+        if (fileBlob.hasError() || chunkBlob.hasError())
+        {
+            setLoadError(doc.loadError, fileBlob.hasError() ? fileBlob : chunkBlob, &chunk, chunkIndex, chunkOffset);
+            break;
+        }
+
+        ChunkHash chunkHash = {};
+        memcpy(chunkHash.name, chunk.name, sizeof(chunk.name));
+        chunkHash.typeIndex = -1;
+        chunkHash.propertyName = "";
+        chunkHash.hash = hash64(chunkBlob.data(), chunkBlob.size());
+        chunkHash.payloadHash = payloadHash;
+
         if (memcmp(chunk.name, kChunkInstances, sizeof(chunk.name)) == 0)
         {
             readInstances(chunk, chunkBlob, doc);
+            chunkHash.typeIndex = readChunkTypeIndex(chunkBlob);
         }
         else if (memcmp(chunk.name, kChunkHash, sizeof(chunk.name)) == 0)
         {
+            // the layout of the stored hashes is not documented, the chunk is only hashed like the others
         }
         else if (memcmp(chunk.name, kChunkProperty, sizeof(chunk.name)) == 0)
         {
             readProperties(chunk, chunkBlob, doc);
+            chunkHash.typeIndex = readChunkTypeIndex(chunkBlob);
+            if (!chunkBlob.hasError())
+            {
+                chunkHash.propertyName = doc.types[chunkHash.typeIndex].properties.back().name;
+            }
         }
         else if (memcmp(chunk.name, kChunkParents, sizeof(chunk.name)) == 0)
         {
@@ -1093,6 +1652,7 @@ LoadResult BinaryReader::loadBinary(const char* fileName, Document& doc)
         }
         else if (memcmp(chunk.name, kChunkSharedStrings, sizeof(chunk.name)) == 0)
         {
+            readSharedStrings(chunkBlob, doc);
         }
         else if (memcmp(chunk.name, kChunkSignatures, sizeof(chunk.name)) == 0)
         {
@@ -1100,11 +1660,376 @@ LoadResult BinaryReader::loadBinary(const char* fileName, Document& doc)
         else if (memcmp(chunk.name, kChunkEnd, sizeof(chunk.name)) == 0)
         {
             // we done here
+            reportProgress(chunkIndex + 1);
+            break;
+        }
+
+        if (chunkBlob.hasError())
+        {
+            setLoadError(doc.loadError, chunkBlob, &chunk, chunkIndex, chunkOffset);
+            break;
+        }
+        doc.chunkHashes.push_back(chunkHash);
+        chunkIndex++;
+        reportProgress(chunkIndex);
+    }
+
+    if (doc.loadError.code == LoadErrorCode::None)
+    {
+        // the header object count must match the instances listed by the INST chunks
+        for (const Instance& inst : doc.instances)
+        {
+            if (inst.typeIndex >= doc.types.size())
+            {
+                doc.loadError.code = LoadErrorCode::InvalidInstanceId;
+                doc.loadError.reason = "Instance without a type";
+                doc.loadError.offset = fileBlob.tell();
+                break;
+            }
+        }
+    }
+
+    if (doc.loadError.code != LoadErrorCode::None)
+    {
+        // do not expose a partially decoded document
+        doc.instances.clear();
+        doc.types.clear();
+        doc.chunkHashes.clear();
+        doc.buildHierarchy(std::vector<int32_t>());
+        return LoadResult::Error;
+    }
+
+    if (doc.childOffsets.size() != doc.instances.size() + 1)
+    {
+        // no parent links (or no PRNT chunk at all), every instance is a root
+        doc.buildHierarchy(std::vector<int32_t>());
+    }
+
+    return LoadResult::OK;
+}
+
+// Decodes a changed PROP chunk into the existing column of the property, returns false if the type has no such column
+bool BinaryReader::patchProperties(const ChunkHeader& chunk, BinaryBlob& blob, Document& doc)
+{
+    int32_t typeIndex = readChunkTypeIndex(blob);
+    if (typeIndex < 0 || size_t(typeIndex) >= doc.types.size())
+    {
+        return false;
+    }
+
+    // the column is decoded as a new last column and then moved over the old one
+    Type& type = doc.types[typeIndex];
+    size_t numColumns = type.properties.size();
+    readProperties(chunk, blob, doc);
+    if (blob.hasError() || type.properties.size() != numColumns + 1)
+    {
+        return false;
+    }
+
+    PropertyInfo column = type.properties.back();
+    type.properties.pop_back();
+    int32_t index = type.findProperty(column.name);
+    if (index < 0 || type.properties[index].type != column.type)
+    {
+        return false;
+    }
+
+    for (int32_t id : type.instanceIds)
+    {
+        std::vector<Property>& properties = doc.instances[id].properties;
+        const char* name = properties[index].name;
+        properties[index] = properties.back();
+        properties[index].name = name;
+        properties.pop_back();
+    }
+    return true;
+}
+
+LoadResult BinaryReader::reloadBinary(const char* fileName, Document& doc)
+{
+    std::vector<ChunkHash>& loaded = doc.chunkHashes;
+    if (loaded.empty() || !doc.originalIds.empty())
+    {
+        return loadBinary(fileName, doc, LoadOptions());
+    }
+
+    BinaryBlob fileBlob;
+    FileHeader header = {};
+    size_t numObjects = 0;
+    size_t numTypes = 0;
+    if (!fileBlob.initFromFile(fileName) || !readFileHeader(fileBlob, header) || !validateHeader(fileBlob, header, numObjects, numTypes) ||
+        numObjects != doc.instances.size() || numTypes != doc.types.size())
+    {
+        return loadBinary(fileName, doc, LoadOptions());
+    }
+
+    // the chunk list must match the loaded one, changed chunks are found by the hash of their stored bytes
+    std::vector<size_t> changedChunks;
+    size_t totalSize = 0;
+    size_t changedSize = 0;
+    size_t chunkIndex = 0;
+    while (fileBlob.tell() < fileBlob.size())
+    {
+        ChunkHeader chunk = {};
+        fileBlob.read(chunk);
+        uint64_t payloadHash = hashChunkPayload(chunk, fileBlob);
+        if (!skipChunkData(chunk, fileBlob))
+        {
+            return loadBinary(fileName, doc, LoadOptions());
+        }
+
+        if (memcmp(chunk.name, kChunkEnd, sizeof(chunk.name)) == 0)
+        {
             break;
         }
+
+        if (chunkIndex >= loaded.size() || memcmp(chunk.name, loaded[chunkIndex].name, sizeof(chunk.name)) != 0)
+        {
+            return loadBinary(fileName, doc, LoadOptions());
+        }
+
+        if (payloadHash != loaded[chunkIndex].payloadHash)
+        {
+            // new or removed instances and shared strings change ids and indices all over the document
+            if (memcmp(chunk.name, kChunkInstances, sizeof(chunk.name)) == 0 || memcmp(chunk.name, kChunkSharedStrings, sizeof(chunk.name)) == 0)
+            {
+                return loadBinary(fileName, doc, LoadOptions());
+            }
+            changedChunks.push_back(chunkIndex);
+            changedSize += chunk.size;
+        }
+        totalSize += chunk.size;
+        chunkIndex++;
+    }
+
+    // pooled values of replaced columns stay in the pool, a full load once reloads decoded as much as the whole file bounds the waste
+    if (chunkIndex != loaded.size() || doc.reloadedSize + changedSize > totalSize)
+    {
+        return loadBinary(fileName, doc, LoadOptions());
+    }
+
+    doc.loadError = LoadError();
+    doc.reloadedSize += changedSize;
+
+    BinaryBlob chunkBlob;
+    BinaryBlob walkBlob;
+    walkBlob.initFromMemory(fileBlob.data(), fileBlob.size());
+    readFileHeader(walkBlob, header);
+    size_t next = 0;
+    for (size_t i = 0; next < changedChunks.size(); i++)
+    {
+        ChunkHeader chunk = {};
+        walkBlob.read(chunk);
+        if (i != changedChunks[next])
+        {
+            skipChunkData(chunk, walkBlob);
+            continue;
+        }
+        next++;
+
+        ChunkHash& chunkHash = loaded[i];
+        chunkHash.payloadHash = hashChunkPayload(chunk, walkBlob);
+        bool isPatched = readChunkData(chunk, walkBlob, chunkBlob);
+        chunkHash.hash = hash64(chunkBlob.data(), chunkBlob.size());
+
+        if (isPatched && memcmp(chunk.name, kChunkProperty, sizeof(chunk.name)) == 0)
+        {
+            isPatched = patchProperties(chunk, chunkBlob, doc);
+        }
+        else if (isPatched && memcmp(chunk.name, kChunkParents, sizeof(chunk.name)) == 0)
+        {
+            for (Instance& inst : doc.instances)
+            {
+                inst.parentId = -1;
+            }
+            readParentsChunk(chunk, chunkBlob, doc);
+        }
+
+        // a full load reports decoding errors and handles layout changes
+        if (!isPatched || walkBlob.hasError() || chunkBlob.hasError())
+        {
+            return loadBinary(fileName, doc, LoadOptions());
+        }
     }
 
+    if (doc.hasReferenceIndex())
+    {
+        doc.buildReferenceIndex();
+    }
     return LoadResult::OK;
 }
 
+LoadResult BinaryReader::scanAssets(const uint8_t* data, size_t size, const char* fileName, const AssetScanner& scanner, const AssetCallback& callback)
+{
+    // enough to peek at the PROP chunk header (type index, name and type)
+    static constexpr size_t kPropertyHeaderPeekSize = 256;
+
+    BinaryBlob fileBlob;
+    fileBlob.initFromMemory(data, size);
+
+    FileHeader header = {};
+    size_t numObjects = 0;
+    size_t numTypes = 0;
+    if (!readFileHeader(fileBlob, header) || !validateHeader(fileBlob, header, numObjects, numTypes))
+    {
+        return LoadResult::Error;
+    }
+
+    struct ScanType
+    {
+        std::string name;
+        std::vector<int32_t> ids;
+    };
+    std::vector<ScanType> types(numTypes);
+
+    // urls are passed to the callback in place: they point into the mapped file for uncompressed chunks and into the decompressed chunk
+    // otherwise, both stay valid until the next chunk is read
+    BinaryBlob chunkBlob;
+    std::string propertyName;
+    std::vector<int32_t> sourceTypes;
+    while (fileBlob.tell() < fileBlob.size())
+    {
+        ChunkHeader chunk = {};
+        fileBlob.read(chunk);
+
+        if (memcmp(chunk.name, kChunkInstances, sizeof(chunk.name)) == 0)
+        {
+            // instance ids are needed to report the owner of every property value
+            if (!readChunkData(chunk, fileBlob, chunkBlob))
+            {
+                return LoadResult::Error;
+            }
+
+            uint32_t typeIndex;
+            chunkBlob.read(typeIndex);
+            if (typeIndex >= types.size())
+            {
+                return LoadResult::Error;
+            }
+
+            ScanType& type = types[typeIndex];
+            readString(chunkBlob, type.name);
+
+            char format;
+            chunkBlob.read(format);
+
+            uint32_t idCount;
+            chunkBlob.read(idCount);
+            if (!chunkBlob.require(size_t(idCount) * 4))
+            {
+                return LoadResult::Error;
+            }
+            readIdVector(chunkBlob, type.ids, idCount);
+        }
+        else if (memcmp(chunk.name, kChunkProperty, sizeof(chunk.name)) == 0)
+        {
+            if (!fileBlob.require((chunk.compressedSize != 0) ? chunk.compressedSize : chunk.size))
+            {
+                return LoadResult::Error;
+            }
+
+            // peek at the header first, only the chunks we are interested in are decompressed
+            const uint8_t* payload = fileBlob.data() + fileBlob.tell();
+            if (chunk.compressedSize == 0)
+            {
+                chunkBlob.initFromMemory(payload, chunk.size);
+            }
+            else
+            {
+                size_t peekSize = std::min(size_t(chunk.size), kPropertyHeaderPeekSize);
+                chunkBlob.initFromCompressedPrefix(reinterpret_cast<const char*>(payload), chunk.compressedSize, peekSize);
+            }
+
+            uint32_t typeIndex = 0;
+            uint32_t nameLength = 0;
+            bool isAsset = false;
+            if (chunkBlob.size() >= sizeof(uint32_t) * 2)
+            {
+                chunkBlob.read(typeIndex);
+                chunkBlob.read(nameLength);
+                if (nameLength < chunkBlob.size() - chunkBlob.tell())
+                {
+                    const char* name = reinterpret_cast<const char*>(chunkBlob.data() + chunkBlob.tell());
+                    PropertyType propertyType = PropertyType(chunkBlob.at(chunkBlob.tell() + nameLength));
+                    isAsset = (propertyType == PropertyType::Content) || (propertyType == PropertyType::String && scanner.isAssetProperty(name, nameLength));
+                }
+            }
+
+            if (!isAsset || typeIndex >= types.size())
+            {
+                skipChunkData(chunk, fileBlob);
+                continue;
+            }
+
+            if (!readChunkData(chunk, fileBlob, chunkBlob))
+            {
+                return LoadResult::Error;
+            }
+            chunkBlob.read(typeIndex);
+            readString(chunkBlob, propertyName);
+            char propFormat;
+            chunkBlob.read(propFormat);
+
+            const ScanType& type = types[typeIndex];
+            AssetReference ref = {fileName, -1, type.name.c_str(), propertyName.c_str(), nullptr, 0};
+            uint32_t urlLength;
+            if (PropertyType(propFormat) == PropertyType::String)
+            {
+                for (int32_t id : type.ids)
+                {
+                    const char* url = readStringView(chunkBlob, urlLength);
+                    if (urlLength != 0)
+                    {
+                        ref.instanceId = id;
+                        ref.url = url;
+                        ref.urlLength = urlLength;
+                        callback(ref);
+                    }
+                }
+            }
+            else
+            {
+                // Content: source types for every value followed by the uris of Uri-sourced values
+                readIntVector(chunkBlob, sourceTypes, type.ids.size());
+
+                uint32_t uriCount;
+                chunkBlob.read(uriCount);
+                size_t uriIndex = 0;
+                for (size_t row = 0; row < type.ids.size() && uriIndex < uriCount; row++)
+                {
+                    if (sourceTypes[row] != int32_t(ContentSourceType::Uri))
+                    {
+                        continue;
+                    }
+
+                    const char* url = readStringView(chunkBlob, urlLength);
+                    uriIndex++;
+                    if (urlLength != 0)
+                    {
+                        ref.instanceId = type.ids[row];
+                        ref.url = url;
+                        ref.urlLength = urlLength;
+                        callback(ref);
+                    }
+                }
+            }
+        }
+        else if (memcmp(chunk.name, kChunkEnd, sizeof(chunk.name)) == 0)
+        {
+            break;
+        }
+        else
+        {
+            skipChunkData(chunk, fileBlob);
+        }
+
+        if (fileBlob.hasError() || chunkBlob.hasError())
+        {
+            return LoadResult::Error;
+        }
+    }
+
+    return fileBlob.hasError() ? LoadResult::Error : LoadResult::OK;
+}
+
 } // namespace rbxdoc
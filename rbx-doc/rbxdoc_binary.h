@@ -1,48 +1,47 @@
 #pragma once
 
+#include <functional>
+
 namespace rbxdoc
 {
 struct ChunkHeader;
 class BinaryBlob;
+template <typename... Planes> struct PlaneList;
+
+struct AssetReference;
+class AssetScanner;
 
 enum class LoadResult;
+struct LoadOptions;
+enum class PropertyType : uint8_t;
 class Document;
 
 class BinaryReader
 {
-    static void readStringProperties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances);
-    static void readBoolProperties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances);
-    static void readInt32Properties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances);
-    static void readInt64Properties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances);
-    static void readFloatProperties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances);
-    static void readDoubleProperties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances);
-    static void readColor3Properties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances);
-    static void readUColor3Properties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances);
-    static void readVector3Properties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances);
-    static void readVector2Properties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances);
-    static void readEnumProperties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances);
-    static void readRefProperties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances);
-    static void readFontProperties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances);
-    static void readSharedStringProperties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances);
-    static void readPhysicalProperties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances);
-    static void readNumberRangeProperties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances);
-    static void readCFrameProperties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances);
-    static void readOptionalCFrameProperties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances);
-    static void readUdim2Properties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances);
-    static void readRect2DProperties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances);
-    static void readColorSequenceProperties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances);
-    static void readNumberSequenceProperties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances);
-    static void readBrickColorProperties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances);
-    static void readUniqueIdProperties(const std::string& name, BinaryBlob& blob, Document& doc, const std::vector<uint32_t>& typeInstances);
-
-    static void createEmptyProperties(const std::string& name, Document& doc, const std::vector<uint32_t>& typeInstances);
+    template <PropertyType Type, typename... Planes>
+    static void decodeFixedColumn(const char* name, BinaryBlob& blob, Document& doc, const std::vector<int32_t>& typeInstances, PlaneList<Planes...> components);
+
+    template <PropertyType Format> static void readCFrameColumn(const char* name, BinaryBlob& blob, Document& doc, const std::vector<int32_t>& typeInstances);
+    static void readStringColumn(const char* name, PropertyType type, BinaryBlob& blob, Document& doc, const std::vector<int32_t>& typeInstances);
+
+    static void createEmptyProperties(const char* name, Document& doc, const std::vector<int32_t>& typeInstances);
 
     static void readInstances(const ChunkHeader& chunk, BinaryBlob& blob, Document& doc);
     static void readParentsChunk(const ChunkHeader& chunk, BinaryBlob& blob, Document& doc);
     static void readProperties(const ChunkHeader& chunk, BinaryBlob& blob, Document& doc);
+    static void readSharedStrings(BinaryBlob& blob, Document& doc);
+
+    static bool patchProperties(const ChunkHeader& chunk, BinaryBlob& blob, Document& doc);
 
   public:
-    static LoadResult loadBinary(const char* fileName, Document& doc);
+    // decodes a column of a PROP chunk, instantiated for every supported PropertyType
+    template <PropertyType Type> static void readColumn(const char* name, BinaryBlob& blob, Document& doc, const std::vector<int32_t>& typeInstances);
+
+    static LoadResult loadBinary(const char* fileName, Document& doc, const LoadOptions& options);
+    static LoadResult reloadBinary(const char* fileName, Document& doc);
+
+    static LoadResult scanAssets(const uint8_t* data, size_t size, const char* fileName, const AssetScanner& scanner,
+                                 const std::function<void(const AssetReference& ref)>& callback);
 };
 
 } // namespace rbxdoc
@@ -0,0 +1,620 @@
+#include <algorithm>
+#include <string.h>
+#include <string_view>
+#include <unordered_map>
+
+#include "rbxdoc.h"
+#include "rbxdoc_intern.h"
+
+namespace rbxdoc
+{
+
+// Copies instances of source documents into a destination document
+// Types are matched by class name. Property rows are copied in bulk when the layouts match (otherwise they are placed column by column on
+// top of a row of default values), then fixed up column by column: names are interned in the destination pool, pooled values are copied
+// into it and refs are remapped to destination ids.
+class DocumentCopier
+{
+  public:
+    explicit DocumentCopier(Document& _dst)
+        : dst(_dst)
+        , dstPool(*_dst.pool)
+    {
+    }
+
+    // creates the destination types of the given source instances, layouts of existing types are extended by the properties they miss
+    // note: must be called for every source before its instances are copied, rows are created with the final layout
+    void addTypes(const Document& doc, const std::vector<int32_t>& ids)
+    {
+        addedPools.push_back(doc.pool.get());
+        std::vector<uint32_t> counts(doc.types.size(), 0);
+        for (int32_t id : ids)
+        {
+            uint32_t typeIndex = doc.instances[id].typeIndex;
+            if (typeIndex < counts.size())
+            {
+                counts[typeIndex]++;
+            }
+        }
+
+        for (size_t srcTypeIndex = 0; srcTypeIndex < doc.types.size(); srcTypeIndex++)
+        {
+            if (counts[srcTypeIndex] == 0)
+            {
+                continue;
+            }
+
+            const Type& srcType = doc.types[srcTypeIndex];
+            auto it = typeIndices.emplace(srcType.name, uint32_t(dst.types.size()));
+            if (it.second)
+            {
+                dst.types.emplace_back(std::string(srcType.name));
+                rowCounts.push_back(0);
+            }
+            rowCounts[it.first->second] += counts[srcTypeIndex];
+
+            Type& dstType = dst.types[it.first->second];
+            for (const PropertyInfo& info : srcType.properties)
+            {
+                if (findColumn(dstType, info.name) < 0)
+                {
+                    dstType.properties.push_back(PropertyInfo{internName(info.name), info.type});
+                }
+            }
+        }
+    }
+
+    // reserves the instance lists of the destination types for the sources added so far
+    void reserveRows()
+    {
+        for (size_t typeIndex = 0; typeIndex < dst.types.size(); typeIndex++)
+        {
+            reserveMore(dst.types[typeIndex].instanceIds, rowCounts[typeIndex]);
+            rowCounts[typeIndex] = 0;
+        }
+    }
+
+    // reserves the value pools for all values of the sources added so far (whole documents are copied)
+    void reservePools()
+    {
+        size_t counts[10] = {};
+        for (const ValuePool* pool : addedPools)
+        {
+            counts[0] += pool->strings.size();
+            counts[1] += pool->cframes.size();
+            counts[2] += pool->optionalCFrames.size();
+            counts[3] += pool->physicalProperties.size();
+            counts[4] += pool->fonts.size();
+            counts[5] += pool->numberSequences.size();
+            counts[6] += pool->colorSequences.size();
+            counts[7] += pool->rays.size();
+            counts[8] += pool->contents.size();
+            counts[9] += pool->sharedStrings.size();
+        }
+        addedPools.clear();
+
+        reserveMore(dstPool.strings, counts[0]);
+        reserveMore(dstPool.cframes, counts[1]);
+        reserveMore(dstPool.optionalCFrames, counts[2]);
+        reserveMore(dstPool.physicalProperties, counts[3]);
+        reserveMore(dstPool.fonts, counts[4]);
+        reserveMore(dstPool.numberSequences, counts[5]);
+        reserveMore(dstPool.colorSequences, counts[6]);
+        reserveMore(dstPool.rays, counts[7]);
+        reserveMore(dstPool.contents, counts[8]);
+        reserveMore(dstPool.sharedStrings, counts[9]);
+    }
+
+    // copies source instances, the i-th one becomes the destination instance appended i-th
+    // instances with a parent outside of the copied set are placed under rootParentId
+    void copyInstances(const Document& _src, std::vector<int32_t>&& _order, int32_t rootParentId)
+    {
+        src = &_src;
+        srcPool = _src.pool.get();
+        sharedStrings.clear();
+        setOrder(std::move(_order), int32_t(dst.instances.size()));
+
+        std::vector<SourceType> sourceTypes(src->types.size());
+        dst.instances.resize(firstId + order.size());
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            const Instance& srcInst = src->instances[order[i]];
+            int32_t id = firstId + int32_t(i);
+            int32_t parentId = mapId(srcInst.parentId);
+            Instance& dstInst = dst.instances[id];
+            if (srcInst.typeIndex >= sourceTypes.size())
+            {
+                // instance without a type (loaders reject them), copied without properties
+                dstInst = Instance(parentId >= 0 ? parentId : rootParentId, id, uint32_t(-1), srcInst.isService, srcInst.isServiceRooted);
+                continue;
+            }
+
+            SourceType& sourceType = sourceTypes[srcInst.typeIndex];
+            if (sourceType.typeIndex == uint32_t(-1))
+            {
+                mapType(srcInst.typeIndex, sourceType);
+            }
+
+            dstInst = Instance(parentId >= 0 ? parentId : rootParentId, id, sourceType.typeIndex, srcInst.isService, srcInst.isServiceRooted);
+            if (sourceType.isSameLayout)
+            {
+                dstInst.properties = srcInst.properties;
+            }
+            else
+            {
+                dstInst.properties = getDefaultRow(sourceType.typeIndex);
+                for (size_t column = 0; column < sourceType.columns.size(); column++)
+                {
+                    if (sourceType.columns[column] >= 0)
+                    {
+                        dstInst.properties[sourceType.columns[column]] = srcInst.properties[column];
+                    }
+                }
+            }
+            dst.types[sourceType.typeIndex].instanceIds.push_back(id);
+            sourceType.ids.push_back(id);
+        }
+
+        for (const SourceType& sourceType : sourceTypes)
+        {
+            fixupColumns(sourceType);
+        }
+    }
+
+  private:
+    // copied instances of a source type
+    struct SourceType
+    {
+        uint32_t typeIndex = uint32_t(-1);
+        // source column -> destination column, -1 when the destination type has a property of the same name but of another type
+        std::vector<int32_t> columns;
+        bool isSameLayout = false;
+        std::vector<int32_t> ids;
+    };
+
+    // source ids of the copied instances, the i-th one becomes destination instance firstId + i
+    void setOrder(std::vector<int32_t>&& _order, int32_t _firstId)
+    {
+        order = std::move(_order);
+        firstId = _firstId;
+
+        // a contiguous source range needs no lookup table (whole documents and subtrees of a depth-first ordered document)
+        isContiguous = order.empty() || size_t(order.back() - order.front()) + 1 == order.size();
+        for (size_t i = 1; isContiguous && i < order.size(); i++)
+        {
+            isContiguous = order[i] == order[i - 1] + 1;
+        }
+
+        positions.clear();
+        if (!isContiguous)
+        {
+            positions.reserve(order.size());
+            for (size_t i = 0; i < order.size(); i++)
+            {
+                positions.emplace_back(order[i], int32_t(i));
+            }
+            std::sort(positions.begin(), positions.end());
+        }
+    }
+
+    // destination id of a source instance, -1 if it is not copied
+    int32_t mapId(int32_t id) const
+    {
+        if (id < 0 || order.empty())
+        {
+            return -1;
+        }
+        if (isContiguous)
+        {
+            return (id >= order.front() && id <= order.back()) ? firstId + (id - order.front()) : -1;
+        }
+        auto it = std::lower_bound(positions.begin(), positions.end(), std::make_pair(id, int32_t(-1)));
+        return (it != positions.end() && it->first == id) ? firstId + it->second : -1;
+    }
+
+    template <typename T> static void reserveMore(std::vector<T>& values, size_t count) { values.reserve(values.size() + count); }
+
+    static int32_t findColumn(const Type& type, const char* name)
+    {
+        for (size_t column = 0; column < type.properties.size(); column++)
+        {
+            if (strcmp(type.properties[column].name, name) == 0)
+            {
+                return int32_t(column);
+            }
+        }
+        return -1;
+    }
+
+    void mapType(uint32_t srcTypeIndex, SourceType& sourceType)
+    {
+        const Type& srcType = src->types[srcTypeIndex];
+        sourceType.typeIndex = typeIndices.at(srcType.name);
+        const Type& dstType = dst.types[sourceType.typeIndex];
+
+        sourceType.isSameLayout = srcType.properties.size() == dstType.properties.size();
+        for (size_t column = 0; column < srcType.properties.size(); column++)
+        {
+            const PropertyInfo& info = srcType.properties[column];
+            int32_t dstColumn = findColumn(dstType, info.name);
+            if (dstColumn >= 0 && dstType.properties[dstColumn].type != info.type)
+            {
+                dstColumn = -1;
+            }
+            sourceType.columns.push_back(dstColumn);
+            sourceType.isSameLayout = sourceType.isSameLayout && dstColumn == int32_t(column);
+        }
+    }
+
+    // row of default values (the ones XML files use for missing properties) of a destination type, values are shared by all rows
+    const std::vector<Property>& getDefaultRow(uint32_t typeIndex)
+    {
+        if (defaultRows.size() <= typeIndex)
+        {
+            defaultRows.resize(typeIndex + 1);
+        }
+
+        std::vector<Property>& row = defaultRows[typeIndex];
+        if (row.empty())
+        {
+            for (const PropertyInfo& info : dst.types[typeIndex].properties)
+            {
+                row.push_back(Property(info.name, info.type));
+                Property& prop = row.back();
+                if (info.type == PropertyType::Ref)
+                {
+                    prop.data.i32 = -1;
+                }
+                else if (isPooled(info.type))
+                {
+                    prop.data.pooled = Property::PooledValue{&dstPool, getDefaultIndex(info.type)};
+                }
+            }
+        }
+        return row;
+    }
+
+    uint32_t getDefaultIndex(PropertyType type)
+    {
+        uint32_t& index = defaultIndices[size_t(type)];
+        if (index != uint32_t(-1))
+        {
+            return index;
+        }
+
+        switch (type)
+        {
+        case PropertyType::String:
+        case PropertyType::SharedString:
+        case PropertyType::Bytecode:
+            dstPool.allocateString(0, index);
+            break;
+        case PropertyType::CFrameMatrix:
+        case PropertyType::CFrameQuat:
+            index = uint32_t(dstPool.cframes.size());
+            dstPool.cframes.push_back(CFrame{Mat3x3{1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f}, Vec3{0.0f, 0.0f, 0.0f}});
+            break;
+        case PropertyType::OptionalCFrame:
+            index = uint32_t(dstPool.optionalCFrames.size());
+            dstPool.optionalCFrames.push_back(OptionalCFrame{CFrame{}, false});
+            break;
+        case PropertyType::PhysicalProperties:
+            index = uint32_t(dstPool.physicalProperties.size());
+            dstPool.physicalProperties.push_back(PhysicalProperties());
+            break;
+        case PropertyType::Font:
+            index = uint32_t(dstPool.fonts.size());
+            dstPool.fonts.push_back(FontInfo());
+            break;
+        case PropertyType::NumberSequence:
+            dstPool.allocateNumberSequence(0, index);
+            break;
+        case PropertyType::ColorSequenceV1:
+            dstPool.allocateColorSequence(0, index);
+            break;
+        case PropertyType::Ray:
+            index = uint32_t(dstPool.rays.size());
+            dstPool.rays.push_back(Ray{});
+            break;
+        case PropertyType::Content:
+            index = uint32_t(dstPool.contents.size());
+            dstPool.contents.push_back(ValuePool::ContentRef{ContentSourceType::None, 0, -1});
+            break;
+        default:
+            index = 0;
+            break;
+        }
+        return index;
+    }
+
+    const char* internName(const char* name)
+    {
+        auto it = names.emplace(std::string_view(name), nullptr);
+        if (it.second)
+        {
+            it.first->second = dstPool.internName(name, strlen(name));
+        }
+        return it.first->second;
+    }
+
+    uint32_t copyString(uint32_t index)
+    {
+        const ValuePool::StringRef& str = srcPool->strings[index];
+        uint32_t res;
+        char* data = dstPool.allocateString(str.size, res);
+        memcpy(data, str.data, str.size);
+        dstPool.internString(res);
+        return res;
+    }
+
+    // shared strings are copied once per payload, the destination keeps them shared (also across sources)
+    uint32_t copySharedString(uint32_t index)
+    {
+        auto it = sharedStrings.emplace(index, 0);
+        if (it.second)
+        {
+            const ValuePool::StringRef& str = srcPool->strings[index];
+            auto shared = sharedPayloads.emplace(std::string_view(str.data, str.size), 0);
+            if (shared.second)
+            {
+                shared.first->second = copyString(index);
+                dstPool.sharedStrings.push_back(shared.first->second);
+            }
+            it.first->second = shared.first->second;
+        }
+        return it.first->second;
+    }
+
+    template <typename T> static uint32_t copyPooled(std::vector<T>& dstValues, const std::vector<T>& srcValues, uint32_t index)
+    {
+        dstValues.push_back(srcValues[index]);
+        return uint32_t(dstValues.size() - 1);
+    }
+
+    uint32_t copyNumberSequence(uint32_t index)
+    {
+        const ValuePool::SequenceRef<NumberSeq::KeyValue>& seq = srcPool->numberSequences[index];
+        uint32_t res;
+        memcpy(dstPool.allocateNumberSequence(seq.size, res), seq.data, seq.size * sizeof(NumberSeq::KeyValue));
+        dstPool.internNumberSequence(res);
+        return res;
+    }
+
+    uint32_t copyColorSequence(uint32_t index)
+    {
+        const ValuePool::SequenceRef<ColorSeq::KeyValue>& seq = srcPool->colorSequences[index];
+        uint32_t res;
+        memcpy(dstPool.allocateColorSequence(seq.size, res), seq.data, seq.size * sizeof(ColorSeq::KeyValue));
+        dstPool.internColorSequence(res);
+        return res;
+    }
+
+    uint32_t copyContent(uint32_t index)
+    {
+        ValuePool::ContentRef content = srcPool->contents[index];
+        if (content.sourceType == ContentSourceType::Uri)
+        {
+            content.uri = copyString(content.uri);
+        }
+        else if (content.sourceType == ContentSourceType::Object)
+        {
+            content.objectId = mapId(content.objectId);
+        }
+        dstPool.contents.push_back(content);
+        return uint32_t(dstPool.contents.size() - 1);
+    }
+
+    uint32_t copyValue(PropertyType type, uint32_t index)
+    {
+        switch (type)
+        {
+        case PropertyType::String:
+        case PropertyType::Bytecode:
+            return copyString(index);
+        case PropertyType::SharedString:
+            return copySharedString(index);
+        case PropertyType::CFrameMatrix:
+        case PropertyType::CFrameQuat:
+            return copyPooled(dstPool.cframes, srcPool->cframes, index);
+        case PropertyType::OptionalCFrame:
+            return copyPooled(dstPool.optionalCFrames, srcPool->optionalCFrames, index);
+        case PropertyType::PhysicalProperties:
+            return copyPooled(dstPool.physicalProperties, srcPool->physicalProperties, index);
+        case PropertyType::Font:
+            return copyPooled(dstPool.fonts, srcPool->fonts, index);
+        case PropertyType::NumberSequence:
+            return copyNumberSequence(index);
+        case PropertyType::ColorSequenceV1:
+            return copyColorSequence(index);
+        case PropertyType::Ray:
+            return copyPooled(dstPool.rays, srcPool->rays, index);
+        case PropertyType::Content:
+            return copyContent(index);
+        default:
+            return index;
+        }
+    }
+
+    static bool isPooled(PropertyType type)
+    {
+        switch (type)
+        {
+        case PropertyType::String:
+        case PropertyType::SharedString:
+        case PropertyType::Bytecode:
+        case PropertyType::CFrameMatrix:
+        case PropertyType::CFrameQuat:
+        case PropertyType::OptionalCFrame:
+        case PropertyType::PhysicalProperties:
+        case PropertyType::Font:
+        case PropertyType::NumberSequence:
+        case PropertyType::ColorSequenceV1:
+        case PropertyType::Ray:
+        case PropertyType::Content:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    // fixes up the columns copied from a source type, default values already belong to the destination
+    void fixupColumns(const SourceType& sourceType)
+    {
+        for (int32_t column : sourceType.columns)
+        {
+            if (column < 0)
+            {
+                continue;
+            }
+
+            const PropertyInfo& info = dst.types[sourceType.typeIndex].properties[column];
+            bool isRef = info.type == PropertyType::Ref;
+            bool isPooledValue = isPooled(info.type);
+            for (int32_t id : sourceType.ids)
+            {
+                Property& prop = dst.instances[id].properties[column];
+                prop.name = info.name;
+                if (isRef)
+                {
+                    prop.data.i32 = mapId(prop.data.i32);
+                }
+                else if (isPooledValue)
+                {
+                    prop.data.pooled = Property::PooledValue{&dstPool, copyValue(info.type, prop.data.pooled.index)};
+                }
+            }
+        }
+    }
+
+    Document& dst;
+    ValuePool& dstPool;
+    const Document* src = nullptr;
+    const ValuePool* srcPool = nullptr;
+
+    std::vector<int32_t> order;
+    int32_t firstId = 0;
+    bool isContiguous = true;
+    // (source id, position in order) sorted by id
+    std::vector<std::pair<int32_t, int32_t>> positions;
+
+    // class name -> destination type index
+    std::unordered_map<std::string, uint32_t> typeIndices;
+    // instances of the destination types and pools of the sources added by addTypes() since the last reserve call
+    std::vector<uint32_t> rowCounts;
+    std::vector<const ValuePool*> addedPools;
+    std::vector<std::vector<Property>> defaultRows;
+    std::vector<uint32_t> defaultIndices = std::vector<uint32_t>(size_t(PropertyType::Content) + 1, uint32_t(-1));
+    std::unordered_map<std::string_view, const char*> names;
+    // source string index -> destination string index (of the current source)
+    std::unordered_map<uint32_t, uint32_t> sharedStrings;
+    // payload -> destination string index (of all sources)
+    std::unordered_map<std::string_view, uint32_t> sharedPayloads;
+};
+
+Document Document::extractSubtree(int32_t id) const
+{
+    Document res;
+    res.setInternStore(internStore);
+    res.pool->store = internStore;
+    if (id < -1 || id >= int32_t(instances.size()))
+    {
+        return res;
+    }
+
+    std::vector<int32_t> order;
+    for (int32_t i : getSubtree(id))
+    {
+        order.push_back(i);
+    }
+
+    DocumentCopier copier(res);
+    copier.addTypes(*this, order);
+    copier.reserveRows();
+    copier.copyInstances(*this, std::move(order), -1);
+
+    // instances are in preorder, sibling order is kept by building the hierarchy in id order
+    res.buildHierarchy(std::vector<int32_t>());
+    res.subtreeSizes.assign(res.instances.size(), 1);
+    for (size_t i = res.instances.size(); i-- > 0;)
+    {
+        int32_t parentId = res.instances[i].parentId;
+        if (parentId >= 0)
+        {
+            res.subtreeSizes[parentId] += res.subtreeSizes[i];
+        }
+    }
+    return res;
+}
+
+Document Document::merge(const std::vector<MergeSource>& sources)
+{
+    Document res;
+    if (!sources.empty() && sources[0].doc)
+    {
+        res.setInternStore(sources[0].doc->internStore);
+        res.pool->store = res.internStore;
+    }
+
+    // preorder keeps the sibling order of every source when the hierarchy is built in id order
+    std::vector<std::vector<int32_t>> orders(sources.size());
+    std::vector<int32_t> firstIds(sources.size(), 0);
+    size_t instanceCount = 0;
+    DocumentCopier copier(res);
+    for (size_t i = 0; i < sources.size(); i++)
+    {
+        firstIds[i] = int32_t(instanceCount);
+        if (sources[i].doc)
+        {
+            for (int32_t id : sources[i].doc->getSubtree(-1))
+            {
+                orders[i].push_back(id);
+            }
+            copier.addTypes(*sources[i].doc, orders[i]);
+            instanceCount += orders[i].size();
+        }
+    }
+
+    // merged ids of the target parents, positions in the preorder of a parent source are looked up once per source
+    std::vector<int32_t> rootParentIds(sources.size(), -1);
+    std::vector<std::vector<int32_t>> positions(sources.size());
+    for (size_t i = 0; i < sources.size(); i++)
+    {
+        int32_t parentSource = sources[i].parentSource;
+        if (!sources[i].doc || parentSource < 0 || size_t(parentSource) >= i)
+        {
+            continue;
+        }
+
+        const std::vector<int32_t>& parentOrder = orders[parentSource];
+        std::vector<int32_t>& parentPositions = positions[parentSource];
+        if (parentPositions.empty() && !parentOrder.empty())
+        {
+            parentPositions.resize(parentOrder.size());
+            for (size_t pos = 0; pos < parentOrder.size(); pos++)
+            {
+                parentPositions[parentOrder[pos]] = int32_t(pos);
+            }
+        }
+        if (sources[i].parentId >= 0 && size_t(sources[i].parentId) < parentPositions.size())
+        {
+            rootParentIds[i] = firstIds[parentSource] + parentPositions[sources[i].parentId];
+        }
+    }
+    positions.clear();
+
+    copier.reserveRows();
+    copier.reservePools();
+    res.instances.reserve(instanceCount);
+    for (size_t i = 0; i < sources.size(); i++)
+    {
+        if (sources[i].doc)
+        {
+            copier.copyInstances(*sources[i].doc, std::move(orders[i]), rootParentIds[i]);
+        }
+    }
+
+    res.buildHierarchy(std::vector<int32_t>());
+    return res;
+}
+
+} // namespace rbxdoc
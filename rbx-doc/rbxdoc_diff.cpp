@@ -0,0 +1,525 @@
+#include <algorithm>
+#include <string.h>
+#include <unordered_map>
+
+#include "rbxdoc_diff.h"
+#include "rbxdoc_hash.h"
+#include "rbxdoc_parallel.h"
+
+namespace rbxdoc
+{
+
+// instances per batch of the parallel passes
+static constexpr size_t kMinBatchSize = 4096;
+
+ArrayView<DiffRecord> DocumentDiff::getRecords() const { return ArrayView<DiffRecord>(records.begin(), records.end()); }
+
+int32_t DocumentDiff::getNewId(int32_t oldId) const
+{
+    if (oldId < 0 || size_t(oldId) >= oldToNew.size())
+    {
+        return -1;
+    }
+    return oldToNew[oldId];
+}
+
+int32_t DocumentDiff::getOldId(int32_t newId) const
+{
+    if (newId < 0 || size_t(newId) >= newToOld.size())
+    {
+        return -1;
+    }
+    return newToOld[newId];
+}
+
+// How values of a property column are compared
+enum class ValueCompare : uint8_t
+{
+    // inline payload
+    Bitwise,
+    Ref,
+    Bytes,
+    CFrame,
+    OptionalCFrame,
+    PhysicalProperties,
+    Font,
+    NumberSequence,
+    ColorSequence,
+    Ray,
+    Content,
+    // the property is missing on one side or has a different type
+    Different
+};
+
+static ValueCompare getValueCompare(PropertyType type)
+{
+    switch (type)
+    {
+    case PropertyType::Ref:
+        return ValueCompare::Ref;
+    case PropertyType::String:
+    case PropertyType::SharedString:
+    case PropertyType::Bytecode:
+        return ValueCompare::Bytes;
+    case PropertyType::CFrameMatrix:
+    case PropertyType::CFrameQuat:
+        return ValueCompare::CFrame;
+    case PropertyType::OptionalCFrame:
+        return ValueCompare::OptionalCFrame;
+    case PropertyType::PhysicalProperties:
+        return ValueCompare::PhysicalProperties;
+    case PropertyType::Font:
+        return ValueCompare::Font;
+    case PropertyType::NumberSequence:
+        return ValueCompare::NumberSequence;
+    case PropertyType::ColorSequenceV1:
+        return ValueCompare::ColorSequence;
+    case PropertyType::Ray:
+        return ValueCompare::Ray;
+    case PropertyType::Content:
+        return ValueCompare::Content;
+    default:
+        return ValueCompare::Bitwise;
+    }
+}
+
+template <typename T> static bool isSameMemory(ArrayView<T> a, ArrayView<T> b)
+{
+    return a.size() == b.size() && (a.size() == 0 || memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0);
+}
+
+template <typename T> static bool isSameMemory(const T& a, const T& b) { return memcmp(&a, &b, sizeof(T)) == 0; }
+
+struct ColumnPair
+{
+    int32_t oldIndex;
+    int32_t newIndex;
+    ValueCompare compare;
+};
+
+// Correspondence of the property columns of an old and a new type (matched by name)
+struct TypePairLayout
+{
+    uint32_t oldTypeIndex;
+    uint32_t newTypeIndex;
+    // columns in the new type order, followed by the columns of the old type only
+    std::vector<ColumnPair> columns;
+};
+
+// 16-byte UniqueId, zero means "not set"
+struct UniqueIdKey
+{
+    uint64_t rawbits;
+    uint64_t timeAndIndex;
+
+    bool operator==(const UniqueIdKey& other) const { return rawbits == other.rawbits && timeAndIndex == other.timeAndIndex; }
+};
+
+struct UniqueIdKeyHash
+{
+    size_t operator()(const UniqueIdKey& key) const { return size_t(hash64(&key, sizeof(key))); }
+};
+
+// Per-document data of the matching passes
+struct DiffSide
+{
+    const Document* doc;
+    // instance id -> hash of the class and Name
+    std::vector<uint64_t> pathHashes;
+    // Name column of every type, -1 if the type has none
+    std::vector<int32_t> nameColumns;
+};
+
+class DiffEngine
+{
+  public:
+    DiffEngine(const Document& oldDoc, const Document& newDoc, const DiffOptions& _options, DocumentDiff& _result)
+        : options(_options)
+        , result(_result)
+    {
+        oldSide.doc = &oldDoc;
+        newSide.doc = &newDoc;
+    }
+
+    void run()
+    {
+        numThreads = resolveThreadCount(options.numThreads);
+        result.oldToNew.assign(oldSide.doc->getInstances().size(), -1);
+        result.newToOld.assign(newSide.doc->getInstances().size(), -1);
+
+        if (options.matchUniqueIds)
+        {
+            matchUniqueIds();
+        }
+        matchPaths();
+        compareInstances();
+    }
+
+  private:
+    static int32_t findColumn(const Type& type, const char* name, PropertyType propertyType)
+    {
+        int32_t index = type.findProperty(name);
+        return (index >= 0 && type.getProperties()[index].type == propertyType) ? index : -1;
+    }
+
+    static ArrayView<char> getName(const DiffSide& side, const Instance& inst)
+    {
+        int32_t column = (inst.getTypeIndex() < side.nameColumns.size()) ? side.nameColumns[inst.getTypeIndex()] : -1;
+        return (column >= 0) ? inst.getProperties()[column].asBytes() : ArrayView<char>();
+    }
+
+    static bool isSameClass(const Instance& a, const Instance& b, const DiffSide& sideA, const DiffSide& sideB)
+    {
+        // instances without a type never match
+        return a.getTypeIndex() < sideA.doc->getTypes().size() && b.getTypeIndex() < sideB.doc->getTypes().size() &&
+               strcmp(sideA.doc->getTypeName(a), sideB.doc->getTypeName(b)) == 0;
+    }
+
+    // UniqueId -> instance id, -1 for ids shared by several instances
+    static void collectUniqueIds(const Document& doc, std::unordered_map<UniqueIdKey, int32_t, UniqueIdKeyHash>& ids)
+    {
+        for (const Type& type : doc.getTypes())
+        {
+            int32_t column = findColumn(type, "UniqueId", PropertyType::UniqueId);
+            if (column < 0)
+            {
+                continue;
+            }
+
+            for (int32_t id : type.getInstances())
+            {
+                const UniqueId& uid = doc.getInstances()[id].getProperties()[column].asUniqueId();
+                UniqueIdKey key = {uint64_t(uid.rawbits), (uint64_t(uid.timestamp) << 32) | uid.index};
+                if (key.rawbits == 0 && key.timeAndIndex == 0)
+                {
+                    continue;
+                }
+
+                auto it = ids.emplace(key, id);
+                if (!it.second)
+                {
+                    it.first->second = -1;
+                }
+            }
+        }
+    }
+
+    void match(int32_t oldId, int32_t newId)
+    {
+        result.oldToNew[oldId] = newId;
+        result.newToOld[newId] = oldId;
+        pending.emplace_back(oldId, newId);
+    }
+
+    void matchUniqueIds()
+    {
+        std::unordered_map<UniqueIdKey, int32_t, UniqueIdKeyHash> oldIds;
+        std::unordered_map<UniqueIdKey, int32_t, UniqueIdKeyHash> newIds;
+        collectUniqueIds(*oldSide.doc, oldIds);
+        if (oldIds.empty())
+        {
+            return;
+        }
+        collectUniqueIds(*newSide.doc, newIds);
+
+        for (const auto& entry : newIds)
+        {
+            auto it = oldIds.find(entry.first);
+            if (entry.second < 0 || it == oldIds.end() || it->second < 0)
+            {
+                continue;
+            }
+
+            const Instance& oldInst = oldSide.doc->getInstances()[it->second];
+            const Instance& newInst = newSide.doc->getInstances()[entry.second];
+            if (isSameClass(oldInst, newInst, oldSide, newSide))
+            {
+                match(it->second, entry.second);
+            }
+        }
+
+        // the traversal order of the path pass does not depend on the hash map order
+        std::sort(pending.begin(), pending.end());
+    }
+
+    void hashPaths(DiffSide& side)
+    {
+        const Document& doc = *side.doc;
+        std::vector<uint64_t> classHashes;
+        for (const Type& type : doc.getTypes())
+        {
+            classHashes.push_back(hash64(type.getName(), strlen(type.getName())));
+            side.nameColumns.push_back(findColumn(type, "Name", PropertyType::String));
+        }
+
+        side.pathHashes.resize(doc.getInstances().size());
+        parallelFor(doc.getInstances().size(), kMinBatchSize, numThreads, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+            {
+                const Instance& inst = doc.getInstances()[i];
+                ArrayView<char> name = getName(side, inst);
+                uint64_t classHash = (inst.getTypeIndex() < classHashes.size()) ? classHashes[inst.getTypeIndex()] : 0;
+                side.pathHashes[i] = hash64(name.data(), name.size(), classHash);
+            }
+        });
+    }
+
+    struct PathEntry
+    {
+        uint64_t hash;
+        int32_t id;
+    };
+
+    // unmatched children of an instance, sorted by path hash (siblings with the same class and Name stay in order)
+    void collectUnmatched(const DiffSide& side, const std::vector<int32_t>& matching, int32_t parentId, std::vector<PathEntry>& entries)
+    {
+        entries.clear();
+        for (int32_t id : side.doc->getChildren(parentId))
+        {
+            if (matching[id] < 0)
+            {
+                entries.push_back(PathEntry{side.pathHashes[id], id});
+            }
+        }
+        std::stable_sort(entries.begin(), entries.end(), [](const PathEntry& a, const PathEntry& b) { return a.hash < b.hash; });
+    }
+
+    void matchPaths()
+    {
+        hashPaths(oldSide);
+        hashPaths(newSide);
+
+        // children of every matched pair are paired by class, Name and position, starting from the document roots
+        pending.insert(pending.begin(), std::make_pair(-1, -1));
+        std::vector<PathEntry> oldEntries;
+        std::vector<PathEntry> newEntries;
+        for (size_t i = 0; i < pending.size(); i++)
+        {
+            std::pair<int32_t, int32_t> parents = pending[i];
+            collectUnmatched(newSide, result.newToOld, parents.second, newEntries);
+            if (newEntries.empty())
+            {
+                continue;
+            }
+            collectUnmatched(oldSide, result.oldToNew, parents.first, oldEntries);
+
+            size_t a = 0;
+            size_t b = 0;
+            while (a < oldEntries.size() && b < newEntries.size())
+            {
+                if (oldEntries[a].hash != newEntries[b].hash)
+                {
+                    (oldEntries[a].hash < newEntries[b].hash) ? a++ : b++;
+                    continue;
+                }
+
+                const Instance& oldInst = oldSide.doc->getInstances()[oldEntries[a].id];
+                const Instance& newInst = newSide.doc->getInstances()[newEntries[b].id];
+                if (isSameClass(oldInst, newInst, oldSide, newSide) && isSameMemory(getName(oldSide, oldInst), getName(newSide, newInst)))
+                {
+                    match(oldEntries[a].id, newEntries[b].id);
+                }
+                a++;
+                b++;
+            }
+        }
+    }
+
+    const TypePairLayout& getLayout(uint32_t oldTypeIndex, uint32_t newTypeIndex)
+    {
+        uint64_t key = (uint64_t(oldTypeIndex) << 32) | newTypeIndex;
+        auto it = layoutIndices.emplace(key, uint32_t(layouts.size()));
+        if (!it.second)
+        {
+            return layouts[it.first->second];
+        }
+
+        const Type& oldType = oldSide.doc->getTypes()[oldTypeIndex];
+        const Type& newType = newSide.doc->getTypes()[newTypeIndex];
+        ArrayView<PropertyInfo> oldProperties = oldType.getProperties();
+        ArrayView<PropertyInfo> newProperties = newType.getProperties();
+
+        layouts.emplace_back();
+        TypePairLayout& layout = layouts.back();
+        layout.oldTypeIndex = oldTypeIndex;
+        layout.newTypeIndex = newTypeIndex;
+
+        std::vector<bool> isOldMatched(oldProperties.size(), false);
+        for (size_t j = 0; j < newProperties.size(); j++)
+        {
+            // layouts of the same class usually agree, the same position is checked first
+            int32_t oldIndex = (j < oldProperties.size() && strcmp(oldProperties[j].name, newProperties[j].name) == 0) ? int32_t(j)
+                                                                                                                     : oldType.findProperty(newProperties[j].name);
+            ValueCompare compare = ValueCompare::Different;
+            if (oldIndex >= 0)
+            {
+                isOldMatched[oldIndex] = true;
+                compare = (oldProperties[oldIndex].type == newProperties[j].type) ? getValueCompare(newProperties[j].type) : ValueCompare::Different;
+            }
+            layout.columns.push_back(ColumnPair{oldIndex, int32_t(j), compare});
+        }
+
+        for (size_t i = 0; i < oldProperties.size(); i++)
+        {
+            if (!isOldMatched[i])
+            {
+                layout.columns.push_back(ColumnPair{int32_t(i), -1, ValueCompare::Different});
+            }
+        }
+        return layout;
+    }
+
+    int32_t mapOldRef(int32_t ref) const { return (ref >= 0 && size_t(ref) < result.oldToNew.size()) ? result.oldToNew[ref] : -1; }
+
+    bool isEqual(const Property& a, const Property& b, ValueCompare compare) const
+    {
+        switch (compare)
+        {
+        case ValueCompare::Bitwise:
+            return a.data.raw[0] == b.data.raw[0] && a.data.raw[1] == b.data.raw[1];
+        case ValueCompare::Ref:
+            return mapOldRef(a.data.i32) == b.data.i32;
+        case ValueCompare::Bytes:
+            return isSameMemory(a.asBytes(), b.asBytes());
+        case ValueCompare::CFrame:
+            return isSameMemory(a.asCFrame(), b.asCFrame());
+        case ValueCompare::OptionalCFrame:
+        {
+            const OptionalCFrame& ocfA = a.asOptionalCFrame();
+            const OptionalCFrame& ocfB = b.asOptionalCFrame();
+            return ocfA.hasData == ocfB.hasData && (!ocfA.hasData || isSameMemory(ocfA.val, ocfB.val));
+        }
+        case ValueCompare::PhysicalProperties:
+            return isSameMemory(a.asPhysicalProperties(), b.asPhysicalProperties());
+        case ValueCompare::Font:
+        {
+            const FontInfo& fontA = a.asFont();
+            const FontInfo& fontB = b.asFont();
+            return fontA.weight == fontB.weight && fontA.style == fontB.style && fontA.family == fontB.family && fontA.cachedFaceId == fontB.cachedFaceId;
+        }
+        case ValueCompare::NumberSequence:
+            return isSameMemory(a.asNumberSequence(), b.asNumberSequence());
+        case ValueCompare::ColorSequence:
+            return isSameMemory(a.asColorSequence(), b.asColorSequence());
+        case ValueCompare::Ray:
+            return isSameMemory(a.asRay(), b.asRay());
+        case ValueCompare::Content:
+        {
+            ContentSourceType sourceType = a.asContentSourceType();
+            if (sourceType != b.asContentSourceType())
+            {
+                return false;
+            }
+            if (sourceType == ContentSourceType::Object)
+            {
+                return mapOldRef(a.asRef()) == b.asRef();
+            }
+            return isSameMemory(a.asBytes(), b.asBytes());
+        }
+        default:
+            return false;
+        }
+    }
+
+    void compareInstances()
+    {
+        const Document& oldDoc = *oldSide.doc;
+        const Document& newDoc = *newSide.doc;
+        size_t newCount = newDoc.getInstances().size();
+
+        // layouts of all matched type pairs are built up front, the parallel pass only reads them
+        std::vector<uint32_t> instanceLayouts(newCount, uint32_t(-1));
+        const TypePairLayout* lastLayout = nullptr;
+        for (size_t i = 0; i < newCount; i++)
+        {
+            int32_t oldId = result.newToOld[i];
+            if (oldId < 0)
+            {
+                continue;
+            }
+
+            uint32_t oldTypeIndex = oldDoc.getInstances()[oldId].getTypeIndex();
+            uint32_t newTypeIndex = newDoc.getInstances()[i].getTypeIndex();
+            if (!lastLayout || lastLayout->oldTypeIndex != oldTypeIndex || lastLayout->newTypeIndex != newTypeIndex)
+            {
+                lastLayout = &getLayout(oldTypeIndex, newTypeIndex);
+            }
+            instanceLayouts[i] = uint32_t(lastLayout - layouts.data());
+        }
+
+        for (size_t i = 0; i < result.oldToNew.size(); i++)
+        {
+            if (result.oldToNew[i] < 0)
+            {
+                result.records.push_back(DiffRecord{DiffKind::Removed, int32_t(i), -1, -1, -1});
+            }
+        }
+
+        size_t numBatches = std::max(std::min(newCount / kMinBatchSize, size_t(numThreads) * 4), size_t(1));
+        std::vector<std::vector<DiffRecord>> batchRecords(numBatches);
+        parallelFor(numBatches, 1, numThreads, [&](size_t first, size_t last) {
+            for (size_t batch = first; batch < last; batch++)
+            {
+                std::vector<DiffRecord>& records = batchRecords[batch];
+                for (size_t i = newCount * batch / numBatches; i < newCount * (batch + 1) / numBatches; i++)
+                {
+                    const Instance& newInst = newDoc.getInstances()[i];
+                    int32_t newId = int32_t(i);
+                    int32_t oldId = result.newToOld[i];
+                    if (oldId < 0)
+                    {
+                        records.push_back(DiffRecord{DiffKind::Added, -1, newId, -1, -1});
+                        continue;
+                    }
+
+                    const Instance& oldInst = oldDoc.getInstances()[oldId];
+                    int32_t oldParentId = oldInst.getParentId();
+                    int32_t mappedParentId = (oldParentId < 0) ? -1 : result.oldToNew[oldParentId];
+                    if (mappedParentId != newInst.getParentId())
+                    {
+                        records.push_back(DiffRecord{DiffKind::Moved, oldId, newId, -1, -1});
+                    }
+
+                    ArrayView<Property> oldProperties = oldInst.getProperties();
+                    ArrayView<Property> newProperties = newInst.getProperties();
+                    for (const ColumnPair& column : layouts[instanceLayouts[i]].columns)
+                    {
+                        bool isChanged = column.compare == ValueCompare::Different ||
+                                         !isEqual(oldProperties[column.oldIndex], newProperties[column.newIndex], column.compare);
+                        if (isChanged)
+                        {
+                            records.push_back(DiffRecord{DiffKind::Changed, oldId, newId, column.oldIndex, column.newIndex});
+                        }
+                    }
+                }
+            }
+        });
+
+        for (const std::vector<DiffRecord>& records : batchRecords)
+        {
+            result.records.insert(result.records.end(), records.begin(), records.end());
+        }
+    }
+
+    const DiffOptions& options;
+    DocumentDiff& result;
+    uint32_t numThreads = 1;
+
+    DiffSide oldSide;
+    DiffSide newSide;
+
+    // matched pairs which children are not matched yet
+    std::vector<std::pair<int32_t, int32_t>> pending;
+
+    std::vector<TypePairLayout> layouts;
+    std::unordered_map<uint64_t, uint32_t> layoutIndices;
+};
+
+DocumentDiff diff(const Document& oldDoc, const Document& newDoc, const DiffOptions& options)
+{
+    DocumentDiff result;
+    DiffEngine(oldDoc, newDoc, options, result).run();
+    return result;
+}
+
+} // namespace rbxdoc
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "rbxdoc.h"
+
+namespace rbxdoc
+{
+
+struct DiffOptions
+{
+    // 0 = use all hardware threads
+    uint32_t numThreads = 0;
+    // match instances by their UniqueId property first (instances without a UniqueId, or with a duplicated one, are matched by path)
+    bool matchUniqueIds = true;
+};
+
+enum class DiffKind : uint8_t
+{
+    // newId only
+    Added,
+    // oldId only
+    Removed,
+    // the instance has a different parent
+    Moved,
+    // a property value differs, or the property exists on one side only
+    Changed
+};
+
+struct DiffRecord
+{
+    DiffKind kind;
+    int32_t oldId;
+    int32_t newId;
+    // index in Instance::getProperties() of Changed records, -1 if the property is missing on that side
+    int32_t oldPropertyIndex;
+    int32_t newPropertyIndex;
+};
+
+// Differences between two versions of a document
+// Instances are matched by UniqueId, the rest is matched top down by path: children of matched parents are paired by class, Name and
+// position among siblings with the same class and Name. Values are compared bitwise (NaN equals NaN, -0 differs from 0), refs are
+// compared through the instance matching.
+class DocumentDiff
+{
+  public:
+    // removed instances in old id order followed by the other records in new id order
+    ArrayView<DiffRecord> getRecords() const;
+
+    // matched instance in the other document, -1 if there is none
+    int32_t getNewId(int32_t oldId) const;
+    int32_t getOldId(int32_t newId) const;
+
+  private:
+    std::vector<DiffRecord> records;
+    std::vector<int32_t> oldToNew;
+    std::vector<int32_t> newToOld;
+
+    friend class DiffEngine;
+};
+
+DocumentDiff diff(const Document& oldDoc, const Document& newDoc, const DiffOptions& options = DiffOptions());
+
+} // namespace rbxdoc
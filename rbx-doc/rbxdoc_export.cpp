@@ -0,0 +1,1264 @@
+#include <algorithm>
+#include <charconv>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "rbxdoc_export.h"
+#include "rbxdoc_hash.h"
+#include "rbxdoc_parallel.h"
+
+namespace rbxdoc
+{
+
+// ranges smaller than this are not worth a thread
+static constexpr size_t kMinRangeSize = 4096;
+
+void OutputBuffer::grow(size_t size)
+{
+    size_t newCapacity = std::max(std::max(capacity * 2, length + size), size_t(64 * 1024));
+    std::unique_ptr<char[]> newBytes(new char[newCapacity]);
+    if (length != 0)
+    {
+        memcpy(newBytes.get(), bytes.get(), length);
+    }
+    bytes = std::move(newBytes);
+    capacity = newCapacity;
+}
+
+void OutputBuffer::append(const char* data, size_t size)
+{
+    char* dst = reserve(size);
+    if (size != 0)
+    {
+        memcpy(dst, data, size);
+    }
+    length += size;
+}
+
+bool OutputBuffer::writeFile(const char* fileName) const
+{
+    FILE* file = fopen(fileName, "wb");
+    if (!file)
+    {
+        return false;
+    }
+
+    bool written = fwrite(bytes.get(), 1, length, file) == length;
+    return (fclose(file) == 0) && written;
+}
+
+static constexpr char kHexDigits[] = "0123456789abcdef";
+static constexpr char kBase64Digits[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Appends text to an output buffer, every write reserves its worst case size up front
+class TextWriter
+{
+  public:
+    explicit TextWriter(OutputBuffer& _out)
+        : out(_out)
+    {
+    }
+
+    void write(const char* text, size_t size)
+    {
+        char* p = out.reserve(size);
+        memcpy(p, text, size);
+        out.commit(p + size);
+    }
+
+    template <size_t N> void write(const char (&text)[N]) { write(text, N - 1); }
+
+    void write(char c)
+    {
+        char* p = out.reserve(1);
+        *p = c;
+        out.commit(p + 1);
+    }
+
+    void writeIndent(size_t depth)
+    {
+        char* p = out.reserve(depth);
+        memset(p, '\t', depth);
+        out.commit(p + depth);
+    }
+
+    template <typename T> void writeNumber(T value)
+    {
+        char* p = out.reserve(32);
+        out.commit(std::to_chars(p, p + 32, value).ptr);
+    }
+
+    // shortest round-trip form of finite floats
+    // integral values (most rotation matrix elements, sizes and offsets) are written as integers, which is several times faster
+    void writeNumber(float value)
+    {
+        if (value > -16777216.0f && value < 16777216.0f && value == float(int32_t(value)) && !(value == 0.0f && signbit(value)))
+        {
+            writeNumber(int32_t(value));
+            return;
+        }
+        char* p = out.reserve(32);
+        out.commit(std::to_chars(p, p + 32, value).ptr);
+    }
+
+    void writeNumber(double value)
+    {
+        if (value > -9007199254740992.0 && value < 9007199254740992.0 && value == double(int64_t(value)) && !(value == 0.0 && signbit(value)))
+        {
+            writeNumber(int64_t(value));
+            return;
+        }
+        char* p = out.reserve(32);
+        out.commit(std::to_chars(p, p + 32, value).ptr);
+    }
+
+    void writeHex(uint64_t value, int numDigits)
+    {
+        char* p = out.reserve(size_t(numDigits));
+        for (int i = numDigits - 1; i >= 0; i--)
+        {
+            p[i] = kHexDigits[value & 15];
+            value >>= 4;
+        }
+        out.commit(p + numDigits);
+    }
+
+    void writeBase64(const char* data, size_t size)
+    {
+        const uint8_t* src = reinterpret_cast<const uint8_t*>(data);
+        char* p = out.reserve((size + 2) / 3 * 4);
+        size_t i = 0;
+        for (; i + 3 <= size; i += 3)
+        {
+            uint32_t v = (uint32_t(src[i]) << 16) | (uint32_t(src[i + 1]) << 8) | uint32_t(src[i + 2]);
+            p[0] = kBase64Digits[v >> 18];
+            p[1] = kBase64Digits[(v >> 12) & 63];
+            p[2] = kBase64Digits[(v >> 6) & 63];
+            p[3] = kBase64Digits[v & 63];
+            p += 4;
+        }
+        if (i < size)
+        {
+            uint32_t v = uint32_t(src[i]) << 16;
+            if (i + 1 < size)
+            {
+                v |= uint32_t(src[i + 1]) << 8;
+            }
+            p[0] = kBase64Digits[v >> 18];
+            p[1] = kBase64Digits[(v >> 12) & 63];
+            p[2] = (i + 1 < size) ? kBase64Digits[(v >> 6) & 63] : '=';
+            p[3] = '=';
+            p += 4;
+        }
+        out.commit(p);
+    }
+
+  protected:
+    OutputBuffer& out;
+};
+
+// Instances of the export in preorder, a range of it can be exported without looking at the rest of the document
+struct ExportOrder
+{
+    std::vector<int32_t> ids;
+    // depth relative to the exported roots
+    std::vector<uint32_t> depths;
+
+    // number of elements closed after instance i (0 if it has children)
+    uint32_t getCloseCount(size_t i) const
+    {
+        uint32_t nextDepth = (i + 1 < depths.size()) ? depths[i + 1] : 0;
+        return (nextDepth > depths[i]) ? 0 : depths[i] - nextDepth + 1;
+    }
+};
+
+static void buildExportOrder(const Document& doc, int32_t id, ExportOrder& order)
+{
+    std::vector<std::pair<int32_t, uint32_t>> stack;
+    if (id == -1)
+    {
+        ArrayView<int32_t> roots = doc.getChildren(-1);
+        for (size_t i = roots.size(); i > 0; i--)
+        {
+            stack.emplace_back(roots[i - 1], 0);
+        }
+    }
+    else if (id >= 0 && size_t(id) < doc.getInstances().size())
+    {
+        stack.emplace_back(id, 0);
+    }
+
+    while (!stack.empty())
+    {
+        std::pair<int32_t, uint32_t> item = stack.back();
+        stack.pop_back();
+        order.ids.push_back(item.first);
+        order.depths.push_back(item.second);
+
+        ArrayView<int32_t> children = doc.getChildren(item.first);
+        for (size_t i = children.size(); i > 0; i--)
+        {
+            stack.emplace_back(children[i - 1], item.second + 1);
+        }
+    }
+}
+
+// size of a valid UTF-8 sequence, 0 for bytes that do not start one (overlong forms, surrogates and truncated sequences)
+static size_t getUtf8SequenceSize(const char* text, size_t size)
+{
+    const uint8_t* s = reinterpret_cast<const uint8_t*>(text);
+    auto isContinuation = [s, size](size_t i) { return i < size && (s[i] & 0xC0) == 0x80; };
+    if (s[0] >= 0xC2 && s[0] <= 0xDF)
+    {
+        return isContinuation(1) ? 2 : 0;
+    }
+    if (s[0] >= 0xE0 && s[0] <= 0xEF)
+    {
+        bool isValid = isContinuation(1) && isContinuation(2) && !(s[0] == 0xE0 && s[1] < 0xA0) && !(s[0] == 0xED && s[1] >= 0xA0);
+        return isValid ? 3 : 0;
+    }
+    if (s[0] >= 0xF0 && s[0] <= 0xF4)
+    {
+        bool isValid = isContinuation(1) && isContinuation(2) && isContinuation(3) && !(s[0] == 0xF0 && s[1] < 0x90) && !(s[0] == 0xF4 && s[1] >= 0x90);
+        return isValid ? 4 : 0;
+    }
+    return 0;
+}
+
+struct SharedStringEntry
+{
+    uint64_t hash;
+    ArrayView<char> bytes;
+};
+
+// 0 - copied as is, 1 - escaped, 2 - can not be represented in XML text (written as base64)
+struct XmlEscapeTable
+{
+    uint8_t values[256];
+
+    constexpr XmlEscapeTable()
+        : values()
+    {
+        for (int i = 0; i < 32; i++)
+        {
+            values[i] = 2;
+        }
+        values[int('\t')] = 0;
+        values[int('\n')] = 0;
+        values[int('\r')] = 1;
+        values[int('&')] = 1;
+        values[int('<')] = 1;
+        values[int('>')] = 1;
+        values[int('"')] = 1;
+    }
+};
+
+static constexpr XmlEscapeTable kXmlEscape;
+
+class XmlWriter : public TextWriter
+{
+  public:
+    XmlWriter(const Document& _doc, OutputBuffer& _out)
+        : TextWriter(_out)
+        , doc(_doc)
+    {
+    }
+
+    // writes instances [first, last) of the order, with the end tags that follow them
+    void writeRange(const ExportOrder& order, size_t first, size_t last)
+    {
+        for (size_t i = first; i < last; i++)
+        {
+            const Instance& inst = doc.getInstances()[order.ids[i]];
+            uint32_t depth = order.depths[i];
+
+            writeIndent(depth);
+            write("<Item class=\"");
+            writeEscaped(doc.getTypeName(inst));
+            write("\" referent=\"");
+            writeReferent(inst.getId());
+            write("\">\n");
+            writeIndent(depth + 1);
+            write("<Properties>\n");
+            for (const Property& prop : inst.getProperties())
+            {
+                writeProperty(prop, depth + 2);
+            }
+            writeIndent(depth + 1);
+            write("</Properties>\n");
+
+            uint32_t closeCount = order.getCloseCount(i);
+            for (uint32_t j = 0; j < closeCount; j++)
+            {
+                writeIndent(depth - j);
+                write("</Item>\n");
+            }
+        }
+    }
+
+    void writeSharedStrings()
+    {
+        std::sort(sharedStrings.begin(), sharedStrings.end(), [](const SharedStringEntry& a, const SharedStringEntry& b) { return a.hash < b.hash; });
+
+        write("<SharedStrings>\n");
+        for (size_t i = 0; i < sharedStrings.size(); i++)
+        {
+            const SharedStringEntry& entry = sharedStrings[i];
+            if (i > 0 && sharedStrings[i - 1].hash == entry.hash)
+            {
+                continue;
+            }
+            write("\t<SharedString md5=\"");
+            writeHex(entry.hash, 16);
+            write("\">");
+            writeBase64(entry.bytes.data(), entry.bytes.size());
+            write("</SharedString>\n");
+        }
+        write("</SharedStrings>\n");
+    }
+
+    // shared string values referenced by the written properties (keyed by content hash)
+    std::vector<SharedStringEntry> sharedStrings;
+
+  private:
+    // control characters and invalid UTF-8 can not be written as XML text
+    static bool needsBase64(const char* text, size_t size)
+    {
+        for (size_t i = 0; i < size; i++)
+        {
+            uint8_t c = uint8_t(text[i]);
+            if (c >= 0x80)
+            {
+                size_t sequenceSize = getUtf8SequenceSize(text + i, size - i);
+                if (sequenceSize == 0)
+                {
+                    return true;
+                }
+                i += sequenceSize - 1;
+            }
+            else if (kXmlEscape.values[c] == 2)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void writeEscaped(const char* text, size_t size)
+    {
+        // "&quot;" is the longest escape sequence
+        char* p = out.reserve(size * 6);
+        for (size_t i = 0; i < size; i++)
+        {
+            char c = text[i];
+            if (kXmlEscape.values[uint8_t(c)] == 0)
+            {
+                *p++ = c;
+                continue;
+            }
+
+            const char* escaped;
+            switch (c)
+            {
+            case '&':
+                escaped = "&amp;";
+                break;
+            case '<':
+                escaped = "&lt;";
+                break;
+            case '>':
+                escaped = "&gt;";
+                break;
+            case '"':
+                escaped = "&quot;";
+                break;
+            case '\r':
+                escaped = "&#13;";
+                break;
+            default:
+                // not representable, callers write such strings as base64
+                escaped = "";
+                break;
+            }
+            size_t escapedSize = strlen(escaped);
+            memcpy(p, escaped, escapedSize);
+            p += escapedSize;
+        }
+        out.commit(p);
+    }
+
+    void writeEscaped(const char* text) { writeEscaped(text, strlen(text)); }
+    void writeEscaped(const std::string& text) { writeEscaped(text.data(), text.size()); }
+
+    void writeReferent(int32_t id)
+    {
+        write("RBX");
+        writeHex(uint64_t(uint32_t(id)), 8);
+    }
+
+    void writeFloat(float value)
+    {
+        if (isfinite(value))
+        {
+            writeNumber(value);
+        }
+        else if (isnan(value))
+        {
+            write("NAN");
+        }
+        else
+        {
+            (value < 0.0f) ? write("-INF") : write("INF");
+        }
+    }
+
+    void writeDouble(double value)
+    {
+        if (isfinite(value))
+        {
+            writeNumber(value);
+        }
+        else if (isnan(value))
+        {
+            write("NAN");
+        }
+        else
+        {
+            (value < 0.0) ? write("-INF") : write("INF");
+        }
+    }
+
+    // <tag>value</tag> of a single component
+    template <size_t N> void writeFloatElement(const char (&tag)[N], float value)
+    {
+        write('<');
+        write(tag);
+        write('>');
+        writeFloat(value);
+        write("</");
+        write(tag);
+        write('>');
+    }
+
+    template <size_t N, typename T> void writeIntElement(const char (&tag)[N], T value)
+    {
+        write('<');
+        write(tag);
+        write('>');
+        writeNumber(value);
+        write("</");
+        write(tag);
+        write('>');
+    }
+
+    void writeVec3(const Vec3& v)
+    {
+        writeFloatElement("X", v.x);
+        writeFloatElement("Y", v.y);
+        writeFloatElement("Z", v.z);
+    }
+
+    void writeVec2(const Vec2& v)
+    {
+        writeFloatElement("X", v.x);
+        writeFloatElement("Y", v.y);
+    }
+
+    void writeCFrame(const CFrame& cf)
+    {
+        static const char kRotationTags[9][4] = {"R00", "R01", "R02", "R10", "R11", "R12", "R20", "R21", "R22"};
+        writeVec3(cf.translation);
+        for (int i = 0; i < 9; i++)
+        {
+            write('<');
+            write(kRotationTags[i], 3);
+            write('>');
+            writeFloat(cf.rotation.v[i]);
+            write("</");
+            write(kRotationTags[i], 3);
+            write('>');
+        }
+    }
+
+    void writeUrl(const char* text, size_t size)
+    {
+        write("<url>");
+        writeEscaped(text, size);
+        write("</url>");
+    }
+
+    void beginProperty(const char* tag, const Property& prop, size_t depth)
+    {
+        writeIndent(depth);
+        write('<');
+        write(tag, strlen(tag));
+        write(" name=\"");
+        writeEscaped(prop.getName());
+        write("\">");
+    }
+
+    void endProperty(const char* tag)
+    {
+        write("</");
+        write(tag, strlen(tag));
+        write(">\n");
+    }
+
+    void writeProperty(const Property& prop, size_t depth);
+
+    const Document& doc;
+};
+
+void XmlWriter::writeProperty(const Property& prop, size_t depth)
+{
+    const char* tag = nullptr;
+    switch (prop.getType())
+    {
+    case PropertyType::String:
+    case PropertyType::Bytecode:
+    {
+        ArrayView<char> bytes = prop.asBytes();
+        bool isBinary = prop.getType() == PropertyType::Bytecode || needsBase64(bytes.data(), bytes.size());
+        tag = isBinary ? "BinaryString" : "string";
+        beginProperty(tag, prop, depth);
+        isBinary ? writeBase64(bytes.data(), bytes.size()) : writeEscaped(bytes.data(), bytes.size());
+        break;
+    }
+    case PropertyType::SharedString:
+    {
+        ArrayView<char> bytes = prop.asBytes();
+        uint64_t hash = hash64(bytes.data(), bytes.size());
+        sharedStrings.push_back(SharedStringEntry{hash, bytes});
+        tag = "SharedString";
+        beginProperty(tag, prop, depth);
+        writeHex(hash, 16);
+        break;
+    }
+    case PropertyType::Content:
+    {
+        ArrayView<char> bytes = prop.asBytes();
+        tag = "Content";
+        beginProperty(tag, prop, depth);
+        if (prop.asContentSourceType() == ContentSourceType::Uri)
+        {
+            write("<uri>");
+            writeEscaped(bytes.data(), bytes.size());
+            write("</uri>");
+        }
+        else
+        {
+            write("<null></null>");
+        }
+        break;
+    }
+    case PropertyType::Bool:
+        tag = "bool";
+        beginProperty(tag, prop, depth);
+        prop.asBool() ? write("true") : write("false");
+        break;
+    case PropertyType::Int32:
+        tag = "int";
+        beginProperty(tag, prop, depth);
+        writeNumber(prop.asInt32());
+        break;
+    case PropertyType::Int64:
+        tag = "int64";
+        beginProperty(tag, prop, depth);
+        writeNumber(prop.asInt64());
+        break;
+    case PropertyType::Float:
+        tag = "float";
+        beginProperty(tag, prop, depth);
+        writeFloat(prop.asFloat());
+        break;
+    case PropertyType::Double:
+        tag = "double";
+        beginProperty(tag, prop, depth);
+        writeDouble(prop.asDouble());
+        break;
+    case PropertyType::Enum:
+        tag = "token";
+        beginProperty(tag, prop, depth);
+        writeNumber(prop.asEnum());
+        break;
+    case PropertyType::BrickColor:
+        tag = "BrickColor";
+        beginProperty(tag, prop, depth);
+        writeNumber(prop.asBrickColor().index);
+        break;
+    case PropertyType::Color3:
+    {
+        const Color3& color = prop.asColor3();
+        tag = "Color3";
+        beginProperty(tag, prop, depth);
+        writeFloatElement("R", color.r);
+        writeFloatElement("G", color.g);
+        writeFloatElement("B", color.b);
+        break;
+    }
+    case PropertyType::UColor3:
+    {
+        // packed 0xFFRRGGBB
+        const Color3& color = prop.asColor3();
+        auto toByte = [](float v) { return uint32_t(std::min(std::max(v, 0.0f), 1.0f) * 255.0f + 0.5f); };
+        tag = "Color3uint8";
+        beginProperty(tag, prop, depth);
+        writeNumber(0xFF000000u | (toByte(color.r) << 16) | (toByte(color.g) << 8) | toByte(color.b));
+        break;
+    }
+    case PropertyType::Vector2:
+        tag = "Vector2";
+        beginProperty(tag, prop, depth);
+        writeVec2(prop.asVec2());
+        break;
+    case PropertyType::Vector3:
+        tag = "Vector3";
+        beginProperty(tag, prop, depth);
+        writeVec3(prop.asVec3());
+        break;
+    case PropertyType::Vector2int16:
+    {
+        const Vec2int16& v = prop.asVec2int16();
+        tag = "Vector2int16";
+        beginProperty(tag, prop, depth);
+        writeIntElement("X", v.x);
+        writeIntElement("Y", v.y);
+        break;
+    }
+    case PropertyType::Vector3int16:
+    {
+        const Vec3int16& v = prop.asVec3int16();
+        tag = "Vector3int16";
+        beginProperty(tag, prop, depth);
+        writeIntElement("X", v.x);
+        writeIntElement("Y", v.y);
+        writeIntElement("Z", v.z);
+        break;
+    }
+    case PropertyType::CFrameMatrix:
+    case PropertyType::CFrameQuat:
+        tag = "CoordinateFrame";
+        beginProperty(tag, prop, depth);
+        writeCFrame(prop.asCFrame());
+        break;
+    case PropertyType::OptionalCFrame:
+    {
+        const OptionalCFrame& ocf = prop.asOptionalCFrame();
+        tag = "OptionalCoordinateFrame";
+        beginProperty(tag, prop, depth);
+        if (ocf.hasData)
+        {
+            write("<CFrame>");
+            writeCFrame(ocf.val);
+            write("</CFrame>");
+        }
+        break;
+    }
+    case PropertyType::UDim:
+    {
+        const UDim& udim = prop.asUDim();
+        tag = "UDim";
+        beginProperty(tag, prop, depth);
+        writeFloatElement("S", udim.scale);
+        writeIntElement("O", udim.offset);
+        break;
+    }
+    case PropertyType::UDim2:
+    {
+        const UDim2& udim2 = prop.asUDim2();
+        tag = "UDim2";
+        beginProperty(tag, prop, depth);
+        writeFloatElement("XS", udim2.scaleX);
+        writeIntElement("XO", udim2.offsetX);
+        writeFloatElement("YS", udim2.scaleY);
+        writeIntElement("YO", udim2.offsetY);
+        break;
+    }
+    case PropertyType::Ray:
+    {
+        const Ray& ray = prop.asRay();
+        tag = "Ray";
+        beginProperty(tag, prop, depth);
+        write("<origin>");
+        writeVec3(ray.origin);
+        write("</origin><direction>");
+        writeVec3(ray.direction);
+        write("</direction>");
+        break;
+    }
+    case PropertyType::Faces:
+        tag = "Faces";
+        beginProperty(tag, prop, depth);
+        writeIntElement("faces", uint32_t(prop.asFaces()));
+        break;
+    case PropertyType::Axes:
+        tag = "Axes";
+        beginProperty(tag, prop, depth);
+        writeIntElement("axes", uint32_t(prop.asAxes()));
+        break;
+    case PropertyType::NumberSequence:
+        tag = "NumberSequence";
+        beginProperty(tag, prop, depth);
+        for (const NumberSeq::KeyValue& key : prop.asNumberSequence())
+        {
+            writeFloat(key.time);
+            write(' ');
+            writeFloat(key.val);
+            write(' ');
+            writeFloat(key.envelope);
+            write(' ');
+        }
+        break;
+    case PropertyType::ColorSequenceV1:
+        tag = "ColorSequence";
+        beginProperty(tag, prop, depth);
+        for (const ColorSeq::KeyValue& key : prop.asColorSequence())
+        {
+            writeFloat(key.time);
+            write(' ');
+            writeFloat(key.val.r);
+            write(' ');
+            writeFloat(key.val.g);
+            write(' ');
+            writeFloat(key.val.b);
+            write(' ');
+            writeFloat(key.envelope);
+            write(' ');
+        }
+        break;
+    case PropertyType::NumberRange:
+    {
+        const NumberRange& range = prop.asNumberRange();
+        tag = "NumberRange";
+        beginProperty(tag, prop, depth);
+        writeFloat(range.min);
+        write(' ');
+        writeFloat(range.max);
+        write(' ');
+        break;
+    }
+    case PropertyType::Rect2D:
+    {
+        const Rect2D& rect = prop.asRect2D();
+        tag = "Rect2D";
+        beginProperty(tag, prop, depth);
+        write("<min>");
+        writeVec2(Vec2{rect.x0, rect.y0});
+        write("</min><max>");
+        writeVec2(Vec2{rect.x1, rect.y1});
+        write("</max>");
+        break;
+    }
+    case PropertyType::PhysicalProperties:
+    {
+        // the binary format stores non-custom physics as default values
+        const PhysicalProperties& pp = prop.asPhysicalProperties();
+        const PhysicalProperties defaults;
+        bool isCustom = memcmp(&pp, &defaults, sizeof(PhysicalProperties)) != 0;
+        tag = "PhysicalProperties";
+        beginProperty(tag, prop, depth);
+        if (!isCustom)
+        {
+            write("<CustomPhysics>false</CustomPhysics>");
+            break;
+        }
+        write("<CustomPhysics>true</CustomPhysics>");
+        writeFloatElement("Density", pp.density);
+        writeFloatElement("Friction", pp.friction);
+        writeFloatElement("Elasticity", pp.elasticity);
+        writeFloatElement("FrictionWeight", pp.frictionWeight);
+        writeFloatElement("ElasticityWeight", pp.elasticityWeight);
+        writeFloatElement("AcousticAbsorption", pp.acousticAbsorption);
+        break;
+    }
+    case PropertyType::Ref:
+    {
+        int32_t ref = prop.asRef();
+        tag = "Ref";
+        beginProperty(tag, prop, depth);
+        (ref < 0) ? write("null") : writeReferent(ref);
+        break;
+    }
+    case PropertyType::UniqueId:
+    {
+        // random bits, timestamp and index as 32 hex digits
+        const UniqueId& uid = prop.asUniqueId();
+        tag = "UniqueId";
+        beginProperty(tag, prop, depth);
+        writeHex(uint64_t(uid.rawbits), 16);
+        writeHex(uid.timestamp, 8);
+        writeHex(uid.index, 8);
+        break;
+    }
+    case PropertyType::Font:
+    {
+        const FontInfo& font = prop.asFont();
+        tag = "Font";
+        beginProperty(tag, prop, depth);
+        write("<Family>");
+        writeUrl(font.family.data(), font.family.size());
+        write("</Family>");
+        writeIntElement("Weight", font.weight);
+        (font.style == 1) ? write("<Style>Italic</Style>") : write("<Style>Normal</Style>");
+        write("<CachedFaceId>");
+        writeUrl(font.cachedFaceId.data(), font.cachedFaceId.size());
+        write("</CachedFaceId>");
+        break;
+    }
+    case PropertyType::SecurityCapabilities:
+        tag = "SecurityCapabilities";
+        beginProperty(tag, prop, depth);
+        writeNumber(prop.asSecurityCapabilities());
+        break;
+    default:
+        // unknown values are not exported
+        return;
+    }
+    endProperty(tag);
+}
+
+class JsonWriter : public TextWriter
+{
+  public:
+    JsonWriter(const Document& _doc, OutputBuffer& _out)
+        : TextWriter(_out)
+        , doc(_doc)
+    {
+    }
+
+    void writeRange(const ExportOrder& order, size_t first, size_t last)
+    {
+        for (size_t i = first; i < last; i++)
+        {
+            const Instance& inst = doc.getInstances()[order.ids[i]];
+
+            // every instance except the first child of its parent follows a sibling
+            if (i > 0 && order.depths[i] <= order.depths[i - 1])
+            {
+                write(',');
+            }
+            write("{\"id\":");
+            writeNumber(inst.getId());
+            write(",\"class\":");
+            writeString(doc.getTypeName(inst));
+            write(",\"properties\":{");
+            bool isFirst = true;
+            for (const Property& prop : inst.getProperties())
+            {
+                if (prop.getType() == PropertyType::Unknown)
+                {
+                    continue;
+                }
+                if (!isFirst)
+                {
+                    write(',');
+                }
+                isFirst = false;
+                writeString(prop.getName());
+                write(':');
+                writeValue(prop);
+            }
+            write("},\"children\":[");
+
+            uint32_t closeCount = order.getCloseCount(i);
+            for (uint32_t j = 0; j < closeCount; j++)
+            {
+                write("]}");
+            }
+        }
+    }
+
+  private:
+    void writeString(const char* text, size_t size)
+    {
+        // "\u00XX" is the longest escape sequence
+        char* p = out.reserve(size * 6 + 2);
+        *p++ = '"';
+        for (size_t i = 0; i < size; i++)
+        {
+            uint8_t c = uint8_t(text[i]);
+            if (c >= 0x20 && c < 0x80 && c != '"' && c != '\\')
+            {
+                *p++ = char(c);
+                continue;
+            }
+
+            if (c >= 0x80)
+            {
+                size_t sequenceSize = getUtf8SequenceSize(text + i, size - i);
+                if (sequenceSize != 0)
+                {
+                    memcpy(p, text + i, sequenceSize);
+                    p += sequenceSize;
+                    i += sequenceSize - 1;
+                    continue;
+                }
+            }
+
+            *p++ = '\\';
+            switch (c)
+            {
+            case '"':
+            case '\\':
+                *p++ = char(c);
+                break;
+            case '\n':
+                *p++ = 'n';
+                break;
+            case '\r':
+                *p++ = 'r';
+                break;
+            case '\t':
+                *p++ = 't';
+                break;
+            default:
+                memcpy(p, "u00", 3);
+                p[3] = kHexDigits[c >> 4];
+                p[4] = kHexDigits[c & 15];
+                p += 5;
+                break;
+            }
+        }
+        *p++ = '"';
+        out.commit(p);
+    }
+
+    void writeString(const char* text) { writeString(text, strlen(text)); }
+
+    template <typename T> void writeFloat(T value)
+    {
+        if (isfinite(value))
+        {
+            writeNumber(value);
+        }
+        else
+        {
+            write("null");
+        }
+    }
+
+    // [a,b,...]
+    void writeFloats(const float* values, size_t count)
+    {
+        write('[');
+        for (size_t i = 0; i < count; i++)
+        {
+            if (i > 0)
+            {
+                write(',');
+            }
+            writeFloat(values[i]);
+        }
+        write(']');
+    }
+
+    void writeCFrame(const CFrame& cf)
+    {
+        float values[12] = {cf.translation.x, cf.translation.y, cf.translation.z};
+        memcpy(values + 3, cf.rotation.v, sizeof(cf.rotation.v));
+        writeFloats(values, 12);
+    }
+
+    void writeValue(const Property& prop);
+
+    const Document& doc;
+};
+
+void JsonWriter::writeValue(const Property& prop)
+{
+    switch (prop.getType())
+    {
+    case PropertyType::String:
+    case PropertyType::Content:
+    {
+        ArrayView<char> bytes = prop.asBytes();
+        writeString(bytes.data(), bytes.size());
+        break;
+    }
+    case PropertyType::SharedString:
+    case PropertyType::Bytecode:
+    {
+        ArrayView<char> bytes = prop.asBytes();
+        write('"');
+        writeBase64(bytes.data(), bytes.size());
+        write('"');
+        break;
+    }
+    case PropertyType::Bool:
+        prop.asBool() ? write("true") : write("false");
+        break;
+    case PropertyType::Int32:
+        writeNumber(prop.asInt32());
+        break;
+    case PropertyType::Int64:
+        writeNumber(prop.asInt64());
+        break;
+    case PropertyType::Float:
+        writeFloat(prop.asFloat());
+        break;
+    case PropertyType::Double:
+        writeFloat(prop.asDouble());
+        break;
+    case PropertyType::Enum:
+        writeNumber(prop.asEnum());
+        break;
+    case PropertyType::BrickColor:
+        writeNumber(prop.asBrickColor().index);
+        break;
+    case PropertyType::Color3:
+    case PropertyType::UColor3:
+    {
+        const Color3& color = prop.asColor3();
+        float values[3] = {color.r, color.g, color.b};
+        writeFloats(values, 3);
+        break;
+    }
+    case PropertyType::Vector2:
+    {
+        const Vec2& v = prop.asVec2();
+        float values[2] = {v.x, v.y};
+        writeFloats(values, 2);
+        break;
+    }
+    case PropertyType::Vector3:
+    {
+        const Vec3& v = prop.asVec3();
+        float values[3] = {v.x, v.y, v.z};
+        writeFloats(values, 3);
+        break;
+    }
+    case PropertyType::Vector2int16:
+    {
+        const Vec2int16& v = prop.asVec2int16();
+        write('[');
+        writeNumber(v.x);
+        write(',');
+        writeNumber(v.y);
+        write(']');
+        break;
+    }
+    case PropertyType::Vector3int16:
+    {
+        const Vec3int16& v = prop.asVec3int16();
+        write('[');
+        writeNumber(v.x);
+        write(',');
+        writeNumber(v.y);
+        write(',');
+        writeNumber(v.z);
+        write(']');
+        break;
+    }
+    case PropertyType::CFrameMatrix:
+    case PropertyType::CFrameQuat:
+        writeCFrame(prop.asCFrame());
+        break;
+    case PropertyType::OptionalCFrame:
+    {
+        const OptionalCFrame& ocf = prop.asOptionalCFrame();
+        ocf.hasData ? writeCFrame(ocf.val) : write("null");
+        break;
+    }
+    case PropertyType::UDim:
+    {
+        const UDim& udim = prop.asUDim();
+        write('[');
+        writeFloat(udim.scale);
+        write(',');
+        writeNumber(udim.offset);
+        write(']');
+        break;
+    }
+    case PropertyType::UDim2:
+    {
+        const UDim2& udim2 = prop.asUDim2();
+        write("[[");
+        writeFloat(udim2.scaleX);
+        write(',');
+        writeNumber(udim2.offsetX);
+        write("],[");
+        writeFloat(udim2.scaleY);
+        write(',');
+        writeNumber(udim2.offsetY);
+        write("]]");
+        break;
+    }
+    case PropertyType::Ray:
+    {
+        const Ray& ray = prop.asRay();
+        float origin[3] = {ray.origin.x, ray.origin.y, ray.origin.z};
+        float direction[3] = {ray.direction.x, ray.direction.y, ray.direction.z};
+        write("{\"origin\":");
+        writeFloats(origin, 3);
+        write(",\"direction\":");
+        writeFloats(direction, 3);
+        write('}');
+        break;
+    }
+    case PropertyType::Faces:
+        writeNumber(uint32_t(prop.asFaces()));
+        break;
+    case PropertyType::Axes:
+        writeNumber(uint32_t(prop.asAxes()));
+        break;
+    case PropertyType::NumberSequence:
+    {
+        // [[time,value,envelope],...]
+        write('[');
+        bool isFirst = true;
+        for (const NumberSeq::KeyValue& key : prop.asNumberSequence())
+        {
+            float values[3] = {key.time, key.val, key.envelope};
+            if (!isFirst)
+            {
+                write(',');
+            }
+            isFirst = false;
+            writeFloats(values, 3);
+        }
+        write(']');
+        break;
+    }
+    case PropertyType::ColorSequenceV1:
+    {
+        // [[time,r,g,b,envelope],...]
+        write('[');
+        bool isFirst = true;
+        for (const ColorSeq::KeyValue& key : prop.asColorSequence())
+        {
+            float values[5] = {key.time, key.val.r, key.val.g, key.val.b, key.envelope};
+            if (!isFirst)
+            {
+                write(',');
+            }
+            isFirst = false;
+            writeFloats(values, 5);
+        }
+        write(']');
+        break;
+    }
+    case PropertyType::NumberRange:
+    {
+        const NumberRange& range = prop.asNumberRange();
+        float values[2] = {range.min, range.max};
+        writeFloats(values, 2);
+        break;
+    }
+    case PropertyType::Rect2D:
+    {
+        const Rect2D& rect = prop.asRect2D();
+        float values[4] = {rect.x0, rect.y0, rect.x1, rect.y1};
+        writeFloats(values, 4);
+        break;
+    }
+    case PropertyType::PhysicalProperties:
+    {
+        const PhysicalProperties& pp = prop.asPhysicalProperties();
+        float values[6] = {pp.density, pp.friction, pp.elasticity, pp.frictionWeight, pp.elasticityWeight, pp.acousticAbsorption};
+        writeFloats(values, 6);
+        break;
+    }
+    case PropertyType::Ref:
+    {
+        int32_t ref = prop.asRef();
+        (ref < 0) ? write("null") : writeNumber(ref);
+        break;
+    }
+    case PropertyType::UniqueId:
+    {
+        const UniqueId& uid = prop.asUniqueId();
+        write('"');
+        writeHex(uint64_t(uid.rawbits), 16);
+        writeHex(uid.timestamp, 8);
+        writeHex(uid.index, 8);
+        write('"');
+        break;
+    }
+    case PropertyType::Font:
+    {
+        const FontInfo& font = prop.asFont();
+        write("{\"family\":");
+        writeString(font.family.data(), font.family.size());
+        write(",\"weight\":");
+        writeNumber(font.weight);
+        (font.style == 1) ? write(",\"style\":\"Italic\"") : write(",\"style\":\"Normal\"");
+        write(",\"cachedFaceId\":");
+        writeString(font.cachedFaceId.data(), font.cachedFaceId.size());
+        write('}');
+        break;
+    }
+    case PropertyType::SecurityCapabilities:
+        writeNumber(prop.asSecurityCapabilities());
+        break;
+    default:
+        write("null");
+        break;
+    }
+}
+
+// Exports ranges of the order into separate buffers in parallel, then concatenates them
+template <typename Writer, typename Finish> static void exportRanges(const Document& doc, OutputBuffer& out, int32_t id, uint32_t numThreads, const Finish& finish)
+{
+    ExportOrder order;
+    buildExportOrder(doc, id, order);
+
+    size_t count = order.ids.size();
+    numThreads = resolveThreadCount(numThreads);
+    size_t numRanges = std::max(std::min(count / kMinRangeSize, size_t(numThreads) * 4), size_t(1));
+
+    std::vector<OutputBuffer> buffers(numRanges);
+    std::vector<Writer> writers;
+    writers.reserve(numRanges);
+    for (size_t i = 0; i < numRanges; i++)
+    {
+        writers.emplace_back(doc, (i == 0) ? out : buffers[i]);
+    }
+
+    // the first range is written to the output directly
+    parallelFor(numRanges, 1, numThreads, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; i++)
+        {
+            writers[i].writeRange(order, count * i / numRanges, count * (i + 1) / numRanges);
+        }
+    });
+
+    size_t totalSize = out.getSize();
+    for (const OutputBuffer& buffer : buffers)
+    {
+        totalSize += buffer.getSize();
+    }
+    out.reserve(totalSize - out.getSize());
+    for (size_t i = 1; i < numRanges; i++)
+    {
+        out.append(buffers[i].getData(), buffers[i].getSize());
+    }
+
+    finish(writers);
+}
+
+void Exporter::exportXml(const Document& doc, OutputBuffer& out, int32_t id, const ExportOptions& options)
+{
+    TextWriter(out).write("<roblox version=\"4\">\n");
+
+    exportRanges<XmlWriter>(doc, out, id, options.numThreads, [&out](std::vector<XmlWriter>& writers) {
+        XmlWriter& writer = writers[0];
+        for (size_t i = 1; i < writers.size(); i++)
+        {
+            writer.sharedStrings.insert(writer.sharedStrings.end(), writers[i].sharedStrings.begin(), writers[i].sharedStrings.end());
+        }
+        if (!writer.sharedStrings.empty())
+        {
+            writer.writeSharedStrings();
+        }
+        TextWriter(out).write("</roblox>\n");
+    });
+}
+
+void Exporter::exportJson(const Document& doc, OutputBuffer& out, int32_t id, const ExportOptions& options)
+{
+    TextWriter(out).write("{\"instances\":[");
+    exportRanges<JsonWriter>(doc, out, id, options.numThreads, [&out](std::vector<JsonWriter>&) { TextWriter(out).write("]}"); });
+}
+
+} // namespace rbxdoc
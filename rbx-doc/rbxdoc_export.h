@@ -0,0 +1,70 @@
+#pragma once
+
+#include "rbxdoc.h"
+
+namespace rbxdoc
+{
+
+struct ExportOptions
+{
+    // 0 = use all hardware threads
+    uint32_t numThreads = 0;
+};
+
+// Growable output buffer, exporters write into it directly without per-value allocations
+class OutputBuffer
+{
+  public:
+    OutputBuffer() = default;
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+    OutputBuffer(OutputBuffer&&) = default;
+    OutputBuffer& operator=(OutputBuffer&&) = default;
+
+    const char* getData() const { return bytes.get(); }
+    size_t getSize() const { return length; }
+    void clear() { length = 0; }
+
+    // returns space for at least size bytes at the end of the buffer, commit() marks the bytes that were actually written
+    char* reserve(size_t size)
+    {
+        if (capacity - length < size)
+        {
+            grow(size);
+        }
+        return bytes.get() + length;
+    }
+    void commit(char* end) { length = size_t(end - bytes.get()); }
+
+    void append(const char* data, size_t size);
+
+    // returns false if the file can not be written
+    bool writeFile(const char* fileName) const;
+
+  private:
+    void grow(size_t size);
+
+    std::unique_ptr<char[]> bytes;
+    size_t length = 0;
+    size_t capacity = 0;
+};
+
+// Streaming exporters of a document (id = -1) or a subtree of it
+// Instances are split into ranges of the preorder traversal, ranges are exported in parallel and concatenated
+//
+// XML uses the Roblox model format (.rbxmx) and reads back with loadFile()
+// JSON layout: {"instances":[{"id":0,"class":"Part","properties":{"Name":"Part",...},"children":[...]},...]}
+//  - strings and content uris are strings (bytes that are not valid UTF-8 are escaped as \u0080 - \u00ff),
+//    shared strings and bytecode are base64 strings
+//  - vectors, colors, UDim, NumberRange and Rect2D are arrays of numbers, UDim2 is [[xs,xo],[ys,yo]]
+//  - CFrames are [x,y,z,R00,R01,...,R22] (null for an empty OptionalCFrame), sequences are arrays of keypoints
+//  - refs are instance ids (or null), non-finite floats are null
+// Floats are written in the shortest form that reads back to the same value
+class Exporter
+{
+  public:
+    static void exportXml(const Document& doc, OutputBuffer& out, int32_t id = -1, const ExportOptions& options = ExportOptions());
+    static void exportJson(const Document& doc, OutputBuffer& out, int32_t id = -1, const ExportOptions& options = ExportOptions());
+};
+
+} // namespace rbxdoc
@@ -0,0 +1,107 @@
+#include <string.h>
+
+#include "rbxdoc_hash.h"
+
+namespace rbxdoc
+{
+
+static constexpr uint64_t kPrime1 = 11400714785074694791ULL;
+static constexpr uint64_t kPrime2 = 14029467366897019727ULL;
+static constexpr uint64_t kPrime3 = 1609587929392839161ULL;
+static constexpr uint64_t kPrime4 = 9650029242287828579ULL;
+static constexpr uint64_t kPrime5 = 2870177450012600261ULL;
+
+static inline uint64_t rotl64(uint64_t v, int bits) { return (v << bits) | (v >> (64 - bits)); }
+
+// note: the hash is defined over little-endian reads
+static inline uint64_t read64(const uint8_t* p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint32_t read32(const uint8_t* p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t hashRound(uint64_t acc, uint64_t input)
+{
+    acc += input * kPrime2;
+    acc = rotl64(acc, 31);
+    return acc * kPrime1;
+}
+
+static inline uint64_t mergeRound(uint64_t acc, uint64_t val)
+{
+    acc ^= hashRound(0, val);
+    return acc * kPrime1 + kPrime4;
+}
+
+uint64_t hash64(const void* data, size_t size, uint64_t seed)
+{
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    const uint8_t* end = p + size;
+
+    uint64_t h;
+    if (size >= 32)
+    {
+        uint64_t v1 = seed + kPrime1 + kPrime2;
+        uint64_t v2 = seed + kPrime2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - kPrime1;
+
+        const uint8_t* limit = end - 32;
+        do
+        {
+            v1 = hashRound(v1, read64(p));
+            v2 = hashRound(v2, read64(p + 8));
+            v3 = hashRound(v3, read64(p + 16));
+            v4 = hashRound(v4, read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+
+        h = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+        h = mergeRound(h, v1);
+        h = mergeRound(h, v2);
+        h = mergeRound(h, v3);
+        h = mergeRound(h, v4);
+    }
+    else
+    {
+        h = seed + kPrime5;
+    }
+
+    h += uint64_t(size);
+
+    for (; p + 8 <= end; p += 8)
+    {
+        h ^= hashRound(0, read64(p));
+        h = rotl64(h, 27) * kPrime1 + kPrime4;
+    }
+
+    if (p + 4 <= end)
+    {
+        h ^= uint64_t(read32(p)) * kPrime1;
+        h = rotl64(h, 23) * kPrime2 + kPrime3;
+        p += 4;
+    }
+
+    for (; p < end; p++)
+    {
+        h ^= uint64_t(*p) * kPrime5;
+        h = rotl64(h, 11) * kPrime1;
+    }
+
+    h ^= h >> 33;
+    h *= kPrime2;
+    h ^= h >> 29;
+    h *= kPrime3;
+    h ^= h >> 32;
+    return h;
+}
+
+} // namespace rbxdoc
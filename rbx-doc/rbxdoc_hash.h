@@ -0,0 +1,12 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace rbxdoc
+{
+
+// 64-bit non-cryptographic hash of a memory block (XXH64 compatible)
+uint64_t hash64(const void* data, size_t size, uint64_t seed = 0);
+
+} // namespace rbxdoc
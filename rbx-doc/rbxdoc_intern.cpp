@@ -0,0 +1,116 @@
+#include <new>
+#include <string.h>
+
+#include "rbxdoc_hash.h"
+#include "rbxdoc_intern.h"
+
+namespace rbxdoc
+{
+
+InternStore::InternStore(size_t _minValueSize)
+    : minValueSize(_minValueSize)
+{
+}
+
+InternStore::~InternStore()
+{
+    // documents keep the store alive, all values are normally released by now
+    for (Shard& shard : shards)
+    {
+        for (auto& it : shard.entries)
+        {
+            ::operator delete(it.second);
+        }
+    }
+}
+
+size_t InternStore::getMinValueSize() const { return minValueSize; }
+
+size_t InternStore::getValueCount() const
+{
+    size_t count = 0;
+    for (const Shard& shard : shards)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        count += shard.entries.size();
+    }
+    return count;
+}
+
+size_t InternStore::getValueBytes() const
+{
+    size_t bytes = 0;
+    for (const Shard& shard : shards)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        bytes += shard.bytes;
+    }
+    return bytes;
+}
+
+InternStore::Entry* InternStore::getEntry(const char* value) { return reinterpret_cast<Entry*>(const_cast<char*>(value) - sizeof(Entry)); }
+
+InternStore::Shard& InternStore::getShard(uint64_t hash) { return shards[hash >> 60]; }
+
+const char* InternStore::acquire(const char* data, size_t size)
+{
+    static_assert(kNumShards == 16, "The shard index is expected to be the top 4 bits of the hash");
+    // values are stored right after their entry header
+    static_assert(sizeof(Entry) % 8 == 0, "Interned values are expected to be 8 byte aligned");
+
+    uint64_t hash = hash64(data, size);
+    Shard& shard = getShard(hash);
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto range = shard.entries.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        Entry* entry = it->second;
+        char* value = reinterpret_cast<char*>(entry + 1);
+        if (entry->size == size && memcmp(value, data, size) == 0)
+        {
+            entry->refCount++;
+            return value;
+        }
+    }
+
+    Entry* entry = static_cast<Entry*>(::operator new(sizeof(Entry) + size));
+    entry->hash = hash;
+    entry->size = size;
+    entry->refCount = 1;
+    char* value = reinterpret_cast<char*>(entry + 1);
+    memcpy(value, data, size);
+
+    shard.entries.emplace(hash, entry);
+    shard.bytes += size;
+    return value;
+}
+
+void InternStore::release(const std::vector<const char*>& values)
+{
+    for (const char* value : values)
+    {
+        Entry* entry = getEntry(value);
+        Shard& shard = getShard(entry->hash);
+
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (--entry->refCount != 0)
+        {
+            continue;
+        }
+
+        auto range = shard.entries.equal_range(entry->hash);
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            if (it->second == entry)
+            {
+                shard.entries.erase(it);
+                break;
+            }
+        }
+        shard.bytes -= entry->size;
+        ::operator delete(entry);
+    }
+}
+
+} // namespace rbxdoc
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <mutex>
+#include <stddef.h>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+namespace rbxdoc
+{
+
+// Pooled values shared by all documents attached to the store (see Document::setInternStore())
+// Strings, SharedString payloads and sequences of at least minValueSize bytes are kept once for all documents. Every document holds a
+// reference to the values it uses, a value is freed by the last document that releases it.
+// The store is thread-safe, documents attached to the same store can be loaded and destroyed concurrently.
+class InternStore
+{
+  public:
+    // smaller values stay in the document pools, sharing them costs more than it saves
+    explicit InternStore(size_t minValueSize = 32);
+    ~InternStore();
+    InternStore(const InternStore&) = delete;
+    InternStore& operator=(const InternStore&) = delete;
+
+    size_t getMinValueSize() const;
+
+    // unique values currently referenced by documents and their total size in bytes
+    size_t getValueCount() const;
+    size_t getValueBytes() const;
+
+  private:
+    struct Entry
+    {
+        uint64_t hash;
+        size_t size;
+        uint32_t refCount;
+    };
+
+    // the store is split by hash to keep concurrent loads from waiting on a single lock
+    struct Shard
+    {
+        mutable std::mutex mutex;
+        std::unordered_multimap<uint64_t, Entry*> entries;
+        size_t bytes = 0;
+    };
+
+    static constexpr size_t kNumShards = 16;
+
+    // returns a stable copy of the bytes (aligned to 8) and adds a reference to it
+    const char* acquire(const char* data, size_t size);
+    // drops one reference of every value returned by acquire()
+    void release(const std::vector<const char*>& values);
+
+    static Entry* getEntry(const char* value);
+    Shard& getShard(uint64_t hash);
+
+    size_t minValueSize;
+    Shard shards[kNumShards];
+
+    friend class ValuePool;
+};
+
+} // namespace rbxdoc
@@ -0,0 +1,134 @@
+#include <string.h>
+#include <string_view>
+#include <unordered_map>
+
+#include "rbxdoc_mesh.h"
+
+namespace rbxdoc
+{
+
+struct MeshKey
+{
+    std::string_view meshId;
+    std::string_view textureId;
+
+    bool operator==(const MeshKey& other) const { return meshId == other.meshId && textureId == other.textureId; }
+};
+
+struct MeshKeyHash
+{
+    size_t operator()(const MeshKey& key) const
+    {
+        size_t h = std::hash<std::string_view>()(key.meshId);
+        return h ^ (std::hash<std::string_view>()(key.textureId) + 0x9e3779b9 + (h << 6) + (h >> 2));
+    }
+};
+
+static int32_t findColumn(const Type& type, const char* name, PropertyType propertyType, PropertyType altPropertyType = PropertyType::Unknown)
+{
+    int32_t index = type.findProperty(name, true);
+    if (index < 0)
+    {
+        return -1;
+    }
+
+    PropertyType columnType = type.getProperties()[index].type;
+    if (columnType != propertyType && (altPropertyType == PropertyType::Unknown || columnType != altPropertyType))
+    {
+        return -1;
+    }
+    return index;
+}
+
+// asset ids are String properties in older files and Content properties in newer ones (MeshContent / TextureContent)
+static int32_t findAssetColumn(const Type& type, const char* name, const char* contentName)
+{
+    int32_t index = findColumn(type, name, PropertyType::String, PropertyType::Content);
+    return index >= 0 ? index : findColumn(type, contentName, PropertyType::Content);
+}
+
+static float safeScale(float size, float initialSize) { return initialSize != 0.0f ? size / initialSize : 1.0f; }
+
+void MeshInstances::extract(const Document& doc)
+{
+    batches.clear();
+    instanceIds.clear();
+    transforms.clear();
+    scales.clear();
+
+    for (const Type& type : doc.getTypes())
+    {
+        if (strcmp(type.getName(), "MeshPart") != 0)
+        {
+            continue;
+        }
+
+        // resolve columns once, rows are read by index afterwards
+        int32_t cframeColumn = findColumn(type, "CFrame", PropertyType::CFrameMatrix, PropertyType::CFrameQuat);
+        int32_t sizeColumn = findColumn(type, "Size", PropertyType::Vector3);
+        int32_t initialSizeColumn = findColumn(type, "InitialSize", PropertyType::Vector3);
+        int32_t meshIdColumn = findAssetColumn(type, "MeshId", "MeshContent");
+        int32_t textureIdColumn = findAssetColumn(type, "TextureID", "TextureContent");
+
+        ArrayView<int32_t> rows = type.getInstances();
+        ArrayView<Instance> instances = doc.getInstances();
+
+        // first pass: assign every row to a batch
+        std::unordered_map<MeshKey, uint32_t, MeshKeyHash> batchByKey;
+        std::vector<uint32_t> rowBatch(rows.size());
+        for (size_t row = 0; row < rows.size(); row++)
+        {
+            ArrayView<Property> props = instances[rows[row]].getProperties();
+            const char* meshId = meshIdColumn >= 0 ? props[meshIdColumn].asString() : "";
+            const char* textureId = textureIdColumn >= 0 ? props[textureIdColumn].asString() : "";
+
+            auto it = batchByKey.emplace(MeshKey{meshId, textureId}, uint32_t(batches.size()));
+            if (it.second)
+            {
+                batches.push_back(MeshBatch{meshId, textureId, 0, 0});
+            }
+            rowBatch[row] = it.first->second;
+            batches[it.first->second].count++;
+        }
+
+        uint32_t offset = 0;
+        for (MeshBatch& batch : batches)
+        {
+            batch.first = offset;
+            offset += batch.count;
+            batch.count = 0;
+        }
+
+        // second pass: scatter rows into the packed arrays
+        instanceIds.resize(offset);
+        transforms.resize(offset);
+        scales.resize(offset);
+        for (size_t row = 0; row < rows.size(); row++)
+        {
+            ArrayView<Property> props = instances[rows[row]].getProperties();
+            MeshBatch& batch = batches[rowBatch[row]];
+            uint32_t index = batch.first + batch.count;
+            batch.count++;
+
+            instanceIds[index] = rows[row];
+            transforms[index] = cframeColumn >= 0 ? props[cframeColumn].asCFrame() : CFrame{Mat3x3{1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f}, Vec3{0.0f, 0.0f, 0.0f}};
+
+            Vec3 size = sizeColumn >= 0 ? props[sizeColumn].asVec3() : Vec3{1.0f, 1.0f, 1.0f};
+            Vec3 initialSize = initialSizeColumn >= 0 ? props[initialSizeColumn].asVec3() : size;
+            scales[index] = Vec3{safeScale(size.x, initialSize.x), safeScale(size.y, initialSize.y), safeScale(size.z, initialSize.z)};
+        }
+
+        // type names are unique
+        break;
+    }
+}
+
+ArrayView<MeshBatch> MeshInstances::getBatches() const { return ArrayView<MeshBatch>(batches.begin(), batches.end()); }
+
+ArrayView<int32_t> MeshInstances::getInstanceIds(const MeshBatch& batch) const { return ArrayView<int32_t>(instanceIds.data() + batch.first, batch.count); }
+
+ArrayView<CFrame> MeshInstances::getTransforms(const MeshBatch& batch) const { return ArrayView<CFrame>(transforms.data() + batch.first, batch.count); }
+
+ArrayView<Vec3> MeshInstances::getScales(const MeshBatch& batch) const { return ArrayView<Vec3>(scales.data() + batch.first, batch.count); }
+
+} // namespace rbxdoc
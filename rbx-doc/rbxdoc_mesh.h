@@ -0,0 +1,38 @@
+#pragma once
+
+#include "rbxdoc.h"
+
+namespace rbxdoc
+{
+
+// Instances of MeshParts sharing the same MeshId/TextureID pair (MeshContent/TextureContent uris in newer files)
+struct MeshBatch
+{
+    const char* meshId;
+    const char* textureId;
+    // range in the MeshInstances packed arrays
+    uint32_t first;
+    uint32_t count;
+};
+
+// Extracts MeshParts grouped for instanced rendering
+// Transforms and scales of every batch are packed contiguously, the scale is Size / InitialSize
+class MeshInstances
+{
+  public:
+    void extract(const Document& doc);
+
+    ArrayView<MeshBatch> getBatches() const;
+
+    ArrayView<int32_t> getInstanceIds(const MeshBatch& batch) const;
+    ArrayView<CFrame> getTransforms(const MeshBatch& batch) const;
+    ArrayView<Vec3> getScales(const MeshBatch& batch) const;
+
+  private:
+    std::vector<MeshBatch> batches;
+    std::vector<int32_t> instanceIds;
+    std::vector<CFrame> transforms;
+    std::vector<Vec3> scales;
+};
+
+} // namespace rbxdoc
@@ -0,0 +1,255 @@
+#include <algorithm>
+#include <string.h>
+
+#include "rbxdoc_names.h"
+
+namespace rbxdoc
+{
+
+static inline char foldCase(char c) { return (c >= 'A' && c <= 'Z') ? char(c - 'A' + 'a') : c; }
+
+// FNV-1a
+static uint32_t hashName(const char* name, size_t size, NameMatch match)
+{
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < size; i++)
+    {
+        char c = (match == NameMatch::CaseInsensitive) ? foldCase(name[i]) : name[i];
+        h = (h ^ uint8_t(c)) * 16777619u;
+    }
+    return h;
+}
+
+static inline uint32_t hashSlot(int32_t parentId, uint32_t hash) { return hash ^ (uint32_t(parentId) * 0x9E3779B1u); }
+
+static int compareNames(const char* a, size_t aSize, const char* b, size_t bSize, NameMatch match)
+{
+    size_t size = std::min(aSize, bSize);
+    for (size_t i = 0; i < size; i++)
+    {
+        char ca = (match == NameMatch::CaseInsensitive) ? foldCase(a[i]) : a[i];
+        char cb = (match == NameMatch::CaseInsensitive) ? foldCase(b[i]) : b[i];
+        if (ca != cb)
+        {
+            return uint8_t(ca) < uint8_t(cb) ? -1 : 1;
+        }
+    }
+
+    if (aSize == bSize)
+    {
+        return 0;
+    }
+    return aSize < bSize ? -1 : 1;
+}
+
+void NameIndex::build(const Document& _doc)
+{
+    doc = &_doc;
+
+    ArrayView<Instance> instances = doc->getInstances();
+    names.assign(instances.size(), "");
+
+    // all instances of a type share the property layout, the Name slot is resolved once per type
+    for (const Type& type : doc->getTypes())
+    {
+        int32_t slot = type.findProperty("Name");
+        if (slot < 0 || type.getProperties()[slot].type != PropertyType::String)
+        {
+            continue;
+        }
+
+        for (int32_t id : type.getInstances())
+        {
+            names[id] = instances[id].getProperties()[slot].asString();
+        }
+    }
+
+    buildTable(exact, NameMatch::CaseSensitive);
+    buildTable(folded, NameMatch::CaseInsensitive);
+}
+
+void NameIndex::buildTable(Table& table, NameMatch match)
+{
+    struct Record
+    {
+        int32_t parentId;
+        uint32_t hash;
+        uint32_t size;
+        // position in the children list, keeps duplicate siblings in a deterministic order
+        uint32_t order;
+        int32_t id;
+    };
+
+    size_t numInstances = names.size();
+    std::vector<Record> records;
+    records.reserve(numInstances);
+    for (int32_t parentId = -1; parentId < int32_t(numInstances); parentId++)
+    {
+        ArrayView<int32_t> children = doc->getChildren(parentId);
+        for (size_t i = 0; i < children.size(); i++)
+        {
+            int32_t id = children[i];
+            uint32_t size = uint32_t(strlen(names[id]));
+            records.push_back(Record{parentId, hashName(names[id], size, match), size, uint32_t(i), id});
+        }
+    }
+
+    std::sort(records.begin(), records.end(), [&](const Record& a, const Record& b) {
+        if (a.parentId != b.parentId)
+        {
+            return a.parentId < b.parentId;
+        }
+        if (a.hash != b.hash)
+        {
+            return a.hash < b.hash;
+        }
+        int res = compareNames(names[a.id], a.size, names[b.id], b.size, match);
+        if (res != 0)
+        {
+            return res < 0;
+        }
+        return a.order < b.order;
+    });
+
+    // count groups to size the table, load factor is kept at or below 0.5
+    size_t numGroups = 0;
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        const Record& r = records[i];
+        if (i == 0 || r.parentId != records[i - 1].parentId || r.hash != records[i - 1].hash ||
+            compareNames(names[r.id], r.size, names[records[i - 1].id], records[i - 1].size, match) != 0)
+        {
+            numGroups++;
+        }
+    }
+
+    size_t capacity = 16;
+    while (capacity < numGroups * 2)
+    {
+        capacity *= 2;
+    }
+
+    table.buckets.assign(capacity, Bucket{-1, 0, 0, 0});
+    table.mask = uint32_t(capacity - 1);
+    table.ids.resize(records.size());
+
+    size_t groupBegin = 0;
+    while (groupBegin < records.size())
+    {
+        const Record& head = records[groupBegin];
+        size_t groupEnd = groupBegin + 1;
+        while (groupEnd < records.size() && records[groupEnd].parentId == head.parentId && records[groupEnd].hash == head.hash &&
+               compareNames(names[records[groupEnd].id], records[groupEnd].size, names[head.id], head.size, match) == 0)
+        {
+            groupEnd++;
+        }
+
+        for (size_t i = groupBegin; i < groupEnd; i++)
+        {
+            table.ids[i] = records[i].id;
+        }
+
+        // linear probing, empty buckets have zero count
+        uint32_t slot = hashSlot(head.parentId, head.hash) & table.mask;
+        while (table.buckets[slot].count != 0)
+        {
+            slot = (slot + 1) & table.mask;
+        }
+        table.buckets[slot] = Bucket{head.parentId, head.hash, uint32_t(groupBegin), uint32_t(groupEnd - groupBegin)};
+
+        groupBegin = groupEnd;
+    }
+}
+
+const NameIndex::Bucket* NameIndex::find(const Table& table, int32_t parentId, const char* name, size_t size, NameMatch match) const
+{
+    if (table.buckets.empty())
+    {
+        return nullptr;
+    }
+
+    uint32_t hash = hashName(name, size, match);
+    uint32_t slot = hashSlot(parentId, hash) & table.mask;
+    while (true)
+    {
+        const Bucket& bucket = table.buckets[slot];
+        if (bucket.count == 0)
+        {
+            return nullptr;
+        }
+
+        if (bucket.parentId == parentId && bucket.hash == hash)
+        {
+            const char* candidate = names[table.ids[bucket.first]];
+            if (compareNames(candidate, strlen(candidate), name, size, match) == 0)
+            {
+                return &bucket;
+            }
+        }
+        slot = (slot + 1) & table.mask;
+    }
+}
+
+ArrayView<int32_t> NameIndex::findChildren(int32_t parentId, const char* name, NameMatch match) const
+{
+    const Table& table = (match == NameMatch::CaseInsensitive) ? folded : exact;
+    const Bucket* bucket = find(table, parentId, name, strlen(name), match);
+    if (!bucket)
+    {
+        return ArrayView<int32_t>();
+    }
+    return ArrayView<int32_t>(table.ids.data() + bucket->first, bucket->count);
+}
+
+int32_t NameIndex::findChild(int32_t parentId, const char* name, NameMatch match) const
+{
+    ArrayView<int32_t> children = findChildren(parentId, name, match);
+    return children.size() > 0 ? children[0] : -1;
+}
+
+int32_t NameIndex::resolvePath(int32_t parentId, const char* path, NameMatch match, char separator) const
+{
+    const Table& table = (match == NameMatch::CaseInsensitive) ? folded : exact;
+    int32_t id = parentId;
+    const char* component = path;
+    while (true)
+    {
+        const char* componentEnd = strchr(component, separator);
+        size_t size = componentEnd ? size_t(componentEnd - component) : strlen(component);
+
+        const Bucket* bucket = find(table, id, component, size, match);
+        if (!bucket)
+        {
+            return -1;
+        }
+        id = table.ids[bucket->first];
+
+        if (!componentEnd)
+        {
+            return id;
+        }
+        component = componentEnd + 1;
+    }
+}
+
+int32_t NameIndex::findPath(const char* path, NameMatch match, char separator) const { return resolvePath(-1, path, match, separator); }
+
+int32_t NameIndex::findPath(int32_t rootId, const char* path, NameMatch match, char separator) const
+{
+    if (rootId < 0 || size_t(rootId) >= names.size())
+    {
+        return -1;
+    }
+    return resolvePath(rootId, path, match, separator);
+}
+
+const char* NameIndex::getName(int32_t id) const
+{
+    if (id < 0 || size_t(id) >= names.size())
+    {
+        return "";
+    }
+    return names[id];
+}
+
+} // namespace rbxdoc
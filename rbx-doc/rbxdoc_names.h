@@ -0,0 +1,64 @@
+#pragma once
+
+#include "rbxdoc.h"
+
+namespace rbxdoc
+{
+
+enum class NameMatch : uint8_t
+{
+    CaseSensitive,
+    // ASCII case folding
+    CaseInsensitive
+};
+
+// Hash index of instance names: (parentId, Name) -> children
+// Siblings sharing a name are kept in the order of Document::getChildren(), lookups that return a single instance pick the first one
+// note: the index refers to document ids and must be rebuilt after the document is renumbered or reloaded
+class NameIndex
+{
+  public:
+    void build(const Document& doc);
+
+    // children of parentId (-1 for root instances) with the given name
+    ArrayView<int32_t> findChildren(int32_t parentId, const char* name, NameMatch match = NameMatch::CaseSensitive) const;
+    // first child with the given name or -1
+    int32_t findChild(int32_t parentId, const char* name, NameMatch match = NameMatch::CaseSensitive) const;
+
+    // resolves a path like "Workspace.Map.Spawn", the first component is one of the root instances
+    // every component resolves to the first sibling with that name, returns -1 if the path does not exist
+    int32_t findPath(const char* path, NameMatch match = NameMatch::CaseSensitive, char separator = '.') const;
+    // the same as findPath but the first component is a child of rootId
+    int32_t findPath(int32_t rootId, const char* path, NameMatch match = NameMatch::CaseSensitive, char separator = '.') const;
+
+    // value of the Name property, empty string if the instance has none
+    const char* getName(int32_t id) const;
+
+  private:
+    // group of siblings sharing a name, ids[first .. first + count]
+    struct Bucket
+    {
+        int32_t parentId;
+        uint32_t hash;
+        uint32_t first;
+        uint32_t count;
+    };
+
+    struct Table
+    {
+        std::vector<Bucket> buckets;
+        std::vector<int32_t> ids;
+        uint32_t mask = 0;
+    };
+
+    void buildTable(Table& table, NameMatch match);
+    const Bucket* find(const Table& table, int32_t parentId, const char* name, size_t size, NameMatch match) const;
+    int32_t resolvePath(int32_t parentId, const char* path, NameMatch match, char separator) const;
+
+    const Document* doc = nullptr;
+    std::vector<const char*> names;
+    Table exact;
+    Table folded;
+};
+
+} // namespace rbxdoc
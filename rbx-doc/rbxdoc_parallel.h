@@ -0,0 +1,71 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+namespace rbxdoc
+{
+
+// Resolves the number of worker threads, 0 means "use all hardware threads"
+inline uint32_t resolveThreadCount(uint32_t numThreads)
+{
+    if (numThreads != 0)
+    {
+        return numThreads;
+    }
+    uint32_t hwThreads = std::thread::hardware_concurrency();
+    return hwThreads != 0 ? hwThreads : 1;
+}
+
+// Splits [0, count) into batches of at least minBatchSize items and runs func(begin, end) for every batch
+// The calling thread participates in the work, small inputs never spawn threads
+// note: func must not throw
+template <typename Func> void parallelFor(size_t count, size_t minBatchSize, uint32_t numThreads, const Func& func)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    minBatchSize = std::max(minBatchSize, size_t(1));
+    size_t maxThreads = (count + minBatchSize - 1) / minBatchSize;
+    size_t threadCount = std::min(size_t(resolveThreadCount(numThreads)), maxThreads);
+    if (threadCount <= 1)
+    {
+        func(size_t(0), count);
+        return;
+    }
+
+    // a few batches per thread to even out the load
+    size_t batchSize = std::max(minBatchSize, count / (threadCount * 4));
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (;;)
+        {
+            size_t begin = next.fetch_add(batchSize);
+            if (begin >= count)
+            {
+                break;
+            }
+            func(begin, std::min(begin + batchSize, count));
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount - 1);
+    for (size_t i = 0; i + 1 < threadCount; i++)
+    {
+        threads.emplace_back(worker);
+    }
+    worker();
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+} // namespace rbxdoc
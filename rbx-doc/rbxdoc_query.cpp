@@ -0,0 +1,453 @@
+#include <string.h>
+
+#include "rbxdoc_parallel.h"
+#include "rbxdoc_query.h"
+
+namespace rbxdoc
+{
+
+// rows of one type are split into batches of that size
+static constexpr size_t kMinBatchSize = 4096;
+
+Query& Query::ofType(const char* typeName)
+{
+    typeNames.push_back(typeName);
+    return *this;
+}
+
+Query& Query::where(const char* propertyName, CompareOp op, double value) { return where(propertyName, Component::Value, op, value); }
+
+Query& Query::where(const char* propertyName, Component component, CompareOp op, double value)
+{
+    predicates.push_back(Predicate{propertyName, nullptr, value, 0, false, op, component});
+    return *this;
+}
+
+Query& Query::where(const char* propertyName, CompareOp op, int32_t value) { return where(propertyName, op, int64_t(value)); }
+
+Query& Query::where(const char* propertyName, CompareOp op, int64_t value)
+{
+    predicates.push_back(Predicate{propertyName, nullptr, double(value), value, true, op, Component::Value});
+    return *this;
+}
+
+Query& Query::where(const char* propertyName, CompareOp op, const char* value)
+{
+    predicates.push_back(Predicate{propertyName, value ? value : "", 0.0, 0, false, op, Component::Value});
+    return *this;
+}
+
+Query& Query::under(int32_t _ancestorId)
+{
+    ancestorId = _ancestorId;
+    hasAncestor = true;
+    return *this;
+}
+
+class QueryCompiler
+{
+  public:
+    // checks that a predicate can be evaluated against a property column of the given type
+    static bool isCompatible(PropertyType type, Component component, bool isString)
+    {
+        if (isString)
+        {
+            return type == PropertyType::String && component == Component::Value;
+        }
+
+        switch (type)
+        {
+        case PropertyType::Bool:
+        case PropertyType::Int32:
+        case PropertyType::Int64:
+        case PropertyType::Float:
+        case PropertyType::Double:
+        case PropertyType::Enum:
+        case PropertyType::BrickColor:
+        case PropertyType::Ref:
+            return component == Component::Value;
+        case PropertyType::Vector2:
+        case PropertyType::NumberRange:
+            return component == Component::X || component == Component::Y;
+        case PropertyType::Vector3:
+        case PropertyType::Color3:
+        case PropertyType::UColor3:
+            return component == Component::X || component == Component::Y || component == Component::Z;
+        default:
+            return false;
+        }
+    }
+
+    static void compile(const Query& query, const Document& doc, CompiledQuery& res)
+    {
+        res.doc = &doc;
+
+        ArrayView<Type> types = doc.getTypes();
+        for (size_t typeIndex = 0; typeIndex < types.size(); typeIndex++)
+        {
+            const Type& type = types[typeIndex];
+            if (type.getInstances().size() == 0 || !isTypeSelected(query, type))
+            {
+                continue;
+            }
+
+            uint32_t firstCondition = uint32_t(res.conditions.size());
+            bool compatible = true;
+            for (const Query::Predicate& predicate : query.predicates)
+            {
+                int32_t slot = type.findProperty(predicate.propertyName);
+                if (slot < 0)
+                {
+                    // binary and XML files disagree on the case of some names ("size" vs "Size")
+                    slot = type.findProperty(predicate.propertyName, true);
+                }
+                if (slot < 0)
+                {
+                    compatible = false;
+                    break;
+                }
+
+                PropertyType propertyType = type.getProperties()[slot].type;
+                if (!isCompatible(propertyType, predicate.component, predicate.stringValue != nullptr))
+                {
+                    compatible = false;
+                    break;
+                }
+
+                res.conditions.push_back(CompiledQuery::Condition{predicate.stringValue, predicate.value, predicate.intValue, predicate.isInteger,
+                                                                  uint32_t(slot), propertyType, predicate.op, predicate.component});
+            }
+
+            if (!compatible)
+            {
+                // the type can not match, drop its conditions
+                res.conditions.resize(firstCondition);
+                continue;
+            }
+
+            res.plans.push_back(CompiledQuery::TypePlan{uint32_t(typeIndex), firstCondition, uint32_t(res.conditions.size()) - firstCondition});
+        }
+
+        if (query.hasAncestor)
+        {
+            compileAncestor(query.ancestorId, doc, res);
+        }
+    }
+
+  private:
+    static bool isTypeSelected(const Query& query, const Type& type)
+    {
+        if (query.typeNames.empty())
+        {
+            return true;
+        }
+
+        for (const char* typeName : query.typeNames)
+        {
+            if (strcmp(type.getName(), typeName) == 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static void compileAncestor(int32_t ancestorId, const Document& doc, CompiledQuery& res)
+    {
+        res.hasAncestor = true;
+        size_t numInstances = doc.getInstances().size();
+        if (ancestorId < 0 || size_t(ancestorId) >= numInstances)
+        {
+            // nothing can match
+            res.plans.clear();
+            res.conditions.clear();
+            return;
+        }
+
+        if (doc.isDepthFirstOrdered())
+        {
+            // subtree is a contiguous id range
+            res.rangeBegin = ancestorId;
+            res.rangeEnd = ancestorId + int32_t(doc.getSubtreeInstances(ancestorId).size());
+            return;
+        }
+
+        res.ancestorMask.assign(numInstances, 0);
+        for (int32_t id : doc.getSubtree(ancestorId))
+        {
+            res.ancestorMask[id] = 1;
+        }
+    }
+};
+
+class QueryEvaluator
+{
+  public:
+    QueryEvaluator(const CompiledQuery& _query, const Document& _doc)
+        : query(_query)
+        , instances(_doc.getInstances().begin())
+    {
+    }
+
+    // evaluates rows [begin, end) of a type, matching ids are marked in the matches array
+    void evaluate(const CompiledQuery::TypePlan& plan, const int32_t* rows, size_t count, std::vector<int32_t>& scratch, uint8_t* matches) const
+    {
+        scratch.clear();
+        if (query.hasAncestor)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                if (isInsideAncestor(rows[i]))
+                {
+                    scratch.push_back(rows[i]);
+                }
+            }
+        }
+        else
+        {
+            scratch.assign(rows, rows + count);
+        }
+
+        // column-wise: every condition compacts the list of rows that passed the previous ones
+        size_t numRows = scratch.size();
+        for (uint32_t i = 0; i < plan.numConditions && numRows > 0; i++)
+        {
+            numRows = filter(query.conditions[plan.firstCondition + i], scratch.data(), numRows);
+        }
+
+        for (size_t i = 0; i < numRows; i++)
+        {
+            matches[scratch[i]] = 1;
+        }
+    }
+
+  private:
+    bool isInsideAncestor(int32_t id) const
+    {
+        if (query.ancestorMask.empty())
+        {
+            return id >= query.rangeBegin && id < query.rangeEnd;
+        }
+        return query.ancestorMask[id] != 0;
+    }
+
+    template <typename T> static bool compare(T a, CompareOp op, T b)
+    {
+        switch (op)
+        {
+        case CompareOp::Equal:
+            return a == b;
+        case CompareOp::NotEqual:
+            return a != b;
+        case CompareOp::Less:
+            return a < b;
+        case CompareOp::LessEqual:
+            return a <= b;
+        case CompareOp::Greater:
+            return a > b;
+        case CompareOp::GreaterEqual:
+            return a >= b;
+        }
+        return false;
+    }
+
+    template <typename Getter> size_t filterNumbers(const CompiledQuery::Condition& cond, int32_t* ids, size_t count, const Getter& get) const
+    {
+        size_t numPassed = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            int32_t id = ids[i];
+            const Property& prop = instances[id].properties[cond.slot];
+            if (compare(double(get(prop.data)), cond.op, cond.value))
+            {
+                ids[numPassed++] = id;
+            }
+        }
+        return numPassed;
+    }
+
+    // integer columns, integer predicates are compared without a round trip through double
+    template <typename Getter> size_t filterIntegers(const CompiledQuery::Condition& cond, int32_t* ids, size_t count, const Getter& get) const
+    {
+        if (!cond.isInteger)
+        {
+            return filterNumbers(cond, ids, count, get);
+        }
+
+        size_t numPassed = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            int32_t id = ids[i];
+            const Property& prop = instances[id].properties[cond.slot];
+            if (compare(int64_t(get(prop.data)), cond.op, cond.intValue))
+            {
+                ids[numPassed++] = id;
+            }
+        }
+        return numPassed;
+    }
+
+    size_t filterStrings(const CompiledQuery::Condition& cond, int32_t* ids, size_t count) const
+    {
+        bool expectEqual = (cond.op != CompareOp::NotEqual);
+        size_t numPassed = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            int32_t id = ids[i];
+            const Property& prop = instances[id].properties[cond.slot];
+            int res = strcmp(prop.asString(), cond.stringValue);
+            bool passed = false;
+            switch (cond.op)
+            {
+            case CompareOp::Less:
+                passed = res < 0;
+                break;
+            case CompareOp::LessEqual:
+                passed = res <= 0;
+                break;
+            case CompareOp::Greater:
+                passed = res > 0;
+                break;
+            case CompareOp::GreaterEqual:
+                passed = res >= 0;
+                break;
+            default:
+                passed = (res == 0) == expectEqual;
+                break;
+            }
+
+            if (passed)
+            {
+                ids[numPassed++] = id;
+            }
+        }
+        return numPassed;
+    }
+
+    // the value accessor is resolved once per column, not per row
+    size_t filter(const CompiledQuery::Condition& cond, int32_t* ids, size_t count) const
+    {
+        using Payload = Property::Payload;
+        switch (cond.type)
+        {
+        case PropertyType::String:
+            return filterStrings(cond, ids, count);
+        case PropertyType::Bool:
+            return filterIntegers(cond, ids, count, [](const Payload& v) { return v.b ? 1 : 0; });
+        case PropertyType::Int32:
+        case PropertyType::Ref:
+            return filterIntegers(cond, ids, count, [](const Payload& v) { return v.i32; });
+        case PropertyType::Enum:
+            return filterIntegers(cond, ids, count, [](const Payload& v) { return v.u32; });
+        case PropertyType::BrickColor:
+            return filterIntegers(cond, ids, count, [](const Payload& v) { return v.brickColor.index; });
+        case PropertyType::Int64:
+            return filterIntegers(cond, ids, count, [](const Payload& v) { return v.i64; });
+        case PropertyType::Float:
+            return filterNumbers(cond, ids, count, [](const Payload& v) { return v.f; });
+        case PropertyType::Double:
+            return filterNumbers(cond, ids, count, [](const Payload& v) { return v.d; });
+        case PropertyType::Vector2:
+            if (cond.component == Component::X)
+            {
+                return filterNumbers(cond, ids, count, [](const Payload& v) { return v.v2.x; });
+            }
+            return filterNumbers(cond, ids, count, [](const Payload& v) { return v.v2.y; });
+        case PropertyType::NumberRange:
+            if (cond.component == Component::X)
+            {
+                return filterNumbers(cond, ids, count, [](const Payload& v) { return v.numberRange.min; });
+            }
+            return filterNumbers(cond, ids, count, [](const Payload& v) { return v.numberRange.max; });
+        case PropertyType::Vector3:
+            if (cond.component == Component::X)
+            {
+                return filterNumbers(cond, ids, count, [](const Payload& v) { return v.v3.x; });
+            }
+            if (cond.component == Component::Y)
+            {
+                return filterNumbers(cond, ids, count, [](const Payload& v) { return v.v3.y; });
+            }
+            return filterNumbers(cond, ids, count, [](const Payload& v) { return v.v3.z; });
+        case PropertyType::Color3:
+        case PropertyType::UColor3:
+            if (cond.component == Component::X)
+            {
+                return filterNumbers(cond, ids, count, [](const Payload& v) { return v.color3.r; });
+            }
+            if (cond.component == Component::Y)
+            {
+                return filterNumbers(cond, ids, count, [](const Payload& v) { return v.color3.g; });
+            }
+            return filterNumbers(cond, ids, count, [](const Payload& v) { return v.color3.b; });
+        default:
+            // rejected by the compiler
+            return 0;
+        }
+    }
+
+    const CompiledQuery& query;
+    const Instance* instances;
+};
+
+CompiledQuery Query::compile(const Document& doc) const
+{
+    CompiledQuery res;
+    QueryCompiler::compile(*this, doc, res);
+    return res;
+}
+
+void CompiledQuery::evaluate(std::vector<uint8_t>& matches, const QueryOptions& options) const
+{
+    matches.clear();
+    if (!doc)
+    {
+        return;
+    }
+
+    matches.resize(doc->getInstances().size(), 0);
+    QueryEvaluator evaluator(*this, *doc);
+    ArrayView<Type> types = doc->getTypes();
+    for (const TypePlan& plan : plans)
+    {
+        ArrayView<int32_t> rows = types[plan.typeIndex].getInstances();
+        // every batch marks a disjoint set of instances, no synchronization is needed
+        parallelFor(rows.size(), kMinBatchSize, options.numThreads, [&](size_t begin, size_t end) {
+            std::vector<int32_t> scratch;
+            scratch.reserve(end - begin);
+            evaluator.evaluate(plan, rows.data() + begin, end - begin, scratch, matches.data());
+        });
+    }
+}
+
+void CompiledQuery::execute(std::vector<int32_t>& ids, const QueryOptions& options) const
+{
+    std::vector<uint8_t> matches;
+    evaluate(matches, options);
+
+    ids.clear();
+    for (size_t id = 0; id < matches.size(); id++)
+    {
+        if (matches[id])
+        {
+            ids.push_back(int32_t(id));
+        }
+    }
+}
+
+void CompiledQuery::execute(std::vector<uint64_t>& bits, const QueryOptions& options) const
+{
+    std::vector<uint8_t> matches;
+    evaluate(matches, options);
+
+    bits.assign((matches.size() + 63) / 64, 0);
+    for (size_t id = 0; id < matches.size(); id++)
+    {
+        if (matches[id])
+        {
+            bits[id / 64] |= uint64_t(1) << (id % 64);
+        }
+    }
+}
+
+} // namespace rbxdoc
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "rbxdoc.h"
+
+namespace rbxdoc
+{
+
+enum class CompareOp : uint8_t
+{
+    Equal,
+    NotEqual,
+    Less,
+    LessEqual,
+    Greater,
+    GreaterEqual
+};
+
+// Component of a compound value a predicate looks at
+// X/Y/Z are also used for R/G/B of colors and Min/Max (X/Y) of number ranges
+enum class Component : uint8_t
+{
+    Value,
+    X,
+    Y,
+    Z
+};
+
+struct QueryOptions
+{
+    // 0 means "use all hardware threads"
+    uint32_t numThreads = 0;
+};
+
+class CompiledQuery;
+
+// Description of an instance filter, for example:
+//   Query().ofType("Part").where("Anchored", CompareOp::Equal, false).where("Size", Component::Y, CompareOp::Greater, 50.0).under(workspaceId)
+// All the conditions must hold. Names are stored as pointers and must outlive compile().
+// Property names are matched exactly first and case-insensitively otherwise (binary files store "size", XML files "Size"), a type
+// without a matching property of a compatible type never matches.
+class Query
+{
+  public:
+    // multiple types are allowed, no types means "any type"
+    Query& ofType(const char* typeName);
+
+    // numeric comparison of Bool/Int32/Int64/Float/Double/Enum/BrickColor/Ref values or a component of Vector2/Vector3/Color3/NumberRange
+    Query& where(const char* propertyName, CompareOp op, double value);
+    Query& where(const char* propertyName, Component component, CompareOp op, double value);
+    // integer values are compared exactly against integer columns (Bool/Int32/Int64/Enum/BrickColor/Ref) and as double otherwise
+    Query& where(const char* propertyName, CompareOp op, int32_t value);
+    Query& where(const char* propertyName, CompareOp op, int64_t value);
+    // string comparison of String values, ordered ops compare bytes lexicographically (strcmp order, no locale or case folding)
+    Query& where(const char* propertyName, CompareOp op, const char* value);
+
+    // only instances inside the subtree of ancestorId (the ancestor itself included)
+    Query& under(int32_t ancestorId);
+
+    // resolves type and property names against the document tables
+    // note: the compiled query refers to the document and becomes invalid if the document changes
+    CompiledQuery compile(const Document& doc) const;
+
+  private:
+    struct Predicate
+    {
+        const char* propertyName;
+        const char* stringValue;
+        double value;
+        int64_t intValue;
+        bool isInteger;
+        CompareOp op;
+        Component component;
+    };
+
+    std::vector<const char*> typeNames;
+    std::vector<Predicate> predicates;
+    int32_t ancestorId = -1;
+    bool hasAncestor = false;
+
+    friend class QueryCompiler;
+};
+
+// Query bound to a document
+// Every matching type is evaluated column-wise: each predicate is applied to the rows of the type that passed the previous ones
+class CompiledQuery
+{
+  public:
+    // matching instance ids in ascending order
+    void execute(std::vector<int32_t>& ids, const QueryOptions& options = QueryOptions()) const;
+    // bit (id % 64) of word (id / 64) is set for every matching instance
+    void execute(std::vector<uint64_t>& bits, const QueryOptions& options = QueryOptions()) const;
+
+  private:
+    struct Condition
+    {
+        const char* stringValue;
+        double value;
+        int64_t intValue;
+        bool isInteger;
+        // property slot, the same for all instances of a type
+        uint32_t slot;
+        PropertyType type;
+        CompareOp op;
+        Component component;
+    };
+
+    struct TypePlan
+    {
+        uint32_t typeIndex;
+        uint32_t firstCondition;
+        uint32_t numConditions;
+    };
+
+    void evaluate(std::vector<uint8_t>& matches, const QueryOptions& options) const;
+
+    const Document* doc = nullptr;
+    std::vector<TypePlan> plans;
+    std::vector<Condition> conditions;
+    // ancestor constraint, either a range of depth-first ids or a per-instance mask
+    std::vector<uint8_t> ancestorMask;
+    int32_t rangeBegin = 0;
+    int32_t rangeEnd = 0;
+    bool hasAncestor = false;
+
+    friend class QueryCompiler;
+    friend class QueryEvaluator;
+};
+
+} // namespace rbxdoc
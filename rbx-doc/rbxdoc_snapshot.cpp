@@ -0,0 +1,922 @@
+#include <functional>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+
+#include "rbxdoc_file.h"
+#include "rbxdoc_hash.h"
+#include "rbxdoc_snapshot.h"
+
+namespace rbxdoc
+{
+
+static const char kSnapshotMagic[8] = {'R', 'B', 'X', 'S', 'N', 'A', 'P', '\0'};
+static constexpr uint32_t kSnapshotVersion = 1;
+static constexpr uint32_t kByteOrderMark = 0x01020304;
+
+// every section starts at a multiple of 8 bytes (mapped files are page aligned)
+static constexpr size_t kSectionAlignment = 8;
+
+enum SnapshotSection : uint32_t
+{
+    kSectionNames = 0,
+    kSectionNameBytes,
+    kSectionTypes,
+    kSectionTypeInstances,
+    kSectionPropertyInfos,
+    kSectionInstances,
+    kSectionValues,
+    kSectionStrings,
+    kSectionStringBytes,
+    kSectionCFrames,
+    kSectionOptionalCFrames,
+    kSectionPhysicalProperties,
+    kSectionFonts,
+    kSectionNumberSequences,
+    kSectionNumberKeys,
+    kSectionColorSequences,
+    kSectionColorKeys,
+    kSectionRays,
+    kSectionContents,
+    kSectionSharedStrings,
+    kSectionChildOffsets,
+    kSectionChildIds,
+    kSectionRootIds,
+    kSectionReferrerOffsets,
+    kSectionReferrers,
+    kSectionOriginalIds,
+    kSectionCurrentIds,
+    kSectionSubtreeSizes,
+    kNumSections
+};
+
+struct SnapshotRange
+{
+    uint64_t offset;
+    uint64_t size;
+};
+
+struct SnapshotHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t sourceHash;
+    uint32_t numInstances;
+    uint32_t numTypes;
+    SnapshotRange sections[kNumSections];
+};
+
+struct SnapshotType
+{
+    // index in the names section
+    uint32_t name;
+    uint32_t numInstances;
+    uint32_t numProperties;
+    uint32_t padding;
+    uint64_t firstInstance;
+    uint64_t firstProperty;
+    // values are stored column by column: numProperties columns of numInstances values
+    uint64_t firstValue;
+};
+
+struct SnapshotPropertyInfo
+{
+    uint32_t name;
+    uint8_t type;
+    uint8_t padding[3];
+};
+
+struct SnapshotInstance
+{
+    int32_t parentId;
+    uint32_t typeIndex;
+    uint8_t isService;
+    uint8_t isServiceRooted;
+    uint8_t padding[2];
+};
+
+// Property payload, pooled values store the index in raw[0]
+struct SnapshotValue
+{
+    uint64_t raw[2];
+};
+
+struct SnapshotOptionalCFrame
+{
+    CFrame val;
+    uint32_t hasData;
+};
+
+struct SnapshotFont
+{
+    uint32_t family;
+    uint32_t cachedFaceId;
+    uint16_t weight;
+    uint8_t style;
+    uint8_t padding;
+};
+
+struct SnapshotContent
+{
+    uint32_t sourceType;
+    uint32_t uri;
+    int32_t objectId;
+};
+
+static_assert(sizeof(SnapshotValue) == 16, "Snapshot values are expected to match the Property payload size");
+
+int64_t Snapshot::getPoolSize(const ValuePool& pool, PropertyType type)
+{
+    switch (type)
+    {
+    case PropertyType::String:
+    case PropertyType::SharedString:
+    case PropertyType::Bytecode:
+        return int64_t(pool.strings.size());
+    case PropertyType::CFrameMatrix:
+    case PropertyType::CFrameQuat:
+        return int64_t(pool.cframes.size());
+    case PropertyType::OptionalCFrame:
+        return int64_t(pool.optionalCFrames.size());
+    case PropertyType::PhysicalProperties:
+        return int64_t(pool.physicalProperties.size());
+    case PropertyType::Font:
+        return int64_t(pool.fonts.size());
+    case PropertyType::NumberSequence:
+        return int64_t(pool.numberSequences.size());
+    case PropertyType::ColorSequenceV1:
+        return int64_t(pool.colorSequences.size());
+    case PropertyType::Ray:
+        return int64_t(pool.rays.size());
+    case PropertyType::Content:
+        return int64_t(pool.contents.size());
+    default:
+        return -1;
+    }
+}
+
+class SnapshotBuilder
+{
+  public:
+    SnapshotBuilder() { bytes.resize(sizeof(SnapshotHeader)); }
+
+    template <typename T> void addSection(SnapshotSection section, const T* items, size_t count)
+    {
+        static_assert(std::is_trivially_copyable<T>::value && alignof(T) <= kSectionAlignment, "Sections must be flat");
+
+        size_t offset = (bytes.size() + kSectionAlignment - 1) & ~(kSectionAlignment - 1);
+        size_t size = sizeof(T) * count;
+        bytes.resize(offset + size);
+        if (size > 0)
+        {
+            memcpy(bytes.data() + offset, items, size);
+        }
+        header.sections[section] = SnapshotRange{offset, size};
+    }
+
+    template <typename T> void addSection(SnapshotSection section, const std::vector<T>& items) { addSection(section, items.data(), items.size()); }
+
+    // names are deduplicated, the same name is stored once
+    uint32_t addName(const char* name, size_t size)
+    {
+        auto it = nameIndices.emplace(std::string(name, size), uint32_t(names.size()));
+        if (it.second)
+        {
+            names.push_back(SnapshotRange{nameBytes.size(), size});
+            nameBytes.insert(nameBytes.end(), name, name + size);
+            nameBytes.push_back('\0');
+        }
+        return it.first->second;
+    }
+
+    uint32_t addName(const std::string& name) { return addName(name.data(), name.size()); }
+    uint32_t addName(const char* name) { return addName(name, strlen(name)); }
+
+    std::vector<char> bytes;
+    SnapshotHeader header = {};
+
+    std::vector<SnapshotRange> names;
+    std::vector<char> nameBytes;
+
+  private:
+    std::unordered_map<std::string, uint32_t> nameIndices;
+};
+
+static bool writeFile(const char* fileName, const std::vector<char>& bytes)
+{
+    // write to a temporary file first, readers never observe a partially written snapshot
+    // note: a mapped snapshot stays valid when it is replaced, the mapping keeps the old file contents
+    char suffix[32];
+    snprintf(suffix, sizeof(suffix), ".%zx.tmp", std::hash<std::thread::id>()(std::this_thread::get_id()));
+    std::string tempName = std::string(fileName) + suffix;
+
+    FILE* file = fopen(tempName.c_str(), "wb");
+    if (!file)
+    {
+        return false;
+    }
+
+    bool written = fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+    written = (fclose(file) == 0) && written;
+    if (!written)
+    {
+        remove(tempName.c_str());
+        return false;
+    }
+
+#ifdef _WIN32
+    // rename does not replace existing files on Windows
+    remove(fileName);
+#endif
+    if (rename(tempName.c_str(), fileName) != 0)
+    {
+        remove(tempName.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool Snapshot::write(const Document& doc, const char* fileName, uint64_t sourceHash)
+{
+    if (!fileName || fileName[0] == '\0')
+    {
+        return false;
+    }
+
+    const ValuePool& pool = *doc.pool;
+    size_t numInstances = doc.instances.size();
+
+    SnapshotBuilder builder;
+
+    // type table and property columns
+    std::vector<SnapshotType> types;
+    std::vector<int32_t> typeInstances;
+    std::vector<SnapshotPropertyInfo> propertyInfos;
+    std::vector<SnapshotValue> values;
+    types.reserve(doc.types.size());
+    for (uint32_t typeIndex = 0; typeIndex < doc.types.size(); typeIndex++)
+    {
+        const Type& type = doc.types[typeIndex];
+        size_t numRows = type.instanceIds.size();
+        size_t numProperties = type.properties.size();
+
+        // every instance of the type must follow the type layout
+        for (int32_t id : type.instanceIds)
+        {
+            if (id < 0 || size_t(id) >= numInstances || doc.instances[id].typeIndex != typeIndex || doc.instances[id].properties.size() != numProperties)
+            {
+                return false;
+            }
+        }
+
+        types.push_back(SnapshotType{builder.addName(type.name), uint32_t(numRows), uint32_t(numProperties), 0, typeInstances.size(), propertyInfos.size(),
+                                     values.size()});
+        typeInstances.insert(typeInstances.end(), type.instanceIds.begin(), type.instanceIds.end());
+
+        values.resize(values.size() + numRows * numProperties);
+        SnapshotValue* column = values.data() + types.back().firstValue;
+        for (size_t propertyIndex = 0; propertyIndex < numProperties; propertyIndex++, column += numRows)
+        {
+            const PropertyInfo& info = type.properties[propertyIndex];
+            propertyInfos.push_back(SnapshotPropertyInfo{builder.addName(info.name), uint8_t(info.type), {}});
+
+            bool isPooled = getPoolSize(pool, info.type) >= 0;
+            for (size_t row = 0; row < numRows; row++)
+            {
+                const Property& prop = doc.instances[type.instanceIds[row]].properties[propertyIndex];
+                if (prop.type != info.type)
+                {
+                    return false;
+                }
+
+                SnapshotValue& value = column[row];
+                if (isPooled)
+                {
+                    value.raw[0] = prop.data.pooled.index;
+                    value.raw[1] = 0;
+                }
+                else
+                {
+                    memcpy(value.raw, prop.data.raw, sizeof(value.raw));
+                }
+            }
+        }
+    }
+
+    std::vector<SnapshotInstance> instances(numInstances);
+    for (size_t i = 0; i < numInstances; i++)
+    {
+        const Instance& inst = doc.instances[i];
+        instances[i] = SnapshotInstance{inst.parentId, inst.typeIndex, uint8_t(inst.isService), uint8_t(inst.isServiceRooted), {}};
+    }
+
+    // value pools
+    std::vector<SnapshotRange> strings;
+    std::vector<char> stringBytes;
+    strings.reserve(pool.strings.size());
+    for (const ValuePool::StringRef& str : pool.strings)
+    {
+        strings.push_back(SnapshotRange{stringBytes.size(), str.size});
+        stringBytes.insert(stringBytes.end(), str.data, str.data + str.size);
+        stringBytes.push_back('\0');
+    }
+
+    std::vector<SnapshotOptionalCFrame> optionalCFrames;
+    optionalCFrames.reserve(pool.optionalCFrames.size());
+    for (const OptionalCFrame& ocf : pool.optionalCFrames)
+    {
+        optionalCFrames.push_back(SnapshotOptionalCFrame{ocf.val, ocf.hasData ? 1u : 0u});
+    }
+
+    std::vector<SnapshotFont> fonts;
+    fonts.reserve(pool.fonts.size());
+    for (const FontInfo& font : pool.fonts)
+    {
+        fonts.push_back(SnapshotFont{builder.addName(font.family), builder.addName(font.cachedFaceId), font.weight, font.style, 0});
+    }
+
+    auto flattenSequences = [](const auto& sequences, std::vector<SnapshotRange>& ranges, auto& keys) {
+        ranges.reserve(sequences.size());
+        for (const auto& seq : sequences)
+        {
+            ranges.push_back(SnapshotRange{keys.size(), seq.size});
+            keys.insert(keys.end(), seq.data, seq.data + seq.size);
+        }
+    };
+
+    std::vector<SnapshotRange> numberSequences;
+    std::vector<NumberSeq::KeyValue> numberKeys;
+    flattenSequences(pool.numberSequences, numberSequences, numberKeys);
+
+    std::vector<SnapshotRange> colorSequences;
+    std::vector<ColorSeq::KeyValue> colorKeys;
+    flattenSequences(pool.colorSequences, colorSequences, colorKeys);
+
+    std::vector<SnapshotContent> contents;
+    contents.reserve(pool.contents.size());
+    for (const ValuePool::ContentRef& content : pool.contents)
+    {
+        contents.push_back(SnapshotContent{uint32_t(content.sourceType), content.uri, content.objectId});
+    }
+
+    builder.addSection(kSectionTypes, types);
+    builder.addSection(kSectionTypeInstances, typeInstances);
+    builder.addSection(kSectionPropertyInfos, propertyInfos);
+    builder.addSection(kSectionInstances, instances);
+    builder.addSection(kSectionValues, values);
+    builder.addSection(kSectionStrings, strings);
+    builder.addSection(kSectionStringBytes, stringBytes);
+    builder.addSection(kSectionCFrames, pool.cframes);
+    builder.addSection(kSectionOptionalCFrames, optionalCFrames);
+    builder.addSection(kSectionPhysicalProperties, pool.physicalProperties);
+    builder.addSection(kSectionFonts, fonts);
+    builder.addSection(kSectionNumberSequences, numberSequences);
+    builder.addSection(kSectionNumberKeys, numberKeys);
+    builder.addSection(kSectionColorSequences, colorSequences);
+    builder.addSection(kSectionColorKeys, colorKeys);
+    builder.addSection(kSectionRays, pool.rays);
+    builder.addSection(kSectionContents, contents);
+    builder.addSection(kSectionSharedStrings, pool.sharedStrings);
+    builder.addSection(kSectionChildOffsets, doc.childOffsets);
+    builder.addSection(kSectionChildIds, doc.childIds);
+    builder.addSection(kSectionRootIds, doc.rootIds);
+    builder.addSection(kSectionReferrerOffsets, doc.referrerOffsets);
+    builder.addSection(kSectionReferrers, doc.referrers);
+    builder.addSection(kSectionOriginalIds, doc.originalIds);
+    builder.addSection(kSectionCurrentIds, doc.currentIds);
+    builder.addSection(kSectionSubtreeSizes, doc.subtreeSizes);
+    // names are complete only after all types and fonts are added
+    builder.addSection(kSectionNames, builder.names);
+    builder.addSection(kSectionNameBytes, builder.nameBytes);
+
+    SnapshotHeader& header = builder.header;
+    memcpy(header.magic, kSnapshotMagic, sizeof(header.magic));
+    header.version = kSnapshotVersion;
+    header.byteOrder = kByteOrderMark;
+    header.sourceHash = sourceHash;
+    header.numInstances = uint32_t(numInstances);
+    header.numTypes = uint32_t(doc.types.size());
+    memcpy(builder.bytes.data(), &header, sizeof(header));
+
+    return writeFile(fileName, builder.bytes);
+}
+
+// Read-only view of a mapped snapshot, all accessors validate ranges against the file size
+class SnapshotView
+{
+  public:
+    SnapshotView(const uint8_t* _data, size_t _size, const SnapshotHeader& _header)
+        : data(_data)
+        , size(_size)
+        , header(_header)
+    {
+    }
+
+    template <typename T> bool getSection(SnapshotSection section, ArrayView<T>& res) const
+    {
+        static_assert(std::is_trivially_copyable<T>::value && alignof(T) <= kSectionAlignment, "Sections must be flat");
+
+        const SnapshotRange& range = header.sections[section];
+        if (range.offset % kSectionAlignment != 0 || range.offset > size || range.size > size - range.offset || range.size % sizeof(T) != 0)
+        {
+            return false;
+        }
+        res = ArrayView<T>(reinterpret_cast<const T*>(data + range.offset), size_t(range.size / sizeof(T)));
+        return true;
+    }
+
+    // strings are stored with a NUL terminator
+    static bool getString(const ArrayView<SnapshotRange>& ranges, const ArrayView<char>& bytes, uint64_t index, const char*& str, size_t& strSize)
+    {
+        if (index >= ranges.size())
+        {
+            return false;
+        }
+
+        const SnapshotRange& range = ranges[size_t(index)];
+        if (range.offset >= bytes.size() || range.size >= bytes.size() - range.offset || bytes[size_t(range.offset + range.size)] != '\0')
+        {
+            return false;
+        }
+        str = bytes.data() + range.offset;
+        strSize = size_t(range.size);
+        return true;
+    }
+
+    template <typename T, typename SequenceRef>
+    static bool getSequence(const ArrayView<SnapshotRange>& ranges, const ArrayView<T>& keys, size_t index, SequenceRef& res)
+    {
+        const SnapshotRange& range = ranges[index];
+        if (range.offset > keys.size() || range.size > keys.size() - range.offset)
+        {
+            return false;
+        }
+        res = SequenceRef{keys.data() + range.offset, size_t(range.size)};
+        return true;
+    }
+
+  private:
+    const uint8_t* data;
+    size_t size;
+    const SnapshotHeader& header;
+};
+
+LoadResult Snapshot::fail(Document& doc, LoadErrorCode code, const char* reason)
+{
+    // do not expose a partially loaded document
+    doc.clear();
+    doc.loadError.code = code;
+    doc.loadError.reason = reason;
+    return LoadResult::Error;
+}
+
+static bool isValidId(int64_t id, size_t numInstances) { return id >= 0 && uint64_t(id) < numInstances; }
+
+// offsets of a compressed sparse row index: numInstances + 1 non-decreasing offsets that cover all items
+static bool isValidOffsets(const ArrayView<uint32_t>& offsets, size_t numInstances, size_t numItems)
+{
+    if (offsets.size() != numInstances + 1 || offsets[0] != 0 || offsets[numInstances] != numItems)
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < numInstances; i++)
+    {
+        if (offsets[i] > offsets[i + 1])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+LoadResult Snapshot::load(const char* fileName, Document& doc, uint64_t expectedSourceHash)
+{
+    doc.clear();
+    doc.loadError = LoadError();
+
+    if (!fileName || fileName[0] == '\0')
+    {
+        return fail(doc, LoadErrorCode::InvalidArgument, "Empty file name");
+    }
+
+    std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>();
+    if (!file->open(fileName))
+    {
+        return fail(doc, LoadErrorCode::FileReadFailed, "Failed to open file");
+    }
+
+    SnapshotHeader header;
+    if (file->size() < sizeof(header))
+    {
+        return fail(doc, LoadErrorCode::UnsupportedFormat, "Not a snapshot file");
+    }
+    memcpy(&header, file->data(), sizeof(header));
+
+    if (memcmp(header.magic, kSnapshotMagic, sizeof(header.magic)) != 0)
+    {
+        return fail(doc, LoadErrorCode::UnsupportedFormat, "Not a snapshot file");
+    }
+
+    if (header.version != kSnapshotVersion || header.byteOrder != kByteOrderMark)
+    {
+        return fail(doc, LoadErrorCode::UnsupportedFormat, "Unsupported snapshot version");
+    }
+
+    if (expectedSourceHash != 0 && header.sourceHash != expectedSourceHash)
+    {
+        return fail(doc, LoadErrorCode::UnsupportedFormat, "Snapshot of a different source file");
+    }
+
+    SnapshotView view(file->data(), file->size(), header);
+
+    ArrayView<SnapshotRange> names;
+    ArrayView<char> nameBytes;
+    ArrayView<SnapshotType> types;
+    ArrayView<int32_t> typeInstances;
+    ArrayView<SnapshotPropertyInfo> propertyInfos;
+    ArrayView<SnapshotInstance> instances;
+    ArrayView<SnapshotValue> values;
+    ArrayView<SnapshotRange> strings;
+    ArrayView<char> stringBytes;
+    ArrayView<CFrame> cframes;
+    ArrayView<SnapshotOptionalCFrame> optionalCFrames;
+    ArrayView<PhysicalProperties> physicalProperties;
+    ArrayView<SnapshotFont> fonts;
+    ArrayView<SnapshotRange> numberSequences;
+    ArrayView<NumberSeq::KeyValue> numberKeys;
+    ArrayView<SnapshotRange> colorSequences;
+    ArrayView<ColorSeq::KeyValue> colorKeys;
+    ArrayView<Ray> rays;
+    ArrayView<SnapshotContent> contents;
+    ArrayView<uint32_t> sharedStrings;
+    ArrayView<uint32_t> childOffsets;
+    ArrayView<int32_t> childIds;
+    ArrayView<int32_t> rootIds;
+    ArrayView<uint32_t> referrerOffsets;
+    ArrayView<Referrer> referrers;
+    ArrayView<int32_t> originalIds;
+    ArrayView<int32_t> currentIds;
+    ArrayView<uint32_t> subtreeSizes;
+
+    bool sectionsValid = view.getSection(kSectionNames, names) && view.getSection(kSectionNameBytes, nameBytes) && view.getSection(kSectionTypes, types) &&
+                         view.getSection(kSectionTypeInstances, typeInstances) && view.getSection(kSectionPropertyInfos, propertyInfos) &&
+                         view.getSection(kSectionInstances, instances) && view.getSection(kSectionValues, values) &&
+                         view.getSection(kSectionStrings, strings) && view.getSection(kSectionStringBytes, stringBytes) &&
+                         view.getSection(kSectionCFrames, cframes) && view.getSection(kSectionOptionalCFrames, optionalCFrames) &&
+                         view.getSection(kSectionPhysicalProperties, physicalProperties) && view.getSection(kSectionFonts, fonts) &&
+                         view.getSection(kSectionNumberSequences, numberSequences) && view.getSection(kSectionNumberKeys, numberKeys) &&
+                         view.getSection(kSectionColorSequences, colorSequences) && view.getSection(kSectionColorKeys, colorKeys) &&
+                         view.getSection(kSectionRays, rays) && view.getSection(kSectionContents, contents) &&
+                         view.getSection(kSectionSharedStrings, sharedStrings) && view.getSection(kSectionChildOffsets, childOffsets) &&
+                         view.getSection(kSectionChildIds, childIds) && view.getSection(kSectionRootIds, rootIds) &&
+                         view.getSection(kSectionReferrerOffsets, referrerOffsets) && view.getSection(kSectionReferrers, referrers) &&
+                         view.getSection(kSectionOriginalIds, originalIds) && view.getSection(kSectionCurrentIds, currentIds) &&
+                         view.getSection(kSectionSubtreeSizes, subtreeSizes);
+
+    if (!sectionsValid || instances.size() != header.numInstances || types.size() != header.numTypes)
+    {
+        return fail(doc, LoadErrorCode::CorruptedHeader, "Snapshot section out of bounds");
+    }
+
+    size_t numInstances = instances.size();
+    size_t numTypes = types.size();
+    ValuePool& pool = *doc.pool;
+
+    // value pools, strings and sequences are referenced in place
+    pool.strings.resize(strings.size());
+    for (size_t i = 0; i < strings.size(); i++)
+    {
+        ValuePool::StringRef& str = pool.strings[i];
+        if (!SnapshotView::getString(strings, stringBytes, i, str.data, str.size))
+        {
+            return fail(doc, LoadErrorCode::TruncatedData, "Invalid snapshot string");
+        }
+    }
+
+    pool.cframes.assign(cframes.begin(), cframes.end());
+    pool.physicalProperties.assign(physicalProperties.begin(), physicalProperties.end());
+    pool.rays.assign(rays.begin(), rays.end());
+
+    pool.optionalCFrames.resize(optionalCFrames.size());
+    for (size_t i = 0; i < optionalCFrames.size(); i++)
+    {
+        pool.optionalCFrames[i] = OptionalCFrame{optionalCFrames[i].val, optionalCFrames[i].hasData != 0};
+    }
+
+    pool.fonts.resize(fonts.size());
+    for (size_t i = 0; i < fonts.size(); i++)
+    {
+        const char* family;
+        size_t familySize;
+        const char* faceId;
+        size_t faceIdSize;
+        if (!SnapshotView::getString(names, nameBytes, fonts[i].family, family, familySize) ||
+            !SnapshotView::getString(names, nameBytes, fonts[i].cachedFaceId, faceId, faceIdSize))
+        {
+            return fail(doc, LoadErrorCode::TruncatedData, "Invalid snapshot font");
+        }
+
+        FontInfo& font = pool.fonts[i];
+        font.family.assign(family, familySize);
+        font.weight = fonts[i].weight;
+        font.style = fonts[i].style;
+        font.cachedFaceId.assign(faceId, faceIdSize);
+    }
+
+    pool.numberSequences.resize(numberSequences.size());
+    for (size_t i = 0; i < numberSequences.size(); i++)
+    {
+        if (!SnapshotView::getSequence(numberSequences, numberKeys, i, pool.numberSequences[i]))
+        {
+            return fail(doc, LoadErrorCode::TruncatedData, "Invalid snapshot sequence");
+        }
+    }
+
+    pool.colorSequences.resize(colorSequences.size());
+    for (size_t i = 0; i < colorSequences.size(); i++)
+    {
+        if (!SnapshotView::getSequence(colorSequences, colorKeys, i, pool.colorSequences[i]))
+        {
+            return fail(doc, LoadErrorCode::TruncatedData, "Invalid snapshot sequence");
+        }
+    }
+
+    pool.contents.resize(contents.size());
+    for (size_t i = 0; i < contents.size(); i++)
+    {
+        const SnapshotContent& content = contents[i];
+        bool isUri = content.sourceType == uint32_t(ContentSourceType::Uri);
+        if (content.sourceType > uint32_t(ContentSourceType::Object) || (isUri && content.uri >= pool.strings.size()) ||
+            (content.objectId != -1 && !isValidId(content.objectId, numInstances)))
+        {
+            return fail(doc, LoadErrorCode::InvalidInstanceId, "Invalid snapshot content");
+        }
+        pool.contents[i] = ValuePool::ContentRef{ContentSourceType(content.sourceType), content.uri, content.objectId};
+    }
+
+    for (uint32_t index : sharedStrings)
+    {
+        if (index >= pool.strings.size())
+        {
+            return fail(doc, LoadErrorCode::TruncatedData, "Invalid snapshot shared string");
+        }
+    }
+    pool.sharedStrings.assign(sharedStrings.begin(), sharedStrings.end());
+
+    // instances
+    doc.instances.resize(numInstances);
+    for (size_t i = 0; i < numInstances; i++)
+    {
+        const SnapshotInstance& src = instances[i];
+        if ((src.parentId != -1 && !isValidId(src.parentId, numInstances)) || src.typeIndex >= numTypes)
+        {
+            return fail(doc, LoadErrorCode::InvalidInstanceId, "Invalid snapshot instance");
+        }
+        doc.instances[i] = Instance(src.parentId, int32_t(i), src.typeIndex, src.isService != 0, src.isServiceRooted != 0);
+    }
+
+    // types and property columns
+    std::vector<bool> listed(numInstances, false);
+    doc.types.resize(numTypes);
+    for (uint32_t typeIndex = 0; typeIndex < numTypes; typeIndex++)
+    {
+        const SnapshotType& src = types[typeIndex];
+        uint64_t numRows = src.numInstances;
+        uint64_t numProperties = src.numProperties;
+
+        const char* typeName;
+        size_t typeNameSize;
+        if (!SnapshotView::getString(names, nameBytes, src.name, typeName, typeNameSize) || src.firstInstance > typeInstances.size() ||
+            numRows > typeInstances.size() - src.firstInstance || src.firstProperty > propertyInfos.size() ||
+            numProperties > propertyInfos.size() - src.firstProperty || src.firstValue > values.size() ||
+            (numRows > 0 && numProperties > (values.size() - src.firstValue) / numRows))
+        {
+            return fail(doc, LoadErrorCode::InvalidTypeIndex, "Invalid snapshot type");
+        }
+
+        Type& type = doc.types[typeIndex];
+        type.name.assign(typeName, typeNameSize);
+        type.instanceIds.assign(typeInstances.begin() + src.firstInstance, typeInstances.begin() + src.firstInstance + numRows);
+        type.properties.resize(size_t(numProperties));
+
+        // every instance of the type is listed exactly once
+        for (int32_t id : type.instanceIds)
+        {
+            if (!isValidId(id, numInstances) || listed[id] || doc.instances[id].typeIndex != typeIndex)
+            {
+                return fail(doc, LoadErrorCode::InvalidInstanceId, "Invalid snapshot type instance");
+            }
+            listed[id] = true;
+            doc.instances[id].properties.resize(size_t(numProperties));
+        }
+
+        const SnapshotValue* column = values.data() + src.firstValue;
+        for (size_t propertyIndex = 0; propertyIndex < numProperties; propertyIndex++, column += numRows)
+        {
+            const SnapshotPropertyInfo& info = propertyInfos[size_t(src.firstProperty + propertyIndex)];
+            PropertyType propertyType = PropertyType(info.type);
+
+            const char* name;
+            size_t nameSize;
+            if (!SnapshotView::getString(names, nameBytes, info.name, name, nameSize) || info.type > uint8_t(PropertyType::Content))
+            {
+                return fail(doc, LoadErrorCode::InvalidTypeIndex, "Invalid snapshot property");
+            }
+            type.properties[propertyIndex] = PropertyInfo{name, propertyType};
+
+            int64_t poolSize = getPoolSize(pool, propertyType);
+            for (size_t row = 0; row < numRows; row++)
+            {
+                Property& prop = doc.instances[type.instanceIds[row]].properties[propertyIndex];
+                prop.name = name;
+                prop.type = propertyType;
+
+                const SnapshotValue& value = column[row];
+                if (poolSize >= 0)
+                {
+                    if (value.raw[0] >= uint64_t(poolSize))
+                    {
+                        return fail(doc, LoadErrorCode::TruncatedData, "Invalid snapshot pooled value");
+                    }
+                    prop.data.pooled = Property::PooledValue{&pool, uint32_t(value.raw[0])};
+                    continue;
+                }
+
+                memcpy(prop.data.raw, value.raw, sizeof(value.raw));
+                if ((propertyType == PropertyType::Bool && prop.data.u8 > 1) ||
+                    (propertyType == PropertyType::Ref && prop.data.i32 != -1 && !isValidId(prop.data.i32, numInstances)))
+                {
+                    return fail(doc, LoadErrorCode::InvalidInstanceId, "Invalid snapshot value");
+                }
+            }
+        }
+    }
+
+    for (size_t i = 0; i < numInstances; i++)
+    {
+        if (!listed[i])
+        {
+            return fail(doc, LoadErrorCode::InvalidInstanceId, "Invalid snapshot type instance");
+        }
+    }
+
+    // hierarchy, every instance is either a root or a child of its parent
+    if (!isValidOffsets(childOffsets, numInstances, childIds.size()) || childIds.size() + rootIds.size() != numInstances)
+    {
+        return fail(doc, LoadErrorCode::InvalidInstanceId, "Invalid snapshot hierarchy");
+    }
+
+    std::vector<bool> placed(numInstances, false);
+    auto place = [&](int32_t id, int32_t parentId) {
+        if (!isValidId(id, numInstances) || placed[id] || doc.instances[id].parentId != parentId)
+        {
+            return false;
+        }
+        placed[id] = true;
+        return true;
+    };
+
+    for (size_t parentId = 0; parentId < numInstances; parentId++)
+    {
+        for (uint32_t i = childOffsets[parentId]; i < childOffsets[parentId + 1]; i++)
+        {
+            if (!place(childIds[i], int32_t(parentId)))
+            {
+                return fail(doc, LoadErrorCode::InvalidInstanceId, "Invalid snapshot hierarchy");
+            }
+        }
+    }
+
+    for (int32_t id : rootIds)
+    {
+        if (!place(id, -1))
+        {
+            return fail(doc, LoadErrorCode::InvalidInstanceId, "Invalid snapshot hierarchy");
+        }
+    }
+
+    // a cycle places every instance on it as a child, no root would lead to them
+    if (doc.hasParentCycle())
+    {
+        return fail(doc, LoadErrorCode::InvalidInstanceId, "Cyclic parent link");
+    }
+
+    doc.childOffsets.assign(childOffsets.begin(), childOffsets.end());
+    doc.childIds.assign(childIds.begin(), childIds.end());
+    doc.rootIds.assign(rootIds.begin(), rootIds.end());
+
+    // optional indices
+    if (referrerOffsets.size() > 0)
+    {
+        if (!isValidOffsets(referrerOffsets, numInstances, referrers.size()))
+        {
+            return fail(doc, LoadErrorCode::InvalidInstanceId, "Invalid snapshot reference index");
+        }
+
+        for (const Referrer& referrer : referrers)
+        {
+            if (!isValidId(referrer.instanceId, numInstances) || referrer.propertyIndex >= doc.instances[referrer.instanceId].properties.size())
+            {
+                return fail(doc, LoadErrorCode::InvalidInstanceId, "Invalid snapshot reference index");
+            }
+        }
+
+        doc.referrerOffsets.assign(referrerOffsets.begin(), referrerOffsets.end());
+        doc.referrers.assign(referrers.begin(), referrers.end());
+    }
+
+    // id maps are set by renumberDepthFirst(), subtree sizes also by extractSubtree() which keeps ids in preorder
+    if (originalIds.size() > 0 || currentIds.size() > 0)
+    {
+        if (originalIds.size() != numInstances || currentIds.size() != numInstances)
+        {
+            return fail(doc, LoadErrorCode::InvalidInstanceId, "Invalid snapshot renumbering");
+        }
+
+        for (size_t i = 0; i < numInstances; i++)
+        {
+            if (!isValidId(originalIds[i], numInstances) || !isValidId(currentIds[i], numInstances))
+            {
+                return fail(doc, LoadErrorCode::InvalidInstanceId, "Invalid snapshot renumbering");
+            }
+        }
+
+        doc.originalIds.assign(originalIds.begin(), originalIds.end());
+        doc.currentIds.assign(currentIds.begin(), currentIds.end());
+    }
+
+    if (subtreeSizes.size() > 0)
+    {
+        if (subtreeSizes.size() != numInstances)
+        {
+            return fail(doc, LoadErrorCode::InvalidInstanceId, "Invalid snapshot renumbering");
+        }
+
+        for (size_t i = 0; i < numInstances; i++)
+        {
+            if (subtreeSizes[i] == 0 || subtreeSizes[i] > numInstances - i)
+            {
+                return fail(doc, LoadErrorCode::InvalidInstanceId, "Invalid snapshot renumbering");
+            }
+        }
+
+        doc.subtreeSizes.assign(subtreeSizes.begin(), subtreeSizes.end());
+    }
+
+    pool.mapping = std::move(file);
+    return LoadResult::OK;
+}
+
+SnapshotCache::SnapshotCache(const char* _directory)
+    : directory(_directory ? _directory : "")
+{
+}
+
+std::string SnapshotCache::getSnapshotPath(uint64_t sourceHash) const
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.rbxsnap", (unsigned long long)sourceHash);
+
+    std::string path = directory;
+    if (!path.empty() && path.back() != '/' && path.back() != '\\')
+    {
+        path += '/';
+    }
+    return path + name;
+}
+
+LoadResult SnapshotCache::loadFile(const char* fileName, Document& doc) const
+{
+    MappedFile source;
+    if (!fileName || !source.open(fileName))
+    {
+        // reports the error
+        return doc.loadFile(fileName);
+    }
+
+    uint64_t sourceHash = hash64(source.data(), source.size());
+    source.close();
+
+    // 0 disables the source check on load
+    sourceHash = (sourceHash != 0) ? sourceHash : 1;
+
+    std::string snapshotPath = getSnapshotPath(sourceHash);
+    if (Snapshot::load(snapshotPath.c_str(), doc, sourceHash) == LoadResult::OK)
+    {
+        return LoadResult::OK;
+    }
+
+    LoadResult res = doc.loadFile(fileName);
+    if (res == LoadResult::OK)
+    {
+        // a failed write only costs a reload from the source next time
+        Snapshot::write(doc, snapshotPath.c_str(), sourceHash);
+    }
+    return res;
+}
+
+} // namespace rbxdoc
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "rbxdoc.h"
+
+namespace rbxdoc
+{
+
+// Native snapshot of a decoded document: a flat, versioned and pointer-free image of the type table, property columns,
+// hierarchy and value pools. Snapshots are memory mapped on load, strings and sequences are referenced in place and
+// the rest is bulk copied, nothing is decompressed or decoded.
+// note: snapshots use the native byte order and are meant as a local cache, not as an interchange format
+class Snapshot
+{
+  public:
+    // sourceHash identifies the source file the document was loaded from (see SnapshotCache)
+    // returns false if the file can not be written
+    static bool write(const Document& doc, const char* fileName, uint64_t sourceHash = 0);
+
+    // fails if the snapshot is corrupted, has a different version or (if expectedSourceHash is not 0) a different source hash
+    static LoadResult load(const char* fileName, Document& doc, uint64_t expectedSourceHash = 0);
+
+  private:
+    // number of pool entries the values of a property type refer to, -1 for values stored inline
+    static int64_t getPoolSize(const ValuePool& pool, PropertyType type);
+    static LoadResult fail(Document& doc, LoadErrorCode code, const char* reason);
+};
+
+// Serves snapshots of binary files from a cache directory, snapshots are keyed by the content hash of the source file
+class SnapshotCache
+{
+  public:
+    explicit SnapshotCache(const char* _directory);
+
+    // loads a valid snapshot if there is one, otherwise loads the source file and writes its snapshot
+    LoadResult loadFile(const char* fileName, Document& doc) const;
+
+    std::string getSnapshotPath(uint64_t sourceHash) const;
+
+  private:
+    std::string directory;
+};
+
+} // namespace rbxdoc
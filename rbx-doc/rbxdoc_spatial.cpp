@@ -0,0 +1,594 @@
+#include <algorithm>
+#include <cmath>
+#include <float.h>
+
+#include "rbxdoc_parallel.h"
+#include "rbxdoc_spatial.h"
+#include "rbxdoc_transform.h"
+
+namespace rbxdoc
+{
+
+static constexpr uint32_t kNumBins = 16;
+
+// subtrees smaller than that are built on a single thread
+static constexpr size_t kMinParallelBuildSize = 4096;
+
+static Aabb emptyAabb() { return Aabb{Vec3{FLT_MAX, FLT_MAX, FLT_MAX}, Vec3{-FLT_MAX, -FLT_MAX, -FLT_MAX}}; }
+
+static void growAabb(Aabb& box, const Aabb& other)
+{
+    box.min = Vec3{std::min(box.min.x, other.min.x), std::min(box.min.y, other.min.y), std::min(box.min.z, other.min.z)};
+    box.max = Vec3{std::max(box.max.x, other.max.x), std::max(box.max.y, other.max.y), std::max(box.max.z, other.max.z)};
+}
+
+static void growAabb(Aabb& box, const Vec3& p)
+{
+    box.min = Vec3{std::min(box.min.x, p.x), std::min(box.min.y, p.y), std::min(box.min.z, p.z)};
+    box.max = Vec3{std::max(box.max.x, p.x), std::max(box.max.y, p.y), std::max(box.max.z, p.z)};
+}
+
+static float surfaceArea(const Aabb& box)
+{
+    float dx = box.max.x - box.min.x;
+    float dy = box.max.y - box.min.y;
+    float dz = box.max.z - box.min.z;
+    if (dx < 0.0f || dy < 0.0f || dz < 0.0f)
+    {
+        return 0.0f;
+    }
+    return 2.0f * (dx * dy + dy * dz + dz * dx);
+}
+
+static bool overlaps(const Aabb& a, const Aabb& b)
+{
+    return a.min.x <= b.max.x && a.max.x >= b.min.x && a.min.y <= b.max.y && a.max.y >= b.min.y && a.min.z <= b.max.z && a.max.z >= b.min.z;
+}
+
+static float axisValue(const Vec3& v, int axis) { return axis == 0 ? v.x : (axis == 1 ? v.y : v.z); }
+
+static Vec3 centroid(const Aabb& box) { return Vec3{(box.min.x + box.max.x) * 0.5f, (box.min.y + box.max.y) * 0.5f, (box.min.z + box.max.z) * 0.5f}; }
+
+// bounds of an oriented box, rotation is row-major
+static Aabb orientedBoxBounds(const CFrame& cframe, const Vec3& halfSize)
+{
+    const float* r = cframe.rotation.v;
+    Vec3 extent = Vec3{std::fabs(r[0]) * halfSize.x + std::fabs(r[1]) * halfSize.y + std::fabs(r[2]) * halfSize.z,
+                       std::fabs(r[3]) * halfSize.x + std::fabs(r[4]) * halfSize.y + std::fabs(r[5]) * halfSize.z,
+                       std::fabs(r[6]) * halfSize.x + std::fabs(r[7]) * halfSize.y + std::fabs(r[8]) * halfSize.z};
+    const Vec3& t = cframe.translation;
+    return Aabb{Vec3{t.x - extent.x, t.y - extent.y, t.z - extent.z}, Vec3{t.x + extent.x, t.y + extent.y, t.z + extent.z}};
+}
+
+// slab test, returns the entry distance
+static bool intersectAabb(const Aabb& box, const Vec3& origin, const Vec3& invDir, float maxDistance, float& distance)
+{
+    float tx0 = (box.min.x - origin.x) * invDir.x;
+    float tx1 = (box.max.x - origin.x) * invDir.x;
+    float ty0 = (box.min.y - origin.y) * invDir.y;
+    float ty1 = (box.max.y - origin.y) * invDir.y;
+    float tz0 = (box.min.z - origin.z) * invDir.z;
+    float tz1 = (box.max.z - origin.z) * invDir.z;
+
+    float tmin = std::max(std::max(std::min(tx0, tx1), std::min(ty0, ty1)), std::max(std::min(tz0, tz1), 0.0f));
+    float tmax = std::min(std::min(std::max(tx0, tx1), std::max(ty0, ty1)), std::min(std::max(tz0, tz1), maxDistance));
+    distance = tmin;
+    return tmin <= tmax;
+}
+
+static Vec3 inverseDirection(const Vec3& dir) { return Vec3{1.0f / dir.x, 1.0f / dir.y, 1.0f / dir.z}; }
+
+class BvhBuilder
+{
+  public:
+    struct Task
+    {
+        uint32_t node;
+        uint32_t begin;
+        uint32_t end;
+    };
+
+    BvhBuilder(SpatialIndex& _index, uint32_t _maxLeafSize)
+        : index(_index)
+        , maxLeafSize(std::max(_maxLeafSize, 1u))
+    {
+    }
+
+    // builds a subtree over partOrder[begin, end), ranges not larger than deferSize are not built but returned as tasks
+    uint32_t build(std::vector<SpatialIndex::Node>& nodes, uint32_t begin, uint32_t end, std::vector<Task>* deferred, size_t deferSize)
+    {
+        Aabb bounds = emptyAabb();
+        Aabb centroidBounds = emptyAabb();
+        for (uint32_t i = begin; i < end; i++)
+        {
+            const Aabb& partBounds = index.parts[index.partOrder[i]].bounds;
+            growAabb(bounds, partBounds);
+            growAabb(centroidBounds, centroid(partBounds));
+        }
+
+        uint32_t count = end - begin;
+        uint32_t nodeIndex = uint32_t(nodes.size());
+        nodes.push_back(SpatialIndex::Node{bounds, begin, count, 0, 0});
+        if (count <= maxLeafSize)
+        {
+            return nodeIndex;
+        }
+
+        if (deferred && count <= deferSize)
+        {
+            nodes[nodeIndex].count = 0;
+            deferred->push_back(Task{nodeIndex, begin, end});
+            return nodeIndex;
+        }
+
+        uint32_t mid = split(bounds, centroidBounds, begin, end);
+        if (mid == end)
+        {
+            // splitting is not worth it
+            return nodeIndex;
+        }
+
+        uint32_t left = build(nodes, begin, mid, deferred, deferSize);
+        uint32_t right = build(nodes, mid, end, deferred, deferSize);
+        SpatialIndex::Node& node = nodes[nodeIndex];
+        node.count = 0;
+        node.left = left;
+        node.right = right;
+        return nodeIndex;
+    }
+
+  private:
+    // binned surface area heuristic, returns end if the range should stay a leaf
+    uint32_t split(const Aabb& bounds, const Aabb& centroidBounds, uint32_t begin, uint32_t end)
+    {
+        uint32_t* order = index.partOrder.data();
+
+        int axis = 0;
+        float extent = centroidBounds.max.x - centroidBounds.min.x;
+        for (int i = 1; i < 3; i++)
+        {
+            float axisExtent = axisValue(centroidBounds.max, i) - axisValue(centroidBounds.min, i);
+            if (axisExtent > extent)
+            {
+                axis = i;
+                extent = axisExtent;
+            }
+        }
+
+        if (extent <= 0.0f)
+        {
+            // all centroids are at the same point
+            return begin + (end - begin) / 2;
+        }
+
+        struct Bin
+        {
+            Aabb bounds = emptyAabb();
+            uint32_t count = 0;
+        };
+        Bin bins[kNumBins];
+
+        float axisMin = axisValue(centroidBounds.min, axis);
+        float scale = float(kNumBins) / extent;
+        auto binIndex = [&](uint32_t partIndex) {
+            float c = axisValue(centroid(index.parts[partIndex].bounds), axis);
+            return std::min(uint32_t((c - axisMin) * scale), kNumBins - 1);
+        };
+
+        for (uint32_t i = begin; i < end; i++)
+        {
+            Bin& bin = bins[binIndex(order[i])];
+            growAabb(bin.bounds, index.parts[order[i]].bounds);
+            bin.count++;
+        }
+
+        float rightArea[kNumBins];
+        uint32_t rightCount[kNumBins];
+        Aabb acc = emptyAabb();
+        uint32_t accCount = 0;
+        for (uint32_t i = kNumBins - 1; i > 0; i--)
+        {
+            growAabb(acc, bins[i].bounds);
+            accCount += bins[i].count;
+            rightArea[i] = surfaceArea(acc);
+            rightCount[i] = accCount;
+        }
+
+        float bestCost = FLT_MAX;
+        uint32_t bestSplit = 0;
+        acc = emptyAabb();
+        accCount = 0;
+        for (uint32_t i = 0; i + 1 < kNumBins; i++)
+        {
+            growAabb(acc, bins[i].bounds);
+            accCount += bins[i].count;
+            float cost = surfaceArea(acc) * accCount + rightArea[i + 1] * rightCount[i + 1];
+            if (accCount != 0 && rightCount[i + 1] != 0 && cost < bestCost)
+            {
+                bestCost = cost;
+                bestSplit = i;
+            }
+        }
+
+        uint32_t count = end - begin;
+        float leafCost = surfaceArea(bounds) * count;
+        if (bestCost >= leafCost && count <= maxLeafSize * 4)
+        {
+            return end;
+        }
+
+        uint32_t* mid = std::partition(order + begin, order + end, [&](uint32_t partIndex) { return binIndex(partIndex) <= bestSplit; });
+        uint32_t midIndex = uint32_t(mid - order);
+        if (midIndex == begin || midIndex == end)
+        {
+            midIndex = begin + count / 2;
+        }
+        return midIndex;
+    }
+
+    SpatialIndex& index;
+    uint32_t maxLeafSize;
+};
+
+void SpatialIndex::build(const Document& doc, const SpatialIndexOptions& options)
+{
+    TransformOptions transformOptions;
+    transformOptions.numThreads = options.numThreads;
+
+    WorldTransforms transforms;
+    transforms.solve(doc, transformOptions);
+    build(doc, transforms, options);
+}
+
+void SpatialIndex::build(const Document& doc, const WorldTransforms& transforms, const SpatialIndexOptions& options)
+{
+    parts.clear();
+    partOrder.clear();
+    nodes.clear();
+    partByInstance.assign(doc.getInstances().size(), -1);
+    dirty = false;
+
+    for (const Type& type : doc.getTypes())
+    {
+        int32_t cframeIndex = type.findProperty("CFrame");
+        int32_t sizeIndex = type.findProperty("Size", true);
+        if (cframeIndex < 0 || sizeIndex < 0 || type.getProperties()[sizeIndex].type != PropertyType::Vector3)
+        {
+            continue;
+        }
+
+        PropertyType cframeType = type.getProperties()[cframeIndex].type;
+        if (cframeType != PropertyType::CFrameMatrix && cframeType != PropertyType::CFrameQuat)
+        {
+            continue;
+        }
+
+        for (int32_t id : type.getInstances())
+        {
+            const Instance& inst = doc.getInstances()[id];
+            const Vec3& size = inst.getProperties()[sizeIndex].asVec3();
+            const CFrame& cframe = transforms.getTransform(id);
+
+            Vec3 halfSize = Vec3{size.x * 0.5f, size.y * 0.5f, size.z * 0.5f};
+            partByInstance[id] = int32_t(parts.size());
+            parts.push_back(Part{cframe, halfSize, orientedBoxBounds(cframe, halfSize), id});
+        }
+    }
+
+    partOrder.resize(parts.size());
+    for (size_t i = 0; i < parts.size(); i++)
+    {
+        partOrder[i] = uint32_t(i);
+    }
+
+    if (parts.empty())
+    {
+        return;
+    }
+
+    BvhBuilder builder(*this, options.maxLeafSize);
+    uint32_t numThreads = resolveThreadCount(options.numThreads);
+    if (numThreads <= 1 || parts.size() < kMinParallelBuildSize)
+    {
+        builder.build(nodes, 0, uint32_t(parts.size()), nullptr, 0);
+        return;
+    }
+
+    // build the top of the tree serially and the rest as independent subtrees
+    std::vector<BvhBuilder::Task> tasks;
+    size_t deferSize = std::max(parts.size() / (size_t(numThreads) * 4), kMinParallelBuildSize / 4);
+    builder.build(nodes, 0, uint32_t(parts.size()), &tasks, deferSize);
+
+    std::vector<std::vector<Node>> subtrees(tasks.size());
+    parallelFor(tasks.size(), 1, numThreads, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+        {
+            builder.build(subtrees[i], tasks[i].begin, tasks[i].end, nullptr, 0);
+        }
+    });
+
+    // stitch the subtrees, the subtree root replaces its placeholder node
+    for (size_t i = 0; i < tasks.size(); i++)
+    {
+        const std::vector<Node>& subtree = subtrees[i];
+        uint32_t placeholder = tasks[i].node;
+        uint32_t base = uint32_t(nodes.size());
+        auto remap = [&](uint32_t localIndex) { return localIndex == 0 ? placeholder : base + localIndex - 1; };
+
+        for (size_t j = 0; j < subtree.size(); j++)
+        {
+            Node node = subtree[j];
+            if (node.count == 0)
+            {
+                node.left = remap(node.left);
+                node.right = remap(node.right);
+            }
+
+            if (j == 0)
+            {
+                nodes[placeholder] = node;
+            }
+            else
+            {
+                nodes.push_back(node);
+            }
+        }
+    }
+}
+
+bool SpatialIndex::updatePart(int32_t id, const CFrame& cframe, const Vec3& size)
+{
+    if (id < 0 || size_t(id) >= partByInstance.size() || partByInstance[id] < 0)
+    {
+        return false;
+    }
+
+    Part& part = parts[partByInstance[id]];
+    part.cframe = cframe;
+    part.halfSize = Vec3{size.x * 0.5f, size.y * 0.5f, size.z * 0.5f};
+    part.bounds = orientedBoxBounds(part.cframe, part.halfSize);
+    dirty = true;
+    return true;
+}
+
+void SpatialIndex::refit()
+{
+    if (!dirty)
+    {
+        return;
+    }
+
+    // children are always stored after their parents
+    for (size_t i = nodes.size(); i-- > 0;)
+    {
+        Node& node = nodes[i];
+        Aabb bounds = emptyAabb();
+        if (node.count > 0)
+        {
+            for (uint32_t j = node.first; j < node.first + node.count; j++)
+            {
+                growAabb(bounds, parts[partOrder[j]].bounds);
+            }
+        }
+        else
+        {
+            growAabb(bounds, nodes[node.left].bounds);
+            growAabb(bounds, nodes[node.right].bounds);
+        }
+        node.bounds = bounds;
+    }
+    dirty = false;
+}
+
+void SpatialIndex::queryAabb(const Aabb& box, std::vector<int32_t>& result) const
+{
+    if (nodes.empty())
+    {
+        return;
+    }
+
+    std::vector<uint32_t> stack;
+    stack.push_back(0);
+    while (!stack.empty())
+    {
+        const Node& node = nodes[stack.back()];
+        stack.pop_back();
+        if (!overlaps(node.bounds, box))
+        {
+            continue;
+        }
+
+        if (node.count == 0)
+        {
+            stack.push_back(node.left);
+            stack.push_back(node.right);
+            continue;
+        }
+
+        for (uint32_t i = node.first; i < node.first + node.count; i++)
+        {
+            const Part& part = parts[partOrder[i]];
+            if (overlaps(part.bounds, box))
+            {
+                result.push_back(part.id);
+            }
+        }
+    }
+}
+
+void SpatialIndex::queryFrustum(const Frustum& frustum, std::vector<int32_t>& result) const
+{
+    auto isVisible = [&](const Aabb& box) {
+        for (const Plane& plane : frustum.planes)
+        {
+            // the box corner that is the furthest along the plane normal
+            const Vec3& n = plane.normal;
+            Vec3 p = Vec3{n.x >= 0.0f ? box.max.x : box.min.x, n.y >= 0.0f ? box.max.y : box.min.y, n.z >= 0.0f ? box.max.z : box.min.z};
+            if (n.x * p.x + n.y * p.y + n.z * p.z + plane.distance < 0.0f)
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    if (nodes.empty())
+    {
+        return;
+    }
+
+    std::vector<uint32_t> stack;
+    stack.push_back(0);
+    while (!stack.empty())
+    {
+        const Node& node = nodes[stack.back()];
+        stack.pop_back();
+        if (!isVisible(node.bounds))
+        {
+            continue;
+        }
+
+        if (node.count == 0)
+        {
+            stack.push_back(node.left);
+            stack.push_back(node.right);
+            continue;
+        }
+
+        for (uint32_t i = node.first; i < node.first + node.count; i++)
+        {
+            const Part& part = parts[partOrder[i]];
+            if (isVisible(part.bounds))
+            {
+                result.push_back(part.id);
+            }
+        }
+    }
+}
+
+bool SpatialIndex::intersectPart(const Part& part, const Ray& ray, float maxDistance, float& distance) const
+{
+    // move the ray into the part space (inverse of a rotation is its transpose)
+    const float* r = part.cframe.rotation.v;
+    Vec3 d = Vec3{ray.origin.x - part.cframe.translation.x, ray.origin.y - part.cframe.translation.y, ray.origin.z - part.cframe.translation.z};
+    Vec3 origin = Vec3{r[0] * d.x + r[3] * d.y + r[6] * d.z, r[1] * d.x + r[4] * d.y + r[7] * d.z, r[2] * d.x + r[5] * d.y + r[8] * d.z};
+    const Vec3& dir = ray.direction;
+    Vec3 localDir = Vec3{r[0] * dir.x + r[3] * dir.y + r[6] * dir.z, r[1] * dir.x + r[4] * dir.y + r[7] * dir.z, r[2] * dir.x + r[5] * dir.y + r[8] * dir.z};
+
+    const Vec3& h = part.halfSize;
+    Aabb box = Aabb{Vec3{-h.x, -h.y, -h.z}, h};
+    return intersectAabb(box, origin, inverseDirection(localDir), maxDistance, distance);
+}
+
+void SpatialIndex::queryRay(const Ray& ray, float maxDistance, std::vector<int32_t>& result) const
+{
+    if (nodes.empty())
+    {
+        return;
+    }
+
+    Vec3 invDir = inverseDirection(ray.direction);
+    std::vector<uint32_t> stack;
+    stack.push_back(0);
+    while (!stack.empty())
+    {
+        const Node& node = nodes[stack.back()];
+        stack.pop_back();
+
+        float distance;
+        if (!intersectAabb(node.bounds, ray.origin, invDir, maxDistance, distance))
+        {
+            continue;
+        }
+
+        if (node.count == 0)
+        {
+            stack.push_back(node.left);
+            stack.push_back(node.right);
+            continue;
+        }
+
+        for (uint32_t i = node.first; i < node.first + node.count; i++)
+        {
+            const Part& part = parts[partOrder[i]];
+            if (intersectPart(part, ray, maxDistance, distance))
+            {
+                result.push_back(part.id);
+            }
+        }
+    }
+}
+
+bool SpatialIndex::raycast(const Ray& ray, float maxDistance, RayHit& hit) const
+{
+    hit = RayHit();
+    if (nodes.empty())
+    {
+        return false;
+    }
+
+    float closest = maxDistance;
+    Vec3 invDir = inverseDirection(ray.direction);
+    std::vector<uint32_t> stack;
+    stack.push_back(0);
+    while (!stack.empty())
+    {
+        const Node& node = nodes[stack.back()];
+        stack.pop_back();
+
+        float distance;
+        if (!intersectAabb(node.bounds, ray.origin, invDir, closest, distance))
+        {
+            continue;
+        }
+
+        if (node.count == 0)
+        {
+            // visit the nearer child first
+            float leftDistance = FLT_MAX;
+            float rightDistance = FLT_MAX;
+            bool hitLeft = intersectAabb(nodes[node.left].bounds, ray.origin, invDir, closest, leftDistance);
+            bool hitRight = intersectAabb(nodes[node.right].bounds, ray.origin, invDir, closest, rightDistance);
+            if (hitLeft && hitRight)
+            {
+                stack.push_back(leftDistance < rightDistance ? node.right : node.left);
+                stack.push_back(leftDistance < rightDistance ? node.left : node.right);
+            }
+            else if (hitLeft)
+            {
+                stack.push_back(node.left);
+            }
+            else if (hitRight)
+            {
+                stack.push_back(node.right);
+            }
+            continue;
+        }
+
+        for (uint32_t i = node.first; i < node.first + node.count; i++)
+        {
+            const Part& part = parts[partOrder[i]];
+            if (intersectPart(part, ray, closest, distance))
+            {
+                closest = distance;
+                hit.id = part.id;
+                hit.distance = distance;
+            }
+        }
+    }
+    return hit.id >= 0;
+}
+
+size_t SpatialIndex::getPartCount() const { return parts.size(); }
+
+bool SpatialIndex::getBounds(int32_t id, Aabb& bounds) const
+{
+    if (id < 0 || size_t(id) >= partByInstance.size() || partByInstance[id] < 0)
+    {
+        return false;
+    }
+    bounds = parts[partByInstance[id]].bounds;
+    return true;
+}
+
+} // namespace rbxdoc
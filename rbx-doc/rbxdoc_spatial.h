@@ -0,0 +1,97 @@
+#pragma once
+
+#include "rbxdoc.h"
+
+namespace rbxdoc
+{
+
+class WorldTransforms;
+
+struct Aabb
+{
+    Vec3 min;
+    Vec3 max;
+};
+
+// Plane is a normal and a distance, a point p is inside if dot(normal, p) + distance >= 0
+struct Plane
+{
+    Vec3 normal;
+    float distance;
+};
+
+struct Frustum
+{
+    Plane planes[6];
+};
+
+struct RayHit
+{
+    int32_t id = -1;
+    float distance = 0.0f;
+};
+
+struct SpatialIndexOptions
+{
+    // 0 = use all hardware threads
+    uint32_t numThreads = 0;
+    uint32_t maxLeafSize = 4;
+};
+
+// Bounding volume hierarchy over parts (instances with both CFrame and Size properties)
+// Every part is represented by the AABB of its oriented box, ray casts test against the exact oriented box
+class SpatialIndex
+{
+  public:
+    // builds the index using world transforms (see WorldTransforms)
+    void build(const Document& doc, const WorldTransforms& transforms, const SpatialIndexOptions& options = SpatialIndexOptions());
+    void build(const Document& doc, const SpatialIndexOptions& options = SpatialIndexOptions());
+
+    // Incremental update: move/resize parts and then refit the hierarchy once
+    // note: refit keeps the tree topology, rebuild the index if parts moved far away from their original locations
+    bool updatePart(int32_t id, const CFrame& cframe, const Vec3& size);
+    void refit();
+
+    // query results are instance ids
+    void queryAabb(const Aabb& box, std::vector<int32_t>& result) const;
+    void queryFrustum(const Frustum& frustum, std::vector<int32_t>& result) const;
+    // all parts hit by the ray (unsorted)
+    void queryRay(const Ray& ray, float maxDistance, std::vector<int32_t>& result) const;
+    // the closest part hit by the ray
+    bool raycast(const Ray& ray, float maxDistance, RayHit& hit) const;
+
+    size_t getPartCount() const;
+    bool getBounds(int32_t id, Aabb& bounds) const;
+
+  private:
+    struct Part
+    {
+        CFrame cframe;
+        Vec3 halfSize;
+        Aabb bounds;
+        int32_t id;
+    };
+
+    struct Node
+    {
+        Aabb bounds;
+        // leaf: count > 0 and first is an offset in partOrder, interior node: count == 0
+        uint32_t first;
+        uint32_t count;
+        uint32_t left;
+        uint32_t right;
+    };
+
+    bool intersectPart(const Part& part, const Ray& ray, float maxDistance, float& distance) const;
+
+    std::vector<Part> parts;
+    std::vector<uint32_t> partOrder;
+    std::vector<Node> nodes;
+    // instance id to part index (-1 for instances that are not parts)
+    std::vector<int32_t> partByInstance;
+    bool dirty = false;
+
+    friend class BvhBuilder;
+};
+
+} // namespace rbxdoc
@@ -0,0 +1,269 @@
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define RBXDOC_SSE2 1
+    #include <emmintrin.h>
+#endif
+
+#include "rbxdoc_parallel.h"
+#include "rbxdoc_transform.h"
+
+namespace rbxdoc
+{
+
+static const CFrame kIdentity = CFrame{Mat3x3{1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f}, Vec3{0.0f, 0.0f, 0.0f}};
+
+// levels smaller than that are not worth spreading across threads
+static constexpr size_t kMinBatchSize = 2048;
+
+enum class TransformKind : uint8_t
+{
+    Inherit,
+    Absolute,
+    Relative
+};
+
+class TransformSolver
+{
+  public:
+    explicit TransformSolver(const Document& _doc)
+        : doc(_doc)
+    {
+        ArrayView<Type> types = doc.getTypes();
+        rules.resize(types.size());
+        for (size_t i = 0; i < types.size(); i++)
+        {
+            const char* typeName = types[i].getName();
+            TypeRule& rule = rules[i];
+            if (strcmp(typeName, "Attachment") == 0 || strcmp(typeName, "Bone") == 0)
+            {
+                rule.kind = TransformKind::Relative;
+                rule.propertyName = "CFrame";
+            }
+            else if (strcmp(typeName, "Model") == 0 || strcmp(typeName, "WorldModel") == 0)
+            {
+                // OptionalCFrame, models without a pivot (hasData = false) inherit the transform of their parent
+                rule.kind = TransformKind::Absolute;
+                rule.propertyName = "WorldPivotData";
+            }
+            else
+            {
+                rule.kind = TransformKind::Absolute;
+                rule.propertyName = "CFrame";
+            }
+        }
+
+        // all instances of a type share the property layout, resolve it once per type
+        for (const Instance& inst : doc.getInstances())
+        {
+            uint32_t typeIndex = inst.getTypeIndex();
+            if (typeIndex >= rules.size() || rules[typeIndex].resolved)
+            {
+                continue;
+            }
+
+            TypeRule& rule = rules[typeIndex];
+            rule.resolved = true;
+            rule.slot = findSlot(inst.getProperties(), rule.propertyName);
+            if (rule.slot >= 0)
+            {
+                rule.internedName = inst.getProperties()[rule.slot].getName();
+            }
+        }
+    }
+
+    void solve(WorldTransforms& res, int32_t id) const
+    {
+        const Instance& inst = doc.getInstances()[id];
+        int32_t parentId = inst.getParentId();
+        const CFrame& parent = (parentId >= 0) ? res.transforms[parentId] : kIdentity;
+
+        TransformKind kind = TransformKind::Inherit;
+        const CFrame* local = findLocal(inst, kind);
+        switch (kind)
+        {
+        case TransformKind::Absolute:
+            res.transforms[id] = *local;
+            res.spatial[id] = 1;
+            break;
+        case TransformKind::Relative:
+            compose(parent, *local, res.transforms[id]);
+            res.spatial[id] = 1;
+            break;
+        default:
+            res.transforms[id] = parent;
+            res.spatial[id] = 0;
+            break;
+        }
+    }
+
+    static void compose(const CFrame& parent, const CFrame& local, CFrame& res)
+    {
+        const float* p = parent.rotation.v;
+        const float* l = local.rotation.v;
+#if RBXDOC_SSE2
+        // rows of [R | t] of the local transform, every row of the result is a linear combination of them
+        // the fourth lane of the result row i is (parent.R * local.t + parent.t)[i]
+        __m128 l0 = _mm_setr_ps(l[0], l[1], l[2], local.translation.x);
+        __m128 l1 = _mm_setr_ps(l[3], l[4], l[5], local.translation.y);
+        __m128 l2 = _mm_setr_ps(l[6], l[7], l[8], local.translation.z);
+
+        __m128 r0 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(p[0]), l0), _mm_mul_ps(_mm_set1_ps(p[1]), l1)),
+                               _mm_add_ps(_mm_mul_ps(_mm_set1_ps(p[2]), l2), _mm_setr_ps(0.0f, 0.0f, 0.0f, parent.translation.x)));
+        __m128 r1 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(p[3]), l0), _mm_mul_ps(_mm_set1_ps(p[4]), l1)),
+                               _mm_add_ps(_mm_mul_ps(_mm_set1_ps(p[5]), l2), _mm_setr_ps(0.0f, 0.0f, 0.0f, parent.translation.y)));
+        __m128 r2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(p[6]), l0), _mm_mul_ps(_mm_set1_ps(p[7]), l1)),
+                               _mm_add_ps(_mm_mul_ps(_mm_set1_ps(p[8]), l2), _mm_setr_ps(0.0f, 0.0f, 0.0f, parent.translation.z)));
+
+        float rows[12];
+        _mm_storeu_ps(rows + 0, r0);
+        _mm_storeu_ps(rows + 4, r1);
+        _mm_storeu_ps(rows + 8, r2);
+        res = CFrame{Mat3x3{rows[0], rows[1], rows[2], rows[4], rows[5], rows[6], rows[8], rows[9], rows[10]}, Vec3{rows[3], rows[7], rows[11]}};
+#else
+        const Vec3& t = local.translation;
+        CFrame tmp;
+        for (int row = 0; row < 3; row++)
+        {
+            const float* pr = p + row * 3;
+            for (int col = 0; col < 3; col++)
+            {
+                tmp.rotation.v[row * 3 + col] = pr[0] * l[col] + pr[1] * l[3 + col] + pr[2] * l[6 + col];
+            }
+        }
+        tmp.translation.x = p[0] * t.x + p[1] * t.y + p[2] * t.z + parent.translation.x;
+        tmp.translation.y = p[3] * t.x + p[4] * t.y + p[5] * t.z + parent.translation.y;
+        tmp.translation.z = p[6] * t.x + p[7] * t.y + p[8] * t.z + parent.translation.z;
+        res = tmp;
+#endif
+    }
+
+  private:
+    struct TypeRule
+    {
+        const char* propertyName = nullptr;
+        const char* internedName = nullptr;
+        int32_t slot = -1;
+        TransformKind kind = TransformKind::Inherit;
+        bool resolved = false;
+    };
+
+    static int32_t findSlot(ArrayView<Property> props, const char* name)
+    {
+        for (size_t i = 0; i < props.size(); i++)
+        {
+            if (strcmp(props[i].getName(), name) == 0)
+            {
+                return int32_t(i);
+            }
+        }
+        return -1;
+    }
+
+    const CFrame* findLocal(const Instance& inst, TransformKind& kind) const
+    {
+        kind = TransformKind::Inherit;
+        uint32_t typeIndex = inst.getTypeIndex();
+        if (typeIndex >= rules.size())
+        {
+            return nullptr;
+        }
+
+        const TypeRule& rule = rules[typeIndex];
+        ArrayView<Property> props = inst.getProperties();
+        int32_t slot = rule.slot;
+        if (slot < 0 || size_t(slot) >= props.size() || props[slot].getName() != rule.internedName)
+        {
+            // layout differs from the rest of the type instances
+            slot = findSlot(props, rule.propertyName);
+            if (slot < 0)
+            {
+                return nullptr;
+            }
+        }
+
+        static const CFrame kMissing = kIdentity;
+        const CFrame& cf = props[slot].asCFrame(kMissing);
+        if (&cf == &kMissing)
+        {
+            // not a CFrame or an empty OptionalCFrame
+            return nullptr;
+        }
+
+        kind = rule.kind;
+        return &cf;
+    }
+
+    const Document& doc;
+    std::vector<TypeRule> rules;
+};
+
+void WorldTransforms::solve(const Document& doc, const TransformOptions& options)
+{
+    size_t numInstances = doc.getInstances().size();
+    transforms.resize(numInstances);
+    spatial.resize(numInstances);
+
+    TransformSolver solver(doc);
+
+    // breadth-first order, every level only depends on the previous one
+    std::vector<int32_t> order;
+    order.reserve(numInstances);
+    ArrayView<int32_t> roots = doc.getChildren(-1);
+    order.insert(order.end(), roots.begin(), roots.end());
+
+    size_t levelBegin = 0;
+    while (levelBegin < order.size())
+    {
+        size_t levelEnd = order.size();
+        for (size_t i = levelBegin; i < levelEnd; i++)
+        {
+            ArrayView<int32_t> children = doc.getChildren(order[i]);
+            order.insert(order.end(), children.begin(), children.end());
+        }
+
+        parallelFor(levelEnd - levelBegin, kMinBatchSize, options.numThreads, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+            {
+                solver.solve(*this, order[levelBegin + i]);
+            }
+        });
+
+        levelBegin = levelEnd;
+    }
+}
+
+void WorldTransforms::solveSubtree(const Document& doc, int32_t id)
+{
+    size_t numInstances = doc.getInstances().size();
+    transforms.resize(numInstances, kIdentity);
+    spatial.resize(numInstances, 0);
+
+    TransformSolver solver(doc);
+    for (int32_t subtreeId : doc.getSubtree(id))
+    {
+        solver.solve(*this, subtreeId);
+    }
+}
+
+ArrayView<CFrame> WorldTransforms::getTransforms() const { return ArrayView<CFrame>(transforms.begin(), transforms.end()); }
+
+const CFrame& WorldTransforms::getTransform(int32_t id) const
+{
+    if (id < 0 || size_t(id) >= transforms.size())
+    {
+        return kIdentity;
+    }
+    return transforms[id];
+}
+
+bool WorldTransforms::isSpatial(int32_t id) const
+{
+    if (id < 0 || size_t(id) >= spatial.size())
+    {
+        return false;
+    }
+    return spatial[id] != 0;
+}
+
+} // namespace rbxdoc
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "rbxdoc.h"
+
+namespace rbxdoc
+{
+
+struct TransformOptions
+{
+    // 0 = use all hardware threads
+    uint32_t numThreads = 0;
+};
+
+// Dense array of world-space transforms indexed by instance id
+//
+// Rotation matrices are row-major, a point is transformed as R * p + t
+// Transforms follow the engine rules:
+//  - Attachment and Bone CFrames are relative to the nearest spatial ancestor
+//  - any other instance with a CFrame property (parts, cameras, ...) is already in world space
+//  - Model uses its WorldPivotData (if set)
+//  - non-spatial instances (folders, scripts, ...) are skipped and inherit the transform of their nearest spatial ancestor
+class WorldTransforms
+{
+  public:
+    // computes transforms for the whole document, level by level over the hierarchy
+    void solve(const Document& doc, const TransformOptions& options = TransformOptions());
+
+    // recomputes transforms for a single subtree (the transform of its parent must be up to date)
+    // subtrees that do not overlap can be solved concurrently
+    void solveSubtree(const Document& doc, int32_t id);
+
+    ArrayView<CFrame> getTransforms() const;
+    const CFrame& getTransform(int32_t id) const;
+
+    // true if the instance has its own transform, false if it was inherited from an ancestor
+    bool isSpatial(int32_t id) const;
+
+  private:
+    std::vector<CFrame> transforms;
+    std::vector<uint8_t> spatial;
+
+    friend class TransformSolver;
+};
+
+} // namespace rbxdoc
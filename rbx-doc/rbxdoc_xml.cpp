@@ -0,0 +1,2081 @@
+#include <algorithm>
+#include <iterator>
+#include <math.h>
+#include <mutex>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+
+#include "rbxdoc.h"
+#include "rbxdoc_file.h"
+#include "rbxdoc_parallel.h"
+#include "rbxdoc_xml.h"
+
+namespace rbxdoc
+{
+
+// fragments smaller than this are not worth a thread
+static constexpr size_t kMinFragmentSize = 64 * 1024;
+// items scanned between checks of the cancellation flag
+static constexpr size_t kCancelCheckItems = 4096;
+
+struct XmlTag
+{
+    // position of '<'
+    const char* start = nullptr;
+    std::string_view name;
+    // raw attribute list of a start tag
+    std::string_view attributes;
+    bool isClosing = false;
+    bool isSelfClosing = false;
+};
+
+static inline bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+static inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+static std::string_view trim(std::string_view s)
+{
+    size_t first = 0;
+    size_t last = s.size();
+    while (first < last && isSpace(s[first]))
+    {
+        first++;
+    }
+    while (last > first && isSpace(s[last - 1]))
+    {
+        last--;
+    }
+    return s.substr(first, last - first);
+}
+
+// Forward-only tokenizer over a memory mapped buffer, tag names, attributes and character data are returned as views into the buffer
+class XmlCursor
+{
+  public:
+    XmlCursor(const char* _begin, const char* _end, const char* _pos)
+        : begin(_begin)
+        , end(_end)
+        , pos(_pos)
+    {
+    }
+
+    // advances to the next start or end tag, character data in front of it (including CDATA sections and comments) is returned in text
+    bool next(XmlTag& tag, std::string_view& text);
+    bool next(XmlTag& tag)
+    {
+        std::string_view text;
+        return next(tag, text);
+    }
+
+    // skips the content and the end tag of an element which start tag has just been read
+    bool skipElement(const XmlTag& tag);
+
+    // reads the character data of a leaf element which start tag has just been read, nested elements are skipped
+    bool readText(const XmlTag& tag, std::string_view& text);
+
+    // skips to the end of a Properties element without tokenizing the values
+    bool skipProperties();
+
+    // keeps the first error, the cursor stops at the end of the buffer
+    bool fail(LoadErrorCode code, const char* reason)
+    {
+        if (errorCode == LoadErrorCode::None)
+        {
+            errorCode = code;
+            errorReason = reason;
+            errorOffset = size_t(pos - begin);
+        }
+        pos = end;
+        return false;
+    }
+
+    const char* begin;
+    const char* end;
+    const char* pos;
+
+    LoadErrorCode errorCode = LoadErrorCode::None;
+    const char* errorReason = "";
+    size_t errorOffset = 0;
+
+  private:
+    // skips a CDATA section, comment, processing instruction or declaration at the current position
+    bool skipMarkup(bool& skipped);
+    bool skipPast(const char* from, std::string_view terminator);
+};
+
+bool XmlCursor::skipPast(const char* from, std::string_view terminator)
+{
+    std::string_view rest(from, size_t(end - from));
+    size_t at = rest.find(terminator);
+    if (at == std::string_view::npos)
+    {
+        return fail(LoadErrorCode::TruncatedData, "Unterminated markup");
+    }
+    pos = from + at + terminator.size();
+    return true;
+}
+
+bool XmlCursor::skipMarkup(bool& skipped)
+{
+    if (end - pos < 2 || (pos[1] != '!' && pos[1] != '?'))
+    {
+        skipped = false;
+        return true;
+    }
+
+    std::string_view rest(pos, size_t(end - pos));
+    skipped = true;
+    if (rest.compare(0, 9, "<![CDATA[") == 0)
+    {
+        return skipPast(pos + 9, "]]>");
+    }
+    if (rest.compare(0, 4, "<!--") == 0)
+    {
+        return skipPast(pos + 4, "-->");
+    }
+    // processing instructions and declarations
+    return skipPast(pos + 2, rest[1] == '?' ? "?>" : ">");
+}
+
+bool XmlCursor::next(XmlTag& tag, std::string_view& text)
+{
+    const char* textBegin = pos;
+    for (;;)
+    {
+        const char* lt = (pos < end) ? static_cast<const char*>(memchr(pos, '<', size_t(end - pos))) : nullptr;
+        if (!lt)
+        {
+            return fail(LoadErrorCode::TruncatedData, "Unexpected end of file");
+        }
+        pos = lt;
+
+        bool skipped;
+        if (!skipMarkup(skipped))
+        {
+            return false;
+        }
+        if (!skipped)
+        {
+            break;
+        }
+    }
+    text = std::string_view(textBegin, size_t(pos - textBegin));
+
+    tag = XmlTag();
+    tag.start = pos;
+    const char* p = pos + 1;
+    if (p < end && *p == '/')
+    {
+        tag.isClosing = true;
+        p++;
+    }
+
+    const char* nameBegin = p;
+    while (p < end && !isSpace(*p) && *p != '>' && *p != '/')
+    {
+        p++;
+    }
+    if (p == nameBegin)
+    {
+        return fail(LoadErrorCode::InvalidXml, "Invalid tag name");
+    }
+    tag.name = std::string_view(nameBegin, size_t(p - nameBegin));
+
+    // quoted attribute values may contain '>'
+    const char* attributesBegin = p;
+    while (p < end && *p != '>')
+    {
+        if (*p == '"' || *p == '\'')
+        {
+            const char* quote = static_cast<const char*>(memchr(p + 1, *p, size_t(end - p - 1)));
+            p = quote ? quote : end;
+            if (p == end)
+            {
+                break;
+            }
+        }
+        p++;
+    }
+    if (p >= end)
+    {
+        return fail(LoadErrorCode::TruncatedData, "Unterminated tag");
+    }
+
+    const char* attributesEnd = p;
+    if (attributesEnd > attributesBegin && attributesEnd[-1] == '/')
+    {
+        tag.isSelfClosing = !tag.isClosing;
+        attributesEnd--;
+    }
+    tag.attributes = std::string_view(attributesBegin, size_t(attributesEnd - attributesBegin));
+    pos = p + 1;
+    return true;
+}
+
+bool XmlCursor::skipElement(const XmlTag& tag)
+{
+    if (tag.isSelfClosing || tag.isClosing)
+    {
+        return true;
+    }
+
+    XmlTag child;
+    for (size_t depth = 1; depth > 0;)
+    {
+        if (!next(child))
+        {
+            return false;
+        }
+
+        if (child.isClosing)
+        {
+            depth--;
+        }
+        else if (!child.isSelfClosing)
+        {
+            depth++;
+        }
+    }
+    return true;
+}
+
+bool XmlCursor::readText(const XmlTag& tag, std::string_view& text)
+{
+    text = std::string_view();
+    if (tag.isSelfClosing)
+    {
+        return true;
+    }
+
+    XmlTag child;
+    if (!next(child, text))
+    {
+        return false;
+    }
+
+    while (!child.isClosing)
+    {
+        if (!skipElement(child) || !next(child))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool XmlCursor::skipProperties()
+{
+    static constexpr std::string_view kEndTag = "</Properties";
+    for (;;)
+    {
+        const char* lt = (pos < end) ? static_cast<const char*>(memchr(pos, '<', size_t(end - pos))) : nullptr;
+        if (!lt)
+        {
+            return fail(LoadErrorCode::TruncatedData, "Unexpected end of file");
+        }
+        pos = lt;
+
+        bool skipped;
+        if (!skipMarkup(skipped))
+        {
+            return false;
+        }
+        if (skipped)
+        {
+            continue;
+        }
+
+        std::string_view rest(pos, size_t(end - pos));
+        if (rest.compare(0, kEndTag.size(), kEndTag) == 0 && rest.size() > kEndTag.size() && (rest[kEndTag.size()] == '>' || isSpace(rest[kEndTag.size()])))
+        {
+            XmlTag tag;
+            return next(tag);
+        }
+        pos++;
+    }
+}
+
+static bool findAttribute(std::string_view attributes, std::string_view name, std::string_view& value)
+{
+    size_t size = attributes.size();
+    size_t i = 0;
+    while (i < size)
+    {
+        while (i < size && isSpace(attributes[i]))
+        {
+            i++;
+        }
+
+        size_t nameBegin = i;
+        while (i < size && attributes[i] != '=' && !isSpace(attributes[i]))
+        {
+            i++;
+        }
+        std::string_view attributeName = attributes.substr(nameBegin, i - nameBegin);
+
+        while (i < size && isSpace(attributes[i]))
+        {
+            i++;
+        }
+        if (i >= size || attributes[i] != '=')
+        {
+            return false;
+        }
+        i++;
+
+        while (i < size && isSpace(attributes[i]))
+        {
+            i++;
+        }
+        if (i >= size || (attributes[i] != '"' && attributes[i] != '\''))
+        {
+            return false;
+        }
+
+        char quote = attributes[i++];
+        size_t valueBegin = i;
+        while (i < size && attributes[i] != quote)
+        {
+            i++;
+        }
+        if (i >= size)
+        {
+            return false;
+        }
+
+        if (attributeName == name)
+        {
+            value = attributes.substr(valueBegin, i - valueBegin);
+            return true;
+        }
+        i++;
+    }
+    return false;
+}
+
+static bool needsDecoding(std::string_view text)
+{
+    return !text.empty() && (memchr(text.data(), '&', text.size()) || memchr(text.data(), '<', text.size()));
+}
+
+static void appendUtf8(std::string& out, uint32_t cp)
+{
+    if (cp < 0x80)
+    {
+        out.push_back(char(cp));
+    }
+    else if (cp < 0x800)
+    {
+        out.push_back(char(0xC0 | (cp >> 6)));
+        out.push_back(char(0x80 | (cp & 0x3F)));
+    }
+    else if (cp < 0x10000)
+    {
+        out.push_back(char(0xE0 | (cp >> 12)));
+        out.push_back(char(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(char(0x80 | (cp & 0x3F)));
+    }
+    else
+    {
+        out.push_back(char(0xF0 | ((cp >> 18) & 0x07)));
+        out.push_back(char(0x80 | ((cp >> 12) & 0x3F)));
+        out.push_back(char(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(char(0x80 | (cp & 0x3F)));
+    }
+}
+
+static bool decodeEntity(std::string_view entity, std::string& out)
+{
+    if (entity == "lt")
+    {
+        out.push_back('<');
+    }
+    else if (entity == "gt")
+    {
+        out.push_back('>');
+    }
+    else if (entity == "amp")
+    {
+        out.push_back('&');
+    }
+    else if (entity == "quot")
+    {
+        out.push_back('"');
+    }
+    else if (entity == "apos")
+    {
+        out.push_back('\'');
+    }
+    else if (entity.size() >= 2 && entity[0] == '#')
+    {
+        bool isHex = entity[1] == 'x' || entity[1] == 'X';
+        uint32_t cp = 0;
+        for (size_t i = isHex ? 2 : 1; i < entity.size(); i++)
+        {
+            char c = entity[i];
+            uint32_t digit;
+            if (isDigit(c))
+            {
+                digit = uint32_t(c - '0');
+            }
+            else if (isHex && c >= 'a' && c <= 'f')
+            {
+                digit = uint32_t(c - 'a' + 10);
+            }
+            else if (isHex && c >= 'A' && c <= 'F')
+            {
+                digit = uint32_t(c - 'A' + 10);
+            }
+            else
+            {
+                return false;
+            }
+            cp = cp * (isHex ? 16 : 10) + digit;
+            if (cp > 0x10FFFF)
+            {
+                return false;
+            }
+        }
+        appendUtf8(out, cp);
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+// Resolves entity and character references, copies CDATA sections verbatim and drops comments
+static void decodeText(std::string_view text, std::string& out)
+{
+    out.clear();
+    size_t i = 0;
+    while (i < text.size())
+    {
+        char c = text[i];
+        if (c == '<')
+        {
+            std::string_view rest = text.substr(i);
+            if (rest.compare(0, 9, "<![CDATA[") == 0)
+            {
+                size_t close = std::min(text.find("]]>", i + 9), text.size());
+                out.append(text.data() + i + 9, close - (i + 9));
+                i = std::min(close + 3, text.size());
+                continue;
+            }
+
+            const char* terminator = (rest.compare(0, 4, "<!--") == 0) ? "-->" : (rest.size() > 1 && rest[1] == '?') ? "?>" : ">";
+            size_t close = text.find(terminator, i + 1);
+            i = (close == std::string_view::npos) ? text.size() : close + strlen(terminator);
+            continue;
+        }
+
+        if (c == '&')
+        {
+            size_t semicolon = text.find(';', i + 1);
+            if (semicolon != std::string_view::npos && semicolon - i <= 12 && decodeEntity(text.substr(i + 1, semicolon - i - 1), out))
+            {
+                i = semicolon + 1;
+                continue;
+            }
+        }
+
+        out.push_back(c);
+        i++;
+    }
+}
+
+// copies character data into a pooled string
+static uint32_t poolText(ValuePool& pool, std::string_view text, std::string& scratch)
+{
+    if (needsDecoding(text))
+    {
+        decodeText(text, scratch);
+        text = scratch;
+    }
+
+    uint32_t index;
+    char* dst = pool.allocateString(text.size(), index);
+    if (!text.empty())
+    {
+        memcpy(dst, text.data(), text.size());
+    }
+    pool.internString(index);
+    return index;
+}
+
+struct Base64Table
+{
+    int8_t values[256];
+
+    constexpr Base64Table()
+        : values()
+    {
+        for (int i = 0; i < 256; i++)
+        {
+            values[i] = -1;
+        }
+        for (int i = 0; i < 26; i++)
+        {
+            values['A' + i] = int8_t(i);
+            values['a' + i] = int8_t(26 + i);
+        }
+        for (int i = 0; i < 10; i++)
+        {
+            values['0' + i] = int8_t(52 + i);
+        }
+        values[int('+')] = 62;
+        values[int('/')] = 63;
+    }
+};
+
+static constexpr Base64Table kBase64;
+
+// decodes base64 into a pooled string, whitespace and padding are skipped
+static uint32_t poolBase64(ValuePool& pool, std::string_view text)
+{
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(text.data());
+    const uint8_t* end = p + text.size();
+
+    size_t numDigits = 0;
+    for (const uint8_t* it = p; it < end; it++)
+    {
+        numDigits += (kBase64.values[*it] >= 0) ? 1 : 0;
+    }
+
+    uint32_t index;
+    char* out = pool.allocateString(numDigits * 6 / 8, index);
+
+    uint32_t acc = 0;
+    uint32_t bits = 0;
+    while (p < end)
+    {
+        // whole groups of four digits are decoded at once
+        if (bits == 0)
+        {
+            while (end - p >= 4)
+            {
+                int32_t a = kBase64.values[p[0]];
+                int32_t b = kBase64.values[p[1]];
+                int32_t c = kBase64.values[p[2]];
+                int32_t d = kBase64.values[p[3]];
+                if ((a | b | c | d) < 0)
+                {
+                    break;
+                }
+                uint32_t group = (uint32_t(a) << 18) | (uint32_t(b) << 12) | (uint32_t(c) << 6) | uint32_t(d);
+                out[0] = char(group >> 16);
+                out[1] = char(group >> 8);
+                out[2] = char(group);
+                out += 3;
+                p += 4;
+            }
+            if (p >= end)
+            {
+                break;
+            }
+        }
+
+        int32_t v = kBase64.values[*p++];
+        if (v < 0)
+        {
+            continue;
+        }
+        acc = (acc << 6) | uint32_t(v);
+        bits += 6;
+        if (bits >= 8)
+        {
+            bits -= 8;
+            *out++ = char(acc >> bits);
+            acc &= (1u << bits) - 1;
+        }
+    }
+    pool.internString(index);
+    return index;
+}
+
+static constexpr double kPow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+// Splits a plain decimal number into mantissa * 10^exponent, fails on anything else (inf, nan, hex, too many digits)
+static bool parseDecimal(std::string_view s, bool& negative, uint64_t& mantissa, int32_t& exponent)
+{
+    size_t i = 0;
+    negative = false;
+    if (i < s.size() && (s[i] == '-' || s[i] == '+'))
+    {
+        negative = s[i] == '-';
+        i++;
+    }
+
+    mantissa = 0;
+    exponent = 0;
+    bool hasDigits = false;
+    bool isFraction = false;
+    for (; i < s.size(); i++)
+    {
+        char c = s[i];
+        if (c == '.' && !isFraction)
+        {
+            isFraction = true;
+            continue;
+        }
+        if (!isDigit(c))
+        {
+            break;
+        }
+        if (mantissa > (UINT64_MAX - 9) / 10)
+        {
+            return false;
+        }
+        mantissa = mantissa * 10 + uint64_t(c - '0');
+        exponent -= isFraction ? 1 : 0;
+        hasDigits = true;
+    }
+
+    if (!hasDigits)
+    {
+        return false;
+    }
+
+    if (i < s.size() && (s[i] == 'e' || s[i] == 'E'))
+    {
+        i++;
+        bool negativeExponent = false;
+        if (i < s.size() && (s[i] == '-' || s[i] == '+'))
+        {
+            negativeExponent = s[i] == '-';
+            i++;
+        }
+
+        int32_t value = 0;
+        size_t first = i;
+        for (; i < s.size() && isDigit(s[i]); i++)
+        {
+            value = std::min(value * 10 + (s[i] - '0'), 100000);
+        }
+        if (i == first)
+        {
+            return false;
+        }
+        exponent += negativeExponent ? -value : value;
+    }
+    return i == s.size();
+}
+
+template <typename T> static bool parseNumberSlow(std::string_view s, T& value)
+{
+    char buffer[64];
+    if (s.empty() || s.size() >= sizeof(buffer))
+    {
+        return false;
+    }
+    memcpy(buffer, s.data(), s.size());
+    buffer[s.size()] = '\0';
+
+    char* last = nullptr;
+    value = std::is_same<T, float>::value ? T(strtof(buffer, &last)) : T(strtod(buffer, &last));
+    return last == buffer + s.size();
+}
+
+static bool parseDouble(std::string_view s, double& value)
+{
+    s = trim(s);
+
+    // exact mantissa and power of ten, a single correctly rounded operation
+    bool negative;
+    uint64_t mantissa;
+    int32_t exponent;
+    if (parseDecimal(s, negative, mantissa, exponent) && mantissa <= (uint64_t(1) << 53) && exponent >= -22 && exponent <= 22)
+    {
+        double d = double(mantissa);
+        d = (exponent < 0) ? d / kPow10[-exponent] : d * kPow10[exponent];
+        value = negative ? -d : d;
+        return true;
+    }
+    return parseNumberSlow(s, value);
+}
+
+static bool parseFloat(std::string_view s, float& value)
+{
+    double d;
+    if (!parseDouble(s, d))
+    {
+        return false;
+    }
+
+    value = float(d);
+    if (double(value) != d && !isinf(value) && !isnan(d))
+    {
+        // rounding twice only goes wrong if the double lands exactly between two floats
+        float other = nextafterf(value, d > double(value) ? INFINITY : -INFINITY);
+        if ((double(value) + double(other)) * 0.5 == d)
+        {
+            return parseNumberSlow(trim(s), value);
+        }
+    }
+    return true;
+}
+
+static bool parseUInt64(std::string_view s, uint64_t& value, bool& negative)
+{
+    s = trim(s);
+    size_t i = 0;
+    negative = false;
+    if (i < s.size() && (s[i] == '-' || s[i] == '+'))
+    {
+        negative = s[i] == '-';
+        i++;
+    }
+    if (i == s.size())
+    {
+        return false;
+    }
+
+    uint64_t v = 0;
+    for (; i < s.size(); i++)
+    {
+        if (!isDigit(s[i]))
+        {
+            return false;
+        }
+        v = v * 10 + uint64_t(s[i] - '0');
+    }
+    value = v;
+    return true;
+}
+
+// malformed numbers are read as zero
+static int64_t toInt64(std::string_view s)
+{
+    uint64_t v;
+    bool negative;
+    if (!parseUInt64(s, v, negative))
+    {
+        return 0;
+    }
+    return int64_t(negative ? 0 - v : v);
+}
+
+static float toFloat(std::string_view s)
+{
+    float v;
+    return parseFloat(s, v) ? v : 0.0f;
+}
+
+static bool readFloat(XmlCursor& cursor, const XmlTag& tag, float& value)
+{
+    std::string_view text;
+    if (!cursor.readText(tag, text))
+    {
+        return false;
+    }
+    value = toFloat(text);
+    return true;
+}
+
+template <typename T> static bool readInt(XmlCursor& cursor, const XmlTag& tag, T& value)
+{
+    std::string_view text;
+    if (!cursor.readText(tag, text))
+    {
+        return false;
+    }
+    value = T(toInt64(text));
+    return true;
+}
+
+// calls func(child) for every child element, func consumes the child element
+template <typename Func> static bool forEachChild(XmlCursor& cursor, const XmlTag& tag, const Func& func)
+{
+    if (tag.isSelfClosing)
+    {
+        return true;
+    }
+
+    XmlTag child;
+    for (;;)
+    {
+        if (!cursor.next(child))
+        {
+            return false;
+        }
+        if (child.isClosing)
+        {
+            return true;
+        }
+        if (!func(child))
+        {
+            return false;
+        }
+    }
+}
+
+// returns the component of X, Y, Z children
+template <typename T> static T* findComponent(std::string_view name, T& x, T& y, T& z)
+{
+    if (name.size() != 1)
+    {
+        return nullptr;
+    }
+    switch (name[0])
+    {
+    case 'X':
+        return &x;
+    case 'Y':
+        return &y;
+    case 'Z':
+        return &z;
+    default:
+        return nullptr;
+    }
+}
+
+static bool readVec3(XmlCursor& cursor, const XmlTag& tag, Vec3& v)
+{
+    v = Vec3{0.0f, 0.0f, 0.0f};
+    return forEachChild(cursor, tag, [&](const XmlTag& child) {
+        float* component = findComponent(child.name, v.x, v.y, v.z);
+        return component ? readFloat(cursor, child, *component) : cursor.skipElement(child);
+    });
+}
+
+static bool readVec2(XmlCursor& cursor, const XmlTag& tag, Vec2& v)
+{
+    float z = 0.0f;
+    v = Vec2{0.0f, 0.0f};
+    return forEachChild(cursor, tag, [&](const XmlTag& child) {
+        float* component = findComponent(child.name, v.x, v.y, z);
+        return component ? readFloat(cursor, child, *component) : cursor.skipElement(child);
+    });
+}
+
+static bool readCFrame(XmlCursor& cursor, const XmlTag& tag, CFrame& cf)
+{
+    cf = CFrame{Mat3x3{1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f}, Vec3{0.0f, 0.0f, 0.0f}};
+    return forEachChild(cursor, tag, [&](const XmlTag& child) {
+        // X, Y, Z and the row-major rotation R00 .. R22
+        std::string_view name = child.name;
+        float* component = findComponent(name, cf.translation.x, cf.translation.y, cf.translation.z);
+        if (!component && name.size() == 3 && name[0] == 'R' && name[1] >= '0' && name[1] <= '2' && name[2] >= '0' && name[2] <= '2')
+        {
+            component = &cf.rotation.v[(name[1] - '0') * 3 + (name[2] - '0')];
+        }
+        return component ? readFloat(cursor, child, *component) : cursor.skipElement(child);
+    });
+}
+
+// character data of an element or the text of its first <url> or <uri> child (ContentId and Font values)
+static bool readUrl(XmlCursor& cursor, const XmlTag& tag, std::string_view& url)
+{
+    url = std::string_view();
+    if (tag.isSelfClosing)
+    {
+        return true;
+    }
+
+    XmlTag child;
+    std::string_view text;
+    if (!cursor.next(child, text))
+    {
+        return false;
+    }
+    if (child.isClosing)
+    {
+        url = text;
+        return true;
+    }
+
+    for (;;)
+    {
+        if (child.name == "url" || child.name == "uri")
+        {
+            if (!cursor.readText(child, url))
+            {
+                return false;
+            }
+        }
+        else if (!cursor.skipElement(child))
+        {
+            return false;
+        }
+
+        if (!cursor.next(child))
+        {
+            return false;
+        }
+        if (child.isClosing)
+        {
+            return true;
+        }
+    }
+}
+
+// R, G, B children or a packed 0xAARRGGBB value (older files)
+static bool readColor3(XmlCursor& cursor, const XmlTag& tag, Color3& color)
+{
+    color = Color3{0.0f, 0.0f, 0.0f};
+    if (tag.isSelfClosing)
+    {
+        return true;
+    }
+
+    XmlTag child;
+    std::string_view text;
+    if (!cursor.next(child, text))
+    {
+        return false;
+    }
+    if (child.isClosing)
+    {
+        uint32_t packed = uint32_t(toInt64(text));
+        color = Color3{((packed >> 16) & 0xFF) / 255.0f, ((packed >> 8) & 0xFF) / 255.0f, (packed & 0xFF) / 255.0f};
+        return true;
+    }
+
+    for (;;)
+    {
+        float* component = nullptr;
+        if (child.name == "R")
+        {
+            component = &color.r;
+        }
+        else if (child.name == "G")
+        {
+            component = &color.g;
+        }
+        else if (child.name == "B")
+        {
+            component = &color.b;
+        }
+
+        if (!(component ? readFloat(cursor, child, *component) : cursor.skipElement(child)) || !cursor.next(child))
+        {
+            return false;
+        }
+        if (child.isClosing)
+        {
+            return true;
+        }
+    }
+}
+
+// whitespace separated numbers of NumberSequence, ColorSequence and NumberRange values
+static void readNumbers(std::string_view text, std::vector<float>& numbers)
+{
+    numbers.clear();
+    size_t i = 0;
+    while (i < text.size())
+    {
+        while (i < text.size() && isSpace(text[i]))
+        {
+            i++;
+        }
+        size_t first = i;
+        while (i < text.size() && !isSpace(text[i]))
+        {
+            i++;
+        }
+        if (i > first)
+        {
+            numbers.push_back(toFloat(text.substr(first, i - first)));
+        }
+    }
+}
+
+static bool parseHex(std::string_view s, uint64_t& value)
+{
+    value = 0;
+    for (char c : s)
+    {
+        uint64_t digit;
+        if (isDigit(c))
+        {
+            digit = uint64_t(c - '0');
+        }
+        else if (c >= 'a' && c <= 'f')
+        {
+            digit = uint64_t(c - 'a' + 10);
+        }
+        else if (c >= 'A' && c <= 'F')
+        {
+            digit = uint64_t(c - 'A' + 10);
+        }
+        else
+        {
+            return false;
+        }
+        value = (value << 4) | digit;
+    }
+    return true;
+}
+
+// 32 hex digits: random bits, timestamp and index
+static UniqueId parseUniqueId(std::string_view text)
+{
+    text = trim(text);
+    uint64_t rawbits;
+    uint64_t timestamp;
+    uint64_t index;
+    if (text.size() != 32 || !parseHex(text.substr(0, 16), rawbits) || !parseHex(text.substr(16, 8), timestamp) || !parseHex(text.substr(24, 8), index))
+    {
+        return UniqueId{0, 0, 0};
+    }
+    return UniqueId{uint32_t(index), uint32_t(timestamp), int64_t(rawbits)};
+}
+
+static PropertyType getXmlPropertyType(std::string_view tagName)
+{
+    static const std::unordered_map<std::string_view, PropertyType> kTypes = {
+        {"string", PropertyType::String},
+        {"ProtectedString", PropertyType::String},
+        {"BinaryString", PropertyType::String},
+        {"Content", PropertyType::String},
+        {"ContentId", PropertyType::String},
+        {"bool", PropertyType::Bool},
+        {"int", PropertyType::Int32},
+        {"int64", PropertyType::Int64},
+        {"float", PropertyType::Float},
+        {"double", PropertyType::Double},
+        {"token", PropertyType::Enum},
+        {"BrickColor", PropertyType::BrickColor},
+        {"Color3", PropertyType::Color3},
+        {"Color3uint8", PropertyType::UColor3},
+        {"Vector2", PropertyType::Vector2},
+        {"Vector3", PropertyType::Vector3},
+        {"Vector2int16", PropertyType::Vector2int16},
+        {"Vector3int16", PropertyType::Vector3int16},
+        {"CoordinateFrame", PropertyType::CFrameMatrix},
+        {"CFrame", PropertyType::CFrameMatrix},
+        {"OptionalCoordinateFrame", PropertyType::OptionalCFrame},
+        {"UDim", PropertyType::UDim},
+        {"UDim2", PropertyType::UDim2},
+        {"Ray", PropertyType::Ray},
+        {"Faces", PropertyType::Faces},
+        {"Axes", PropertyType::Axes},
+        {"NumberSequence", PropertyType::NumberSequence},
+        {"ColorSequence", PropertyType::ColorSequenceV1},
+        {"NumberRange", PropertyType::NumberRange},
+        {"Rect2D", PropertyType::Rect2D},
+        {"PhysicalProperties", PropertyType::PhysicalProperties},
+        {"Ref", PropertyType::Ref},
+        {"SharedString", PropertyType::SharedString},
+        {"UniqueId", PropertyType::UniqueId},
+        {"Font", PropertyType::Font},
+        {"SecurityCapabilities", PropertyType::SecurityCapabilities},
+    };
+
+    auto it = kTypes.find(tagName);
+    return (it != kTypes.end()) ? it->second : PropertyType::Unknown;
+}
+
+// Item of the first pass, ids are assigned in document order
+struct XmlItem
+{
+    int32_t parentId;
+    uint32_t typeIndex;
+    std::string_view referent;
+    // content of the Properties element, nullptr if the item has no properties
+    const char* properties;
+    bool isService;
+};
+
+// Property slot of a type, as seen by one fragment
+struct XmlSlot
+{
+    // raw name attribute and its decoded NUL terminated copy
+    std::string_view name;
+    const char* internedName;
+    std::string_view tag;
+    PropertyType type;
+};
+
+struct XmlLayout
+{
+    std::vector<XmlSlot> slots;
+    std::unordered_map<std::string_view, uint32_t> slotIndices;
+    // slot of the type layout for every fragment slot, -1 if the fragment slot has a conflicting type
+    std::vector<uint32_t> typeSlots;
+};
+
+struct XmlValue
+{
+    Property prop;
+    uint32_t slot;
+};
+
+// Property values of a range of items, decoded independently of other fragments
+struct XmlFragment
+{
+    size_t firstItem = 0;
+    size_t lastItem = 0;
+
+    ValuePool pool;
+    std::unordered_map<uint32_t, XmlLayout> layouts;
+    // type indices in order of the first appearance
+    std::vector<uint32_t> layoutOrder;
+
+    // values of item firstItem + i are values[itemValues[i] .. itemValues[i + 1]]
+    std::vector<XmlValue> values;
+    std::vector<uint32_t> itemValues;
+
+    // raw values of Ref and SharedString properties, resolved once all items are known
+    std::vector<std::string_view> referents;
+    std::vector<std::string_view> sharedKeys;
+
+    // offsets of the fragment pool entries in the document pool
+    uint32_t stringOffset = 0;
+    uint32_t cframeOffset = 0;
+    uint32_t optionalCFrameOffset = 0;
+    uint32_t physicalPropertiesOffset = 0;
+    uint32_t fontOffset = 0;
+    uint32_t numberSequenceOffset = 0;
+    uint32_t colorSequenceOffset = 0;
+    uint32_t rayOffset = 0;
+
+    std::vector<float> numbers;
+    std::string scratch;
+
+    LoadErrorCode errorCode = LoadErrorCode::None;
+    const char* errorReason = "";
+    size_t errorOffset = 0;
+};
+
+// Shared state of the last pass
+struct XmlContext
+{
+    const std::vector<XmlItem>* items;
+    // default property values of every type, used for properties missing on an instance
+    std::vector<std::vector<Property>> defaults;
+    std::unordered_map<std::string_view, int32_t> referents;
+    std::unordered_map<std::string_view, uint32_t> sharedStrings;
+    uint32_t emptyString;
+};
+
+bool XmlReader::scanItems(XmlCursor& cursor, bool isPlace, const LoadOptions& options, Document& doc, std::vector<XmlItem>& items,
+                          const char*& sharedStrings)
+{
+    if (cursor.end - cursor.pos >= 3 && memcmp(cursor.pos, "\xEF\xBB\xBF", 3) == 0)
+    {
+        cursor.pos += 3;
+    }
+
+    XmlTag tag;
+    if (!cursor.next(tag) || tag.isClosing || tag.name != "roblox")
+    {
+        cursor.errorCode = LoadErrorCode::None;
+        cursor.pos = cursor.begin;
+        return cursor.fail(LoadErrorCode::UnsupportedFormat, "Not a Roblox XML file");
+    }
+
+    if (tag.isSelfClosing)
+    {
+        return true;
+    }
+
+    std::unordered_map<std::string_view, uint32_t> typeIndices;
+    std::vector<int32_t> stack;
+    std::string_view lastClassName;
+    uint32_t lastTypeIndex = uint32_t(-1);
+    std::string className;
+    for (;;)
+    {
+        if (!cursor.next(tag))
+        {
+            return false;
+        }
+
+        if (tag.isClosing)
+        {
+            if (stack.empty())
+            {
+                // </roblox>
+                return true;
+            }
+            if (tag.name != "Item")
+            {
+                return cursor.fail(LoadErrorCode::InvalidXml, "Mismatched end tag");
+            }
+            stack.pop_back();
+            continue;
+        }
+
+        if (tag.name == "Item")
+        {
+            if (items.size() >= size_t(INT32_MAX))
+            {
+                return cursor.fail(LoadErrorCode::InvalidInstanceId, "Too many items");
+            }
+            if (items.size() % kCancelCheckItems == 0 && options.isCancelled())
+            {
+                return cursor.fail(LoadErrorCode::Cancelled, "Load cancelled");
+            }
+
+            std::string_view classAttribute;
+            std::string_view referent;
+            findAttribute(tag.attributes, "class", classAttribute);
+            findAttribute(tag.attributes, "referent", referent);
+
+            // siblings usually share the class
+            if (lastTypeIndex == uint32_t(-1) || classAttribute != lastClassName)
+            {
+                auto it = typeIndices.emplace(classAttribute, uint32_t(doc.types.size()));
+                if (it.second)
+                {
+                    decodeText(classAttribute, className);
+                    doc.types.emplace_back(std::string(className));
+                }
+                lastClassName = classAttribute;
+                lastTypeIndex = it.first->second;
+            }
+
+            items.push_back(XmlItem{stack.empty() ? -1 : stack.back(), lastTypeIndex, referent, nullptr, isPlace && stack.empty()});
+            if (!tag.isSelfClosing)
+            {
+                stack.push_back(int32_t(items.size() - 1));
+            }
+        }
+        else if (tag.name == "Properties" && !stack.empty() && !tag.isSelfClosing && !items[stack.back()].properties)
+        {
+            items[stack.back()].properties = cursor.pos;
+            if (!cursor.skipProperties())
+            {
+                return false;
+            }
+        }
+        else if (tag.name == "SharedStrings" && stack.empty())
+        {
+            sharedStrings = tag.start;
+            if (!cursor.skipElement(tag))
+            {
+                return false;
+            }
+        }
+        else if (!cursor.skipElement(tag))
+        {
+            return false;
+        }
+    }
+}
+
+bool XmlReader::readFragment(const char* begin, const char* end, const std::vector<XmlItem>& items, XmlFragment& fragment)
+{
+    fragment.itemValues.reserve(fragment.lastItem - fragment.firstItem + 1);
+
+    XmlLayout* layout = nullptr;
+    uint32_t layoutType = uint32_t(-1);
+    for (size_t i = fragment.firstItem; i < fragment.lastItem; i++)
+    {
+        fragment.itemValues.push_back(uint32_t(fragment.values.size()));
+
+        const XmlItem& item = items[i];
+        if (!item.properties)
+        {
+            continue;
+        }
+
+        if (item.typeIndex != layoutType)
+        {
+            auto it = fragment.layouts.emplace(item.typeIndex, XmlLayout());
+            if (it.second)
+            {
+                fragment.layoutOrder.push_back(item.typeIndex);
+            }
+            layout = &it.first->second;
+            layoutType = item.typeIndex;
+        }
+
+        XmlCursor cursor(begin, end, item.properties);
+        if (!readProperties(cursor, fragment, *layout))
+        {
+            fragment.errorCode = cursor.errorCode;
+            fragment.errorReason = cursor.errorReason;
+            fragment.errorOffset = cursor.errorOffset;
+            return false;
+        }
+    }
+    fragment.itemValues.push_back(uint32_t(fragment.values.size()));
+    return true;
+}
+
+bool XmlReader::readProperties(XmlCursor& cursor, XmlFragment& fragment, XmlLayout& layout)
+{
+    XmlTag tag;
+    for (size_t expectedSlot = 0;; expectedSlot++)
+    {
+        if (!cursor.next(tag))
+        {
+            return false;
+        }
+        if (tag.isClosing)
+        {
+            // </Properties>
+            return true;
+        }
+
+        std::string_view name;
+        if (!findAttribute(tag.attributes, "name", name))
+        {
+            if (!cursor.skipElement(tag))
+            {
+                return false;
+            }
+            continue;
+        }
+
+        // instances of a type usually list the same properties in the same order
+        uint32_t slot = uint32_t(-1);
+        if (expectedSlot < layout.slots.size() && layout.slots[expectedSlot].name == name && layout.slots[expectedSlot].tag == tag.name)
+        {
+            slot = uint32_t(expectedSlot);
+        }
+        else
+        {
+            PropertyType type = getXmlPropertyType(tag.name);
+            auto it = layout.slotIndices.find(name);
+            if (it != layout.slotIndices.end())
+            {
+                slot = (layout.slots[it->second].type == type) ? it->second : uint32_t(-1);
+            }
+            else if (type != PropertyType::Unknown)
+            {
+                decodeText(name, fragment.scratch);
+                const char* internedName = fragment.pool.internName(fragment.scratch.data(), fragment.scratch.size());
+
+                slot = uint32_t(layout.slots.size());
+                layout.slots.push_back(XmlSlot{name, internedName, tag.name, type});
+                layout.slotIndices.emplace(name, slot);
+            }
+        }
+
+        // unsupported values and values with a type that conflicts with the layout are skipped
+        if (slot == uint32_t(-1))
+        {
+            if (!cursor.skipElement(tag))
+            {
+                return false;
+            }
+            continue;
+        }
+
+        const XmlSlot& info = layout.slots[slot];
+        fragment.values.push_back(XmlValue{Property(info.internedName, info.type), slot});
+        if (!readValue(cursor, tag, fragment, fragment.values.back().prop))
+        {
+            return false;
+        }
+    }
+}
+
+bool XmlReader::readValue(XmlCursor& cursor, const XmlTag& tag, XmlFragment& fragment, Property& prop)
+{
+    ValuePool& pool = fragment.pool;
+    Property::Payload& data = prop.data;
+    std::string_view text;
+
+    switch (prop.type)
+    {
+    case PropertyType::String:
+    {
+        if (tag.name == "Content" || tag.name == "ContentId")
+        {
+            if (!readUrl(cursor, tag, text))
+            {
+                return false;
+            }
+            data.pooled = Property::PooledValue{&pool, poolText(pool, text, fragment.scratch)};
+            return true;
+        }
+
+        if (!cursor.readText(tag, text))
+        {
+            return false;
+        }
+        uint32_t index = (tag.name == "BinaryString") ? poolBase64(pool, text) : poolText(pool, text, fragment.scratch);
+        data.pooled = Property::PooledValue{&pool, index};
+        return true;
+    }
+    case PropertyType::Bool:
+        if (!cursor.readText(tag, text))
+        {
+            return false;
+        }
+        data.b = trim(text) == "true";
+        return true;
+    case PropertyType::Int32:
+        return readInt(cursor, tag, data.i32);
+    case PropertyType::Int64:
+        return readInt(cursor, tag, data.i64);
+    case PropertyType::Enum:
+        return readInt(cursor, tag, data.u32);
+    case PropertyType::SecurityCapabilities:
+        return readInt(cursor, tag, data.u64);
+    case PropertyType::BrickColor:
+        return readInt(cursor, tag, data.brickColor.index);
+    case PropertyType::Float:
+        return readFloat(cursor, tag, data.f);
+    case PropertyType::Double:
+        if (!cursor.readText(tag, text))
+        {
+            return false;
+        }
+        data.d = parseDouble(text, data.d) ? data.d : 0.0;
+        return true;
+    case PropertyType::Color3:
+        return readColor3(cursor, tag, data.color3);
+    case PropertyType::UColor3:
+    {
+        uint32_t packed;
+        if (!readInt(cursor, tag, packed))
+        {
+            return false;
+        }
+        data.color3 = Color3{((packed >> 16) & 0xFF) / 255.0f, ((packed >> 8) & 0xFF) / 255.0f, (packed & 0xFF) / 255.0f};
+        return true;
+    }
+    case PropertyType::Vector2:
+        return readVec2(cursor, tag, data.v2);
+    case PropertyType::Vector3:
+        return readVec3(cursor, tag, data.v3);
+    case PropertyType::Vector2int16:
+    case PropertyType::Vector3int16:
+    {
+        int16_t v[3] = {};
+        bool res = forEachChild(cursor, tag, [&](const XmlTag& child) {
+            int16_t* component = findComponent(child.name, v[0], v[1], v[2]);
+            return component ? readInt(cursor, child, *component) : cursor.skipElement(child);
+        });
+        if (prop.type == PropertyType::Vector2int16)
+        {
+            data.v2i16 = Vec2int16{v[0], v[1]};
+        }
+        else
+        {
+            data.v3i16 = Vec3int16{v[0], v[1], v[2]};
+        }
+        return res;
+    }
+    case PropertyType::UDim:
+        data.udim = UDim{0.0f, 0};
+        return forEachChild(cursor, tag, [&](const XmlTag& child) {
+            if (child.name == "S")
+            {
+                return readFloat(cursor, child, data.udim.scale);
+            }
+            if (child.name == "O")
+            {
+                return readInt(cursor, child, data.udim.offset);
+            }
+            return cursor.skipElement(child);
+        });
+    case PropertyType::UDim2:
+        data.udim2 = UDim2{0.0f, 0.0f, 0, 0};
+        return forEachChild(cursor, tag, [&](const XmlTag& child) {
+            if (child.name == "XS")
+            {
+                return readFloat(cursor, child, data.udim2.scaleX);
+            }
+            if (child.name == "YS")
+            {
+                return readFloat(cursor, child, data.udim2.scaleY);
+            }
+            if (child.name == "XO")
+            {
+                return readInt(cursor, child, data.udim2.offsetX);
+            }
+            if (child.name == "YO")
+            {
+                return readInt(cursor, child, data.udim2.offsetY);
+            }
+            return cursor.skipElement(child);
+        });
+    case PropertyType::Rect2D:
+    {
+        Vec2 corners[2] = {};
+        bool res = forEachChild(cursor, tag, [&](const XmlTag& child) {
+            if (child.name == "min" || child.name == "max")
+            {
+                return readVec2(cursor, child, corners[child.name == "max" ? 1 : 0]);
+            }
+            return cursor.skipElement(child);
+        });
+        data.rect2D = Rect2D{corners[0].x, corners[0].y, corners[1].x, corners[1].y};
+        return res;
+    }
+    case PropertyType::Ray:
+    {
+        Ray ray = {};
+        bool res = forEachChild(cursor, tag, [&](const XmlTag& child) {
+            if (child.name == "origin" || child.name == "direction")
+            {
+                return readVec3(cursor, child, child.name == "origin" ? ray.origin : ray.direction);
+            }
+            return cursor.skipElement(child);
+        });
+        data.pooled = Property::PooledValue{&pool, uint32_t(pool.rays.size())};
+        pool.rays.push_back(ray);
+        return res;
+    }
+    case PropertyType::Faces:
+    case PropertyType::Axes:
+    {
+        const char* maskName = (prop.type == PropertyType::Faces) ? "faces" : "axes";
+        data.u8 = 0;
+        return forEachChild(cursor, tag, [&](const XmlTag& child) { return (child.name == maskName) ? readInt(cursor, child, data.u8) : cursor.skipElement(child); });
+    }
+    case PropertyType::CFrameMatrix:
+    {
+        CFrame cf;
+        bool res = readCFrame(cursor, tag, cf);
+        data.pooled = Property::PooledValue{&pool, uint32_t(pool.cframes.size())};
+        pool.cframes.push_back(cf);
+        return res;
+    }
+    case PropertyType::OptionalCFrame:
+    {
+        OptionalCFrame ocf = {};
+        bool res = forEachChild(cursor, tag, [&](const XmlTag& child) {
+            if (child.name == "CFrame")
+            {
+                ocf.hasData = true;
+                return readCFrame(cursor, child, ocf.val);
+            }
+            return cursor.skipElement(child);
+        });
+        data.pooled = Property::PooledValue{&pool, uint32_t(pool.optionalCFrames.size())};
+        pool.optionalCFrames.push_back(ocf);
+        return res;
+    }
+    case PropertyType::PhysicalProperties:
+    {
+        bool isCustom = false;
+        PhysicalProperties pp;
+        bool res = forEachChild(cursor, tag, [&](const XmlTag& child) {
+            std::string_view name = child.name;
+            if (name == "CustomPhysics")
+            {
+                std::string_view value;
+                bool ok = cursor.readText(child, value);
+                isCustom = trim(value) == "true";
+                return ok;
+            }
+
+            float* component = (name == "Density")              ? &pp.density
+                               : (name == "Friction")           ? &pp.friction
+                               : (name == "Elasticity")         ? &pp.elasticity
+                               : (name == "FrictionWeight")     ? &pp.frictionWeight
+                               : (name == "ElasticityWeight")   ? &pp.elasticityWeight
+                               : (name == "AcousticAbsorption") ? &pp.acousticAbsorption
+                                                                : nullptr;
+            return component ? readFloat(cursor, child, *component) : cursor.skipElement(child);
+        });
+        data.pooled = Property::PooledValue{&pool, uint32_t(pool.physicalProperties.size())};
+        pool.physicalProperties.push_back(isCustom ? pp : PhysicalProperties());
+        return res;
+    }
+    case PropertyType::Font:
+    {
+        FontInfo font = {};
+        font.weight = 400;
+        std::string& scratch = fragment.scratch;
+        bool res = forEachChild(cursor, tag, [&](const XmlTag& child) {
+            std::string_view value;
+            if (child.name == "Family" || child.name == "CachedFaceId")
+            {
+                if (!readUrl(cursor, child, value))
+                {
+                    return false;
+                }
+                decodeText(value, scratch);
+                (child.name == "Family" ? font.family : font.cachedFaceId) = scratch;
+                return true;
+            }
+            if (child.name == "Weight")
+            {
+                return readInt(cursor, child, font.weight);
+            }
+            if (child.name == "Style")
+            {
+                if (!cursor.readText(child, value))
+                {
+                    return false;
+                }
+                font.style = (trim(value) == "Italic") ? 1 : 0;
+                return true;
+            }
+            return cursor.skipElement(child);
+        });
+        data.pooled = Property::PooledValue{&pool, uint32_t(pool.fonts.size())};
+        pool.fonts.push_back(std::move(font));
+        return res;
+    }
+    case PropertyType::NumberSequence:
+    {
+        if (!cursor.readText(tag, text))
+        {
+            return false;
+        }
+        readNumbers(text, fragment.numbers);
+
+        // time, value, envelope
+        size_t count = fragment.numbers.size() / 3;
+        uint32_t index;
+        NumberSeq::KeyValue* keys = pool.allocateNumberSequence(count, index);
+        for (size_t i = 0; i < count; i++)
+        {
+            const float* v = &fragment.numbers[i * 3];
+            keys[i] = NumberSeq::KeyValue{v[0], v[1], v[2]};
+        }
+        pool.internNumberSequence(index);
+        data.pooled = Property::PooledValue{&pool, index};
+        return true;
+    }
+    case PropertyType::ColorSequenceV1:
+    {
+        if (!cursor.readText(tag, text))
+        {
+            return false;
+        }
+        readNumbers(text, fragment.numbers);
+
+        // time, r, g, b, envelope
+        size_t count = fragment.numbers.size() / 5;
+        uint32_t index;
+        ColorSeq::KeyValue* keys = pool.allocateColorSequence(count, index);
+        for (size_t i = 0; i < count; i++)
+        {
+            const float* v = &fragment.numbers[i * 5];
+            keys[i] = ColorSeq::KeyValue{v[0], Color3{v[1], v[2], v[3]}, v[4]};
+        }
+        pool.internColorSequence(index);
+        data.pooled = Property::PooledValue{&pool, index};
+        return true;
+    }
+    case PropertyType::NumberRange:
+        if (!cursor.readText(tag, text))
+        {
+            return false;
+        }
+        readNumbers(text, fragment.numbers);
+        fragment.numbers.resize(2, 0.0f);
+        data.numberRange = NumberRange{fragment.numbers[0], fragment.numbers[1]};
+        return true;
+    case PropertyType::UniqueId:
+        if (!cursor.readText(tag, text))
+        {
+            return false;
+        }
+        data.uniqueId = parseUniqueId(text);
+        return true;
+    case PropertyType::Ref:
+        if (!cursor.readText(tag, text))
+        {
+            return false;
+        }
+        // index + 1 in the fragment referents, 0 for null
+        text = trim(text);
+        data.u32 = 0;
+        if (!text.empty() && text != "null")
+        {
+            fragment.referents.push_back(text);
+            data.u32 = uint32_t(fragment.referents.size());
+        }
+        return true;
+    case PropertyType::SharedString:
+        if (!cursor.readText(tag, text))
+        {
+            return false;
+        }
+        // index in the fragment shared keys
+        data.pooled = Property::PooledValue{nullptr, uint32_t(fragment.sharedKeys.size())};
+        fragment.sharedKeys.push_back(trim(text));
+        return true;
+    default:
+        return cursor.skipElement(tag);
+    }
+}
+
+template <typename T> static uint32_t appendPool(std::vector<T>& dst, std::vector<T>& src)
+{
+    uint32_t offset = uint32_t(dst.size());
+    dst.insert(dst.end(), std::make_move_iterator(src.begin()), std::make_move_iterator(src.end()));
+    src.clear();
+    return offset;
+}
+
+void XmlReader::placeProperties(const XmlContext& context, XmlFragment& fragment, Document& doc)
+{
+    ValuePool* pool = doc.pool.get();
+    const std::vector<XmlItem>& items = *context.items;
+
+    const XmlLayout* layout = nullptr;
+    uint32_t layoutType = uint32_t(-1);
+    for (size_t i = fragment.firstItem; i < fragment.lastItem; i++)
+    {
+        const XmlItem& item = items[i];
+        Instance& inst = doc.instances[i];
+        inst.properties = context.defaults[item.typeIndex];
+
+        uint32_t first = fragment.itemValues[i - fragment.firstItem];
+        uint32_t last = fragment.itemValues[i - fragment.firstItem + 1];
+        if (first == last)
+        {
+            continue;
+        }
+
+        if (item.typeIndex != layoutType)
+        {
+            layout = &fragment.layouts.find(item.typeIndex)->second;
+            layoutType = item.typeIndex;
+        }
+
+        for (uint32_t valueIndex = first; valueIndex < last; valueIndex++)
+        {
+            const XmlValue& value = fragment.values[valueIndex];
+            uint32_t slot = layout->typeSlots[value.slot];
+            if (slot == uint32_t(-1))
+            {
+                continue;
+            }
+
+            Property& dst = inst.properties[slot];
+            Property::Payload data = value.prop.data;
+            uint32_t& index = data.pooled.index;
+            switch (value.prop.type)
+            {
+            case PropertyType::Ref:
+            {
+                int32_t id = -1;
+                if (data.u32 != 0)
+                {
+                    auto it = context.referents.find(fragment.referents[data.u32 - 1]);
+                    id = (it != context.referents.end()) ? it->second : -1;
+                }
+                data.i32 = id;
+                break;
+            }
+            case PropertyType::SharedString:
+            {
+                auto it = context.sharedStrings.find(fragment.sharedKeys[index]);
+                data.pooled = Property::PooledValue{pool, (it != context.sharedStrings.end()) ? it->second : context.emptyString};
+                break;
+            }
+            case PropertyType::String:
+                data.pooled = Property::PooledValue{pool, index + fragment.stringOffset};
+                break;
+            case PropertyType::CFrameMatrix:
+                data.pooled = Property::PooledValue{pool, index + fragment.cframeOffset};
+                break;
+            case PropertyType::OptionalCFrame:
+                data.pooled = Property::PooledValue{pool, index + fragment.optionalCFrameOffset};
+                break;
+            case PropertyType::PhysicalProperties:
+                data.pooled = Property::PooledValue{pool, index + fragment.physicalPropertiesOffset};
+                break;
+            case PropertyType::Font:
+                data.pooled = Property::PooledValue{pool, index + fragment.fontOffset};
+                break;
+            case PropertyType::NumberSequence:
+                data.pooled = Property::PooledValue{pool, index + fragment.numberSequenceOffset};
+                break;
+            case PropertyType::ColorSequenceV1:
+                data.pooled = Property::PooledValue{pool, index + fragment.colorSequenceOffset};
+                break;
+            case PropertyType::Ray:
+                data.pooled = Property::PooledValue{pool, index + fragment.rayOffset};
+                break;
+            default:
+                break;
+            }
+            dst.data = data;
+        }
+    }
+}
+
+// Default value of a property missing on an instance, pooled defaults are shared by all such properties
+static uint32_t getDefaultIndex(ValuePool& pool, PropertyType type, std::vector<uint32_t>& cache)
+{
+    uint32_t& index = cache[size_t(type)];
+    if (index != uint32_t(-1))
+    {
+        return index;
+    }
+
+    switch (type)
+    {
+    case PropertyType::String:
+    case PropertyType::SharedString:
+        pool.allocateString(0, index);
+        break;
+    case PropertyType::NumberSequence:
+        pool.allocateNumberSequence(0, index);
+        break;
+    case PropertyType::ColorSequenceV1:
+        pool.allocateColorSequence(0, index);
+        break;
+    default:
+        index = 0;
+        break;
+    }
+    return index;
+}
+
+LoadResult XmlReader::loadXml(const char* fileName, Document& doc, const LoadOptions& options)
+{
+    doc.clear();
+    doc.loadError = LoadError();
+
+    auto fail = [&doc](LoadErrorCode code, const char* reason, size_t offset) {
+        // do not expose a partially decoded document
+        doc.clear();
+        doc.buildHierarchy(std::vector<int32_t>());
+        doc.loadError.code = code;
+        doc.loadError.reason = reason;
+        doc.loadError.offset = offset;
+        return LoadResult::Error;
+    };
+
+    MappedFile file;
+    if (!file.open(fileName))
+    {
+        return fail(LoadErrorCode::FileReadFailed, "Failed to open file", 0);
+    }
+
+    const char* begin = reinterpret_cast<const char*>(file.data());
+    const char* end = begin + file.size();
+    if (file.size() == 0)
+    {
+        return fail(LoadErrorCode::UnsupportedFormat, "Not a Roblox XML file", 0);
+    }
+
+    // rbxlx top-level items are services
+    size_t nameLength = strlen(fileName);
+    bool isPlace = nameLength >= 2 && (fileName[nameLength - 2] == 'l' || fileName[nameLength - 2] == 'L');
+
+    // first pass: item hierarchy, types and referents
+    std::vector<XmlItem> items;
+    const char* sharedStringsTag = nullptr;
+    XmlCursor cursor(begin, end, begin);
+    if (!scanItems(cursor, isPlace, options, doc, items, sharedStringsTag))
+    {
+        return fail(cursor.errorCode, cursor.errorReason, cursor.errorOffset);
+    }
+
+    // second pass: property values of item ranges of a similar size in bytes
+    uint32_t numThreads = resolveThreadCount(0);
+    size_t fragmentSize = std::max(kMinFragmentSize, file.size() / (size_t(numThreads) * 4));
+    std::vector<size_t> fragmentStarts(1, 0);
+    // file offsets of the fragments (for progress reports)
+    std::vector<size_t> fragmentOffsets(1, 0);
+    const char* fragmentEnd = begin + fragmentSize;
+    for (size_t i = 0; i < items.size(); i++)
+    {
+        if (items[i].properties && items[i].properties >= fragmentEnd && i > fragmentStarts.back())
+        {
+            fragmentStarts.push_back(i);
+            fragmentOffsets.push_back(size_t(items[i].properties - begin));
+            fragmentEnd = items[i].properties + fragmentSize;
+        }
+    }
+    fragmentOffsets.push_back(file.size());
+
+    std::vector<XmlFragment> fragments(fragmentStarts.size());
+    for (size_t i = 0; i < fragments.size(); i++)
+    {
+        fragments[i].firstItem = fragmentStarts[i];
+        fragments[i].lastItem = (i + 1 < fragments.size()) ? fragmentStarts[i + 1] : items.size();
+        fragments[i].pool.store = doc.pool->store;
+    }
+
+    std::mutex progressMutex;
+    LoadProgress progress;
+    progress.bytesTotal = file.size();
+
+    parallelFor(fragments.size(), 1, numThreads, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; i++)
+        {
+            if (options.isCancelled())
+            {
+                fragments[i].errorCode = LoadErrorCode::Cancelled;
+                fragments[i].errorReason = "Load cancelled";
+                continue;
+            }
+
+            readFragment(begin, end, items, fragments[i]);
+            if (options.onProgress)
+            {
+                std::lock_guard<std::mutex> lock(progressMutex);
+                progress.bytesProcessed += fragmentOffsets[i + 1] - fragmentOffsets[i];
+                progress.chunksProcessed++;
+                options.onProgress(progress);
+            }
+        }
+    });
+
+    for (const XmlFragment& fragment : fragments)
+    {
+        if (fragment.errorCode != LoadErrorCode::None)
+        {
+            return fail(fragment.errorCode, fragment.errorReason, fragment.errorOffset);
+        }
+    }
+
+    ValuePool& pool = *doc.pool;
+
+    // type layouts in order of the first appearance in the file, values are merged into the document pool
+    std::vector<std::unordered_map<std::string_view, uint32_t>> typeSlots(doc.types.size());
+    bool hasRefs = false;
+    for (XmlFragment& fragment : fragments)
+    {
+        for (uint32_t typeIndex : fragment.layoutOrder)
+        {
+            Type& type = doc.types[typeIndex];
+            XmlLayout& layout = fragment.layouts[typeIndex];
+            layout.typeSlots.reserve(layout.slots.size());
+            for (const XmlSlot& slot : layout.slots)
+            {
+                auto it = typeSlots[typeIndex].emplace(slot.name, uint32_t(type.properties.size()));
+                if (it.second)
+                {
+                    type.properties.push_back(PropertyInfo{slot.internedName, slot.type});
+                }
+                bool isSameType = type.properties[it.first->second].type == slot.type;
+                layout.typeSlots.push_back(isSameType ? it.first->second : uint32_t(-1));
+            }
+        }
+
+        ValuePool& src = fragment.pool;
+        fragment.stringOffset = appendPool(pool.strings, src.strings);
+        fragment.cframeOffset = appendPool(pool.cframes, src.cframes);
+        fragment.optionalCFrameOffset = appendPool(pool.optionalCFrames, src.optionalCFrames);
+        fragment.physicalPropertiesOffset = appendPool(pool.physicalProperties, src.physicalProperties);
+        fragment.fontOffset = appendPool(pool.fonts, src.fonts);
+        fragment.numberSequenceOffset = appendPool(pool.numberSequences, src.numberSequences);
+        fragment.colorSequenceOffset = appendPool(pool.colorSequences, src.colorSequences);
+        fragment.rayOffset = appendPool(pool.rays, src.rays);
+
+        // memory blocks never move, the document pool keeps filling its own last block
+        pool.blocks.insert(pool.blocks.begin(), std::make_move_iterator(src.blocks.begin()), std::make_move_iterator(src.blocks.end()));
+        src.blocks.clear();
+        pool.internedValues.insert(pool.internedValues.end(), src.internedValues.begin(), src.internedValues.end());
+        src.internedValues.clear();
+
+        hasRefs = hasRefs || !fragment.referents.empty();
+    }
+
+    XmlContext context;
+    context.items = &items;
+
+    uint32_t emptyString;
+    pool.allocateString(0, emptyString);
+    context.emptyString = emptyString;
+
+    if (sharedStringsTag)
+    {
+        // <SharedString md5="key">base64</SharedString>
+        XmlCursor sharedCursor(begin, end, sharedStringsTag);
+        XmlTag tag;
+        bool res = sharedCursor.next(tag) && forEachChild(sharedCursor, tag, [&](const XmlTag& child) {
+            std::string_view key;
+            std::string_view text;
+            if (child.name != "SharedString" || !findAttribute(child.attributes, "md5", key))
+            {
+                return sharedCursor.skipElement(child);
+            }
+            if (!sharedCursor.readText(child, text))
+            {
+                return false;
+            }
+            uint32_t index = poolBase64(pool, text);
+            pool.sharedStrings.push_back(index);
+            context.sharedStrings.emplace(key, index);
+            return true;
+        });
+        if (!res)
+        {
+            return fail(sharedCursor.errorCode, sharedCursor.errorReason, sharedCursor.errorOffset);
+        }
+    }
+
+    if (hasRefs)
+    {
+        context.referents.reserve(items.size());
+        for (size_t i = 0; i < items.size(); i++)
+        {
+            if (!items[i].referent.empty())
+            {
+                context.referents.emplace(items[i].referent, int32_t(i));
+            }
+        }
+    }
+
+    std::vector<uint32_t> defaultIndices(size_t(PropertyType::Content) + 1, uint32_t(-1));
+    context.defaults.resize(doc.types.size());
+    for (size_t typeIndex = 0; typeIndex < doc.types.size(); typeIndex++)
+    {
+        std::vector<Property>& defaults = context.defaults[typeIndex];
+        for (const PropertyInfo& info : doc.types[typeIndex].properties)
+        {
+            defaults.push_back(Property(info.name, info.type));
+            Property& prop = defaults.back();
+            switch (info.type)
+            {
+            case PropertyType::Ref:
+                prop.data.i32 = -1;
+                break;
+            case PropertyType::CFrameMatrix:
+                prop.data.pooled = Property::PooledValue{&pool, uint32_t(pool.cframes.size())};
+                pool.cframes.push_back(CFrame{Mat3x3{1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f}, Vec3{0.0f, 0.0f, 0.0f}});
+                break;
+            case PropertyType::OptionalCFrame:
+                prop.data.pooled = Property::PooledValue{&pool, uint32_t(pool.optionalCFrames.size())};
+                pool.optionalCFrames.push_back(OptionalCFrame{CFrame{}, false});
+                break;
+            case PropertyType::PhysicalProperties:
+                prop.data.pooled = Property::PooledValue{&pool, uint32_t(pool.physicalProperties.size())};
+                pool.physicalProperties.push_back(PhysicalProperties());
+                break;
+            case PropertyType::Font:
+                prop.data.pooled = Property::PooledValue{&pool, uint32_t(pool.fonts.size())};
+                pool.fonts.push_back(FontInfo());
+                break;
+            case PropertyType::Ray:
+                prop.data.pooled = Property::PooledValue{&pool, uint32_t(pool.rays.size())};
+                pool.rays.push_back(Ray{});
+                break;
+            case PropertyType::String:
+            case PropertyType::SharedString:
+            case PropertyType::NumberSequence:
+            case PropertyType::ColorSequenceV1:
+                prop.data.pooled = Property::PooledValue{&pool, getDefaultIndex(pool, info.type, defaultIndices)};
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    doc.instances.resize(items.size());
+    for (size_t i = 0; i < items.size(); i++)
+    {
+        const XmlItem& item = items[i];
+        doc.instances[i] = Instance(item.parentId, int32_t(i), item.typeIndex, item.isService, item.isService);
+        doc.types[item.typeIndex].instanceIds.push_back(int32_t(i));
+    }
+
+    parallelFor(fragments.size(), 1, numThreads, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; i++)
+        {
+            placeProperties(context, fragments[i], doc);
+        }
+    });
+
+    // ids follow the document order, so children are already in the file order
+    doc.buildHierarchy(std::vector<int32_t>());
+    return LoadResult::OK;
+}
+
+} // namespace rbxdoc
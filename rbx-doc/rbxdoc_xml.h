@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+namespace rbxdoc
+{
+struct XmlTag;
+struct XmlItem;
+struct XmlLayout;
+struct XmlFragment;
+struct XmlContext;
+class XmlCursor;
+
+enum class LoadResult;
+struct LoadOptions;
+enum class PropertyType : uint8_t;
+class Document;
+class Property;
+
+// Streaming reader of XML files (.rbxmx, .rbxlx)
+// The file is tokenized in place over a memory mapped buffer in two passes: the first pass collects the item hierarchy and skips
+// property values, the second pass decodes the property values of item ranges in parallel. Values are decoded into the same
+// Document structures as binary files: properties missing on some instances of a type get default values, so that all
+// instances of a type share one property layout.
+class XmlReader
+{
+    static bool scanItems(XmlCursor& cursor, bool isPlace, const LoadOptions& options, Document& doc, std::vector<XmlItem>& items,
+                          const char*& sharedStrings);
+    static bool readFragment(const char* begin, const char* end, const std::vector<XmlItem>& items, XmlFragment& fragment);
+    static bool readProperties(XmlCursor& cursor, XmlFragment& fragment, XmlLayout& layout);
+    static bool readValue(XmlCursor& cursor, const XmlTag& tag, XmlFragment& fragment, Property& prop);
+    static void placeProperties(const XmlContext& context, XmlFragment& fragment, Document& doc);
+
+  public:
+    static LoadResult loadXml(const char* fileName, Document& doc, const LoadOptions& options);
+};
+
+} // namespace rbxdoc
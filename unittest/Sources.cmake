@@ -1,6 +1,32 @@
 set(TEST-SOURCES
     unittest/main.cpp
+    unittest/test.cpp
+    unittest/test_assets.cpp
+    unittest/test_async.cpp
+    unittest/test_cframe.cpp
+    unittest/test_decoders.cpp
+    unittest/test_diff.cpp
+    unittest/test_export.cpp
+    unittest/test_extract.cpp
+    unittest/test_hash.cpp
+    unittest/test_hierarchy.cpp
+    unittest/test_intern.cpp
+    unittest/test_load.cpp
+    unittest/test_merge.cpp
+    unittest/test_mesh.cpp
+    unittest/test_names.cpp
+    unittest/test_property.cpp
+    unittest/test_query.cpp
+    unittest/test_references.cpp
+    unittest/test_reload.cpp
+    unittest/test_renumber.cpp
+    unittest/test_snapshot.cpp
+    unittest/test_spatial.cpp
+    unittest/test_transform.cpp
+    unittest/test_xml.cpp
     )
 
 set(TEST-HEADERS
+    unittest/test.h
+    unittest/test_rbxm.h
     )
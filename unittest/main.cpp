@@ -1,14 +1,21 @@
 #include <assert.h>
 #include <cstdio>
 #include <rbxdoc.h>
+#include <string>
 
-int main()
+#include "test.h"
+
+// usage: rbxdoc-test [data directory], the default works from the unittest directory
+int main(int argc, char** argv)
 {
+    const char* dataDir = (argc > 1) ? argv[1] : "../data";
+
     rbxdoc::Document doc;
-    rbxdoc::LoadResult res = doc.loadFile("../data/test.rbxm");
+    rbxdoc::LoadResult res = doc.loadFile((std::string(dataDir) + "/test.rbxm").c_str());
     if (res != rbxdoc::LoadResult::OK)
     {
-        printf("Can't load file\n");
+        const rbxdoc::LoadError& err = doc.getLoadError();
+        printf("Can't load file: %s (chunk %d '%s', offset %zu)\n", err.reason, err.chunkIndex, err.chunkName, err.offset);
         return -1;
     }
 
@@ -68,5 +75,5 @@ int main()
         }
     }
 
-    return 0;
+    return (rbxdoc_test::runTests(dataDir) == 0) ? 0 : -1;
 }
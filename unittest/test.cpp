@@ -0,0 +1,89 @@
+#include <cstdio>
+#include <filesystem>
+#include <rbxdoc_diff.h>
+#include <string.h>
+#include <vector>
+
+#include "test.h"
+
+namespace rbxdoc_test
+{
+
+struct TestCase
+{
+    const char* name;
+    TestFunc func;
+};
+
+static std::vector<TestCase>& getTests()
+{
+    static std::vector<TestCase> tests;
+    return tests;
+}
+
+static std::string dataDirectory = "../data";
+static int numFailures = 0;
+
+TestRegistrar::TestRegistrar(const char* name, TestFunc func) { getTests().push_back(TestCase{name, func}); }
+
+void reportFailure(const char* file, int line, const char* expression)
+{
+    printf("%s(%d): CHECK failed: %s\n", file, line, expression);
+    numFailures++;
+}
+
+int runTests(const char* dataDir)
+{
+    dataDirectory = dataDir;
+
+    int failedTests = 0;
+    for (const TestCase& test : getTests())
+    {
+        int failuresBefore = numFailures;
+        test.func();
+        if (numFailures != failuresBefore)
+        {
+            printf("FAILED: %s\n", test.name);
+            failedTests++;
+        }
+    }
+    printf("Tests: %zu, failed: %d\n", getTests().size(), failedTests);
+    return failedTests;
+}
+
+std::string getDataPath(const char* fileName) { return dataDirectory + "/" + fileName; }
+
+std::string getTempPath(const char* fileName) { return (std::filesystem::temp_directory_path() / fileName).string(); }
+
+int32_t findInstance(const rbxdoc::Document& doc, const char* className, const char* name)
+{
+    for (const rbxdoc::Instance& inst : doc.getInstances())
+    {
+        if (inst.getTypeIndex() >= doc.getTypes().size() || strcmp(doc.getTypeName(inst), className) != 0)
+        {
+            continue;
+        }
+        const rbxdoc::Property* prop = findProperty(doc, inst.getId(), "Name");
+        if (prop && strcmp(prop->asString(), name) == 0)
+        {
+            return inst.getId();
+        }
+    }
+    return -1;
+}
+
+const rbxdoc::Property* findProperty(const rbxdoc::Document& doc, int32_t id, const char* propertyName)
+{
+    for (const rbxdoc::Property& prop : doc.getInstances()[id].getProperties())
+    {
+        if (strcmp(prop.getName(), propertyName) == 0)
+        {
+            return &prop;
+        }
+    }
+    return nullptr;
+}
+
+size_t countDifferences(const rbxdoc::Document& oldDoc, const rbxdoc::Document& newDoc) { return rbxdoc::diff(oldDoc, newDoc).getRecords().size(); }
+
+} // namespace rbxdoc_test
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <rbxdoc.h>
+#include <string>
+
+// Minimal assert-style test registry
+// Tests register themselves with TEST_CASE, main() runs them all after the demo output. A failed CHECK reports the expression and keeps
+// the test running, a failed REQUIRE also leaves the test (use it when the rest of the test depends on the checked condition).
+namespace rbxdoc_test
+{
+
+using TestFunc = void (*)();
+
+struct TestRegistrar
+{
+    TestRegistrar(const char* name, TestFunc func);
+};
+
+void reportFailure(const char* file, int line, const char* expression);
+
+// runs all registered tests, returns the number of failed tests
+int runTests(const char* dataDir);
+
+// path of a file in the data directory of the repository
+std::string getDataPath(const char* fileName);
+// path of a scratch file in the temp directory
+std::string getTempPath(const char* fileName);
+
+// first instance of a class with a given Name, -1 if there is none
+int32_t findInstance(const rbxdoc::Document& doc, const char* className, const char* name);
+// property of an instance, nullptr if the instance has no such property
+const rbxdoc::Property* findProperty(const rbxdoc::Document& doc, int32_t id, const char* propertyName);
+// number of records of rbxdoc::diff() between two documents, 0 if they have the same content
+size_t countDifferences(const rbxdoc::Document& oldDoc, const rbxdoc::Document& newDoc);
+
+inline bool isNear(float a, float b, float epsilon = 0.01f) { return a - b <= epsilon && b - a <= epsilon; }
+
+} // namespace rbxdoc_test
+
+#define TEST_CASE(name)                                                                                                                      \
+    static void name();                                                                                                                      \
+    static rbxdoc_test::TestRegistrar name##Registrar(#name, &name);                                                                         \
+    static void name()
+
+#define CHECK(expression)                                                                                                                    \
+    do                                                                                                                                       \
+    {                                                                                                                                        \
+        if (!(expression))                                                                                                                   \
+        {                                                                                                                                    \
+            rbxdoc_test::reportFailure(__FILE__, __LINE__, #expression);                                                                     \
+        }                                                                                                                                    \
+    } while (false)
+
+#define REQUIRE(expression)                                                                                                                  \
+    do                                                                                                                                       \
+    {                                                                                                                                        \
+        if (!(expression))                                                                                                                   \
+        {                                                                                                                                    \
+            rbxdoc_test::reportFailure(__FILE__, __LINE__, #expression);                                                                     \
+            return;                                                                                                                          \
+        }                                                                                                                                    \
+    } while (false)
@@ -0,0 +1,76 @@
+#include <rbxdoc_assets.h>
+#include <string.h>
+#include <set>
+#include <string>
+
+#include "test.h"
+
+using namespace rbxdoc;
+
+static std::string makeKey(int32_t id, const char* propertyName, const char* url, size_t urlLength)
+{
+    return std::to_string(id) + " " + propertyName + " " + std::string(url, urlLength);
+}
+
+TEST_CASE(AssetScannerMatchesLoadedDocument)
+{
+    std::string fileName = rbxdoc_test::getDataPath("test.rbxm");
+    AssetScanner scanner;
+    std::set<std::string> scanned;
+    size_t numCallbacks = 0;
+    LoadResult res = scanner.scanFile(fileName.c_str(), [&](const AssetReference& ref) {
+        numCallbacks++;
+        scanned.insert(makeKey(ref.instanceId, ref.propertyName, ref.url, ref.urlLength));
+    });
+    REQUIRE(res == LoadResult::OK);
+
+    Document doc;
+    REQUIRE(doc.loadFile(fileName.c_str()) == LoadResult::OK);
+    std::set<std::string> expected;
+    for (int32_t id = 0; id < int32_t(doc.getInstances().size()); id++)
+    {
+        for (const Property& prop : doc.getInstances()[id].getProperties())
+        {
+            bool isAsset = (prop.getType() == PropertyType::String && scanner.isAssetProperty(prop.getName(), strlen(prop.getName()))) ||
+                           (prop.getType() == PropertyType::Content && prop.asContentSourceType() == ContentSourceType::Uri);
+            ArrayView<char> url = prop.asBytes();
+            if (isAsset && url.size() != 0)
+            {
+                expected.insert(makeKey(id, prop.getName(), url.data(), url.size()));
+            }
+        }
+    }
+
+    CHECK(!expected.empty());
+    CHECK(numCallbacks == expected.size());
+    CHECK(scanned == expected);
+
+    int32_t door = rbxdoc_test::findInstance(doc, "MeshPart", "LF_door");
+    REQUIRE(door >= 0);
+    CHECK(scanned.count(makeKey(door, "MeshId", "rbxassetid://12410981119", strlen("rbxassetid://12410981119"))) == 1);
+}
+
+TEST_CASE(AssetScannerUsesPropertyNames)
+{
+    const char* names[] = {"TextureID"};
+    AssetScanner scanner;
+    scanner.setPropertyNames(names, 1);
+    CHECK(scanner.isAssetProperty("TextureID", strlen("TextureID")));
+    CHECK(!scanner.isAssetProperty("MeshId", strlen("MeshId")));
+
+    size_t numMeshIds = 0;
+    LoadResult res = scanner.scanFile(rbxdoc_test::getDataPath("test.rbxm").c_str(), [&](const AssetReference& ref) {
+        numMeshIds += (strcmp(ref.propertyName, "MeshId") == 0) ? 1 : 0;
+    });
+    CHECK(res == LoadResult::OK);
+    CHECK(numMeshIds == 0);
+}
+
+TEST_CASE(AssetScannerReportsMissingFile)
+{
+    AssetScanner scanner;
+    size_t numCallbacks = 0;
+    LoadResult res = scanner.scanFile(rbxdoc_test::getTempPath("missing.rbxm").c_str(), [&](const AssetReference&) { numCallbacks++; });
+    CHECK(res != LoadResult::OK);
+    CHECK(numCallbacks == 0);
+}
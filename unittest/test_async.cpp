@@ -0,0 +1,108 @@
+#include <atomic>
+#include <memory>
+#include <rbxdoc_async.h>
+#include <rbxdoc_export.h>
+#include <string.h>
+#include <string>
+
+#include "test.h"
+
+using namespace rbxdoc;
+
+static LoadOptions makeCancelledOptions()
+{
+    LoadOptions options;
+    options.cancel = std::make_shared<std::atomic<bool>>(true);
+    return options;
+}
+
+static void checkCancelled(const Document& doc)
+{
+    CHECK(doc.getLoadError().code == LoadErrorCode::Cancelled);
+    CHECK(strcmp(doc.getLoadError().reason, "Load cancelled") == 0);
+}
+
+TEST_CASE(LoadWithCancelledFlagFails)
+{
+    std::string binaryName = rbxdoc_test::getDataPath("test.rbxm");
+    Document doc;
+    CHECK(doc.loadFile(binaryName.c_str(), makeCancelledOptions()) == LoadResult::Error);
+    checkCancelled(doc);
+
+    // XML files check the flag while scanning items
+    Document source;
+    REQUIRE(source.loadFile(binaryName.c_str()) == LoadResult::OK);
+    OutputBuffer out;
+    Exporter::exportXml(source, out, -1);
+    std::string xmlName = rbxdoc_test::getTempPath("rbxdoc_cancel.rbxmx");
+    REQUIRE(out.writeFile(xmlName.c_str()));
+    CHECK(doc.loadFile(xmlName.c_str(), makeCancelledOptions()) == LoadResult::Error);
+    checkCancelled(doc);
+
+    // a cleared flag does not affect the load
+    LoadOptions options = makeCancelledOptions();
+    options.cancel->store(false);
+    CHECK(doc.loadFile(binaryName.c_str(), options) == LoadResult::OK);
+    CHECK(doc.getInstances().size() == source.getInstances().size());
+}
+
+TEST_CASE(LoadCancelledFromProgress)
+{
+    LoadOptions options;
+    options.cancel = std::make_shared<std::atomic<bool>>(false);
+    uint32_t numCalls = 0;
+    options.onProgress = [&](const LoadProgress& progress) {
+        numCalls++;
+        CHECK(progress.chunksProcessed == numCalls);
+        CHECK(progress.bytesProcessed <= progress.bytesTotal);
+        options.cancel->store(true);
+    };
+
+    // the copy passed to loadFile shares the flag
+    Document doc;
+    CHECK(doc.loadFile(rbxdoc_test::getDataPath("test.rbxm").c_str(), LoadOptions(options)) == LoadResult::Error);
+    checkCancelled(doc);
+    CHECK(numCalls == 1);
+}
+
+TEST_CASE(LoadAsyncReportsCancellation)
+{
+    std::string fileName = rbxdoc_test::getDataPath("test.rbxm");
+    Document loaded = loadFileAsync(fileName).get();
+    CHECK(loaded.getLoadError().code == LoadErrorCode::None);
+    CHECK(loaded.getInstances().size() > 0);
+
+    // progress is reported from the loading thread, the future is ready after the last report
+    LoadOptions options;
+    uint32_t numReports = 0;
+    size_t lastBytes = 0;
+    options.onProgress = [&](const LoadProgress& progress) {
+        numReports++;
+        CHECK(progress.bytesProcessed >= lastBytes && progress.bytesProcessed <= progress.bytesTotal);
+        lastBytes = progress.bytesProcessed;
+    };
+    Document reported = loadFileAsync(fileName, options).get();
+    CHECK(reported.getLoadError().code == LoadErrorCode::None);
+    // every chunk is reported, END included (it is not listed in the chunk hashes)
+    CHECK(numReports == reported.getChunkHashes().size() + 1);
+    CHECK(lastBytes > 0);
+
+    Document cancelled = loadFileAsync(fileName, makeCancelledOptions()).get();
+    checkCancelled(cancelled);
+
+    // the executor decides where the load runs
+    int numTasks = 0;
+    Executor inlineExecutor = [&](std::function<void()> task) {
+        numTasks++;
+        task();
+    };
+    bool called = false;
+    loadFileAsync(
+        fileName,
+        [&](Document&& doc) {
+            called = true;
+            checkCancelled(doc);
+        },
+        makeCancelledOptions(), inlineExecutor);
+    CHECK(numTasks == 1 && called);
+}
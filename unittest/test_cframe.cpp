@@ -0,0 +1,104 @@
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "test.h"
+#include "test_rbxm.h"
+
+using namespace rbxdoc;
+
+// unit vector of a NormalId (Right, Top, Back, Left, Bottom, Front)
+static Vec3 getNormal(int normalId)
+{
+    float sign = (normalId >= 3) ? -1.0f : 1.0f;
+    return Vec3{(normalId % 3 == 0) ? sign : 0.0f, (normalId % 3 == 1) ? sign : 0.0f, (normalId % 3 == 2) ? sign : 0.0f};
+}
+
+static bool isSameRow(const Mat3x3& m, int row, const Vec3& v) { return m.v[row * 3] == v.x && m.v[row * 3 + 1] == v.y && m.v[row * 3 + 2] == v.z; }
+
+static std::string translations(size_t count)
+{
+    std::vector<float> x, y, z;
+    for (size_t i = 0; i < count; i++)
+    {
+        x.push_back(float(i));
+        y.push_back(float(i) + 0.5f);
+        z.push_back(-float(i));
+    }
+    return rbxdoc_test::RbxmBuilder::floats(x) + rbxdoc_test::RbxmBuilder::floats(y) + rbxdoc_test::RbxmBuilder::floats(z);
+}
+
+TEST_CASE(CFrameRotationIdsDecodeToAxisAlignedMatrices)
+{
+    // the 24 rotation ids with perpendicular axes and one explicit matrix
+    std::vector<int> xNormals;
+    std::vector<int> yNormals;
+    std::string rotations;
+    for (int xNormal = 0; xNormal < 6; xNormal++)
+    {
+        for (int yNormal = 0; yNormal < 6; yNormal++)
+        {
+            if (xNormal % 3 != yNormal % 3)
+            {
+                xNormals.push_back(xNormal);
+                yNormals.push_back(yNormal);
+                rotations += char(xNormal * 6 + yNormal + 1);
+            }
+        }
+    }
+    REQUIRE(xNormals.size() == 24);
+    const float explicitRotation[9] = {0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f};
+    rotations += '\0' + std::string(reinterpret_cast<const char*>(explicitRotation), sizeof(explicitRotation));
+
+    std::vector<int32_t> ids;
+    for (int32_t id = 0; id < 25; id++)
+    {
+        ids.push_back(id);
+    }
+    rbxdoc_test::RbxmBuilder file;
+    file.addInstances(0, "Part", ids);
+    file.addProperty(0, "CFrame", PropertyType::CFrameMatrix, rotations + translations(ids.size()));
+    file.addParents(ids, std::vector<int32_t>(ids.size(), -1));
+    std::string fileName = rbxdoc_test::getTempPath("rbxdoc_rotations.rbxm");
+    REQUIRE(file.save(fileName));
+
+    Document doc;
+    REQUIRE(doc.loadFile(fileName.c_str()) == LoadResult::OK);
+    for (size_t i = 0; i < xNormals.size(); i++)
+    {
+        const Property* prop = rbxdoc_test::findProperty(doc, int32_t(i), "CFrame");
+        REQUIRE(prop && prop->getType() == PropertyType::CFrameMatrix);
+        const Mat3x3& m = prop->asCFrame().rotation;
+        Vec3 r0 = getNormal(xNormals[i]);
+        Vec3 r1 = getNormal(yNormals[i]);
+        Vec3 r2 = Vec3{r0.y * r1.z - r0.z * r1.y, r0.z * r1.x - r0.x * r1.z, r0.x * r1.y - r0.y * r1.x};
+        CHECK(isSameRow(m, 0, r0) && isSameRow(m, 1, r1) && isSameRow(m, 2, r2));
+
+        // proper rotations: the determinant is 1
+        float det = m.v[0] * (m.v[4] * m.v[8] - m.v[5] * m.v[7]) - m.v[1] * (m.v[3] * m.v[8] - m.v[5] * m.v[6]) +
+                    m.v[2] * (m.v[3] * m.v[7] - m.v[4] * m.v[6]);
+        CHECK(det == 1.0f);
+
+        const Vec3& t = prop->asCFrame().translation;
+        CHECK(t.x == float(i) && t.y == float(i) + 0.5f && t.z == -float(i));
+    }
+
+    const CFrame& last = rbxdoc_test::findProperty(doc, 24, "CFrame")->asCFrame();
+    CHECK(memcmp(last.rotation.v, explicitRotation, sizeof(explicitRotation)) == 0);
+    CHECK(last.translation.x == 24.0f && last.translation.z == -24.0f);
+}
+
+TEST_CASE(CFrameRejectsInvalidRotationIds)
+{
+    rbxdoc_test::RbxmBuilder file;
+    file.addInstances(0, "Part", {0});
+    file.addProperty(0, "CFrame", PropertyType::CFrameMatrix, std::string(1, char(37)) + translations(1));
+    file.addParents({0}, {-1});
+    std::string fileName = rbxdoc_test::getTempPath("rbxdoc_bad_rotation.rbxm");
+    REQUIRE(file.save(fileName));
+
+    Document doc;
+    CHECK(doc.loadFile(fileName.c_str()) == LoadResult::Error);
+    CHECK(doc.getLoadError().code == LoadErrorCode::UnsupportedEncoding);
+    CHECK(strcmp(doc.getLoadError().chunkName, "PROP") == 0);
+}
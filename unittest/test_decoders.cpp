@@ -0,0 +1,132 @@
+#include <math.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "test.h"
+#include "test_rbxm.h"
+
+using namespace rbxdoc;
+using Builder = rbxdoc_test::RbxmBuilder;
+
+static std::string floats(std::initializer_list<float> values)
+{
+    std::string res;
+    for (float value : values)
+    {
+        res += Builder::raw(value);
+    }
+    return res;
+}
+
+// three rows, the first one rotated by 90 degrees around Z (quaternion), the second one identity (rotation id), the third one identity
+// (quaternion) and translations (i, i + 10, i + 20)
+static std::string quatCFrames()
+{
+    float h = sqrtf(0.5f);
+    std::string res = std::string(1, '\0') + floats({0.0f, 0.0f, h, h}) + std::string(1, '\2') + std::string(1, '\0') + floats({0.0f, 0.0f, 0.0f, 1.0f});
+    return res + Builder::floats({0.0f, 1.0f, 2.0f}) + Builder::floats({10.0f, 11.0f, 12.0f}) + Builder::floats({20.0f, 21.0f, 22.0f});
+}
+
+static bool saveDecodersFile(const std::string& fileName)
+{
+    Builder file;
+    file.addSharedStrings({"hello", std::string("bin\0ary", 7)});
+    file.addInstances(0, "Thing", {0, 1, 2});
+    file.addProperty(0, "U", PropertyType::UDim, Builder::floats({0.5f, 1.5f, -2.0f}) + Builder::int32s({10, -20, 30}));
+    file.addProperty(0, "R", PropertyType::Ray, floats({0, 1, 2, 0, -1, 0, 1, 2, 3, -1, -1, 0, 2, 3, 4, -2, -1, 0}));
+    file.addProperty(0, "F", PropertyType::Faces, std::string("\x01\x3f\x24", 3));
+    file.addProperty(0, "A", PropertyType::Axes, std::string("\x01\x02\x07", 3));
+    std::string v2;
+    std::string v3;
+    for (int16_t i = 0; i < 3; i++)
+    {
+        v2 += Builder::raw(i) + Builder::raw(int16_t(-i - 1));
+        v3 += Builder::raw(i) + Builder::raw(int16_t(-300)) + Builder::raw(int16_t(32767));
+    }
+    file.addProperty(0, "V2", PropertyType::Vector2int16, v2);
+    file.addProperty(0, "V3", PropertyType::Vector3int16, v3);
+    file.addProperty(0, "Q", PropertyType::CFrameQuat, quatCFrames());
+    file.addProperty(0, "B", PropertyType::Bytecode, Builder::string(std::string("\x1bLua\0x", 6)) + Builder::string("") + Builder::string("abc"));
+    file.addProperty(0, "S", PropertyType::SecurityCapabilities, Builder::int64s({0, 5, int64_t(1) << 40}));
+    // uri, object (instance 2), none
+    std::string content = Builder::int32s({1, 2, 0}) + Builder::raw(uint32_t(1)) + Builder::string("rbxassetid://42") + Builder::raw(uint32_t(1)) +
+                          Builder::refs({2}) + Builder::raw(uint32_t(0));
+    file.addProperty(0, "C", PropertyType::Content, content);
+    // index 7 is not in the dictionary
+    file.addProperty(0, "SS", PropertyType::SharedString, Builder::interleave({1, 0, 7}, 4));
+    // the CFrame encoding, the CFrames, then the Bool type and the flags
+    std::string optional = std::string(1, char(PropertyType::CFrameQuat)) + quatCFrames();
+    optional += std::string(1, char(PropertyType::Bool)) + std::string("\x01\x00\x01", 3);
+    file.addProperty(0, "OQ", PropertyType::OptionalCFrame, optional);
+    file.addParents({0, 1, 2}, {-1, -1, -1});
+    return file.save(fileName);
+}
+
+static bool isRotatedAroundZ(const Mat3x3& m)
+{
+    const float expected[9] = {0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f};
+    for (int i = 0; i < 9; i++)
+    {
+        if (!rbxdoc_test::isNear(m.v[i], expected[i], 1e-5f))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool isIdentity(const Mat3x3& m)
+{
+    for (int i = 0; i < 9; i++)
+    {
+        if (m.v[i] != ((i % 4 == 0) ? 1.0f : 0.0f))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+TEST_CASE(DecodersReadAllPropertyTypes)
+{
+    std::string fileName = rbxdoc_test::getTempPath("rbxdoc_decoders.rbxm");
+    REQUIRE(saveDecodersFile(fileName));
+    Document doc;
+    REQUIRE(doc.loadFile(fileName.c_str()) == LoadResult::OK);
+    auto get = [&doc](int32_t id, const char* name) {
+        const Property* prop = rbxdoc_test::findProperty(doc, id, name);
+        return prop ? *prop : Property();
+    };
+
+    CHECK(get(1, "U").asUDim().scale == 1.5f && get(1, "U").asUDim().offset == -20);
+    CHECK(get(2, "U").asUDim().scale == -2.0f && get(2, "U").asUDim().offset == 30);
+    CHECK(get(1, "R").asRay().origin.z == 3.0f && get(1, "R").asRay().direction.x == -1.0f);
+    CHECK(get(0, "F").asFaces() == 0x01 && get(1, "F").asFaces() == 0x3f && get(2, "F").asFaces() == 0x24);
+    CHECK(get(1, "A").asAxes() == 2 && get(2, "A").asAxes() == 7);
+    CHECK(get(2, "V2").asVec2int16().x == 2 && get(2, "V2").asVec2int16().y == -3);
+    CHECK(get(1, "V3").asVec3int16().x == 1 && get(1, "V3").asVec3int16().y == -300 && get(1, "V3").asVec3int16().z == 32767);
+    CHECK(get(2, "S").asSecurityCapabilities() == (uint64_t(1) << 40) && get(1, "S").asSecurityCapabilities() == 5);
+
+    // CFrameQuat decodes to rotation matrices
+    REQUIRE(get(0, "Q").getType() == PropertyType::CFrameQuat);
+    CHECK(isRotatedAroundZ(get(0, "Q").asCFrame().rotation));
+    CHECK(isIdentity(get(1, "Q").asCFrame().rotation) && isIdentity(get(2, "Q").asCFrame().rotation));
+    CHECK(get(2, "Q").asCFrame().translation.x == 2.0f && get(2, "Q").asCFrame().translation.y == 12.0f);
+
+    ArrayView<char> bytecode = get(0, "B").asBytes();
+    CHECK(bytecode.size() == 6 && memcmp(bytecode.data(), "\x1bLua\0x", 6) == 0);
+    CHECK(get(1, "B").asBytes().size() == 0 && strcmp(get(2, "B").asString(), "abc") == 0);
+
+    CHECK(get(0, "C").asContentSourceType() == ContentSourceType::Uri && strcmp(get(0, "C").asString(), "rbxassetid://42") == 0);
+    CHECK(get(1, "C").asContentSourceType() == ContentSourceType::Object && get(1, "C").asRef() == 2);
+    CHECK(get(2, "C").asContentSourceType() == ContentSourceType::None && get(2, "C").asRef() == -1);
+
+    ArrayView<char> shared = get(0, "SS").asBytes();
+    CHECK(shared.size() == 7 && memcmp(shared.data(), "bin\0ary", 7) == 0);
+    CHECK(strcmp(get(1, "SS").asString(), "hello") == 0 && get(2, "SS").asBytes().size() == 0);
+
+    CHECK(get(0, "OQ").asOptionalCFrame().hasData && isRotatedAroundZ(get(0, "OQ").asOptionalCFrame().val.rotation));
+    CHECK(!get(1, "OQ").asOptionalCFrame().hasData);
+    CHECK(get(2, "OQ").asOptionalCFrame().hasData && get(2, "OQ").asOptionalCFrame().val.translation.z == 22.0f);
+}
@@ -0,0 +1,106 @@
+#include <rbxdoc_diff.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "test.h"
+#include "test_rbxm.h"
+
+using namespace rbxdoc;
+using Builder = rbxdoc_test::RbxmBuilder;
+
+// uniqueIds are the index parts of the UniqueId values (0 = not set)
+static bool saveParts(const std::string& fileName, const std::vector<const char*>& names, const std::vector<float>& transparency,
+                      const std::vector<uint64_t>& uniqueIds, const std::vector<int32_t>& parents)
+{
+    std::vector<int32_t> ids;
+    std::string nameValues;
+    for (size_t i = 0; i < names.size(); i++)
+    {
+        ids.push_back(int32_t(i + 1));
+        nameValues += Builder::string(names[i]);
+    }
+
+    Builder file;
+    file.addInstances(0, "Folder", {0});
+    file.addInstances(1, "Part", ids);
+    file.addProperty(0, "Name", PropertyType::String, Builder::string("Root"));
+    file.addProperty(1, "Name", PropertyType::String, nameValues);
+    file.addProperty(1, "Transparency", PropertyType::Float, Builder::floats(transparency));
+    std::vector<uint64_t> zeros(names.size(), 0);
+    std::vector<int64_t> rawbits(names.size(), 0);
+    file.addProperty(1, "UniqueId", PropertyType::UniqueId, Builder::interleave(uniqueIds, 4) + Builder::interleave(zeros, 4) + Builder::int64s(rawbits));
+    ids.insert(ids.begin(), 0);
+    std::vector<int32_t> parentIds = parents;
+    parentIds.insert(parentIds.begin(), -1);
+    file.addParents(ids, parentIds);
+    return file.save(fileName);
+}
+
+TEST_CASE(DiffOfIdenticalDocumentsIsEmpty)
+{
+    Document doc;
+    REQUIRE(doc.loadFile(rbxdoc_test::getDataPath("test.rbxm").c_str()) == LoadResult::OK);
+    DocumentDiff same = diff(doc, doc);
+    CHECK(same.getRecords().size() == 0);
+    for (int32_t id = 0; id < int32_t(doc.getInstances().size()); id++)
+    {
+        CHECK(same.getNewId(id) == id && same.getOldId(id) == id);
+    }
+
+    // new ids, the same content
+    Document renumbered;
+    REQUIRE(renumbered.loadFile(rbxdoc_test::getDataPath("test.rbxm").c_str()) == LoadResult::OK);
+    REQUIRE(renumbered.renumberDepthFirst());
+    DocumentDiff moved = diff(doc, renumbered);
+    CHECK(moved.getRecords().size() == 0);
+    for (int32_t id = 0; id < int32_t(doc.getInstances().size()); id++)
+    {
+        int32_t newId = moved.getNewId(id);
+        REQUIRE(newId >= 0);
+        CHECK(moved.getOldId(newId) == id);
+        CHECK(strcmp(doc.getTypeName(doc.getInstances()[id]), renumbered.getTypeName(renumbered.getInstances()[newId])) == 0);
+    }
+}
+
+TEST_CASE(DiffReportsAddedRemovedMovedAndChanged)
+{
+    // Root { A, B, C } -> Root { D, A { C } } with a new Transparency of A, C is matched by its UniqueId, the others by path
+    std::string oldName = rbxdoc_test::getTempPath("rbxdoc_diff_old.rbxm");
+    std::string newName = rbxdoc_test::getTempPath("rbxdoc_diff_new.rbxm");
+    REQUIRE(saveParts(oldName, {"A", "B", "C"}, {0.0f, 0.0f, 0.0f}, {0, 0, 7}, {0, 0, 0}));
+    REQUIRE(saveParts(newName, {"D", "C", "A"}, {0.0f, 0.0f, 0.5f}, {0, 7, 0}, {0, 3, 0}));
+
+    Document oldDoc;
+    Document newDoc;
+    REQUIRE(oldDoc.loadFile(oldName.c_str()) == LoadResult::OK);
+    REQUIRE(newDoc.loadFile(newName.c_str()) == LoadResult::OK);
+    DocumentDiff res = diff(oldDoc, newDoc);
+
+    CHECK(res.getNewId(0) == 0);
+    CHECK(res.getNewId(1) == 3);
+    CHECK(res.getNewId(2) == -1);
+    CHECK(res.getNewId(3) == 2);
+    CHECK(res.getOldId(1) == -1);
+
+    ArrayView<DiffRecord> records = res.getRecords();
+    REQUIRE(records.size() == 4);
+    CHECK(records[0].kind == DiffKind::Removed && records[0].oldId == 2 && records[0].newId == -1);
+    CHECK(records[1].kind == DiffKind::Added && records[1].newId == 1 && records[1].oldId == -1);
+    CHECK(records[2].kind == DiffKind::Moved && records[2].oldId == 3 && records[2].newId == 2);
+    CHECK(records[3].kind == DiffKind::Changed && records[3].oldId == 1 && records[3].newId == 3);
+    REQUIRE(records[3].newPropertyIndex >= 0);
+    CHECK(strcmp(newDoc.getInstances()[3].getProperties()[records[3].newPropertyIndex].getName(), "Transparency") == 0);
+
+    // the same documents the other way round
+    DocumentDiff back = diff(newDoc, oldDoc);
+    CHECK(back.getRecords().size() == 4);
+    CHECK(back.getNewId(3) == 1 && back.getNewId(1) == -1);
+
+    // without UniqueId matching C is a different instance under another parent
+    DiffOptions options;
+    options.matchUniqueIds = false;
+    DocumentDiff byPath = diff(oldDoc, newDoc, options);
+    CHECK(byPath.getNewId(3) == -1);
+    CHECK(byPath.getRecords().size() == 5);
+}
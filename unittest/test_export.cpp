@@ -0,0 +1,102 @@
+#include <rbxdoc_export.h>
+#include <string.h>
+#include <string>
+
+#include "test.h"
+
+using namespace rbxdoc;
+
+static std::string exportXml(const Document& doc, int32_t id, uint32_t numThreads)
+{
+    ExportOptions options;
+    options.numThreads = numThreads;
+    OutputBuffer out;
+    Exporter::exportXml(doc, out, id, options);
+    return std::string(out.getData(), out.getSize());
+}
+
+static size_t countOccurrences(const std::string& text, const char* pattern)
+{
+    size_t count = 0;
+    for (size_t pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1))
+    {
+        count++;
+    }
+    return count;
+}
+
+TEST_CASE(ExportXmlRoundTrip)
+{
+    Document source;
+    REQUIRE(source.loadFile(rbxdoc_test::getDataPath("test.rbxm").c_str()) == LoadResult::OK);
+
+    std::string xml = exportXml(source, -1, 1);
+    CHECK(xml == exportXml(source, -1, 4));
+
+    OutputBuffer out;
+    out.append(xml.data(), xml.size());
+    std::string fileName = rbxdoc_test::getTempPath("rbxdoc_export.rbxmx");
+    REQUIRE(out.writeFile(fileName.c_str()));
+
+    Document doc;
+    REQUIRE(doc.loadFile(fileName.c_str()) == LoadResult::OK);
+    CHECK(doc.getInstances().size() == source.getInstances().size());
+    CHECK(rbxdoc_test::countDifferences(source, doc) == 0);
+    CHECK(doc.getSubtreeHash(-1) == source.getSubtreeHash(-1));
+}
+
+TEST_CASE(ExportXmlSubtreeMatchesExtractedSubtree)
+{
+    Document source;
+    REQUIRE(source.loadFile(rbxdoc_test::getDataPath("test.rbxm").c_str()) == LoadResult::OK);
+
+    // the largest child of a root
+    int32_t id = -1;
+    size_t numInstances = 0;
+    for (int32_t rootId : source.getChildren(-1))
+    {
+        for (int32_t childId : source.getChildren(rootId))
+        {
+            size_t count = 0;
+            for (int32_t subtreeId : source.getSubtree(childId))
+            {
+                count += (subtreeId >= 0) ? 1 : 0;
+            }
+            if (count > numInstances)
+            {
+                id = childId;
+                numInstances = count;
+            }
+        }
+    }
+    REQUIRE(id >= 0 && numInstances > 1);
+
+    OutputBuffer out;
+    Exporter::exportXml(source, out, id);
+    std::string fileName = rbxdoc_test::getTempPath("rbxdoc_export_subtree.rbxmx");
+    REQUIRE(out.writeFile(fileName.c_str()));
+
+    Document doc;
+    REQUIRE(doc.loadFile(fileName.c_str()) == LoadResult::OK);
+    CHECK(doc.getInstances().size() == numInstances);
+    CHECK(rbxdoc_test::countDifferences(source.extractSubtree(id), doc) == 0);
+}
+
+TEST_CASE(ExportJsonListsEveryInstance)
+{
+    Document source;
+    REQUIRE(source.loadFile(rbxdoc_test::getDataPath("test.rbxm").c_str()) == LoadResult::OK);
+
+    ExportOptions options;
+    options.numThreads = 1;
+    OutputBuffer single;
+    Exporter::exportJson(source, single, -1, options);
+    options.numThreads = 4;
+    OutputBuffer parallel;
+    Exporter::exportJson(source, parallel, -1, options);
+
+    std::string json(single.getData(), single.getSize());
+    CHECK(json == std::string(parallel.getData(), parallel.getSize()));
+    CHECK(json.compare(0, strlen("{\"instances\":["), "{\"instances\":[") == 0);
+    CHECK(countOccurrences(json, "\"class\":") == source.getInstances().size());
+}
@@ -0,0 +1,112 @@
+#include <rbxdoc_snapshot.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "test.h"
+#include "test_rbxm.h"
+
+using namespace rbxdoc;
+using Builder = rbxdoc_test::RbxmBuilder;
+
+TEST_CASE(ExtractWholeDocumentRoundTrip)
+{
+    Document source;
+    REQUIRE(source.loadFile(rbxdoc_test::getDataPath("test.rbxm").c_str()) == LoadResult::OK);
+    Document copy = source.extractSubtree(-1);
+    CHECK(copy.getInstances().size() == source.getInstances().size());
+    CHECK(copy.isDepthFirstOrdered());
+    CHECK(rbxdoc_test::countDifferences(source, copy) == 0);
+    CHECK(copy.getSubtreeHash(-1) == source.getSubtreeHash(-1));
+
+    // the copy does not depend on the source
+    uint64_t hash = copy.getSubtreeHash(-1);
+    source = Document();
+    CHECK(copy.getSubtreeHash(-1) == hash);
+}
+
+TEST_CASE(ExtractedDocumentSnapshotRoundTrip)
+{
+    Document source;
+    REQUIRE(source.loadFile(rbxdoc_test::getDataPath("test.rbxm").c_str()) == LoadResult::OK);
+    Document copy = source.extractSubtree(-1);
+    std::string fileName = rbxdoc_test::getTempPath("rbxdoc_extract.rbxsnap");
+    REQUIRE(Snapshot::write(copy, fileName.c_str()));
+
+    // the preorder subtree sizes are kept, there is no renumbering to map back
+    Document doc;
+    REQUIRE(Snapshot::load(fileName.c_str(), doc) == LoadResult::OK);
+    CHECK(doc.isDepthFirstOrdered());
+    CHECK(rbxdoc_test::countDifferences(copy, doc) == 0);
+    CHECK(doc.getSubtreeHash(-1) == copy.getSubtreeHash(-1));
+    for (int32_t id = 0; id < int32_t(doc.getInstances().size()); id++)
+    {
+        CHECK(doc.getOriginalId(id) == id);
+        CHECK(doc.getSubtreeInstances(id).size() == copy.getSubtreeInstances(id).size());
+    }
+}
+
+TEST_CASE(ExtractSubtreeRemapsRefs)
+{
+    // Root { A { X -> A }, B { Y -> Root } }
+    Builder file;
+    file.addInstances(0, "Folder", {0, 1, 2});
+    file.addInstances(1, "ObjectValue", {3, 4});
+    file.addProperty(0, "Name", PropertyType::String, Builder::string("Root") + Builder::string("A") + Builder::string("B"));
+    file.addProperty(1, "Name", PropertyType::String, Builder::string("X") + Builder::string("Y"));
+    file.addProperty(1, "Value", PropertyType::Ref, Builder::refs({1, 0}));
+    file.addParents({0, 1, 2, 3, 4}, {-1, 0, 0, 1, 2});
+    std::string fileName = rbxdoc_test::getTempPath("rbxdoc_extract.rbxm");
+    REQUIRE(file.save(fileName));
+    Document source;
+    REQUIRE(source.loadFile(fileName.c_str()) == LoadResult::OK);
+
+    // refs inside the subtree follow the new ids
+    Document a = source.extractSubtree(1);
+    REQUIRE(a.getInstances().size() == 2);
+    CHECK(a.getChildren(-1).size() == 1 && a.getChildren(-1)[0] == 0);
+    CHECK(strcmp(rbxdoc_test::findProperty(a, 1, "Name")->asString(), "X") == 0);
+    CHECK(rbxdoc_test::findProperty(a, 1, "Value")->asRef() == 0);
+    CHECK(a.getSubtreeHash(0) == source.getSubtreeHash(1));
+
+    // refs to the outside become null
+    Document b = source.extractSubtree(2);
+    REQUIRE(b.getInstances().size() == 2);
+    CHECK(rbxdoc_test::findProperty(b, 1, "Value")->asRef() == -1);
+
+    // types without instances are dropped
+    Document x = source.extractSubtree(3);
+    REQUIRE(x.getInstances().size() == 1);
+    CHECK(x.getTypes().size() == 1);
+    CHECK(strcmp(x.getTypeName(x.getInstances()[0]), "ObjectValue") == 0);
+    CHECK(rbxdoc_test::findProperty(x, 0, "Value")->asRef() == -1);
+
+    CHECK(source.extractSubtree(17).getInstances().size() == 0);
+}
+
+TEST_CASE(ExtractSubtreesConcurrently)
+{
+    Document source;
+    REQUIRE(source.loadFile(rbxdoc_test::getDataPath("test.rbxm").c_str()) == LoadResult::OK);
+    ArrayView<int32_t> roots = source.getChildren(-1);
+    REQUIRE(roots.size() > 0);
+    std::vector<int32_t> ids(source.getChildren(roots[0]).begin(), source.getChildren(roots[0]).end());
+    REQUIRE(ids.size() > 1);
+
+    std::vector<uint64_t> hashes(ids.size(), 0);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < ids.size(); i++)
+    {
+        threads.emplace_back([&, i]() { hashes[i] = source.extractSubtree(ids[i]).getSubtreeHash(-1, 1); });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    for (size_t i = 0; i < ids.size(); i++)
+    {
+        CHECK(hashes[i] == source.extractSubtree(ids[i]).getSubtreeHash(-1, 1));
+    }
+}
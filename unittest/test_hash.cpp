@@ -0,0 +1,100 @@
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "test.h"
+#include "test_rbxm.h"
+
+using namespace rbxdoc;
+using Builder = rbxdoc_test::RbxmBuilder;
+
+// Root { Twin { Leaf }, Twin { <leafName> } }, the Leaf values point at their parents
+static bool saveTwins(const std::string& fileName, const char* leafName)
+{
+    Builder file;
+    file.addInstances(0, "Folder", {0, 1, 2});
+    file.addInstances(1, "ObjectValue", {3, 4});
+    file.addProperty(0, "Name", PropertyType::String, Builder::string("Root") + Builder::string("Twin") + Builder::string("Twin"));
+    file.addProperty(1, "Name", PropertyType::String, Builder::string("Leaf") + Builder::string(leafName));
+    file.addProperty(1, "Value", PropertyType::Ref, Builder::refs({1, 2}));
+    file.addParents({0, 1, 2, 3, 4}, {-1, 0, 0, 1, 2});
+    return file.save(fileName);
+}
+
+TEST_CASE(SubtreeHashDoesNotDependOnIdsOrThreads)
+{
+    Document doc;
+    REQUIRE(doc.loadFile(rbxdoc_test::getDataPath("test.rbxm").c_str()) == LoadResult::OK);
+    uint64_t hash = doc.getSubtreeHash(-1, 1);
+    CHECK(doc.getSubtreeHash(-1, 4) == hash);
+
+    Document renumbered;
+    REQUIRE(renumbered.loadFile(rbxdoc_test::getDataPath("test.rbxm").c_str()) == LoadResult::OK);
+    std::vector<int32_t> preorder;
+    for (int32_t id : doc.getSubtree(-1))
+    {
+        preorder.push_back(id);
+    }
+    REQUIRE(renumbered.renumberDepthFirst());
+    CHECK(renumbered.getSubtreeHash(-1) == hash);
+
+    // the i-th instance in preorder gets id i
+    for (size_t i = 0; i < preorder.size(); i++)
+    {
+        CHECK(renumbered.getSubtreeHash(int32_t(i), 1) == doc.getSubtreeHash(preorder[i], 1));
+    }
+}
+
+TEST_CASE(SubtreeHashCoversValuesAndRefs)
+{
+    std::string sameName = rbxdoc_test::getTempPath("rbxdoc_twins.rbxm");
+    std::string otherName = rbxdoc_test::getTempPath("rbxdoc_twins_other.rbxm");
+    REQUIRE(saveTwins(sameName, "Leaf"));
+    REQUIRE(saveTwins(otherName, "Other"));
+
+    Document same;
+    Document other;
+    REQUIRE(same.loadFile(sameName.c_str()) == LoadResult::OK);
+    REQUIRE(other.loadFile(otherName.c_str()) == LoadResult::OK);
+
+    // equal subtrees hash the same, refs hash as positions inside the subtree
+    CHECK(same.getSubtreeHash(1) == same.getSubtreeHash(2));
+    CHECK(same.getSubtreeHash(0) != same.getSubtreeHash(1));
+    CHECK(same.getSubtreeHash(3) == same.getSubtreeHash(4));
+
+    CHECK(other.getSubtreeHash(1) == same.getSubtreeHash(1));
+    CHECK(other.getSubtreeHash(2) != same.getSubtreeHash(2));
+    CHECK(other.getSubtreeHash(-1) != same.getSubtreeHash(-1));
+}
+
+TEST_CASE(ChunkHashesFollowTheFile)
+{
+    std::string fileName = rbxdoc_test::getTempPath("rbxdoc_twins.rbxm");
+    REQUIRE(saveTwins(fileName, "Leaf"));
+    Document doc;
+    REQUIRE(doc.loadFile(fileName.c_str()) == LoadResult::OK);
+
+    // END is not listed
+    ArrayView<ChunkHash> hashes = doc.getChunkHashes();
+    REQUIRE(hashes.size() == 6);
+    const char* names[] = {"INST", "INST", "PROP", "PROP", "PROP", "PRNT"};
+    const int32_t typeIndices[] = {0, 1, 0, 1, 1, -1};
+    const char* propertyNames[] = {"", "", "Name", "Name", "Value", ""};
+    for (size_t i = 0; i < hashes.size(); i++)
+    {
+        CHECK(strcmp(hashes[i].name, names[i]) == 0);
+        CHECK(hashes[i].typeIndex == typeIndices[i]);
+        CHECK(strcmp(hashes[i].propertyName, propertyNames[i]) == 0);
+    }
+
+    // uncompressed chunks are stored as they are
+    CHECK(hashes[2].hash == hashes[2].payloadHash);
+    CHECK(hashes[2].hash != hashes[3].hash);
+
+    Document again;
+    REQUIRE(again.loadFile(fileName.c_str()) == LoadResult::OK);
+    for (size_t i = 0; i < hashes.size(); i++)
+    {
+        CHECK(again.getChunkHashes()[i].hash == hashes[i].hash);
+    }
+}
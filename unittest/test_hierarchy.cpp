@@ -0,0 +1,85 @@
+#include <string.h>
+#include <vector>
+
+#include "test.h"
+#include "test_rbxm.h"
+
+using namespace rbxdoc;
+
+TEST_CASE(HierarchyChildListsMatchParentLinks)
+{
+    Document doc;
+    REQUIRE(doc.loadFile(rbxdoc_test::getDataPath("test.rbxm").c_str()) == LoadResult::OK);
+    ArrayView<Instance> instances = doc.getInstances();
+
+    size_t numLinks = doc.getChildren(-1).size();
+    for (int32_t rootId : doc.getChildren(-1))
+    {
+        CHECK(doc.getParent(rootId) == -1);
+    }
+    for (const Instance& inst : instances)
+    {
+        for (int32_t childId : doc.getChildren(inst.getId()))
+        {
+            CHECK(doc.getParent(childId) == inst.getId());
+        }
+        numLinks += doc.getChildren(inst.getId()).size();
+
+        // ancestor walks end at a root
+        int32_t last = inst.getId();
+        for (int32_t ancestorId : doc.getAncestors(inst.getId()))
+        {
+            last = ancestorId;
+        }
+        CHECK(doc.getParent(last) == -1);
+    }
+    CHECK(numLinks == instances.size());
+
+    std::vector<int> visits(instances.size(), 0);
+    for (int32_t id : doc.getSubtree(-1))
+    {
+        visits[id]++;
+    }
+    CHECK(std::vector<int>(instances.size(), 1) == visits);
+}
+
+TEST_CASE(HierarchyKeepsFileOrderOfChildren)
+{
+    rbxdoc_test::RbxmBuilder file;
+    file.addInstances(0, "Folder", {0, 1, 2});
+    file.addParents({0, 2, 1}, {-1, 0, 0});
+    std::string fileName = rbxdoc_test::getTempPath("rbxdoc_order.rbxm");
+    REQUIRE(file.save(fileName));
+
+    Document doc;
+    REQUIRE(doc.loadFile(fileName.c_str()) == LoadResult::OK);
+    ArrayView<int32_t> children = doc.getChildren(0);
+    REQUIRE(children.size() == 2);
+    CHECK(children[0] == 2 && children[1] == 1);
+    CHECK(doc.getChildren(-1).size() == 1);
+}
+
+TEST_CASE(HierarchyRejectsCyclicParentLinks)
+{
+    // 1 and 2 are parents of each other
+    rbxdoc_test::RbxmBuilder cycle;
+    cycle.addInstances(0, "Folder", {0, 1, 2});
+    cycle.addParents({0, 1, 2}, {-1, 2, 1});
+    std::string cycleName = rbxdoc_test::getTempPath("rbxdoc_cycle.rbxm");
+    REQUIRE(cycle.save(cycleName));
+
+    Document doc;
+    CHECK(doc.loadFile(cycleName.c_str()) == LoadResult::Error);
+    CHECK(doc.getLoadError().code == LoadErrorCode::InvalidInstanceId);
+    CHECK(strcmp(doc.getLoadError().reason, "Cyclic parent link") == 0);
+    CHECK(strcmp(doc.getLoadError().chunkName, "PRNT") == 0);
+    CHECK(doc.getInstances().size() == 0);
+
+    rbxdoc_test::RbxmBuilder self;
+    self.addInstances(0, "Folder", {0, 1});
+    self.addParents({0, 1}, {-1, 1});
+    std::string selfName = rbxdoc_test::getTempPath("rbxdoc_self.rbxm");
+    REQUIRE(self.save(selfName));
+    CHECK(doc.loadFile(selfName.c_str()) == LoadResult::Error);
+    CHECK(doc.getLoadError().code == LoadErrorCode::InvalidInstanceId);
+}
@@ -0,0 +1,90 @@
+#include <memory>
+#include <rbxdoc_intern.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "test.h"
+
+using namespace rbxdoc;
+
+static const char* kMeshId = "rbxassetid://12410981119";
+
+static const Property* findMeshId(const Document& doc)
+{
+    int32_t id = rbxdoc_test::findInstance(doc, "MeshPart", "LF_door");
+    return (id >= 0) ? rbxdoc_test::findProperty(doc, id, "MeshId") : nullptr;
+}
+
+TEST_CASE(InternStoreSharesValuesUntilTheLastDocumentIsGone)
+{
+    std::string fileName = rbxdoc_test::getDataPath("test.rbxm");
+    std::shared_ptr<InternStore> store = std::make_shared<InternStore>(16);
+    CHECK(store->getValueCount() == 0 && store->getValueBytes() == 0);
+
+    std::unique_ptr<Document> first = std::make_unique<Document>();
+    first->setInternStore(store);
+    REQUIRE(first->loadFile(fileName.c_str()) == LoadResult::OK);
+    size_t numValues = store->getValueCount();
+    size_t numBytes = store->getValueBytes();
+    CHECK(numValues > 0 && numBytes >= numValues * 16);
+
+    // the second document adds references, not values
+    std::unique_ptr<Document> second = std::make_unique<Document>();
+    second->setInternStore(store);
+    REQUIRE(second->loadFile(fileName.c_str()) == LoadResult::OK);
+    CHECK(store->getValueCount() == numValues && store->getValueBytes() == numBytes);
+    REQUIRE(findMeshId(*first) && findMeshId(*second));
+    CHECK(findMeshId(*first)->asString() == findMeshId(*second)->asString());
+
+    first.reset();
+    CHECK(store->getValueCount() == numValues);
+    CHECK(strcmp(findMeshId(*second)->asString(), kMeshId) == 0);
+
+    // an extracted subtree keeps the values it copied
+    Document extracted = second->extractSubtree(-1);
+    second.reset();
+    CHECK(store->getValueCount() == numValues);
+    REQUIRE(findMeshId(extracted));
+    CHECK(strcmp(findMeshId(extracted)->asString(), kMeshId) == 0);
+
+    extracted = Document();
+    CHECK(store->getValueCount() == 0);
+    CHECK(store->getValueBytes() == 0);
+}
+
+TEST_CASE(InternStoreHandlesConcurrentDocuments)
+{
+    std::string fileName = rbxdoc_test::getDataPath("test.rbxm");
+    std::shared_ptr<InternStore> store = std::make_shared<InternStore>(16);
+
+    Document reference;
+    reference.setInternStore(store);
+    REQUIRE(reference.loadFile(fileName.c_str()) == LoadResult::OK);
+    size_t numValues = store->getValueCount();
+
+    std::vector<std::thread> threads;
+    std::vector<int> results(4, 0);
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        threads.emplace_back([&, i]() {
+            for (int iteration = 0; iteration < 4; iteration++)
+            {
+                Document doc;
+                doc.setInternStore(store);
+                const Property* meshId = (doc.loadFile(fileName.c_str()) == LoadResult::OK) ? findMeshId(doc) : nullptr;
+                results[i] += (meshId && strcmp(meshId->asString(), kMeshId) == 0) ? 1 : 0;
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    CHECK(results == std::vector<int>(results.size(), 4));
+    CHECK(store->getValueCount() == numValues);
+    reference = Document();
+    CHECK(store->getValueCount() == 0);
+}
@@ -0,0 +1,29 @@
+#include <string.h>
+#include <string>
+
+#include "test.h"
+#include "test_rbxm.h"
+
+using namespace rbxdoc;
+
+TEST_CASE(LoadRejectsInstancesWithoutType)
+{
+    rbxdoc_test::RbxmBuilder file;
+    file.addInstances(0, "Folder", {0, 1});
+    file.addParents({0, 1}, {-1, 0});
+    std::string validName = rbxdoc_test::getTempPath("rbxdoc_typed.rbxm");
+    REQUIRE(file.save(validName));
+
+    Document doc;
+    REQUIRE(doc.loadFile(validName.c_str()) == LoadResult::OK);
+    CHECK(doc.getInstances().size() == 2);
+
+    // the header announces two instances that no INST chunk lists
+    std::string untypedName = rbxdoc_test::getTempPath("rbxdoc_untyped.rbxm");
+    REQUIRE(file.save(untypedName, 2));
+    CHECK(doc.loadFile(untypedName.c_str()) == LoadResult::Error);
+    CHECK(doc.getLoadError().code == LoadErrorCode::InvalidInstanceId);
+    CHECK(strcmp(doc.getLoadError().reason, "Instance without a type") == 0);
+    CHECK(doc.getInstances().size() == 0);
+    CHECK(doc.getSubtreeHash(-1) == Document().getSubtreeHash(-1));
+}
@@ -0,0 +1,125 @@
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "test.h"
+#include "test_rbxm.h"
+
+using namespace rbxdoc;
+using Builder = rbxdoc_test::RbxmBuilder;
+
+static MergeSource makeSource(const Document& doc, int32_t parentSource = -1, int32_t parentId = -1)
+{
+    MergeSource source;
+    source.doc = &doc;
+    source.parentSource = parentSource;
+    source.parentId = parentId;
+    return source;
+}
+
+TEST_CASE(MergeOfOneSourceIsACopy)
+{
+    Document source;
+    REQUIRE(source.loadFile(rbxdoc_test::getDataPath("test.rbxm").c_str()) == LoadResult::OK);
+    Document merged = Document::merge({makeSource(source)});
+    CHECK(merged.getInstances().size() == source.getInstances().size());
+    CHECK(rbxdoc_test::countDifferences(source, merged) == 0);
+    CHECK(merged.getSubtreeHash(-1) == source.getSubtreeHash(-1));
+}
+
+TEST_CASE(MergeRemapsRefsOfLaterSources)
+{
+    // Workspace, every Folder has a Name only
+    Builder baseFile;
+    baseFile.addInstances(0, "Folder", {0});
+    baseFile.addProperty(0, "Name", PropertyType::String, Builder::string("Workspace"));
+    baseFile.addParents({0}, {-1});
+    std::string baseName = rbxdoc_test::getTempPath("rbxdoc_merge_base.rbxm");
+    REQUIRE(baseFile.save(baseName));
+
+    // Model { X -> Model, Y -> X }, Folders also have a Tag
+    Builder modelFile;
+    modelFile.addInstances(0, "ObjectValue", {1, 2});
+    modelFile.addInstances(1, "Folder", {0});
+    modelFile.addProperty(0, "Name", PropertyType::String, Builder::string("X") + Builder::string("Y"));
+    modelFile.addProperty(0, "Value", PropertyType::Ref, Builder::refs({0, 1}));
+    modelFile.addProperty(1, "Name", PropertyType::String, Builder::string("Model"));
+    modelFile.addProperty(1, "Tag", PropertyType::String, Builder::string("imported"));
+    modelFile.addParents({0, 1, 2}, {-1, 0, 0});
+    std::string modelName = rbxdoc_test::getTempPath("rbxdoc_merge_model.rbxm");
+    REQUIRE(modelFile.save(modelName));
+
+    Document base;
+    Document model;
+    REQUIRE(base.loadFile(baseName.c_str()) == LoadResult::OK);
+    REQUIRE(model.loadFile(modelName.c_str()) == LoadResult::OK);
+    Document merged = Document::merge({makeSource(base), makeSource(model, 0, 0)});
+
+    REQUIRE(merged.getInstances().size() == 4);
+    CHECK(merged.getTypes().size() == 2);
+    CHECK(merged.getChildren(-1).size() == 1);
+    int32_t workspace = rbxdoc_test::findInstance(merged, "Folder", "Workspace");
+    int32_t modelRoot = rbxdoc_test::findInstance(merged, "Folder", "Model");
+    int32_t x = rbxdoc_test::findInstance(merged, "ObjectValue", "X");
+    int32_t y = rbxdoc_test::findInstance(merged, "ObjectValue", "Y");
+    REQUIRE(workspace == 0 && modelRoot == 1);
+    REQUIRE(x > modelRoot && y > modelRoot);
+    CHECK(merged.getParent(modelRoot) == workspace);
+    CHECK(merged.getParent(x) == modelRoot && merged.getParent(y) == modelRoot);
+    CHECK(rbxdoc_test::findProperty(merged, x, "Value")->asRef() == modelRoot);
+    CHECK(rbxdoc_test::findProperty(merged, y, "Value")->asRef() == x);
+
+    // the Folder layout is the union of both sources
+    const Property* tag = rbxdoc_test::findProperty(merged, workspace, "Tag");
+    REQUIRE(tag && tag->getType() == PropertyType::String);
+    CHECK(strcmp(tag->asString(), "") == 0);
+    CHECK(strcmp(rbxdoc_test::findProperty(merged, modelRoot, "Tag")->asString(), "imported") == 0);
+
+    // the merged model is the same as its source
+    CHECK(rbxdoc_test::countDifferences(model, merged.extractSubtree(modelRoot)) == 0);
+    CHECK(merged.getSubtreeHash(modelRoot) == model.getSubtreeHash(0));
+
+    // the sources are not needed after the merge
+    base = Document();
+    model = Document();
+    CHECK(strcmp(rbxdoc_test::findProperty(merged, modelRoot, "Tag")->asString(), "imported") == 0);
+}
+
+TEST_CASE(MergeDeduplicatesSharedStrings)
+{
+    // both files have a "data" payload at different dictionary indices
+    Builder firstFile;
+    firstFile.addSharedStrings({"data", "first"});
+    firstFile.addInstances(0, "Thing", {0, 1});
+    firstFile.addProperty(0, "Blob", PropertyType::SharedString, Builder::interleave({0, 1}, 4));
+    firstFile.addParents({0, 1}, {-1, -1});
+    std::string firstName = rbxdoc_test::getTempPath("rbxdoc_merge_sstr_first.rbxm");
+    REQUIRE(firstFile.save(firstName));
+
+    Builder secondFile;
+    secondFile.addSharedStrings({"second", "data"});
+    secondFile.addInstances(0, "Thing", {0, 1});
+    secondFile.addProperty(0, "Blob", PropertyType::SharedString, Builder::interleave({1, 0}, 4));
+    secondFile.addParents({0, 1}, {-1, -1});
+    std::string secondName = rbxdoc_test::getTempPath("rbxdoc_merge_sstr_second.rbxm");
+    REQUIRE(secondFile.save(secondName));
+
+    Document first;
+    Document second;
+    REQUIRE(first.loadFile(firstName.c_str()) == LoadResult::OK);
+    REQUIRE(second.loadFile(secondName.c_str()) == LoadResult::OK);
+    Document merged = Document::merge({makeSource(first), makeSource(second)});
+
+    // sources without a parent stay roots
+    REQUIRE(merged.getInstances().size() == 4);
+    CHECK(merged.getChildren(-1).size() == 4);
+    const char* expected[] = {"data", "first", "data", "second"};
+    for (int32_t id = 0; id < 4; id++)
+    {
+        CHECK(strcmp(rbxdoc_test::findProperty(merged, id, "Blob")->asString(), expected[id]) == 0);
+    }
+
+    // one copy of the payload serves both sources
+    CHECK(rbxdoc_test::findProperty(merged, 0, "Blob")->asString() == rbxdoc_test::findProperty(merged, 2, "Blob")->asString());
+    CHECK(rbxdoc_test::findProperty(merged, 1, "Blob")->asString() != rbxdoc_test::findProperty(merged, 3, "Blob")->asString());
+}
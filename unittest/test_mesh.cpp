@@ -0,0 +1,156 @@
+#include <rbxdoc_mesh.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "test.h"
+#include "test_rbxm.h"
+
+using namespace rbxdoc;
+using Builder = rbxdoc_test::RbxmBuilder;
+
+static std::string strings(const std::vector<const char*>& values)
+{
+    std::string res;
+    for (const char* value : values)
+    {
+        res += Builder::string(value);
+    }
+    return res;
+}
+
+static std::string vectors(const std::vector<Vec3>& values)
+{
+    std::vector<float> xs;
+    std::vector<float> ys;
+    std::vector<float> zs;
+    for (const Vec3& value : values)
+    {
+        xs.push_back(value.x);
+        ys.push_back(value.y);
+        zs.push_back(value.z);
+    }
+    return Builder::floats(xs) + Builder::floats(ys) + Builder::floats(zs);
+}
+
+// identity rotations (rotation id 2), translation x = row
+static std::string cframes(size_t count)
+{
+    std::vector<Vec3> translations;
+    for (size_t i = 0; i < count; i++)
+    {
+        translations.push_back(Vec3{float(i), 0.0f, 0.0f});
+    }
+    return std::string(count, '\2') + vectors(translations);
+}
+
+// checks every packed range against the document rows
+static size_t checkBatches(const Document& doc, const MeshInstances& meshes)
+{
+    size_t numInstances = 0;
+    uint32_t next = 0;
+    for (const MeshBatch& batch : meshes.getBatches())
+    {
+        CHECK(batch.first == next && batch.count > 0);
+        next = batch.first + batch.count;
+        numInstances += batch.count;
+
+        ArrayView<int32_t> ids = meshes.getInstanceIds(batch);
+        ArrayView<CFrame> transforms = meshes.getTransforms(batch);
+        CHECK(ids.size() == batch.count && transforms.size() == batch.count && meshes.getScales(batch).size() == batch.count);
+        for (size_t i = 0; i < ids.size(); i++)
+        {
+            CHECK(strcmp(doc.getTypeName(doc.getInstances()[ids[i]]), "MeshPart") == 0);
+            const Property* cframe = rbxdoc_test::findProperty(doc, ids[i], "CFrame");
+            CHECK(cframe && memcmp(&transforms[i], &cframe->asCFrame(), sizeof(CFrame)) == 0);
+        }
+    }
+    return numInstances;
+}
+
+TEST_CASE(MeshInstancesGroupByMeshAndTexture)
+{
+    // five MeshParts and a Part that is not extracted
+    Builder file;
+    file.addInstances(0, "MeshPart", {0, 1, 2, 3, 4});
+    file.addInstances(1, "Part", {5});
+    file.addProperty(0, "CFrame", PropertyType::CFrameMatrix, cframes(5));
+    file.addProperty(0, "MeshId", PropertyType::String, strings({"m1", "m2", "m1", "m1", "m2"}));
+    file.addProperty(0, "TextureID", PropertyType::String, strings({"t1", "t1", "t1", "t2", "t1"}));
+    std::vector<Vec3> sizes = {{2, 2, 2}, {1, 1, 1}, {4, 6, 8}, {3, 3, 3}, {1, 1, 1}};
+    std::vector<Vec3> initialSizes = {{1, 1, 1}, {1, 1, 1}, {2, 0, 4}, {3, 3, 3}, {2, 2, 2}};
+    file.addProperty(0, "Size", PropertyType::Vector3, vectors(sizes));
+    file.addProperty(0, "InitialSize", PropertyType::Vector3, vectors(initialSizes));
+    file.addProperty(1, "MeshId", PropertyType::String, strings({"m1"}));
+    file.addParents({0, 1, 2, 3, 4, 5}, {-1, -1, -1, -1, -1, -1});
+    std::string fileName = rbxdoc_test::getTempPath("rbxdoc_meshes.rbxm");
+    REQUIRE(file.save(fileName));
+
+    Document doc;
+    REQUIRE(doc.loadFile(fileName.c_str()) == LoadResult::OK);
+    MeshInstances meshes;
+    meshes.extract(doc);
+
+    // batches follow the first use of every pair, rows keep their order
+    ArrayView<MeshBatch> batches = meshes.getBatches();
+    REQUIRE(batches.size() == 3);
+    const char* meshIds[] = {"m1", "m2", "m1"};
+    const char* textureIds[] = {"t1", "t1", "t2"};
+    const std::vector<std::vector<int32_t>> rows = {{0, 2}, {1, 4}, {3}};
+    for (size_t i = 0; i < batches.size(); i++)
+    {
+        CHECK(strcmp(batches[i].meshId, meshIds[i]) == 0 && strcmp(batches[i].textureId, textureIds[i]) == 0);
+        ArrayView<int32_t> ids = meshes.getInstanceIds(batches[i]);
+        CHECK(std::vector<int32_t>(ids.begin(), ids.end()) == rows[i]);
+    }
+    CHECK(checkBatches(doc, meshes) == 5);
+    CHECK(meshes.getTransforms(batches[0])[1].translation.x == 2.0f);
+
+    // Size / InitialSize, a zero InitialSize component scales by 1
+    ArrayView<Vec3> scales = meshes.getScales(batches[0]);
+    CHECK(scales[0].x == 2.0f && scales[0].y == 2.0f && scales[0].z == 2.0f);
+    CHECK(scales[1].x == 2.0f && scales[1].y == 1.0f && scales[1].z == 2.0f);
+    CHECK(meshes.getScales(batches[1])[1].x == 0.5f);
+    CHECK(meshes.getScales(batches[2])[0].z == 1.0f);
+
+    // extracting again replaces the previous batches
+    meshes.extract(Document());
+    CHECK(meshes.getBatches().size() == 0);
+}
+
+TEST_CASE(MeshInstancesReadContentAssets)
+{
+    // MeshContent / TextureContent uris, without Size or InitialSize
+    Builder file;
+    file.addInstances(0, "MeshPart", {0, 1, 2});
+    file.addProperty(0, "CFrame", PropertyType::CFrameMatrix, cframes(3));
+    std::string meshContent = Builder::int32s({1, 1, 1}) + Builder::raw(uint32_t(3)) + strings({"rbxassetid://1", "rbxassetid://2", "rbxassetid://1"}) +
+                              Builder::raw(uint32_t(0)) + Builder::raw(uint32_t(0));
+    std::string textureContent = Builder::int32s({1, 0, 1}) + Builder::raw(uint32_t(2)) + strings({"rbxassetid://9", "rbxassetid://9"}) +
+                                 Builder::raw(uint32_t(0)) + Builder::raw(uint32_t(0));
+    file.addProperty(0, "MeshContent", PropertyType::Content, meshContent);
+    file.addProperty(0, "TextureContent", PropertyType::Content, textureContent);
+    file.addParents({0, 1, 2}, {-1, -1, -1});
+    std::string fileName = rbxdoc_test::getTempPath("rbxdoc_mesh_content.rbxm");
+    REQUIRE(file.save(fileName));
+
+    Document doc;
+    REQUIRE(doc.loadFile(fileName.c_str()) == LoadResult::OK);
+    MeshInstances meshes;
+    meshes.extract(doc);
+
+    ArrayView<MeshBatch> batches = meshes.getBatches();
+    REQUIRE(batches.size() == 2);
+    CHECK(strcmp(batches[0].meshId, "rbxassetid://1") == 0 && strcmp(batches[0].textureId, "rbxassetid://9") == 0);
+    CHECK(strcmp(batches[1].meshId, "rbxassetid://2") == 0 && strcmp(batches[1].textureId, "") == 0);
+    CHECK(batches[0].count == 2 && batches[1].count == 1);
+    CHECK(checkBatches(doc, meshes) == 3);
+
+    for (const MeshBatch& batch : batches)
+    {
+        for (const Vec3& scale : meshes.getScales(batch))
+        {
+            CHECK(scale.x == 1.0f && scale.y == 1.0f && scale.z == 1.0f);
+        }
+    }
+}
@@ -0,0 +1,79 @@
+#include <rbxdoc_names.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "test.h"
+#include "test_rbxm.h"
+
+using namespace rbxdoc;
+
+// Workspace { Map { Spawn }, map { Spawn }, Part, Part }
+static bool saveNamesFile(const std::string& fileName)
+{
+    const char* names[] = {"Workspace", "Map", "map", "Spawn", "Part", "Part", "Spawn"};
+    std::string values;
+    for (const char* name : names)
+    {
+        values += rbxdoc_test::RbxmBuilder::string(name);
+    }
+
+    rbxdoc_test::RbxmBuilder file;
+    file.addInstances(0, "Folder", {0, 1, 2, 3, 4, 5, 6});
+    file.addProperty(0, "Name", PropertyType::String, values);
+    file.addParents({0, 1, 2, 3, 4, 5, 6}, {-1, 0, 0, 1, 0, 0, 2});
+    return file.save(fileName);
+}
+
+TEST_CASE(NameIndexResolvesPaths)
+{
+    std::string fileName = rbxdoc_test::getTempPath("rbxdoc_names.rbxm");
+    REQUIRE(saveNamesFile(fileName));
+    Document doc;
+    REQUIRE(doc.loadFile(fileName.c_str()) == LoadResult::OK);
+    NameIndex index;
+    index.build(doc);
+
+    CHECK(strcmp(index.getName(3), "Spawn") == 0);
+    CHECK(index.findChild(-1, "Workspace") == 0);
+    CHECK(index.findPath("Workspace.Map.Spawn") == 3);
+    CHECK(index.findPath("Workspace.map.Spawn") == 6);
+    CHECK(index.findPath(0, "Map.Spawn") == 3);
+    CHECK(index.findPath("Workspace/map/Spawn", NameMatch::CaseSensitive, '/') == 6);
+    CHECK(index.findPath("Workspace.Nope") == -1);
+    CHECK(index.findPath("Workspace.Map.Spawn.Nope") == -1);
+
+    // case folded lookups pick the first sibling in child order
+    CHECK(index.findPath("workspace.MAP.spawn") == -1);
+    CHECK(index.findPath("workspace.MAP.spawn", NameMatch::CaseInsensitive) == 3);
+    ArrayView<int32_t> maps = index.findChildren(0, "MAP", NameMatch::CaseInsensitive);
+    REQUIRE(maps.size() == 2);
+    CHECK(maps[0] == 1 && maps[1] == 2);
+    CHECK(index.findChildren(0, "MAP").size() == 0);
+
+    ArrayView<int32_t> parts = index.findChildren(0, "Part");
+    REQUIRE(parts.size() == 2);
+    CHECK(parts[0] == 4 && parts[1] == 5);
+    CHECK(index.findChild(0, "Part") == 4);
+}
+
+TEST_CASE(NameIndexListsEveryInstance)
+{
+    Document doc;
+    REQUIRE(doc.loadFile(rbxdoc_test::getDataPath("test.rbxm").c_str()) == LoadResult::OK);
+    NameIndex index;
+    index.build(doc);
+
+    for (const Instance& inst : doc.getInstances())
+    {
+        const Property* name = rbxdoc_test::findProperty(doc, inst.getId(), "Name");
+        CHECK(strcmp(index.getName(inst.getId()), name ? name->asString() : "") == 0);
+
+        bool found = false;
+        for (int32_t id : index.findChildren(inst.getParentId(), index.getName(inst.getId()), NameMatch::CaseInsensitive))
+        {
+            found |= (id == inst.getId());
+        }
+        CHECK(found);
+    }
+}
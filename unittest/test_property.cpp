@@ -0,0 +1,82 @@
+#include <string.h>
+#include <utility>
+#include <vector>
+
+#include "test.h"
+
+using namespace rbxdoc;
+
+TEST_CASE(PropertyInlineAndPooledValues)
+{
+    Document doc;
+    REQUIRE(doc.loadFile(rbxdoc_test::getDataPath("test.rbxm").c_str()) == LoadResult::OK);
+
+    int32_t id = rbxdoc_test::findInstance(doc, "MeshPart", "LF_door");
+    REQUIRE(id >= 0);
+
+    // inline payload
+    const Property* size = rbxdoc_test::findProperty(doc, id, "size");
+    REQUIRE(size && size->getType() == PropertyType::Vector3);
+    CHECK(rbxdoc_test::isNear(size->asVec3().x, 0.59f) && rbxdoc_test::isNear(size->asVec3().y, 3.32f) && rbxdoc_test::isNear(size->asVec3().z, 4.60f));
+
+    // pooled values
+    const Property* meshId = rbxdoc_test::findProperty(doc, id, "MeshId");
+    REQUIRE(meshId);
+    CHECK(strcmp(meshId->asString(), "rbxassetid://12410981119") == 0);
+    CHECK(meshId->asBytes().size() == strlen("rbxassetid://12410981119"));
+
+    const Property* cframe = rbxdoc_test::findProperty(doc, id, "CFrame");
+    REQUIRE(cframe && cframe->getType() == PropertyType::CFrameMatrix);
+    CHECK(rbxdoc_test::isNear(cframe->asCFrame().translation.x, 268.46f) && rbxdoc_test::isNear(cframe->asCFrame().translation.y, 3.95f));
+    CHECK(rbxdoc_test::isNear(cframe->asCFrame().rotation.v[0], 1.0f) && rbxdoc_test::isNear(cframe->asCFrame().rotation.v[4], 1.0f));
+
+    // accessors of another type return the default value
+    CHECK(size->asInt32(7) == 7);
+    CHECK(strcmp(size->asString("none"), "none") == 0);
+    CHECK(meshId->asVec3(Vec3{1.0f, 2.0f, 3.0f}).z == 3.0f);
+    CHECK(meshId->asNumberSequence().size() == 0);
+}
+
+TEST_CASE(PropertyPooledValuesSurviveDocumentMove)
+{
+    Document doc;
+    REQUIRE(doc.loadFile(rbxdoc_test::getDataPath("test.rbxm").c_str()) == LoadResult::OK);
+    int32_t id = rbxdoc_test::findInstance(doc, "MeshPart", "LF_door");
+    REQUIRE(id >= 0);
+
+    Document moved = std::move(doc);
+    const Property* meshId = rbxdoc_test::findProperty(moved, id, "MeshId");
+    REQUIRE(meshId);
+    CHECK(strcmp(meshId->asString(), "rbxassetid://12410981119") == 0);
+}
+
+TEST_CASE(PropertyCopyColumnGathersRows)
+{
+    Document doc;
+    REQUIRE(doc.loadFile(rbxdoc_test::getDataPath("test.rbxm").c_str()) == LoadResult::OK);
+
+    ArrayView<Type> types = doc.getTypes();
+    uint32_t typeIndex = 0;
+    while (typeIndex < types.size() && strcmp(types[typeIndex].getName(), "MeshPart") != 0)
+    {
+        typeIndex++;
+    }
+    REQUIRE(typeIndex < types.size());
+    const Type& type = types[typeIndex];
+    int32_t sizeIndex = type.findProperty("size");
+    REQUIRE(sizeIndex >= 0);
+
+    std::vector<Vec3> sizes(type.getInstances().size() + 1);
+    REQUIRE(doc.copyColumn(typeIndex, uint32_t(sizeIndex), sizes.data(), sizes.size()) == type.getInstances().size());
+    for (size_t row = 0; row < type.getInstances().size(); row++)
+    {
+        const Vec3& expected = doc.getInstances()[type.getInstances()[row]].getProperties()[sizeIndex].asVec3();
+        CHECK(sizes[row].x == expected.x && sizes[row].y == expected.y && sizes[row].z == expected.z);
+    }
+
+    // the destination size limits the copy, mismatching element types copy nothing
+    CHECK(doc.copyColumn(typeIndex, uint32_t(sizeIndex), sizes.data(), 1) == 1);
+    std::vector<float> floats(sizes.size());
+    CHECK(doc.copyColumn(typeIndex, uint32_t(sizeIndex), floats.data(), floats.size()) == 0);
+    CHECK(doc.copyColumn(uint32_t(types.size()), 0, floats.data(), floats.size()) == 0);
+}
@@ -0,0 +1,110 @@
+#include <rbxdoc_query.h>
+#include <string.h>
+#include <vector>
+
+#include "test.h"
+#include "test_rbxm.h"
+
+using namespace rbxdoc;
+
+static std::vector<int32_t> execute(const Query& query, const Document& doc, uint32_t numThreads = 0)
+{
+    QueryOptions options;
+    options.numThreads = numThreads;
+    std::vector<int32_t> ids;
+    query.compile(doc).execute(ids, options);
+    return ids;
+}
+
+TEST_CASE(QueryMatchesBruteForce)
+{
+    Document doc;
+    REQUIRE(doc.loadFile(rbxdoc_test::getDataPath("test.rbxm").c_str()) == LoadResult::OK);
+
+    std::vector<int32_t> expected;
+    for (const Instance& inst : doc.getInstances())
+    {
+        if (strcmp(doc.getTypeName(inst), "Part") != 0)
+        {
+            continue;
+        }
+        const Property* anchored = rbxdoc_test::findProperty(doc, inst.getId(), "Anchored");
+        const Property* size = rbxdoc_test::findProperty(doc, inst.getId(), "size");
+        if (anchored && size && !anchored->asBool() && size->asVec3().y > 1.0f)
+        {
+            expected.push_back(inst.getId());
+        }
+    }
+    CHECK(!expected.empty());
+
+    Query query = Query().ofType("Part").where("Anchored", CompareOp::Equal, false).where("size", Component::Y, CompareOp::Greater, 1.0);
+    CHECK(execute(query, doc, 1) == expected);
+    CHECK(execute(query, doc, 4) == expected);
+
+    std::vector<uint64_t> bits;
+    query.compile(doc).execute(bits);
+    size_t numBits = 0;
+    for (size_t id = 0; id < bits.size() * 64; id++)
+    {
+        numBits += (bits[id / 64] >> (id % 64)) & 1;
+    }
+    CHECK(numBits == expected.size());
+}
+
+TEST_CASE(QueryResolvesPropertyNamesIgnoringCase)
+{
+    Document doc;
+    REQUIRE(doc.loadFile(rbxdoc_test::getDataPath("test.rbxm").c_str()) == LoadResult::OK);
+
+    // binary files store the part size as "size"
+    std::vector<int32_t> lower = execute(Query().where("size", Component::Y, CompareOp::Greater, 0.0), doc);
+    std::vector<int32_t> upper = execute(Query().where("Size", Component::Y, CompareOp::Greater, 0.0), doc);
+    CHECK(!lower.empty());
+    CHECK(lower == upper);
+    CHECK(execute(Query().where("NoSuchProperty", CompareOp::Equal, 0.0), doc).empty());
+}
+
+TEST_CASE(QueryComparesInt64Exactly)
+{
+    const int64_t big = int64_t(1) << 53;
+    rbxdoc_test::RbxmBuilder file;
+    file.addInstances(0, "IntValue", {0, 1, 2});
+    file.addProperty(0, "Value", PropertyType::Int64, rbxdoc_test::RbxmBuilder::int64s({big, big + 1, -big - 1}));
+    file.addParents({0, 1, 2}, {-1, -1, -1});
+    std::string fileName = rbxdoc_test::getTempPath("rbxdoc_query_int64.rbxm");
+    REQUIRE(file.save(fileName));
+
+    Document doc;
+    REQUIRE(doc.loadFile(fileName.c_str()) == LoadResult::OK);
+    CHECK(execute(Query().where("Value", CompareOp::Equal, big + 1), doc) == std::vector<int32_t>{1});
+    CHECK(execute(Query().where("Value", CompareOp::Greater, big), doc) == std::vector<int32_t>{1});
+    CHECK(execute(Query().where("Value", CompareOp::NotEqual, big), doc) == (std::vector<int32_t>{1, 2}));
+    CHECK(execute(Query().where("Value", CompareOp::Less, -big), doc) == std::vector<int32_t>{2});
+    // double predicates keep double semantics
+    CHECK(execute(Query().where("Value", CompareOp::Equal, double(big)), doc).size() == 2);
+}
+
+TEST_CASE(QueryOrdersStringsByBytes)
+{
+    rbxdoc_test::RbxmBuilder file;
+    file.addInstances(0, "Folder", {0, 1, 2, 3});
+    std::string names;
+    for (const char* name : {"apple", "Banana", "banana", "\xc3\xa9" "clair"})
+    {
+        names += rbxdoc_test::RbxmBuilder::string(name);
+    }
+    file.addProperty(0, "Name", PropertyType::String, names);
+    file.addParents({0, 1, 2, 3}, {-1, -1, -1, -1});
+    std::string fileName = rbxdoc_test::getTempPath("rbxdoc_query_strings.rbxm");
+    REQUIRE(file.save(fileName));
+
+    // upper case sorts before lower case, bytes >= 0x80 after ASCII
+    Document doc;
+    REQUIRE(doc.loadFile(fileName.c_str()) == LoadResult::OK);
+    CHECK(execute(Query().where("Name", CompareOp::Less, "apple"), doc) == std::vector<int32_t>{1});
+    CHECK(execute(Query().where("Name", CompareOp::LessEqual, "apple"), doc) == (std::vector<int32_t>{0, 1}));
+    CHECK(execute(Query().where("Name", CompareOp::Greater, "banana"), doc) == std::vector<int32_t>{3});
+    CHECK(execute(Query().where("Name", CompareOp::GreaterEqual, "banana"), doc) == (std::vector<int32_t>{2, 3}));
+    CHECK(execute(Query().where("Name", CompareOp::Equal, "Banana"), doc) == std::vector<int32_t>{1});
+    CHECK(execute(Query().where("Name", CompareOp::NotEqual, "Banana"), doc) == (std::vector<int32_t>{0, 2, 3}));
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <fstream>
+#include <rbxdoc.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+namespace rbxdoc_test
+{
+
+// Writes small binary model files (uncompressed chunks) for tests of the binary reader
+class RbxmBuilder
+{
+  public:
+    // INST chunk of a type
+    void addInstances(uint32_t typeIndex, const char* className, const std::vector<int32_t>& ids)
+    {
+        std::string data = raw(typeIndex) + string(className) + raw(uint8_t(0)) + raw(uint32_t(ids.size())) + refs(ids);
+        addChunk("INST", data);
+        numTypes++;
+        numObjects += uint32_t(ids.size());
+    }
+
+    // PROP chunk, values are encoded by the caller (see the encoders below)
+    void addProperty(uint32_t typeIndex, const char* name, rbxdoc::PropertyType type, const std::string& values)
+    {
+        addChunk("PROP", raw(typeIndex) + string(name) + raw(uint8_t(type)) + values);
+    }
+
+    // SSTR chunk, the hashes are left zero
+    void addSharedStrings(const std::vector<std::string>& values)
+    {
+        std::string data = raw(uint32_t(0)) + raw(uint32_t(values.size()));
+        for (const std::string& value : values)
+        {
+            data += std::string(16, '\0') + string(value);
+        }
+        addChunk("SSTR", data);
+    }
+
+    void addParents(const std::vector<int32_t>& childIds, const std::vector<int32_t>& parentIds)
+    {
+        addChunk("PRNT", raw(uint8_t(0)) + raw(uint32_t(childIds.size())) + refs(childIds) + refs(parentIds));
+    }
+
+    // extraObjects is added to the object count of the file header
+    bool save(const std::string& fileName, int32_t extraObjects = 0) const
+    {
+        std::string file = std::string("<roblox!\x89\xff\x0d\x0a\x1a\x0a", 14) + raw(uint16_t(0)) + raw(numTypes) + raw(uint32_t(numObjects + extraObjects)) +
+                           raw(uint64_t(0)) + chunks + chunk("END\0", "</roblox>");
+        std::ofstream out(fileName, std::ios::binary);
+        out.write(file.data(), std::streamsize(file.size()));
+        return bool(out);
+    }
+
+    template <typename T> static std::string raw(const T& value) { return std::string(reinterpret_cast<const char*>(&value), sizeof(T)); }
+
+    static std::string string(const std::string& value) { return raw(uint32_t(value.size())) + value; }
+
+    // byte-interleaved big endian values (the layout of most numeric columns)
+    static std::string interleave(const std::vector<uint64_t>& values, size_t width)
+    {
+        std::string res(values.size() * width, '\0');
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            for (size_t byte = 0; byte < width; byte++)
+            {
+                res[byte * values.size() + i] = char((values[i] >> ((width - 1 - byte) * 8)) & 0xff);
+            }
+        }
+        return res;
+    }
+
+    static std::string int32s(const std::vector<int32_t>& values)
+    {
+        std::vector<uint64_t> encoded;
+        for (int32_t value : values)
+        {
+            encoded.push_back(uint32_t((uint32_t(value) << 1) ^ uint32_t(value >> 31)));
+        }
+        return interleave(encoded, 4);
+    }
+
+    static std::string int64s(const std::vector<int64_t>& values)
+    {
+        std::vector<uint64_t> encoded;
+        for (int64_t value : values)
+        {
+            encoded.push_back((uint64_t(value) << 1) ^ uint64_t(value >> 63));
+        }
+        return interleave(encoded, 8);
+    }
+
+    static std::string floats(const std::vector<float>& values)
+    {
+        std::vector<uint64_t> encoded;
+        for (float value : values)
+        {
+            uint32_t bits;
+            memcpy(&bits, &value, sizeof(bits));
+            encoded.push_back(uint32_t((bits << 1) | (bits >> 31)));
+        }
+        return interleave(encoded, 4);
+    }
+
+    // delta encoded instance ids
+    static std::string refs(const std::vector<int32_t>& ids)
+    {
+        std::vector<int32_t> deltas;
+        int32_t last = 0;
+        for (int32_t id : ids)
+        {
+            deltas.push_back(id - last);
+            last = id;
+        }
+        return int32s(deltas);
+    }
+
+  private:
+    static std::string chunk(const char* name, const std::string& data)
+    {
+        return std::string(name, 4) + raw(uint32_t(0)) + raw(uint32_t(data.size())) + raw(uint32_t(0)) + data;
+    }
+
+    void addChunk(const char* name, const std::string& data) { chunks += chunk(name, data); }
+
+    std::string chunks;
+    uint32_t numTypes = 0;
+    uint32_t numObjects = 0;
+};
+
+} // namespace rbxdoc_test
@@ -0,0 +1,104 @@
+#include <string.h>
+#include <vector>
+
+#include "test.h"
+#include "test_rbxm.h"
+
+using namespace rbxdoc;
+
+static bool hasReferrer(const Document& doc, int32_t target, int32_t instanceId, uint32_t propertyIndex)
+{
+    for (const Referrer& referrer : doc.getReferrers(target))
+    {
+        if (referrer.instanceId == instanceId && referrer.propertyIndex == propertyIndex)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// every referrer is a non-null Ref (or object-sourced Content) property pointing back at the instance and every such property is listed
+static void checkReferenceIndex(const Document& doc)
+{
+    ArrayView<Instance> instances = doc.getInstances();
+    size_t numRefs = 0;
+    for (const Instance& inst : instances)
+    {
+        ArrayView<Property> props = inst.getProperties();
+        for (uint32_t propertyIndex = 0; propertyIndex < uint32_t(props.size()); propertyIndex++)
+        {
+            const Property& prop = props[propertyIndex];
+            bool isRef = prop.getType() == PropertyType::Ref ||
+                         (prop.getType() == PropertyType::Content && prop.asContentSourceType() == ContentSourceType::Object);
+            if (isRef && prop.asRef() >= 0)
+            {
+                numRefs++;
+                CHECK(hasReferrer(doc, prop.asRef(), inst.getId(), propertyIndex));
+            }
+        }
+    }
+
+    size_t numReferrers = 0;
+    for (const Instance& inst : instances)
+    {
+        for (const Referrer& referrer : doc.getReferrers(inst.getId()))
+        {
+            REQUIRE(referrer.instanceId >= 0 && size_t(referrer.instanceId) < instances.size());
+            ArrayView<Property> props = instances[referrer.instanceId].getProperties();
+            REQUIRE(referrer.propertyIndex < props.size());
+            CHECK(props[referrer.propertyIndex].asRef() == inst.getId());
+            numReferrers++;
+        }
+    }
+    CHECK(numRefs != 0);
+    CHECK(numReferrers == numRefs);
+}
+
+TEST_CASE(ReferenceIndexMatchesRefProperties)
+{
+    Document doc;
+    REQUIRE(doc.loadFile(rbxdoc_test::getDataPath("test.rbxm").c_str()) == LoadResult::OK);
+    CHECK(!doc.hasReferenceIndex());
+    for (const Instance& inst : doc.getInstances())
+    {
+        CHECK(doc.getReferrers(inst.getId()).size() == 0);
+    }
+
+    doc.buildReferenceIndex();
+    REQUIRE(doc.hasReferenceIndex());
+    checkReferenceIndex(doc);
+    CHECK(doc.getReferrers(-1).size() == 0);
+    CHECK(doc.getReferrers(int32_t(doc.getInstances().size())).size() == 0);
+
+    // the index follows the new ids
+    REQUIRE(doc.renumberDepthFirst());
+    REQUIRE(doc.hasReferenceIndex());
+    checkReferenceIndex(doc);
+}
+
+TEST_CASE(ReferenceIndexResolvesNullAndDanglingRefs)
+{
+    rbxdoc_test::RbxmBuilder file;
+    file.addInstances(0, "ObjectValue", {0, 1, 2, 3});
+    file.addProperty(0, "Value", PropertyType::Ref, rbxdoc_test::RbxmBuilder::refs({2, -1, 2, 17}));
+    file.addParents({0, 1, 2, 3}, {-1, -1, -1, -1});
+    std::string fileName = rbxdoc_test::getTempPath("rbxdoc_refs.rbxm");
+    REQUIRE(file.save(fileName));
+
+    Document doc;
+    REQUIRE(doc.loadFile(fileName.c_str()) == LoadResult::OK);
+    REQUIRE(rbxdoc_test::findProperty(doc, 0, "Value") != nullptr);
+    CHECK(rbxdoc_test::findProperty(doc, 0, "Value")->asRef() == 2);
+    CHECK(rbxdoc_test::findProperty(doc, 1, "Value")->asRef() == -1);
+    CHECK(rbxdoc_test::findProperty(doc, 2, "Value")->asRef() == 2);
+    CHECK(rbxdoc_test::findProperty(doc, 3, "Value")->asRef() == -1);
+
+    doc.buildReferenceIndex();
+    ArrayView<Referrer> referrers = doc.getReferrers(2);
+    REQUIRE(referrers.size() == 2);
+    CHECK(referrers[0].instanceId == 0 && referrers[1].instanceId == 2);
+    CHECK(doc.getReferrers(0).size() == 0);
+    CHECK(doc.getReferrers(1).size() == 0);
+    CHECK(doc.getReferrers(3).size() == 0);
+}
@@ -0,0 +1,134 @@
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "test.h"
+#include "test_rbxm.h"
+
+using namespace rbxdoc;
+using Builder = rbxdoc_test::RbxmBuilder;
+
+struct PartsFile
+{
+    std::vector<const char*> names = {"A", "B", "C"};
+    std::vector<float> transparency = {0.0f, 0.0f, 0.0f};
+    std::vector<int32_t> targets = {-1, 1, 1};
+    std::vector<int32_t> parents = {0, 0, 0};
+};
+
+// Root { parts }, every part has a Transparency and an ObjectValue-like Value ref
+static bool saveParts(const std::string& fileName, const PartsFile& parts)
+{
+    std::vector<int32_t> ids;
+    std::string names;
+    for (size_t i = 0; i < parts.names.size(); i++)
+    {
+        ids.push_back(int32_t(i + 1));
+        names += Builder::string(parts.names[i]);
+    }
+
+    Builder file;
+    file.addInstances(0, "Folder", {0});
+    file.addInstances(1, "Part", ids);
+    file.addProperty(0, "Name", PropertyType::String, Builder::string("Root"));
+    file.addProperty(1, "Name", PropertyType::String, names);
+    file.addProperty(1, "Transparency", PropertyType::Float, Builder::floats(parts.transparency));
+    file.addProperty(1, "Value", PropertyType::Ref, Builder::refs(parts.targets));
+    ids.insert(ids.begin(), 0);
+    std::vector<int32_t> parentIds = parts.parents;
+    parentIds.insert(parentIds.begin(), -1);
+    file.addParents(ids, parentIds);
+    return file.save(fileName);
+}
+
+// the reloaded document must be the same as a fresh load of the file
+static void checkSameAsLoad(const Document& doc, const std::string& fileName)
+{
+    Document fresh;
+    REQUIRE(fresh.loadFile(fileName.c_str()) == LoadResult::OK);
+    CHECK(rbxdoc_test::countDifferences(fresh, doc) == 0);
+    CHECK(fresh.getSubtreeHash(-1) == doc.getSubtreeHash(-1));
+    REQUIRE(fresh.getChunkHashes().size() == doc.getChunkHashes().size());
+    for (size_t i = 0; i < fresh.getChunkHashes().size(); i++)
+    {
+        CHECK(fresh.getChunkHashes()[i].hash == doc.getChunkHashes()[i].hash);
+        CHECK(fresh.getChunkHashes()[i].payloadHash == doc.getChunkHashes()[i].payloadHash);
+    }
+    for (int32_t id = 0; id < int32_t(fresh.getInstances().size()); id++)
+    {
+        CHECK(fresh.getParent(id) == doc.getParent(id));
+    }
+}
+
+TEST_CASE(ReloadOfAnUnchangedFile)
+{
+    std::string fileName = rbxdoc_test::getDataPath("test.rbxm");
+    Document doc;
+    REQUIRE(doc.loadFile(fileName.c_str()) == LoadResult::OK);
+    const Instance* instances = doc.getInstances().data();
+    REQUIRE(doc.reload(fileName.c_str()) == LoadResult::OK);
+    // nothing to patch, the instances stay where they were
+    CHECK(doc.getInstances().data() == instances);
+    checkSameAsLoad(doc, fileName);
+}
+
+TEST_CASE(ReloadPatchesChangedPropertiesAndParents)
+{
+    std::string fileName = rbxdoc_test::getTempPath("rbxdoc_reload.rbxm");
+    PartsFile parts;
+    REQUIRE(saveParts(fileName, parts));
+
+    Document doc;
+    REQUIRE(doc.loadFile(fileName.c_str()) == LoadResult::OK);
+    doc.buildReferenceIndex();
+    CHECK(doc.getReferrers(1).size() == 2);
+    const Instance* instances = doc.getInstances().data();
+
+    // one PROP chunk changes
+    parts.transparency[1] = 0.5f;
+    REQUIRE(saveParts(fileName, parts));
+    REQUIRE(doc.reload(fileName.c_str()) == LoadResult::OK);
+    CHECK(doc.getInstances().data() == instances);
+    CHECK(rbxdoc_test::findProperty(doc, 2, "Transparency")->asFloat() == 0.5f);
+    CHECK(rbxdoc_test::findProperty(doc, 1, "Transparency")->asFloat() == 0.0f);
+    checkSameAsLoad(doc, fileName);
+
+    // refs and parents change, the reference index follows
+    parts.targets = {3, -1, 3};
+    parts.parents = {0, 1, 0};
+    REQUIRE(saveParts(fileName, parts));
+    REQUIRE(doc.reload(fileName.c_str()) == LoadResult::OK);
+    CHECK(doc.getInstances().data() == instances);
+    CHECK(doc.getParent(2) == 1);
+    REQUIRE(doc.hasReferenceIndex());
+    CHECK(doc.getReferrers(1).size() == 0);
+    CHECK(doc.getReferrers(3).size() == 2);
+    checkSameAsLoad(doc, fileName);
+}
+
+TEST_CASE(ReloadFallsBackToFullLoad)
+{
+    std::string fileName = rbxdoc_test::getTempPath("rbxdoc_reload_full.rbxm");
+    PartsFile parts;
+    REQUIRE(saveParts(fileName, parts));
+    Document doc;
+    REQUIRE(doc.loadFile(fileName.c_str()) == LoadResult::OK);
+
+    // a new instance changes the INST chunk
+    parts.names.push_back("D");
+    parts.transparency.push_back(1.0f);
+    parts.targets.push_back(4);
+    parts.parents.push_back(1);
+    REQUIRE(saveParts(fileName, parts));
+    REQUIRE(doc.reload(fileName.c_str()) == LoadResult::OK);
+    CHECK(doc.getInstances().size() == 5);
+    checkSameAsLoad(doc, fileName);
+
+    // a broken file reports the error of a full load
+    Builder broken;
+    broken.addInstances(0, "Folder", {0});
+    broken.addParents({0}, {0});
+    REQUIRE(broken.save(fileName));
+    CHECK(doc.reload(fileName.c_str()) == LoadResult::Error);
+    CHECK(doc.getLoadError().code == LoadErrorCode::InvalidInstanceId);
+}
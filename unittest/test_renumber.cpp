@@ -0,0 +1,71 @@
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "test.h"
+
+using namespace rbxdoc;
+
+// Name of the instance a Ref property points at, for every Ref property in document order
+static std::vector<std::string> getRefTargetNames(const Document& doc)
+{
+    std::vector<std::string> names;
+    for (int32_t id : doc.getSubtree(-1))
+    {
+        for (const Property& prop : doc.getInstances()[id].getProperties())
+        {
+            if (prop.getType() == PropertyType::Ref)
+            {
+                const Property* name = (prop.asRef() >= 0) ? rbxdoc_test::findProperty(doc, prop.asRef(), "Name") : nullptr;
+                names.push_back(name ? name->asString() : "<null>");
+            }
+        }
+    }
+    return names;
+}
+
+TEST_CASE(RenumberDepthFirstMakesSubtreesContiguous)
+{
+    Document doc;
+    REQUIRE(doc.loadFile(rbxdoc_test::getDataPath("test.rbxm").c_str()) == LoadResult::OK);
+    std::vector<std::string> refTargets = getRefTargetNames(doc);
+    std::vector<int32_t> preorder;
+    for (int32_t id : doc.getSubtree(-1))
+    {
+        preorder.push_back(id);
+    }
+
+    CHECK(!doc.isDepthFirstOrdered());
+    REQUIRE(doc.renumberDepthFirst());
+    REQUIRE(doc.isDepthFirstOrdered());
+
+    // the old preorder position is the new id
+    for (size_t i = 0; i < preorder.size(); i++)
+    {
+        CHECK(doc.getOriginalId(int32_t(i)) == preorder[i]);
+        CHECK(doc.getIdFromOriginal(preorder[i]) == int32_t(i));
+    }
+
+    for (const Instance& inst : doc.getInstances())
+    {
+        size_t subtreeSize = 0;
+        for (int32_t id : doc.getSubtree(inst.getId()))
+        {
+            CHECK(id == inst.getId() + int32_t(subtreeSize));
+            subtreeSize++;
+        }
+        ArrayView<Instance> slice = doc.getSubtreeInstances(inst.getId());
+        CHECK(slice.size() == subtreeSize);
+        CHECK(slice.size() > 0 && slice[0].getId() == inst.getId());
+    }
+
+    // refs follow their targets
+    CHECK(getRefTargetNames(doc) == refTargets);
+
+    // renumbering twice composes the id mappings
+    REQUIRE(doc.renumberDepthFirst());
+    for (size_t i = 0; i < preorder.size(); i++)
+    {
+        CHECK(doc.getOriginalId(int32_t(i)) == preorder[i]);
+    }
+}
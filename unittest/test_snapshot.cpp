@@ -0,0 +1,129 @@
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <rbxdoc_snapshot.h>
+#include <string.h>
+#include <string>
+
+#include "test.h"
+#include "test_rbxm.h"
+
+using namespace rbxdoc;
+
+TEST_CASE(SnapshotRoundTripKeepsContent)
+{
+    Document source;
+    REQUIRE(source.loadFile(rbxdoc_test::getDataPath("test.rbxm").c_str()) == LoadResult::OK);
+    std::string fileName = rbxdoc_test::getTempPath("rbxdoc_test.rbxsnap");
+    REQUIRE(Snapshot::write(source, fileName.c_str(), 42));
+
+    Document doc;
+    REQUIRE(Snapshot::load(fileName.c_str(), doc, 42) == LoadResult::OK);
+    CHECK(doc.getInstances().size() == source.getInstances().size());
+    CHECK(doc.getTypes().size() == source.getTypes().size());
+    CHECK(rbxdoc_test::countDifferences(source, doc) == 0);
+    CHECK(doc.getSubtreeHash(-1) == source.getSubtreeHash(-1));
+    for (int32_t id = 0; id < int32_t(source.getInstances().size()); id++)
+    {
+        CHECK(doc.getParent(id) == source.getParent(id));
+    }
+
+    // the snapshot outlives the source document
+    uint64_t hash = doc.getSubtreeHash(-1);
+    source = Document();
+    CHECK(doc.getSubtreeHash(-1) == hash);
+
+    Document other;
+    CHECK(Snapshot::load(fileName.c_str(), other, 43) == LoadResult::Error);
+    CHECK(Snapshot::load(fileName.c_str(), other, 0) == LoadResult::OK);
+}
+
+TEST_CASE(SnapshotRejectsTruncatedFiles)
+{
+    Document source;
+    REQUIRE(source.loadFile(rbxdoc_test::getDataPath("test.rbxm").c_str()) == LoadResult::OK);
+    std::string fileName = rbxdoc_test::getTempPath("rbxdoc_truncated.rbxsnap");
+    REQUIRE(Snapshot::write(source, fileName.c_str()));
+    std::filesystem::resize_file(fileName, std::filesystem::file_size(fileName) / 2);
+
+    Document doc;
+    CHECK(Snapshot::load(fileName.c_str(), doc) == LoadResult::Error);
+    CHECK(doc.getLoadError().code != LoadErrorCode::None);
+    CHECK(doc.getInstances().size() == 0);
+}
+
+// Overwrites the int32 at index of a snapshot section, offsets follow the header layout of rbxdoc_snapshot.cpp
+static void patchSection(std::string& bytes, uint32_t section, size_t stride, size_t index, int32_t value)
+{
+    uint64_t offset = 0;
+    memcpy(&offset, bytes.data() + 32 + section * 16, sizeof(offset));
+    memcpy(&bytes[size_t(offset) + index * stride], &value, sizeof(value));
+}
+
+TEST_CASE(SnapshotRejectsParentCycles)
+{
+    // Root { A { B } }
+    rbxdoc_test::RbxmBuilder file;
+    file.addInstances(0, "Folder", {0, 1, 2});
+    file.addParents({0, 1, 2}, {-1, 0, 1});
+    std::string rbxmName = rbxdoc_test::getTempPath("rbxdoc_cycle.rbxm");
+    REQUIRE(file.save(rbxmName));
+    Document source;
+    REQUIRE(source.loadFile(rbxmName.c_str()) == LoadResult::OK);
+    std::string fileName = rbxdoc_test::getTempPath("rbxdoc_cycle.rbxsnap");
+    REQUIRE(Snapshot::write(source, fileName.c_str()));
+
+    std::string bytes;
+    {
+        std::ifstream in(fileName, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    REQUIRE(bytes.size() > 32 + 28 * 16);
+
+    // Root <-> A and B is the only root, section sizes and child offsets stay the same
+    const uint32_t kInstances = 5, kChildIds = 21, kRootIds = 22;
+    patchSection(bytes, kInstances, 12, 0, 1);
+    patchSection(bytes, kInstances, 12, 2, -1);
+    patchSection(bytes, kChildIds, 4, 0, 1);
+    patchSection(bytes, kChildIds, 4, 1, 0);
+    patchSection(bytes, kRootIds, 4, 0, 2);
+    {
+        std::ofstream out(fileName, std::ios::binary);
+        out.write(bytes.data(), std::streamsize(bytes.size()));
+    }
+
+    Document doc;
+    CHECK(Snapshot::load(fileName.c_str(), doc) == LoadResult::Error);
+    CHECK(doc.getLoadError().code == LoadErrorCode::InvalidInstanceId);
+    CHECK(strcmp(doc.getLoadError().reason, "Cyclic parent link") == 0);
+    CHECK(doc.getInstances().size() == 0);
+}
+
+TEST_CASE(SnapshotCacheServesTheSameDocument)
+{
+    std::filesystem::path directory = rbxdoc_test::getTempPath("rbxdoc_snapshot_cache");
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    SnapshotCache cache(directory.string().c_str());
+    std::string fileName = rbxdoc_test::getDataPath("test.rbxm");
+
+    Document source;
+    REQUIRE(source.loadFile(fileName.c_str()) == LoadResult::OK);
+
+    // the first load writes the snapshot, the second one reads it
+    Document first;
+    REQUIRE(cache.loadFile(fileName.c_str(), first) == LoadResult::OK);
+    size_t numSnapshots = 0;
+    for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(directory))
+    {
+        numSnapshots += (entry.path().extension() == ".rbxsnap") ? 1 : 0;
+    }
+    CHECK(numSnapshots == 1);
+
+    Document second;
+    REQUIRE(cache.loadFile(fileName.c_str(), second) == LoadResult::OK);
+    CHECK(rbxdoc_test::countDifferences(source, first) == 0);
+    CHECK(rbxdoc_test::countDifferences(source, second) == 0);
+    CHECK(second.getChunkHashes().size() == 0);
+    std::filesystem::remove_all(directory);
+}
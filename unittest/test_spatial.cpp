@@ -0,0 +1,90 @@
+#include <algorithm>
+#include <vector>
+
+#include "test.h"
+#include <rbxdoc_spatial.h>
+
+using namespace rbxdoc;
+
+static bool overlaps(const Aabb& a, const Aabb& b)
+{
+    return a.min.x <= b.max.x && b.min.x <= a.max.x && a.min.y <= b.max.y && b.min.y <= a.max.y && a.min.z <= b.max.z && b.min.z <= a.max.z;
+}
+
+// parts overlapping the box, checked one by one
+static std::vector<int32_t> queryBruteForce(const Document& doc, const SpatialIndex& index, const Aabb& box)
+{
+    std::vector<int32_t> res;
+    for (const Instance& inst : doc.getInstances())
+    {
+        Aabb bounds;
+        if (index.getBounds(inst.getId(), bounds) && overlaps(bounds, box))
+        {
+            res.push_back(inst.getId());
+        }
+    }
+    return res;
+}
+
+TEST_CASE(SpatialIndexQueriesMatchBruteForce)
+{
+    Document doc;
+    REQUIRE(doc.loadFile(rbxdoc_test::getDataPath("test.rbxm").c_str()) == LoadResult::OK);
+    SpatialIndex index;
+    index.build(doc);
+    REQUIRE(index.getPartCount() > 0);
+
+    int32_t doorId = rbxdoc_test::findInstance(doc, "MeshPart", "LF_door");
+    REQUIRE(doorId >= 0);
+    Aabb doorBounds;
+    REQUIRE(index.getBounds(doorId, doorBounds));
+
+    const float sizes[] = {0.5f, 2.0f, 10.0f, 1000.0f};
+    for (float size : sizes)
+    {
+        Vec3 center = Vec3{(doorBounds.min.x + doorBounds.max.x) * 0.5f, (doorBounds.min.y + doorBounds.max.y) * 0.5f,
+                           (doorBounds.min.z + doorBounds.max.z) * 0.5f};
+        Aabb box = Aabb{Vec3{center.x - size, center.y - size, center.z - size}, Vec3{center.x + size, center.y + size, center.z + size}};
+        std::vector<int32_t> found;
+        index.queryAabb(box, found);
+        std::sort(found.begin(), found.end());
+        CHECK(found == queryBruteForce(doc, index, box));
+        CHECK(std::find(found.begin(), found.end(), doorId) != found.end());
+    }
+}
+
+TEST_CASE(SpatialIndexRaycastAndRefit)
+{
+    Document doc;
+    REQUIRE(doc.loadFile(rbxdoc_test::getDataPath("test.rbxm").c_str()) == LoadResult::OK);
+    SpatialIndex index;
+    index.build(doc);
+
+    int32_t doorId = rbxdoc_test::findInstance(doc, "MeshPart", "LF_door");
+    REQUIRE(doorId >= 0);
+    const CFrame& cframe = rbxdoc_test::findProperty(doc, doorId, "CFrame")->asCFrame();
+    const Vec3& size = rbxdoc_test::findProperty(doc, doorId, "size")->asVec3();
+
+    // straight down through the door, the closest hit is one of all hits
+    Ray ray = Ray{Vec3{cframe.translation.x, cframe.translation.y + 100.0f, cframe.translation.z}, Vec3{0.0f, -1.0f, 0.0f}};
+    RayHit hit;
+    REQUIRE(index.raycast(ray, 1000.0f, hit));
+    CHECK(hit.distance > 0.0f && hit.distance <= 100.0f);
+    std::vector<int32_t> hits;
+    index.queryRay(ray, 1000.0f, hits);
+    CHECK(std::find(hits.begin(), hits.end(), doorId) != hits.end());
+    CHECK(std::find(hits.begin(), hits.end(), hit.id) != hits.end());
+
+    // move the door far away
+    CFrame moved = cframe;
+    moved.translation = Vec3{10000.0f, 10000.0f, 10000.0f};
+    REQUIRE(index.updatePart(doorId, moved, size));
+    index.refit();
+
+    std::vector<int32_t> found;
+    index.queryAabb(Aabb{Vec3{9990.0f, 9990.0f, 9990.0f}, Vec3{10010.0f, 10010.0f, 10010.0f}}, found);
+    CHECK(found.size() == 1 && found[0] == doorId);
+    hits.clear();
+    index.queryRay(ray, 1000.0f, hits);
+    CHECK(std::find(hits.begin(), hits.end(), doorId) == hits.end());
+}
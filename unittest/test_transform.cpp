@@ -0,0 +1,90 @@
+#include <string.h>
+
+#include "test.h"
+#include <rbxdoc_transform.h>
+
+using namespace rbxdoc;
+
+static bool isNear(const CFrame& a, const CFrame& b)
+{
+    for (int i = 0; i < 9; i++)
+    {
+        if (!rbxdoc_test::isNear(a.rotation.v[i], b.rotation.v[i], 0.001f))
+        {
+            return false;
+        }
+    }
+    return rbxdoc_test::isNear(a.translation.x, b.translation.x) && rbxdoc_test::isNear(a.translation.y, b.translation.y) &&
+           rbxdoc_test::isNear(a.translation.z, b.translation.z);
+}
+
+TEST_CASE(TransformModelsUseTheirPivot)
+{
+    Document doc;
+    REQUIRE(doc.loadFile(rbxdoc_test::getDataPath("test.rbxm").c_str()) == LoadResult::OK);
+    WorldTransforms transforms;
+    transforms.solve(doc);
+
+    size_t numPivots = 0;
+    for (const Instance& inst : doc.getInstances())
+    {
+        if (strcmp(doc.getTypeName(inst), "Model") != 0)
+        {
+            continue;
+        }
+        const Property* pivot = rbxdoc_test::findProperty(doc, inst.getId(), "WorldPivotData");
+        if (!pivot || !pivot->asOptionalCFrame().hasData)
+        {
+            continue;
+        }
+        numPivots++;
+        CHECK(transforms.isSpatial(inst.getId()));
+        CHECK(isNear(transforms.getTransform(inst.getId()), pivot->asOptionalCFrame().val));
+    }
+    CHECK(numPivots > 0);
+}
+
+TEST_CASE(TransformPartsAreWorldSpaceAndAttachmentsRelative)
+{
+    Document doc;
+    REQUIRE(doc.loadFile(rbxdoc_test::getDataPath("test.rbxm").c_str()) == LoadResult::OK);
+    WorldTransforms transforms;
+    transforms.solve(doc);
+
+    int32_t partId = rbxdoc_test::findInstance(doc, "MeshPart", "LF_door");
+    REQUIRE(partId >= 0);
+    CHECK(transforms.isSpatial(partId));
+    CHECK(isNear(transforms.getTransform(partId), rbxdoc_test::findProperty(doc, partId, "CFrame")->asCFrame()));
+
+    size_t numAttachments = 0;
+    for (const Instance& inst : doc.getInstances())
+    {
+        int32_t parentId = inst.getParentId();
+        if (strcmp(doc.getTypeName(inst), "Attachment") != 0 || parentId < 0)
+        {
+            continue;
+        }
+        numAttachments++;
+
+        // world = parent * local
+        const CFrame& parent = transforms.getTransform(parentId);
+        const CFrame& local = rbxdoc_test::findProperty(doc, inst.getId(), "CFrame")->asCFrame();
+        CFrame expected;
+        for (int row = 0; row < 3; row++)
+        {
+            for (int col = 0; col < 3; col++)
+            {
+                expected.rotation.v[row * 3 + col] = parent.rotation.v[row * 3 + 0] * local.rotation.v[col] +
+                                                     parent.rotation.v[row * 3 + 1] * local.rotation.v[3 + col] +
+                                                     parent.rotation.v[row * 3 + 2] * local.rotation.v[6 + col];
+            }
+        }
+        const float* p = parent.rotation.v;
+        const Vec3& t = local.translation;
+        expected.translation = Vec3{p[0] * t.x + p[1] * t.y + p[2] * t.z + parent.translation.x, p[3] * t.x + p[4] * t.y + p[5] * t.z + parent.translation.y,
+                                    p[6] * t.x + p[7] * t.y + p[8] * t.z + parent.translation.z};
+        CHECK(transforms.isSpatial(inst.getId()));
+        CHECK(isNear(transforms.getTransform(inst.getId()), expected));
+    }
+    CHECK(numAttachments > 0);
+}
@@ -0,0 +1,94 @@
+#include <fstream>
+#include <string.h>
+#include <string>
+
+#include "test.h"
+#include "test_rbxm.h"
+
+using namespace rbxdoc;
+using Builder = rbxdoc_test::RbxmBuilder;
+
+static bool saveText(const std::string& fileName, const char* text)
+{
+    std::ofstream out(fileName, std::ios::binary);
+    out << text;
+    return bool(out);
+}
+
+static const char* kXmlModel = R"(<roblox xmlns:xmime="http://www.w3.org/2005/05/xmlmime" version="4">
+  <Item class="Folder" referent="RBX0">
+    <Properties>
+      <string name="Name">R&amp;D</string>
+    </Properties>
+    <Item class="ObjectValue" referent="RBX1">
+      <Properties>
+        <string name="Name"><![CDATA[Link<1>]]></string>
+        <Ref name="Value">RBX0</Ref>
+        <int64 name="Big">9007199254740993</int64>
+        <Vector3 name="V">
+          <X>1</X>
+          <Y>2.5</Y>
+          <Z>-3</Z>
+        </Vector3>
+        <bool name="On">true</bool>
+      </Properties>
+    </Item>
+  </Item>
+</roblox>
+)";
+
+// the same model as kXmlModel
+static bool saveBinaryModel(const std::string& fileName)
+{
+    Builder file;
+    file.addInstances(0, "Folder", {0});
+    file.addInstances(1, "ObjectValue", {1});
+    file.addProperty(0, "Name", PropertyType::String, Builder::string("R&D"));
+    file.addProperty(1, "Name", PropertyType::String, Builder::string("Link<1>"));
+    file.addProperty(1, "Value", PropertyType::Ref, Builder::refs({0}));
+    file.addProperty(1, "Big", PropertyType::Int64, Builder::int64s({(int64_t(1) << 53) + 1}));
+    file.addProperty(1, "V", PropertyType::Vector3, Builder::floats({1.0f}) + Builder::floats({2.5f}) + Builder::floats({-3.0f}));
+    file.addProperty(1, "On", PropertyType::Bool, std::string(1, '\1'));
+    file.addParents({0, 1}, {-1, 0});
+    return file.save(fileName);
+}
+
+TEST_CASE(XmlReaderMatchesBinaryReader)
+{
+    std::string xmlName = rbxdoc_test::getTempPath("rbxdoc_model.rbxmx");
+    std::string binaryName = rbxdoc_test::getTempPath("rbxdoc_model.rbxm");
+    REQUIRE(saveText(xmlName, kXmlModel));
+    REQUIRE(saveBinaryModel(binaryName));
+
+    Document xml;
+    REQUIRE(xml.loadFile(xmlName.c_str()) == LoadResult::OK);
+    REQUIRE(xml.getInstances().size() == 2);
+    int32_t link = rbxdoc_test::findInstance(xml, "ObjectValue", "Link<1>");
+    REQUIRE(link >= 0);
+    CHECK(xml.getParent(link) == rbxdoc_test::findInstance(xml, "Folder", "R&D"));
+    CHECK(rbxdoc_test::findProperty(xml, link, "Value")->asRef() == xml.getParent(link));
+    CHECK(rbxdoc_test::findProperty(xml, link, "Big")->asInt64() == (int64_t(1) << 53) + 1);
+    CHECK(rbxdoc_test::findProperty(xml, link, "V")->asVec3().y == 2.5f);
+    CHECK(rbxdoc_test::findProperty(xml, link, "On")->asBool());
+    CHECK(xml.getChunkHashes().size() == 0);
+
+    Document binary;
+    REQUIRE(binary.loadFile(binaryName.c_str()) == LoadResult::OK);
+    CHECK(rbxdoc_test::countDifferences(binary, xml) == 0);
+    CHECK(binary.getSubtreeHash(-1) == xml.getSubtreeHash(-1));
+}
+
+TEST_CASE(XmlReaderRejectsMalformedFiles)
+{
+    std::string fileName = rbxdoc_test::getTempPath("rbxdoc_broken.rbxmx");
+    Document doc;
+    REQUIRE(saveText(fileName, "<roblox version=\"4\"><Item class=\"Folder\" referent=\"RBX0\"></Properties></roblox>"));
+    CHECK(doc.loadFile(fileName.c_str()) == LoadResult::Error);
+    CHECK(doc.getLoadError().code == LoadErrorCode::InvalidXml);
+    CHECK(doc.getInstances().size() == 0);
+
+    REQUIRE(saveText(fileName, "<roblox version=\"4\"><Item class=\"Folder\" referent=\"RBX0\"><Properties>"));
+    CHECK(doc.loadFile(fileName.c_str()) == LoadResult::Error);
+    CHECK(doc.getLoadError().code == LoadErrorCode::TruncatedData);
+    CHECK(doc.getInstances().size() == 0);
+}